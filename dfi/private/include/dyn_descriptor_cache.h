@@ -0,0 +1,47 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+#ifndef __DYN_DESCRIPTOR_CACHE_H_
+#define __DYN_DESCRIPTOR_CACHE_H_
+
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/queue.h>
+
+/*
+ * Process wide cache of parsed descriptors (interfaces, messages), shared by all bundles using the dfi library.
+ * A descriptor is read completely and looked up by the hash of its content, which includes the header with the name
+ * and version. A hit returns the already parsed object and increases its use count. The object is destroyed when the
+ * last user releases it.
+ */
+TAILQ_HEAD(descriptor_cache_entries_head, descriptor_cache_entry);
+
+struct descriptor_cache {
+    pthread_mutex_t mutex;
+    struct descriptor_cache_entries_head entries;
+    int (*parse)(FILE *descriptor, void **out);
+    void (*destroy)(void *parsed);
+};
+
+#define DESCRIPTOR_CACHE_INITIALIZER(cache, parseFn, destroyFn) \
+    { PTHREAD_MUTEX_INITIALIZER, TAILQ_HEAD_INITIALIZER((cache).entries), (parseFn), (destroyFn) }
+
+int descriptorCache_parse(struct descriptor_cache *cache, FILE *descriptor, void **out);
+int descriptorCache_release(struct descriptor_cache *cache, void *parsed);
+
+#endif
@@ -0,0 +1,384 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+#include "binary_rpc.h"
+#include "binary_serializer.h"
+#include "dyn_type.h"
+#include "dyn_interface.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ffi.h>
+
+
+static int OK = 0;
+static int ERROR = 1;
+
+DFI_SETUP_LOG(binaryRpc);
+
+typedef void (*gen_func_type)(void);
+
+struct generic_service_layout {
+	void *handle;
+	gen_func_type methods[];
+};
+
+struct binary_buffer {
+	char *buf;
+	size_t len;
+	size_t cap;
+};
+
+static uint32_t binaryRpc_hash(const char *id);
+static int binaryRpc_writeUInt32(struct binary_buffer *buffer, uint32_t val);
+static int binaryRpc_writeFlag(struct binary_buffer *buffer, bool flag);
+static int binaryRpc_readUInt32(const void *input, size_t inputLen, size_t *offset, uint32_t *val);
+static int binaryRpc_readFlag(const void *input, size_t inputLen, size_t *offset, bool *flag);
+
+int binaryRpc_call(dyn_interface_type *intf, void *service, const void *request, size_t requestLen, void **out, size_t *outLen) {
+	int status = OK;
+
+	size_t offset = 0;
+	uint32_t index = 0;
+	uint32_t hash = 0;
+	status = binaryRpc_readUInt32(request, requestLen, &offset, &index);
+	if (status == OK) {
+		status = binaryRpc_readUInt32(request, requestLen, &offset, &hash);
+	}
+	if (status != OK) {
+		LOG_ERROR("Binary request of %zu bytes too short for header\n", requestLen);
+		return status;
+	}
+
+	//methods are addressed by index, the hash catches descriptors that differ between both sides
+	struct methods_head *methods = NULL;
+	dynInterface_methods(intf, &methods);
+	struct method_entry *entry = NULL;
+	struct method_entry *method = NULL;
+	TAILQ_FOREACH(entry, methods, entries) {
+		if (entry->index == (int) index) {
+			method = entry;
+			break;
+		}
+	}
+
+	if (method == NULL) {
+		status = ERROR;
+		LOG_ERROR("Cannot find method with index %u", index);
+	} else if (binaryRpc_hash(method->id) != hash) {
+		status = ERROR;
+		LOG_ERROR("Signature of method %u ('%s') does not match the request", index, method->id);
+	} else {
+		dyn_type *returnType = dynFunction_returnType(method->dynFunc);
+		if (dynType_descriptorType(returnType) != 'N') {
+			//NOTE To be able to handle exception only N as returnType is supported
+			LOG_ERROR("Only interface methods with a native int are supported. Found type '%c'", (char)dynType_descriptorType(returnType));
+			status = ERROR;
+		}
+	}
+
+	if (status != OK) {
+		return status;
+	}
+
+	struct generic_service_layout *serv = service;
+	void *handle = serv->handle;
+	void (*fp)(void) = serv->methods[method->index];
+
+	dyn_function_type *func = method->dynFunc;
+	int nrOfArgs = dynFunction_nrOfArguments(func);
+	void *args[nrOfArgs];
+
+	void *ptr = NULL;
+	void *ptrToPtr = &ptr;
+
+	int i;
+	for (i = 0; i < nrOfArgs; i += 1) {
+		dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+		enum dyn_function_argument_meta  meta = dynFunction_argumentMetaForIndex(func, i);
+		args[i] = NULL;
+		if (meta == DYN_FUNCTION_ARGUMENT_META__STD) {
+			args[i] = calloc(1, dynType_size(argType));
+			if (args[i] != NULL) {
+				status = binarySerializer_deserializeFrom(argType, request, requestLen, &offset, args[i]);
+			} else {
+				status = ERROR;
+			}
+		} else if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+			dynType_alloc(argType, &args[i]);
+		} else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+			args[i] = &ptrToPtr;
+		} else if (meta == DYN_FUNCTION_ARGUMENT_META__HANDLE) {
+			args[i] = &handle;
+		}
+
+		if (status != OK) {
+			LOG_ERROR("Cannot read argument %i of '%s'", i, method->id);
+			break;
+		}
+	}
+
+	ffi_sarg returnVal = 1;
+
+	if (status == OK) {
+		status = dynFunction_call(func, fp, (void *) &returnVal, args);
+	}
+
+	int funcCallStatus = (int)returnVal;
+	if (funcCallStatus != 0) {
+		LOG_WARNING("Error calling remote endpoint function, got error code %i", funcCallStatus);
+	}
+
+	struct binary_buffer reply;
+	reply.buf = NULL;
+	reply.len = 0;
+	reply.cap = 0;
+	if (status == OK) {
+		status = binaryRpc_writeUInt32(&reply, (uint32_t) funcCallStatus);
+	}
+
+	for (i = 0; i < nrOfArgs; i += 1) {
+		dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+		enum dyn_function_argument_meta  meta = dynFunction_argumentMetaForIndex(func, i);
+		if (meta == DYN_FUNCTION_ARGUMENT_META__STD) {
+			if (args[i] != NULL) {
+				dynType_free(argType, args[i]);
+			}
+		} else if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+			if (status == OK && funcCallStatus == 0) {
+				//the typed pointer writes its presence byte
+				status = binarySerializer_serializeTo(argType, args[i], &reply.buf, &reply.len, &reply.cap);
+			}
+			if (args[i] != NULL) {
+				dynType_free(argType, args[i]);
+			}
+		} else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT && ptr != NULL) {
+			dyn_type *typedType = NULL;
+			dynType_typedPointer_getTypedType(argType, &typedType);
+			if (dynType_descriptorType(typedType) == 't') {
+				if (status == OK && funcCallStatus == 0) {
+					status = binaryRpc_writeFlag(&reply, true);
+				}
+				if (status == OK && funcCallStatus == 0) {
+					status = binarySerializer_serializeTo(typedType, (void *) &ptr, &reply.buf, &reply.len, &reply.cap);
+				}
+				free(ptr);
+			} else {
+				dyn_type *typedTypedType = NULL;
+				dynType_typedPointer_getTypedType(typedType, &typedTypedType);
+				if (status == OK && funcCallStatus == 0) {
+					status = binaryRpc_writeFlag(&reply, true);
+				}
+				if (status == OK && funcCallStatus == 0) {
+					status = binarySerializer_serializeTo(typedTypedType, ptr, &reply.buf, &reply.len, &reply.cap);
+				}
+				dynType_free(typedTypedType, ptr);
+			}
+			ptr = NULL;
+		} else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+			if (status == OK && funcCallStatus == 0) {
+				status = binaryRpc_writeFlag(&reply, false);
+			}
+		}
+	}
+
+	if (status == OK) {
+		*out = reply.buf;
+		*outLen = reply.len;
+	} else {
+		free(reply.buf);
+	}
+
+	return status;
+}
+
+int binaryRpc_prepareInvokeRequest(dyn_function_type *func, int methodIndex, const char *id, void *args[], void **out, size_t *outLen) {
+	int status = OK;
+
+	LOG_DEBUG("Calling remote function '%s'\n", id);
+	struct binary_buffer request;
+	request.buf = NULL;
+	request.len = 0;
+	request.cap = 0;
+
+	status = binaryRpc_writeUInt32(&request, (uint32_t) methodIndex);
+	if (status == OK) {
+		status = binaryRpc_writeUInt32(&request, binaryRpc_hash(id));
+	}
+
+	int i;
+	int nrOfArgs = dynFunction_nrOfArguments(func);
+	for (i = 0; i < nrOfArgs && status == OK; i +=1) {
+		dyn_type *type = dynFunction_argumentTypeForIndex(func, i);
+		enum dyn_function_argument_meta  meta = dynFunction_argumentMetaForIndex(func, i);
+		if (meta == DYN_FUNCTION_ARGUMENT_META__STD) {
+			status = binarySerializer_serializeTo(type, args[i], &request.buf, &request.len, &request.cap);
+		} else {
+			//skip handle / output types
+		}
+	}
+
+	if (status == OK) {
+		*out = request.buf;
+		*outLen = request.len;
+	} else {
+		free(request.buf);
+	}
+
+	return status;
+}
+
+int binaryRpc_handleReply(dyn_function_type *func, const void *reply, size_t replyLen, void *args[]) {
+	int status = OK;
+
+	size_t offset = 0;
+	uint32_t funcCallStatus = 0;
+	status = binaryRpc_readUInt32(reply, replyLen, &offset, &funcCallStatus);
+	if (status != OK) {
+		LOG_ERROR("Binary reply of %zu bytes too short", replyLen);
+	} else if (funcCallStatus != 0) {
+		status = ERROR;
+		LOG_ERROR("Remote function returned error %i", (int) funcCallStatus);
+	}
+
+	int nrOfArgs = dynFunction_nrOfArguments(func);
+	int i;
+	for (i = 0; i < nrOfArgs && status == OK; i += 1) {
+		dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+		enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+		if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+			void **out = (void **) args[i];
+			bool present = false;
+			status = binaryRpc_readFlag(reply, replyLen, &offset, &present);
+
+			if (status == OK && present) {
+				//decoded directly into the memory of the caller
+				dyn_type *subType = NULL;
+				dynType_typedPointer_getTypedType(argType, &subType);
+				status = binarySerializer_deserializeFrom(subType, reply, replyLen, &offset, *out);
+			}
+		} else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+			void ***out = (void ***) args[i];
+			bool present = false;
+			status = binaryRpc_readFlag(reply, replyLen, &offset, &present);
+
+			dyn_type *subType = NULL;
+			dynType_typedPointer_getTypedType(argType, &subType);
+			if (status == OK && !present) {
+				**out = NULL;
+			} else if (status == OK && dynType_descriptorType(subType) == 't') {
+				status = binarySerializer_deserializeFrom(subType, reply, replyLen, &offset, *out);
+			} else if (status == OK) {
+				dyn_type *subSubType = NULL;
+				dynType_typedPointer_getTypedType(subType, &subSubType);
+				void *inst = calloc(1, dynType_size(subSubType));
+				if (inst != NULL) {
+					status = binarySerializer_deserializeFrom(subSubType, reply, replyLen, &offset, inst);
+				} else {
+					status = ERROR;
+				}
+				if (status == OK) {
+					**out = inst;
+				} else {
+					dynType_free(subSubType, inst);
+				}
+			}
+		} else {
+			//skip
+		}
+	}
+
+	return status;
+}
+
+static uint32_t binaryRpc_hash(const char *id) {
+	//FNV-1a
+	uint32_t hash = 2166136261U;
+	const unsigned char *c;
+	for (c = (const unsigned char *) id; *c != '\0'; c += 1) {
+		hash ^= *c;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+static int binaryRpc_grow(struct binary_buffer *buffer, size_t size) {
+	int status = OK;
+
+	if (buffer->len + size > buffer->cap) {
+		size_t cap = buffer->cap == 0 ? 256 : buffer->cap;
+		while (buffer->len + size > cap) {
+			cap *= 2;
+		}
+		char *buf = realloc(buffer->buf, cap);
+		if (buf != NULL) {
+			buffer->buf = buf;
+			buffer->cap = cap;
+		} else {
+			status = ERROR;
+			LOG_ERROR("Cannot grow binary buffer to %zu bytes", cap);
+		}
+	}
+
+	return status;
+}
+
+static int binaryRpc_writeUInt32(struct binary_buffer *buffer, uint32_t val) {
+	int status = binaryRpc_grow(buffer, 4);
+	if (status == OK) {
+		int i;
+		for (i = 0; i < 4; i += 1) {
+			buffer->buf[buffer->len++] = (char) ((val >> (8 * i)) & 0xFF);
+		}
+	}
+	return status;
+}
+
+static int binaryRpc_writeFlag(struct binary_buffer *buffer, bool flag) {
+	int status = binaryRpc_grow(buffer, 1);
+	if (status == OK) {
+		buffer->buf[buffer->len++] = flag ? 1 : 0;
+	}
+	return status;
+}
+
+static int binaryRpc_readUInt32(const void *input, size_t inputLen, size_t *offset, uint32_t *val) {
+	int status = OK;
+	if (*offset + 4 > inputLen) {
+		status = ERROR;
+	} else {
+		const unsigned char *buf = (const unsigned char *) input + *offset;
+		*val = (uint32_t) buf[0] | ((uint32_t) buf[1] << 8) | ((uint32_t) buf[2] << 16) | ((uint32_t) buf[3] << 24);
+		*offset += 4;
+	}
+	return status;
+}
+
+static int binaryRpc_readFlag(const void *input, size_t inputLen, size_t *offset, bool *flag) {
+	int status = OK;
+	if (*offset + 1 > inputLen) {
+		status = ERROR;
+		LOG_ERROR("Unexpected end of binary reply at offset %zu", *offset);
+	} else {
+		*flag = ((const char *) input)[*offset] != 0;
+		*offset += 1;
+	}
+	return status;
+}
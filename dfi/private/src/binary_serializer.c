@@ -0,0 +1,560 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+#include "binary_serializer.h"
+#include "dyn_type.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BINARY_SERIALIZER_INITIAL_SIZE 256
+#define BINARY_SERIALIZER_NULL_TEXT 0xFFFFFFFF
+#define BINARY_SERIALIZER_ARENA_FACTOR 2
+
+struct binary_writer {
+    char *buf;
+    size_t len;
+    size_t cap;
+};
+
+struct binary_reader {
+    const char *buf;
+    size_t len;
+    size_t pos;
+    dyn_arena *arena; //allocate the read values in this arena, NULL for the heap
+};
+
+static int binarySerializer_createType(dyn_type *type, struct binary_reader *reader, void **result);
+static int binarySerializer_readAny(dyn_type *type, struct binary_reader *reader, void *loc);
+static int binarySerializer_readComplex(dyn_type *type, struct binary_reader *reader, void *loc);
+static int binarySerializer_readSequence(dyn_type *type, struct binary_reader *reader, void *seqLoc);
+static int binarySerializer_readText(struct binary_reader *reader, char **text);
+static int binarySerializer_readValue(struct binary_reader *reader, void *val, size_t size);
+
+static int binarySerializer_writeAny(dyn_type *type, struct binary_writer *writer, void *input);
+static int binarySerializer_writeComplex(dyn_type *type, struct binary_writer *writer, void *input);
+static int binarySerializer_writeSequence(dyn_type *type, struct binary_writer *writer, void *input);
+static int binarySerializer_writeText(struct binary_writer *writer, const char *text);
+static int binarySerializer_writeValue(struct binary_writer *writer, const void *val, size_t size);
+
+static int OK = 0;
+static int ERROR = 1;
+
+DFI_SETUP_LOG(binarySerializer);
+
+int binarySerializer_deserialize(dyn_type *type, const void *input, size_t inputLen, void **result) {
+    assert(dynType_type(type) == DYN_TYPE_COMPLEX || dynType_type(type) == DYN_TYPE_SEQUENCE);
+    int status = OK;
+
+    struct binary_reader reader;
+    reader.buf = input;
+    reader.len = inputLen;
+    reader.pos = 0;
+    reader.arena = NULL;
+
+    status = binarySerializer_createType(type, &reader, result);
+
+    if (status == OK && reader.pos != reader.len) {
+        LOG_WARNING("Ignoring %zu trailing bytes after binary input\n", reader.len - reader.pos);
+    }
+
+    if (status != OK) {
+        LOG_ERROR("Error cannot deserialize binary input of %zu bytes\n", inputLen);
+    }
+    return status;
+}
+
+int binarySerializer_deserializeInArena(dyn_type *type, const void *input, size_t inputLen, void **result) {
+    assert(dynType_type(type) == DYN_TYPE_COMPLEX || dynType_type(type) == DYN_TYPE_SEQUENCE);
+    int status = OK;
+
+    struct binary_reader reader;
+    reader.buf = input;
+    reader.len = inputLen;
+    reader.pos = 0;
+
+    //values seldom need more than twice their encoded size, so most messages fit in the first block
+    void *inst = NULL;
+    status = dynType_allocArena(type, BINARY_SERIALIZER_ARENA_FACTOR * inputLen, &inst);
+    if (status == OK) {
+        reader.arena = dynType_arena(type, inst);
+        status = binarySerializer_readAny(type, &reader, inst);
+    }
+
+    if (status == OK && reader.pos != reader.len) {
+        LOG_WARNING("Ignoring %zu trailing bytes after binary input\n", reader.len - reader.pos);
+    }
+
+    if (status == OK) {
+        *result = inst;
+    } else {
+        dynType_freeArena(type, inst);
+        LOG_ERROR("Error cannot deserialize binary input of %zu bytes\n", inputLen);
+    }
+    return status;
+}
+
+static int binarySerializer_createType(dyn_type *type, struct binary_reader *reader, void **result) {
+    int status = OK;
+    void *inst = NULL;
+
+    if (dynType_descriptorType(type) == 't') {
+        char *text = NULL;
+        status = binarySerializer_readText(reader, &text);
+        inst = text;
+    } else {
+        status = dynType_allocIn(type, reader->arena, &inst);
+
+        if (status == OK) {
+            assert(inst != NULL);
+            status = binarySerializer_readAny(type, reader, inst);
+        }
+    }
+
+    if (status == OK) {
+        *result = inst;
+    } else if (reader->arena == NULL) {
+        dynType_free(type, inst);
+    }
+
+    return status;
+}
+
+static int binarySerializer_readAny(dyn_type *type, struct binary_reader *reader, void *loc) {
+    int status = OK;
+
+    dyn_type *subType = NULL;
+    char c = dynType_descriptorType(type);
+    uint8_t flag = 0;
+    int32_t n = 0;
+
+    switch (c) {
+        case 'Z' :
+            status = binarySerializer_readValue(reader, &flag, 1);
+            if (status == OK) {
+                *(bool *)loc = flag != 0;
+            }
+            break;
+        case 'B' :
+        case 'b' :
+            status = binarySerializer_readValue(reader, loc, 1);
+            break;
+        case 'S' :
+        case 's' :
+            status = binarySerializer_readValue(reader, loc, 2);
+            break;
+        case 'I' :
+        case 'i' :
+        case 'F' :
+            status = binarySerializer_readValue(reader, loc, 4);
+            break;
+        case 'J' :
+        case 'j' :
+        case 'D' :
+            status = binarySerializer_readValue(reader, loc, 8);
+            break;
+        case 'N' :
+            status = binarySerializer_readValue(reader, &n, 4);
+            if (status == OK) {
+                *(int *)loc = (int) n;
+            }
+            break;
+        case 't' :
+            status = binarySerializer_readText(reader, (char **) loc);
+            break;
+        case '[' :
+            status = binarySerializer_readSequence(type, reader, loc);
+            break;
+        case '{' :
+            status = binarySerializer_readComplex(type, reader, loc);
+            break;
+        case '*' :
+            status = binarySerializer_readValue(reader, &flag, 1);
+            if (status == OK && flag != 0) {
+                status = dynType_typedPointer_getTypedType(type, &subType);
+                if (status == OK) {
+                    status = binarySerializer_createType(subType, reader, (void **) loc);
+                }
+            } else if (status == OK) {
+                *(void **)loc = NULL;
+            }
+            break;
+        case 'P' :
+            LOG_WARNING("Untyped pointer not supported for serialization. ignoring");
+            break;
+        default :
+            status = ERROR;
+            LOG_ERROR("Error provided type '%c' not supported for binary\n", c);
+            break;
+    }
+
+    return status;
+}
+
+static int binarySerializer_readComplex(dyn_type *type, struct binary_reader *reader, void *loc) {
+    assert(dynType_type(type) == DYN_TYPE_COMPLEX);
+    int status = OK;
+
+    //nested structs are flattened in the layout, read the values in order and skip the braces
+    const struct dyn_type_layout *layout = dynType_layout(type);
+    assert(layout != NULL);
+    unsigned int i;
+    for (i = 1; status == OK && i + 1 < layout->nrOfOps; i += 1) {
+        const struct dyn_type_op *op = &layout->ops[i];
+        if (op->descriptor != '{' && op->descriptor != '}') {
+            status = binarySerializer_readAny(op->type, reader, (char *)loc + op->offset);
+        }
+    }
+
+    return status;
+}
+
+static int binarySerializer_readSequence(dyn_type *type, struct binary_reader *reader, void *seqLoc) {
+    assert(dynType_type(type) == DYN_TYPE_SEQUENCE);
+    int status = OK;
+
+    uint32_t len = 0;
+    status = binarySerializer_readValue(reader, &len, sizeof(len));
+
+    dyn_type *itemType = NULL;
+    if (status == OK) {
+        itemType = dynType_sequence_itemType(type);
+        //every item needs at least one byte, reject lengths the remaining input can never satisfy
+        if (len > reader->len - reader->pos) {
+            status = ERROR;
+            LOG_ERROR("Sequence length %u exceeds remaining input of %zu bytes\n", len, reader->len - reader->pos);
+        }
+    }
+
+    if (status == OK) {
+        status = dynType_sequence_allocIn(type, reader->arena, seqLoc, len);
+    }
+
+    if (status == OK) {
+        uint32_t i;
+        for (i = 0; i < len; i += 1) {
+            void *valLoc = NULL;
+            status = dynType_sequence_increaseLengthAndReturnLastLoc(type, seqLoc, &valLoc);
+            if (status == OK) {
+                status = binarySerializer_readAny(itemType, reader, valLoc);
+            }
+            if (status != OK) {
+                break;
+            }
+        }
+    }
+
+    return status;
+}
+
+static int binarySerializer_readText(struct binary_reader *reader, char **text) {
+    int status = OK;
+
+    uint32_t len = 0;
+    status = binarySerializer_readValue(reader, &len, sizeof(len));
+
+    if (status == OK && len == BINARY_SERIALIZER_NULL_TEXT) {
+        *text = NULL;
+    } else if (status == OK) {
+        if (len > reader->len - reader->pos) {
+            status = ERROR;
+            LOG_ERROR("Text length %u exceeds remaining input of %zu bytes\n", len, reader->len - reader->pos);
+        } else {
+            char *str = reader->arena != NULL ? dynArena_alloc(reader->arena, len + 1) : malloc(len + 1);
+            if (str != NULL) {
+                memcpy(str, reader->buf + reader->pos, len);
+                str[len] = '\0';
+                reader->pos += len;
+                *text = str;
+            } else {
+                status = ERROR;
+                LOG_ERROR("Cannot allocate memory for string");
+            }
+        }
+    }
+
+    return status;
+}
+
+static int binarySerializer_readValue(struct binary_reader *reader, void *val, size_t size) {
+    int status = OK;
+
+    if (size > reader->len - reader->pos) {
+        status = ERROR;
+        LOG_ERROR("Unexpected end of binary input at offset %zu\n", reader->pos);
+    } else {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        size_t i;
+        for (i = 0; i < size; i += 1) {
+            ((char *)val)[i] = reader->buf[reader->pos + size - 1 - i];
+        }
+#else
+        memcpy(val, reader->buf + reader->pos, size);
+#endif
+        reader->pos += size;
+    }
+
+    return status;
+}
+
+int binarySerializer_serialize(dyn_type *type, const void *input, void **output, size_t *outputLen) {
+    int status = OK;
+
+    struct binary_writer writer;
+    writer.len = 0;
+    writer.cap = BINARY_SERIALIZER_INITIAL_SIZE;
+    writer.buf = malloc(writer.cap);
+    if (writer.buf == NULL) {
+        status = ERROR;
+        LOG_ERROR("Cannot allocate memory for binary output");
+    }
+
+    if (status == OK) {
+        status = binarySerializer_writeAny(type, &writer, (void *)input);
+    }
+
+    if (status == OK) {
+        *output = writer.buf;
+        *outputLen = writer.len;
+    } else {
+        free(writer.buf);
+    }
+
+    return status;
+}
+
+static int binarySerializer_writeAny(dyn_type *type, struct binary_writer *writer, void *input) {
+    int status = OK;
+
+    int descriptor = dynType_descriptorType(type);
+    dyn_type *subType = NULL;
+    uint8_t flag = 0;
+    int32_t n = 0;
+
+    switch (descriptor) {
+        case 'Z' :
+            flag = *(bool *)input ? 1 : 0;
+            status = binarySerializer_writeValue(writer, &flag, 1);
+            break;
+        case 'B' :
+        case 'b' :
+            status = binarySerializer_writeValue(writer, input, 1);
+            break;
+        case 'S' :
+        case 's' :
+            status = binarySerializer_writeValue(writer, input, 2);
+            break;
+        case 'I' :
+        case 'i' :
+        case 'F' :
+            status = binarySerializer_writeValue(writer, input, 4);
+            break;
+        case 'J' :
+        case 'j' :
+        case 'D' :
+            status = binarySerializer_writeValue(writer, input, 8);
+            break;
+        case 'N' :
+            n = (int32_t) *(int *)input;
+            status = binarySerializer_writeValue(writer, &n, 4);
+            break;
+        case 't' :
+            status = binarySerializer_writeText(writer, *(const char **) input);
+            break;
+        case '*' :
+            flag = *(void **)input != NULL ? 1 : 0;
+            status = binarySerializer_writeValue(writer, &flag, 1);
+            if (status == OK && flag != 0) {
+                status = dynType_typedPointer_getTypedType(type, &subType);
+                if (status == OK) {
+                    status = binarySerializer_writeAny(subType, writer, *(void **)input);
+                }
+            }
+            break;
+        case '{' :
+            status = binarySerializer_writeComplex(type, writer, input);
+            break;
+        case '[' :
+            status = binarySerializer_writeSequence(type, writer, input);
+            break;
+        case 'P' :
+            LOG_WARNING("Untyped pointer not supported for serialization. ignoring");
+            break;
+        default :
+            LOG_ERROR("Unsupported descriptor '%c'", descriptor);
+            status = ERROR;
+            break;
+    }
+
+    return status;
+}
+
+static int binarySerializer_writeComplex(dyn_type *type, struct binary_writer *writer, void *input) {
+    assert(dynType_type(type) == DYN_TYPE_COMPLEX);
+    int status = OK;
+
+    //nested structs are flattened in the layout, write the values in order and skip the braces
+    const struct dyn_type_layout *layout = dynType_layout(type);
+    assert(layout != NULL);
+    unsigned int i;
+    for (i = 1; status == OK && i + 1 < layout->nrOfOps; i += 1) {
+        const struct dyn_type_op *op = &layout->ops[i];
+        if (op->descriptor != '{' && op->descriptor != '}') {
+            status = binarySerializer_writeAny(op->type, writer, (char *)input + op->offset);
+        }
+    }
+
+    return status;
+}
+
+static int binarySerializer_writeSequence(dyn_type *type, struct binary_writer *writer, void *input) {
+    assert(dynType_type(type) == DYN_TYPE_SEQUENCE);
+    int status = OK;
+
+    dyn_type *itemType = dynType_sequence_itemType(type);
+    uint32_t len = dynType_sequence_length(input);
+    status = binarySerializer_writeValue(writer, &len, sizeof(len));
+
+    uint32_t i;
+    void *itemLoc = NULL;
+    for (i = 0; status == OK && i < len; i += 1) {
+        status = dynType_sequence_locForIndex(type, input, i, &itemLoc);
+        if (status == OK) {
+            status = binarySerializer_writeAny(itemType, writer, itemLoc);
+        }
+    }
+
+    return status;
+}
+
+static int binarySerializer_writeText(struct binary_writer *writer, const char *text) {
+    int status = OK;
+
+    uint32_t len = text != NULL ? (uint32_t) strlen(text) : BINARY_SERIALIZER_NULL_TEXT;
+    status = binarySerializer_writeValue(writer, &len, sizeof(len));
+
+    if (status == OK && text != NULL) {
+        if (writer->len + len > writer->cap) {
+            size_t cap = writer->cap;
+            while (writer->len + len > cap) {
+                cap *= 2;
+            }
+            char *buf = realloc(writer->buf, cap);
+            if (buf != NULL) {
+                writer->buf = buf;
+                writer->cap = cap;
+            } else {
+                status = ERROR;
+                LOG_ERROR("Cannot grow binary output to %zu bytes", cap);
+            }
+        }
+        if (status == OK) {
+            memcpy(writer->buf + writer->len, text, len);
+            writer->len += len;
+        }
+    }
+
+    return status;
+}
+
+static int binarySerializer_writeValue(struct binary_writer *writer, const void *val, size_t size) {
+    int status = OK;
+
+    if (writer->len + size > writer->cap) {
+        size_t cap = writer->cap * 2;
+        char *buf = realloc(writer->buf, cap);
+        if (buf != NULL) {
+            writer->buf = buf;
+            writer->cap = cap;
+        } else {
+            status = ERROR;
+            LOG_ERROR("Cannot grow binary output to %zu bytes", cap);
+        }
+    }
+
+    if (status == OK) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        size_t i;
+        for (i = 0; i < size; i += 1) {
+            writer->buf[writer->len + i] = ((const char *)val)[size - 1 - i];
+        }
+#else
+        memcpy(writer->buf + writer->len, val, size);
+#endif
+        writer->len += size;
+    }
+
+    return status;
+}
+
+int binarySerializer_serializeTo(dyn_type *type, const void *input, char **output, size_t *outputLen, size_t *outputCap) {
+    int status = OK;
+
+    struct binary_writer writer;
+    writer.buf = *output;
+    writer.len = *outputLen;
+    writer.cap = *outputCap;
+    if (writer.buf == NULL || writer.cap == 0) {
+        writer.len = 0;
+        writer.cap = BINARY_SERIALIZER_INITIAL_SIZE;
+        writer.buf = malloc(writer.cap);
+        if (writer.buf == NULL) {
+            status = ERROR;
+            LOG_ERROR("Cannot allocate memory for binary output");
+        }
+    }
+
+    if (status == OK) {
+        status = binarySerializer_writeAny(type, &writer, (void *)input);
+
+        //the buffer can have grown, also when writing failed halfway
+        *output = writer.buf;
+        *outputLen = writer.len;
+        *outputCap = writer.cap;
+    }
+
+    return status;
+}
+
+int binarySerializer_deserializeFrom(dyn_type *type, const void *input, size_t inputLen, size_t *offset, void *loc) {
+    int status = OK;
+
+    struct binary_reader reader;
+    reader.buf = input;
+    reader.len = inputLen;
+    reader.pos = *offset;
+    reader.arena = NULL;
+
+    if (reader.pos > reader.len) {
+        status = ERROR;
+        LOG_ERROR("Offset %zu beyond binary input of %zu bytes\n", reader.pos, reader.len);
+    }
+
+    if (status == OK) {
+        status = binarySerializer_readAny(type, &reader, loc);
+    }
+
+    if (status == OK) {
+        *offset = reader.pos;
+    }
+
+    return status;
+}
@@ -0,0 +1,166 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+#include "dyn_descriptor_cache.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DESCRIPTOR_CACHE_READ_SIZE 1024
+
+struct descriptor_cache_entry {
+    uint64_t hash;
+    size_t len;
+    char *content;
+    void *parsed;
+    unsigned int useCount;
+    TAILQ_ENTRY(descriptor_cache_entry) entries;
+};
+
+static int descriptorCache_readAll(FILE *descriptor, char **content, size_t *len);
+static uint64_t descriptorCache_hash(const char *content, size_t len);
+
+static const int OK = 0;
+static const int ERROR = 1;
+
+int descriptorCache_parse(struct descriptor_cache *cache, FILE *descriptor, void **out) {
+    char *content = NULL;
+    size_t len = 0;
+    int status = descriptorCache_readAll(descriptor, &content, &len);
+    if (status != OK) {
+        return status;
+    }
+
+    uint64_t hash = descriptorCache_hash(content, len);
+
+    pthread_mutex_lock(&cache->mutex);
+    struct descriptor_cache_entry *entry = NULL;
+    TAILQ_FOREACH(entry, &cache->entries, entries) {
+        if (entry->hash == hash && entry->len == len && memcmp(entry->content, content, len) == 0) {
+            break;
+        }
+    }
+
+    if (entry != NULL) {
+        entry->useCount += 1;
+        free(content);
+    } else {
+        //parsed while holding the lock, so concurrent users of a new descriptor parse it only once
+        entry = calloc(1, sizeof(*entry));
+        FILE *stream = NULL;
+        if (entry != NULL) {
+            stream = fmemopen(content, len, "r");
+        }
+        if (stream != NULL) {
+            status = cache->parse(stream, &entry->parsed);
+            fclose(stream);
+        } else {
+            status = ERROR;
+        }
+
+        if (status == OK) {
+            entry->hash = hash;
+            entry->len = len;
+            entry->content = content;
+            entry->useCount = 1;
+            TAILQ_INSERT_TAIL(&cache->entries, entry, entries);
+        } else {
+            free(entry);
+            entry = NULL;
+            free(content);
+        }
+    }
+
+    if (entry != NULL) {
+        *out = entry->parsed;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    return status;
+}
+
+int descriptorCache_release(struct descriptor_cache *cache, void *parsed) {
+    int status = ERROR;
+    struct descriptor_cache_entry *entry = NULL;
+
+    pthread_mutex_lock(&cache->mutex);
+    TAILQ_FOREACH(entry, &cache->entries, entries) {
+        if (entry->parsed == parsed) {
+            status = OK;
+            entry->useCount -= 1;
+            if (entry->useCount == 0) {
+                TAILQ_REMOVE(&cache->entries, entry, entries);
+            } else {
+                entry = NULL;
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    if (entry != NULL) {
+        cache->destroy(entry->parsed);
+        free(entry->content);
+        free(entry);
+    }
+
+    return status;
+}
+
+static int descriptorCache_readAll(FILE *descriptor, char **content, size_t *len) {
+    size_t cap = DESCRIPTOR_CACHE_READ_SIZE;
+    size_t size = 0;
+    char *buf = malloc(cap);
+    bool done = false;
+
+    while (buf != NULL && !done) {
+        size += fread(buf + size, 1, cap - size, descriptor);
+        if (size < cap) {
+            done = true;
+        } else {
+            char *grown = realloc(buf, cap * 2);
+            if (grown == NULL) {
+                free(buf);
+            }
+            buf = grown;
+            cap *= 2;
+        }
+    }
+
+    if (buf == NULL || ferror(descriptor)) {
+        free(buf);
+        return ERROR;
+    }
+
+    *content = buf;
+    *len = size;
+    return OK;
+}
+
+/* 64 bit FNV-1a */
+static uint64_t descriptorCache_hash(const char *content, size_t len) {
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i;
+    for (i = 0; i < len; i += 1) {
+        hash ^= (uint8_t) content[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
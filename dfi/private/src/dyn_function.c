@@ -20,10 +20,24 @@
 
 #include <strings.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <ffi.h>
 
 #include "dyn_common.h"
 
+/*
+ * Functions with at most DYN_FUNCTION_MAX_DIRECT_ARGS integer or pointer arguments, returning void, an integer or a
+ * pointer, are called through a trampoline that casts the function pointer to a signature with only machine word
+ * arguments, instead of through ffi_call. This relies on the calling convention passing these arguments in the same
+ * general purpose registers (or word sized stack slots), which holds for the ABIs for which dyn_function.h enables
+ * DYN_FUNCTION_DIRECT_CALL.
+ */
+
+#define DYN_FUNCTION_MAX_DIRECT_ARGS 6
+
+typedef uintptr_t dyn_word;
+typedef void (*dyn_function_trampoline)(void (*fn)(void), const dyn_word *args, void *ret);
+
 struct _dyn_function_type {
     char *name;
     struct types_head *refTypes; //NOTE not owned
@@ -31,6 +45,7 @@ struct _dyn_function_type {
     ffi_type **ffiArguments;
     dyn_type *funcReturn;
     ffi_cif cif;
+    dyn_function_trampoline trampoline; //NULL if the function is called through ffi_call
 
     //closure part
     ffi_closure *ffiClosure;
@@ -58,6 +73,8 @@ DFI_SETUP_LOG(dynFunction)
 static int dynFunction_initCif(dyn_function_type *dynFunc);
 static int dynFunction_parseDescriptor(dyn_function_type *dynFunc, FILE *descriptor);
 static void dynFunction_ffiBind(ffi_cif *cif, void *ret, void *args[], void *userData);
+static dyn_function_trampoline dynFunction_selectTrampoline(ffi_cif *cif);
+static void dynFunction_directCall(dyn_function_type *dynFunc, void(*fn)(void), void *returnValue, void **argValues);
 
 extern ffi_type * dynType_ffiType(dyn_type *type);
 
@@ -222,6 +239,8 @@ static int dynFunction_initCif(dyn_function_type *dynFunc) {
     int ffiResult = ffi_prep_cif(&dynFunc->cif, FFI_DEFAULT_ABI, count, returnType, args);
     if (ffiResult != FFI_OK) {
         status = 1;
+    } else {
+        dynFunc->trampoline = dynFunction_selectTrampoline(&dynFunc->cif);
     }
 
     return status;
@@ -260,10 +279,157 @@ void dynFunction_destroy(dyn_function_type *dynFunc) {
 }
 
 int dynFunction_call(dyn_function_type *dynFunc, void(*fn)(void), void *returnValue, void **argValues) {
-    ffi_call(&dynFunc->cif, fn, returnValue, argValues);
+    if (dynFunc->trampoline != NULL) {
+        dynFunction_directCall(dynFunc, fn, returnValue, argValues);
+    } else {
+        ffi_call(&dynFunc->cif, fn, returnValue, argValues);
+    }
     return 0;
 }
 
+bool dynFunction_hasDirectCall(dyn_function_type *dynFunc) {
+    return dynFunc->trampoline != NULL;
+}
+
+#if DYN_FUNCTION_DIRECT_CALL
+#define DYN_FUNCTION_TRAMPOLINES(n, params, args) \
+    static void dynFunction_callVoid##n(void (*fn)(void), const dyn_word *a, void *ret) { \
+        ((void (*)params) fn)args; \
+    } \
+    static void dynFunction_callInt##n(void (*fn)(void), const dyn_word *a, void *ret) { \
+        *(uint32_t *) ret = ((uint32_t (*)params) fn)args; \
+    } \
+    static void dynFunction_callWord##n(void (*fn)(void), const dyn_word *a, void *ret) { \
+        *(dyn_word *) ret = ((dyn_word (*)params) fn)args; \
+    }
+
+DYN_FUNCTION_TRAMPOLINES(0, (void), ())
+DYN_FUNCTION_TRAMPOLINES(1, (dyn_word), (a[0]))
+DYN_FUNCTION_TRAMPOLINES(2, (dyn_word, dyn_word), (a[0], a[1]))
+DYN_FUNCTION_TRAMPOLINES(3, (dyn_word, dyn_word, dyn_word), (a[0], a[1], a[2]))
+DYN_FUNCTION_TRAMPOLINES(4, (dyn_word, dyn_word, dyn_word, dyn_word), (a[0], a[1], a[2], a[3]))
+DYN_FUNCTION_TRAMPOLINES(5, (dyn_word, dyn_word, dyn_word, dyn_word, dyn_word), (a[0], a[1], a[2], a[3], a[4]))
+DYN_FUNCTION_TRAMPOLINES(6, (dyn_word, dyn_word, dyn_word, dyn_word, dyn_word, dyn_word), (a[0], a[1], a[2], a[3], a[4], a[5]))
+
+//indexed by the return kind (void, int, word) and the number of arguments
+static const dyn_function_trampoline dynFunction_trampolines[3][DYN_FUNCTION_MAX_DIRECT_ARGS + 1] = {
+    {dynFunction_callVoid0, dynFunction_callVoid1, dynFunction_callVoid2, dynFunction_callVoid3, dynFunction_callVoid4, dynFunction_callVoid5, dynFunction_callVoid6},
+    {dynFunction_callInt0, dynFunction_callInt1, dynFunction_callInt2, dynFunction_callInt3, dynFunction_callInt4, dynFunction_callInt5, dynFunction_callInt6},
+    {dynFunction_callWord0, dynFunction_callWord1, dynFunction_callWord2, dynFunction_callWord3, dynFunction_callWord4, dynFunction_callWord5, dynFunction_callWord6}
+};
+
+static bool dynFunction_isWordType(ffi_type *type) {
+    switch (type->type) {
+        case FFI_TYPE_UINT8 :
+        case FFI_TYPE_SINT8 :
+        case FFI_TYPE_UINT16 :
+        case FFI_TYPE_SINT16 :
+        case FFI_TYPE_UINT32 :
+        case FFI_TYPE_SINT32 :
+        case FFI_TYPE_INT :
+        case FFI_TYPE_UINT64 :
+        case FFI_TYPE_SINT64 :
+        case FFI_TYPE_POINTER :
+            return type->size <= sizeof(dyn_word);
+        default :
+            return false;
+    }
+}
+#endif
+
+static dyn_function_trampoline dynFunction_selectTrampoline(ffi_cif *cif) {
+    dyn_function_trampoline result = NULL;
+#if DYN_FUNCTION_DIRECT_CALL
+    bool direct = cif->nargs <= DYN_FUNCTION_MAX_DIRECT_ARGS;
+    unsigned int i;
+    for (i = 0; direct && i < cif->nargs; i += 1) {
+        direct = dynFunction_isWordType(cif->arg_types[i]);
+    }
+    if (direct) {
+        if (cif->rtype->type == FFI_TYPE_VOID) {
+            result = dynFunction_trampolines[0][cif->nargs];
+        } else if (dynFunction_isWordType(cif->rtype)) {
+            //the upper bits of a register holding a smaller return value are undefined, so these are read as 32 bit
+            result = dynFunction_trampolines[cif->rtype->size <= sizeof(uint32_t) ? 1 : 2][cif->nargs];
+        }
+    }
+#endif
+    return result;
+}
+
+static dyn_word dynFunction_loadWord(ffi_type *type, void *value) {
+    switch (type->type) {
+        case FFI_TYPE_UINT8 :
+            return *(uint8_t *) value;
+        case FFI_TYPE_SINT8 :
+            return (dyn_word) (intptr_t) *(int8_t *) value;
+        case FFI_TYPE_UINT16 :
+            return *(uint16_t *) value;
+        case FFI_TYPE_SINT16 :
+            return (dyn_word) (intptr_t) *(int16_t *) value;
+        case FFI_TYPE_UINT32 :
+            return *(uint32_t *) value;
+        case FFI_TYPE_SINT32 :
+        case FFI_TYPE_INT :
+            return (dyn_word) (intptr_t) *(int32_t *) value;
+        case FFI_TYPE_UINT64 :
+        case FFI_TYPE_SINT64 :
+            return (dyn_word) *(uint64_t *) value; //only selected if a word holds 64 bits
+        default :
+            return (dyn_word) *(void **) value;
+    }
+}
+
+static void dynFunction_directCall(dyn_function_type *dynFunc, void(*fn)(void), void *returnValue, void **argValues) {
+    dyn_word args[DYN_FUNCTION_MAX_DIRECT_ARGS];
+    unsigned int i;
+    for (i = 0; i < dynFunc->cif.nargs; i += 1) {
+        args[i] = dynFunction_loadWord(dynFunc->ffiArguments[i], argValues[i]);
+    }
+
+    union {
+        uint32_t i;
+        dyn_word w;
+    } ret;
+    dynFunc->trampoline(fn, args, &ret);
+
+    //like ffi_call, integral return values smaller than a ffi_arg are widened to a ffi_arg
+    ffi_type *rtype = dynFunc->cif.rtype;
+    switch (rtype->type) {
+        case FFI_TYPE_VOID :
+            break;
+        case FFI_TYPE_UINT8 :
+            *(ffi_arg *) returnValue = (uint8_t) ret.i;
+            break;
+        case FFI_TYPE_SINT8 :
+            *(ffi_sarg *) returnValue = (int8_t) ret.i;
+            break;
+        case FFI_TYPE_UINT16 :
+            *(ffi_arg *) returnValue = (uint16_t) ret.i;
+            break;
+        case FFI_TYPE_SINT16 :
+            *(ffi_sarg *) returnValue = (int16_t) ret.i;
+            break;
+        case FFI_TYPE_UINT32 :
+            *(ffi_arg *) returnValue = ret.i;
+            break;
+        case FFI_TYPE_SINT32 :
+        case FFI_TYPE_INT :
+            *(ffi_sarg *) returnValue = (int32_t) ret.i;
+            break;
+        case FFI_TYPE_POINTER :
+            if (rtype->size <= sizeof(uint32_t)) {
+                *(void **) returnValue = (void *) (dyn_word) ret.i;
+            } else {
+                *(void **) returnValue = (void *) ret.w;
+            }
+            break;
+        default :
+            *(uint64_t *) returnValue = ret.w;
+            break;
+    }
+}
+
 static void dynFunction_ffiBind(ffi_cif *cif, void *ret, void *args[], void *userData) {
     dyn_function_type *dynFunc = userData;
     dynFunc->bind(dynFunc->userData, args, ret);
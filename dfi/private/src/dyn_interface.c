@@ -24,6 +24,7 @@
 #include "dyn_common.h"
 #include "dyn_type.h"
 #include "dyn_interface.h"
+#include "dyn_descriptor_cache.h"
 
 DFI_SETUP_LOG(dynInterface);
 
@@ -46,6 +47,41 @@ static int dynInterface_parseHeader(dyn_interface_type *intf, FILE *stream);
 static int dynInterface_parseNameValueSection(dyn_interface_type *intf, FILE *stream, struct namvals_head *head);
 static int dynInterface_checkInterface(dyn_interface_type *intf);
 static int dynInterface_getEntryForHead(struct namvals_head *head, const char *name, char **value);
+static int dynInterface_parseAny(FILE *descriptor, void **out);
+static void dynInterface_destroyAny(void *intf);
+
+static struct descriptor_cache sharedInterfaces =
+        DESCRIPTOR_CACHE_INITIALIZER(sharedInterfaces, dynInterface_parseAny, dynInterface_destroyAny);
+
+int dynInterface_parseShared(FILE *descriptor, dyn_interface_type **out) {
+    void *intf = NULL;
+    int status = descriptorCache_parse(&sharedInterfaces, descriptor, &intf);
+    if (status == OK) {
+        *out = intf;
+    } else {
+        LOG_ERROR("Error parsing shared interface descriptor\n");
+    }
+    return status;
+}
+
+void dynInterface_release(dyn_interface_type *intf) {
+    if (intf != NULL && descriptorCache_release(&sharedInterfaces, intf) != OK) {
+        LOG_ERROR("Released interface %p is not a shared interface\n", (void *) intf);
+    }
+}
+
+static int dynInterface_parseAny(FILE *descriptor, void **out) {
+    dyn_interface_type *intf = NULL;
+    int status = dynInterface_parse(descriptor, &intf);
+    if (status == OK) {
+        *out = intf;
+    }
+    return status;
+}
+
+static void dynInterface_destroyAny(void *intf) {
+    dynInterface_destroy(intf);
+}
 
 int dynInterface_parse(FILE *descriptor, dyn_interface_type **out) {
     int status = OK;
@@ -23,6 +23,7 @@
 
 #include "dyn_common.h"
 #include "dyn_type.h"
+#include "dyn_descriptor_cache.h"
 
 DFI_SETUP_LOG(dynMessage);
 
@@ -45,6 +46,41 @@ static int dynMessage_parseHeader(dyn_message_type *msg, FILE *stream);
 static int dynMessage_parseNameValueSection(dyn_message_type *msg, FILE *stream, struct namvals_head *head);
 static int dynMessage_checkMessage(dyn_message_type *msg);
 static int dynMessage_getEntryForHead(struct namvals_head *head, const char *name, char **value);
+static int dynMessage_parseAny(FILE *descriptor, void **out);
+static void dynMessage_destroyAny(void *msg);
+
+static struct descriptor_cache sharedMessages =
+        DESCRIPTOR_CACHE_INITIALIZER(sharedMessages, dynMessage_parseAny, dynMessage_destroyAny);
+
+int dynMessage_parseShared(FILE *descriptor, dyn_message_type **out) {
+    void *msg = NULL;
+    int status = descriptorCache_parse(&sharedMessages, descriptor, &msg);
+    if (status == OK) {
+        *out = msg;
+    } else {
+        LOG_ERROR("Error parsing shared message descriptor\n");
+    }
+    return status;
+}
+
+void dynMessage_release(dyn_message_type *msg) {
+    if (msg != NULL && descriptorCache_release(&sharedMessages, msg) != OK) {
+        LOG_ERROR("Released message %p is not a shared message\n", (void *) msg);
+    }
+}
+
+static int dynMessage_parseAny(FILE *descriptor, void **out) {
+    dyn_message_type *msg = NULL;
+    int status = dynMessage_parse(descriptor, &msg);
+    if (status == OK) {
+        *out = msg;
+    }
+    return status;
+}
+
+static void dynMessage_destroyAny(void *msg) {
+    dynMessage_destroy(msg);
+}
 
 int dynMessage_parse(FILE *descriptor, dyn_message_type **out) {
     int status = OK;
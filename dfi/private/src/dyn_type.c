@@ -48,7 +48,7 @@ static int dynType_parseSequence(FILE *stream, dyn_type *type);
 static int dynType_parseSimple(int c, dyn_type *type);
 static int dynType_parseTypedPointer(FILE *stream, dyn_type *type);
 static void dynType_prepCif(ffi_type *type);
-static unsigned short dynType_getOffset(dyn_type *type, int index);
+static size_t dynType_getOffset(dyn_type *type, int index);
 
 static void dynType_printAny(char *name, dyn_type *type, int depth, FILE *stream);
 static void dynType_printComplex(char *name, dyn_type *type, int depth, FILE *stream);
@@ -68,6 +68,24 @@ void dynType_freeSequenceType(dyn_type *type, void *seqLoc);
 
 static int dynType_parseMetaInfo(FILE *stream, dyn_type *type);
 
+static int dynType_initInstance(dyn_type *type, dyn_arena *arena, void *inst, void **bufLoc);
+
+static int dynType_compile(dyn_type *type);
+static unsigned int dynType_countOps(dyn_type *type);
+static void dynType_fillOps(dyn_type *type, const char *name, size_t offset, struct dyn_type_layout *layout);
+
+#define DYN_ARENA_ALIGN 16
+#define DYN_ARENA_ALIGN_UP(size) (((size) + DYN_ARENA_ALIGN - 1) & ~((size_t) DYN_ARENA_ALIGN - 1))
+#define DYN_ARENA_MIN_BLOCK_SIZE 1024
+
+/* Stored in the first block, directly after the arena instance */
+struct _dyn_arena {
+    char *pos;
+    char *end;
+    size_t blockSize;
+    void *blocks; //additional blocks, each block starts with a pointer to the next one
+};
+
 struct generic_sequence {
     uint32_t cap;
     uint32_t len;
@@ -91,6 +109,7 @@ struct _dyn_type {
     struct types_head *referenceTypes; //NOTE: not owned
     struct types_head nestedTypesHead;
     struct meta_properties_head metaProperties;
+    struct dyn_type_layout layout; //not for references
     union {
         struct {
             struct complex_type_entries_head entriesHead;
@@ -116,7 +135,15 @@ static const int MEM_ERROR = 2;
 static const int PARSE_ERROR = 3;
 
 int dynType_parse(FILE *descriptorStream, const char *name, struct types_head *refTypes, dyn_type **type) {
-    return dynType_parseWithStream(descriptorStream, name, NULL, refTypes, type);
+    int status = dynType_parseWithStream(descriptorStream, name, NULL, refTypes, type);
+    if (status == OK) {
+        status = dynType_compile(*type);
+        if (status != OK) {
+            dynType_destroy(*type);
+            *type = NULL;
+        }
+    }
+    return status;
 }
 
 int dynType_parseWithStr(const char *descriptor, const char *name, struct types_head *refTypes, dyn_type **type) {
@@ -130,7 +157,14 @@ int dynType_parseWithStr(const char *descriptor, const char *name, struct types_
                 status = PARSE_ERROR;
                 LOG_ERROR("Expected EOF got %c", c);
             }
-        } 
+            if (status == OK) {
+                status = dynType_compile(*type);
+            }
+            if (status != OK) {
+                dynType_destroy(*type);
+                *type = NULL;
+            }
+        }
         fclose(stream);
     } else {
         status = ERROR;
@@ -562,6 +596,8 @@ static void dynType_clear(dyn_type *type) {
     if (type->name != NULL) {
         free(type->name);
     }
+
+    free(type->layout.ops);
 }
 
 static void dynType_clearComplex(dyn_type *type) {
@@ -600,18 +636,25 @@ static void dynType_clearTypedPointer(dyn_type *type) {
 }
 
 int dynType_alloc(dyn_type *type, void **bufLoc) {
+    return dynType_allocIn(type, NULL, bufLoc);
+}
+
+int dynType_allocIn(dyn_type *type, dyn_arena *arena, void **bufLoc) {
     assert(type->type != DYN_TYPE_REF);
     assert(type->ffiType->size != 0);
+    return dynType_initInstance(type, arena, dynArena_alloc(arena, type->ffiType->size), bufLoc);
+}
+
+static int dynType_initInstance(dyn_type *type, dyn_arena *arena, void *inst, void **bufLoc) {
     int status = OK;
 
-    void *inst = calloc(1, type->ffiType->size);
     if (inst != NULL) {
         if (type->type == DYN_TYPE_TYPED_POINTER) {
             void *ptr = NULL;
             dyn_type *sub = NULL;
             status = dynType_typedPointer_getTypedType(type, &sub);
             if (status == OK) {
-                status = dynType_alloc(sub, &ptr);
+                status = dynType_allocIn(sub, arena, &ptr);
                 if (status == OK) {
                     *(void **)inst = ptr;
                 }
@@ -626,6 +669,77 @@ int dynType_alloc(dyn_type *type, void **bufLoc) {
     return status;
 }
 
+int dynType_allocArena(dyn_type *type, size_t capacity, void **instance) {
+    assert(type->type != DYN_TYPE_REF);
+    assert(type->ffiType->size != 0);
+    int status = OK;
+
+    size_t instSize = DYN_ARENA_ALIGN_UP(type->ffiType->size);
+    size_t arenaSize = DYN_ARENA_ALIGN_UP(sizeof(struct _dyn_arena));
+    capacity = DYN_ARENA_ALIGN_UP(capacity);
+    char *block = calloc(1, instSize + arenaSize + capacity);
+    if (block != NULL) {
+        dyn_arena *arena = (dyn_arena *)(block + instSize);
+        arena->pos = block + instSize + arenaSize;
+        arena->end = arena->pos + capacity;
+        arena->blockSize = capacity > DYN_ARENA_MIN_BLOCK_SIZE ? capacity : DYN_ARENA_MIN_BLOCK_SIZE;
+        arena->blocks = NULL;
+        status = dynType_initInstance(type, arena, block, instance);
+        if (status != OK) {
+            dynType_freeArena(type, block);
+            *instance = NULL;
+        }
+    } else {
+        status = MEM_ERROR;
+        LOG_ERROR("Error allocating arena for type '%c'", type->descriptor);
+    }
+
+    return status;
+}
+
+void dynType_freeArena(dyn_type *type, void *instance) {
+    if (instance != NULL) {
+        dyn_arena *arena = dynType_arena(type, instance);
+        void *block = arena->blocks;
+        while (block != NULL) {
+            void *next = *(void **)block;
+            free(block);
+            block = next;
+        }
+        free(instance);
+    }
+}
+
+dyn_arena * dynType_arena(dyn_type *type, void *instance) {
+    if (type->type == DYN_TYPE_REF) {
+        type = type->ref.ref;
+    }
+    return (dyn_arena *)((char *)instance + DYN_ARENA_ALIGN_UP(type->ffiType->size));
+}
+
+void * dynArena_alloc(dyn_arena *arena, size_t size) {
+    if (arena == NULL) {
+        return calloc(1, size);
+    }
+
+    size = DYN_ARENA_ALIGN_UP(size);
+    if (size > (size_t)(arena->end - arena->pos)) {
+        size_t blockSize = size > arena->blockSize ? size : arena->blockSize;
+        char *block = calloc(1, DYN_ARENA_ALIGN + blockSize);
+        if (block == NULL) {
+            LOG_ERROR("Error allocating arena block of %zu bytes", blockSize);
+            return NULL;
+        }
+        *(void **)block = arena->blocks;
+        arena->blocks = block;
+        arena->pos = block + DYN_ARENA_ALIGN;
+        arena->end = arena->pos + blockSize;
+    }
+
+    void *mem = arena->pos;
+    arena->pos += size;
+    return mem;
+}
 
 int dynType_complex_indexForName(dyn_type *type, const char *name) {
     assert(type->type == DYN_TYPE_COMPLEX);
@@ -677,12 +791,16 @@ int dynType_complex_entries(dyn_type *type, struct complex_type_entries_head **e
 
 //sequence
 int dynType_sequence_alloc(dyn_type *type, void *inst, uint32_t cap) {
+    return dynType_sequence_allocIn(type, NULL, inst, cap);
+}
+
+int dynType_sequence_allocIn(dyn_type *type, dyn_arena *arena, void *inst, uint32_t cap) {
     assert(type->type == DYN_TYPE_SEQUENCE);
     int status = OK;
     struct generic_sequence *seq = inst;
     if (seq != NULL) {
         size_t size = dynType_size(type->sequence.itemType);
-        seq->buf = calloc(cap, size);
+        seq->buf = arena != NULL ? dynArena_alloc(arena, (size_t) cap * size) : calloc(cap, size);
         if (seq->buf != NULL) {
             seq->cap = cap;
             seq->len = 0;;
@@ -704,23 +822,24 @@ void dynType_free(dyn_type *type, void *loc) {
 
 void dynType_deepFree(dyn_type *type, void *loc, bool alsoDeleteSelf) {
     if (loc != NULL) {
+        const struct dyn_type_layout *layout = dynType_layout(type);
         dyn_type *subType = NULL;
-        char *text = NULL;
-        switch (type->type) {
-            case DYN_TYPE_COMPLEX :
-                dynType_freeComplexType(type, loc);
-                break;
-            case DYN_TYPE_SEQUENCE :
-                dynType_freeSequenceType(type, loc);
-                break;
-            case DYN_TYPE_TYPED_POINTER:
-                dynType_typedPointer_getTypedType(type, &subType);
-                dynType_deepFree(subType, *(void **)loc, true);
-                break;
-            case DYN_TYPE_TEXT :
-                text = *(char **)loc;
-                free(text);
-                break;
+        unsigned int i;
+        for (i = 0; layout != NULL && !layout->plain && i < layout->nrOfOps; i += 1) {
+            const struct dyn_type_op *op = &layout->ops[i];
+            char *valLoc = (char *)loc + op->offset;
+            switch (op->descriptor) {
+                case '[' :
+                    dynType_freeSequenceType(op->type, valLoc);
+                    break;
+                case '*' :
+                    dynType_typedPointer_getTypedType(op->type, &subType);
+                    dynType_deepFree(subType, *(void **)valLoc, true);
+                    break;
+                case 't' :
+                    free(*(char **)valLoc);
+                    break;
+            }
         }
 
         if (alsoDeleteSelf) {
@@ -732,23 +851,19 @@ void dynType_deepFree(dyn_type *type, void *loc, bool alsoDeleteSelf) {
 void dynType_freeSequenceType(dyn_type *type, void *seqLoc) {
     struct generic_sequence *seq = seqLoc;
     dyn_type *itemType = dynType_sequence_itemType(type);
-    void *itemLoc = NULL;
-    int i;
-    for (i = 0; i < seq->len; i += 1) {
-        dynType_sequence_locForIndex(type, seqLoc, i, &itemLoc);
-        dynType_deepFree(itemType, itemLoc, false);
+    const struct dyn_type_layout *itemLayout = dynType_layout(itemType);
+    if (itemLayout != NULL && !itemLayout->plain) {
+        size_t itemSize = dynType_size(itemType);
+        uint32_t i;
+        for (i = 0; i < seq->len; i += 1) {
+            dynType_deepFree(itemType, (char *)seq->buf + i * itemSize, false);
+        }
     }
     free(seq->buf);
 }
 
 void dynType_freeComplexType(dyn_type *type, void *loc) {
-    struct complex_type_entry *entry = NULL;
-    int index = 0;
-    void *entryLoc = NULL;
-    TAILQ_FOREACH(entry, &type->complex.entriesHead, entries) {
-        dynType_complex_valLocAt(type, index++, loc, &entryLoc);
-        dynType_deepFree(entry->type, entryLoc, false);
-    }
+    dynType_deepFree(type, loc, false);
 }
 
 
@@ -775,14 +890,8 @@ int dynType_sequence_locForIndex(dyn_type *type, void *seqLoc, int index, void *
         LOG_WARNING("Requesting index (%i) outsize defined length (%u) but within capacity", index, seq->len);
     }
 
-    if (status == OK) { }
-    int i;
-    for (i = 0; i < seq->cap; i += 1) {
-        if (index == i) {
-            break;
-        } else {
-            valLoc += itemSize;
-        }
+    if (status == OK) {
+        valLoc += (size_t) index * itemSize;
     }
 
     (*out) = valLoc;
@@ -934,9 +1043,9 @@ static dyn_type * dynType_findType(dyn_type *type, char *name) {
     return result;
 }
 
-static unsigned short dynType_getOffset(dyn_type *type, int index) {
+static size_t dynType_getOffset(dyn_type *type, int index) {
     assert(type->type == DYN_TYPE_COMPLEX);
-    unsigned short offset = 0;
+    size_t offset = 0;
 
     ffi_type *ffiType = &type->complex.structType;
     int i;
@@ -955,6 +1064,110 @@ static unsigned short dynType_getOffset(dyn_type *type, int index) {
     return offset;
 }
 
+const struct dyn_type_layout * dynType_layout(dyn_type *type) {
+    dyn_type *rType = type;
+    if (type->type == DYN_TYPE_REF) {
+        rType = type->ref.ref;
+    }
+    return rType->layout.ops != NULL ? &rType->layout : NULL;
+}
+
+/*
+ * Compiles the layouts of the type and of all types it contains. Referenced types outside the type are compiled
+ * when they are parsed.
+ */
+static int dynType_compile(dyn_type *type) {
+    int status = OK;
+
+    struct type_entry *nested = NULL;
+    TAILQ_FOREACH(nested, &type->nestedTypesHead, entries) {
+        status = dynType_compile(nested->type);
+        if (status != OK) {
+            return status;
+        }
+    }
+
+    struct complex_type_entry *entry = NULL;
+    switch (type->type) {
+        case DYN_TYPE_COMPLEX :
+            TAILQ_FOREACH(entry, &type->complex.entriesHead, entries) {
+                status = dynType_compile(entry->type);
+                if (status != OK) {
+                    break;
+                }
+            }
+            break;
+        case DYN_TYPE_SEQUENCE :
+            status = dynType_compile(type->sequence.itemType);
+            break;
+        case DYN_TYPE_TYPED_POINTER :
+            status = dynType_compile(type->typedPointer.typedType);
+            break;
+    }
+
+    if (status == OK && type->type != DYN_TYPE_REF && type->layout.ops == NULL) {
+        unsigned int nrOfOps = dynType_countOps(type);
+        type->layout.ops = calloc(nrOfOps, sizeof(*type->layout.ops));
+        if (type->layout.ops != NULL) {
+            type->layout.nrOfOps = 0;
+            type->layout.plain = true;
+            dynType_fillOps(type, NULL, 0, &type->layout);
+            assert(type->layout.nrOfOps == nrOfOps);
+        } else {
+            status = MEM_ERROR;
+            LOG_ERROR("Error allocating memory for layout");
+        }
+    }
+
+    return status;
+}
+
+static unsigned int dynType_countOps(dyn_type *type) {
+    unsigned int count = 1;
+    if (type->type == DYN_TYPE_REF) {
+        type = type->ref.ref;
+    }
+    if (type->type == DYN_TYPE_COMPLEX) {
+        struct complex_type_entry *entry = NULL;
+        TAILQ_FOREACH(entry, &type->complex.entriesHead, entries) {
+            count += dynType_countOps(entry->type);
+        }
+        count += 1;
+    }
+    return count;
+}
+
+static void dynType_fillOps(dyn_type *type, const char *name, size_t offset, struct dyn_type_layout *layout) {
+    if (type->type == DYN_TYPE_REF) {
+        type = type->ref.ref;
+    }
+
+    unsigned int index = layout->nrOfOps++;
+    struct dyn_type_op *op = &layout->ops[index];
+    op->descriptor = type->descriptor;
+    op->name = name;
+    op->offset = offset;
+    op->size = type->ffiType->size;
+    op->type = type;
+
+    if (type->type == DYN_TYPE_COMPLEX) {
+        struct complex_type_entry *entry = NULL;
+        int i = 0;
+        TAILQ_FOREACH(entry, &type->complex.entriesHead, entries) {
+            dynType_fillOps(entry->type, entry->name, offset + dynType_getOffset(type, i), layout);
+            i += 1;
+        }
+
+        struct dyn_type_op *close = &layout->ops[layout->nrOfOps++];
+        close->descriptor = '}';
+        close->offset = offset + type->ffiType->size;
+        close->type = type;
+        layout->ops[index].end = layout->nrOfOps - 1;
+    } else if (type->type == DYN_TYPE_SEQUENCE || type->type == DYN_TYPE_TYPED_POINTER || type->type == DYN_TYPE_TEXT) {
+        layout->plain = false;
+    }
+}
+
 size_t dynType_size(dyn_type *type) {
     dyn_type *rType = type;
     if (type->type == DYN_TYPE_REF) {
@@ -983,9 +1196,22 @@ int dynType_typedPointer_getTypedType(dyn_type *type, dyn_type **out) {
 
 
 int dynType_text_allocAndInit(dyn_type *type, void *textLoc, const char *value) {
+    return dynType_text_allocAndInitIn(type, NULL, textLoc, value);
+}
+
+int dynType_text_allocAndInitIn(dyn_type *type, dyn_arena *arena, void *textLoc, const char *value) {
     assert(type->type == DYN_TYPE_TEXT);
     int status = 0;
-    const char *str = strdup(value);
+    char *str = NULL;
+    if (arena != NULL) {
+        size_t len = strlen(value);
+        str = dynArena_alloc(arena, len + 1);
+        if (str != NULL) {
+            memcpy(str, value, len + 1);
+        }
+    } else {
+        str = strdup(value);
+    }
     char const **loc = textLoc;
     if (str != NULL) {
         *loc = str;
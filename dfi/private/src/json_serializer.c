@@ -22,7 +22,10 @@
 
 #include <jansson.h>
 #include <assert.h>
+#include <math.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static int jsonSerializer_createType(dyn_type *type, json_t *object, void **result);
@@ -37,6 +40,42 @@ static int jsonSerializer_writeComplex(dyn_type *type, void *input, json_t **val
 
 static int jsonSerializer_writeSequence(dyn_type *type, void *input, json_t **out);
 
+#define JSON_STREAM_INITIAL_SIZE 256
+
+struct json_buffer {
+    char *buf;
+    size_t len;
+    size_t cap;
+};
+
+struct json_reader {
+    const char *input;
+    size_t len;
+    size_t pos;
+    struct json_buffer scratch; //decoded strings, reused for every member name
+    dyn_arena *arena; //allocate the parsed values in this arena, NULL for the heap
+};
+
+static int jsonSerializer_streamDeserialize(dyn_type *type, const char *input, size_t inputLen, bool inArena, void **result);
+static int jsonSerializer_streamCreateType(dyn_type *type, struct json_reader *reader, void **result);
+static int jsonSerializer_streamParseAny(dyn_type *type, struct json_reader *reader, void *loc);
+static int jsonSerializer_streamParseObject(dyn_type *type, struct json_reader *reader, void *inst);
+static int jsonSerializer_streamParseSequence(dyn_type *type, struct json_reader *reader, void *seqLoc);
+static int jsonSerializer_streamParseString(struct json_reader *reader);
+static int jsonSerializer_streamParseNumber(struct json_reader *reader, char *number, size_t size);
+static int jsonSerializer_streamParseLiteral(struct json_reader *reader, const char *literal);
+static int jsonSerializer_streamCountItems(struct json_reader *reader, uint32_t *count);
+static char jsonSerializer_streamPeek(struct json_reader *reader);
+
+static int jsonSerializer_streamWriteAny(dyn_type *type, struct json_buffer *writer, const void *input);
+static int jsonSerializer_streamWriteComplex(dyn_type *type, struct json_buffer *writer, const void *input);
+static int jsonSerializer_streamWriteSequence(dyn_type *type, struct json_buffer *writer, const void *input);
+static int jsonSerializer_streamWriteText(struct json_buffer *writer, const char *text);
+static int jsonSerializer_streamWriteReal(struct json_buffer *writer, double val);
+
+static int jsonSerializer_bufferGrow(struct json_buffer *buffer, size_t size);
+static int jsonSerializer_bufferAppend(struct json_buffer *buffer, const char *data, size_t size);
+
 static int OK = 0;
 static int ERROR = 1;
 
@@ -482,3 +521,865 @@ static int jsonSerializer_writeComplex(dyn_type *type, void *input, json_t **out
     return status;
 }
 
+
+int jsonSerializer_deserializeStream(dyn_type *type, const char *input, size_t inputLen, void **result) {
+    return jsonSerializer_streamDeserialize(type, input, inputLen, false, result);
+}
+
+int jsonSerializer_deserializeInArena(dyn_type *type, const char *input, size_t inputLen, void **result) {
+    assert(dynType_type(type) == DYN_TYPE_COMPLEX || dynType_type(type) == DYN_TYPE_SEQUENCE);
+    return jsonSerializer_streamDeserialize(type, input, inputLen, true, result);
+}
+
+static int jsonSerializer_streamDeserialize(dyn_type *type, const char *input, size_t inputLen, bool inArena, void **result) {
+    int status = OK;
+
+    struct json_reader reader;
+    reader.input = input;
+    reader.len = inputLen;
+    reader.pos = 0;
+    reader.scratch.buf = NULL;
+    reader.scratch.len = 0;
+    reader.scratch.cap = 0;
+    reader.arena = NULL;
+
+    void *inst = NULL;
+    if (inArena) {
+        //the values take about as much memory as their json text
+        status = dynType_allocArena(type, inputLen, &inst);
+        if (status == OK) {
+            reader.arena = dynType_arena(type, inst);
+            status = jsonSerializer_streamParseAny(type, &reader, inst);
+        }
+    } else {
+        status = jsonSerializer_streamCreateType(type, &reader, &inst);
+    }
+
+    if (status == OK && jsonSerializer_streamPeek(&reader) != '\0') {
+        status = ERROR;
+        LOG_ERROR("Unexpected data after json value at position %zu", reader.pos);
+    }
+
+    if (status == OK) {
+        *result = inst;
+    } else {
+        if (inArena) {
+            dynType_freeArena(type, inst);
+        } else if (inst != NULL) {
+            dynType_free(type, inst);
+        }
+        LOG_ERROR("Error cannot deserialize json. Input is '%.*s'\n", (int) inputLen, input);
+    }
+
+    free(reader.scratch.buf);
+    return status;
+}
+
+static int jsonSerializer_streamCreateType(dyn_type *type, struct json_reader *reader, void **result) {
+    int status = OK;
+    void *inst = NULL;
+
+    if (dynType_descriptorType(type) == 't') {
+        status = jsonSerializer_streamParseString(reader);
+        if (status == OK && reader->arena != NULL) {
+            inst = dynArena_alloc(reader->arena, reader->scratch.len + 1);
+            if (inst != NULL) {
+                memcpy(inst, reader->scratch.buf, reader->scratch.len + 1);
+            }
+        } else if (status == OK) {
+            inst = strdup(reader->scratch.buf);
+        }
+        if (status == OK && inst == NULL) {
+            status = ERROR;
+        }
+    } else {
+        status = dynType_allocIn(type, reader->arena, &inst);
+
+        if (status == OK) {
+            assert(inst != NULL);
+            status = jsonSerializer_streamParseAny(type, reader, inst);
+        }
+    }
+
+    if (status == OK) {
+        *result = inst;
+    } else if (reader->arena == NULL) {
+        dynType_free(type, inst);
+    }
+
+    return status;
+}
+
+static int jsonSerializer_streamParseAny(dyn_type *type, struct json_reader *reader, void *loc) {
+    int status = OK;
+
+    dyn_type *subType = NULL;
+    char c = dynType_descriptorType(type);
+    char number[64];
+    char *end = NULL;
+    long long sval = 0;
+    unsigned long long uval = 0;
+    double dval = 0.0;
+
+    switch (c) {
+        case 'Z' :
+            if (jsonSerializer_streamPeek(reader) == 't') {
+                status = jsonSerializer_streamParseLiteral(reader, "true");
+                *(bool *) loc = true;
+            } else {
+                status = jsonSerializer_streamParseLiteral(reader, "false");
+                *(bool *) loc = false;
+            }
+            break;
+        case 'F' :
+        case 'D' :
+            status = jsonSerializer_streamParseNumber(reader, number, sizeof(number));
+            if (status == OK) {
+                dval = strtod(number, &end);
+                status = *end == '\0' ? OK : ERROR;
+            }
+            if (status == OK && c == 'F') {
+                *(float *) loc = (float) dval;
+            } else if (status == OK) {
+                *(double *) loc = dval;
+            }
+            break;
+        case 'N' :
+        case 'B' :
+        case 'S' :
+        case 'I' :
+        case 'J' :
+            status = jsonSerializer_streamParseNumber(reader, number, sizeof(number));
+            if (status == OK) {
+                sval = strtoll(number, &end, 10);
+                status = *end == '\0' ? OK : ERROR;
+            }
+            if (status == OK) {
+                switch (c) {
+                    case 'N' : *(int *) loc = (int) sval; break;
+                    case 'B' : *(char *) loc = (char) sval; break;
+                    case 'S' : *(int16_t *) loc = (int16_t) sval; break;
+                    case 'I' : *(int32_t *) loc = (int32_t) sval; break;
+                    default  : *(int64_t *) loc = (int64_t) sval; break;
+                }
+            }
+            break;
+        case 'b' :
+        case 's' :
+        case 'i' :
+        case 'j' :
+            status = jsonSerializer_streamParseNumber(reader, number, sizeof(number));
+            if (status == OK) {
+                uval = strtoull(number, &end, 10);
+                status = *end == '\0' ? OK : ERROR;
+            }
+            if (status == OK) {
+                switch (c) {
+                    case 'b' : *(uint8_t *) loc = (uint8_t) uval; break;
+                    case 's' : *(uint16_t *) loc = (uint16_t) uval; break;
+                    case 'i' : *(uint32_t *) loc = (uint32_t) uval; break;
+                    default  : *(uint64_t *) loc = (uint64_t) uval; break;
+                }
+            }
+            break;
+        case 't' :
+            if (jsonSerializer_streamPeek(reader) == 'n') {
+                status = jsonSerializer_streamParseLiteral(reader, "null");
+            } else {
+                status = jsonSerializer_streamParseString(reader);
+                if (status == OK) {
+                    status = dynType_text_allocAndInitIn(type, reader->arena, loc, reader->scratch.buf);
+                }
+            }
+            break;
+        case '[' :
+            status = jsonSerializer_streamParseSequence(type, reader, loc);
+            break;
+        case '{' :
+            status = jsonSerializer_streamParseObject(type, reader, loc);
+            break;
+        case '*' :
+            status = dynType_typedPointer_getTypedType(type, &subType);
+            if (status == OK && jsonSerializer_streamPeek(reader) == 'n') {
+                status = jsonSerializer_streamParseLiteral(reader, "null");
+                *(void **) loc = NULL;
+            } else if (status == OK) {
+                status = jsonSerializer_streamCreateType(subType, reader, (void **) loc);
+            }
+            break;
+        case 'P' :
+            status = ERROR;
+            LOG_WARNING("Untyped pointer are not supported for serialization");
+            break;
+        default :
+            status = ERROR;
+            LOG_ERROR("Error provided type '%c' not supported for JSON\n", dynType_descriptorType(type));
+            break;
+    }
+
+    if (status != OK && end != NULL && *end != '\0') {
+        LOG_ERROR("Invalid json number '%s' for type '%c'", number, c);
+    }
+
+    return status;
+}
+
+static int jsonSerializer_streamParseObject(dyn_type *type, struct json_reader *reader, void *inst) {
+    assert(dynType_type(type) == DYN_TYPE_COMPLEX);
+    int status = OK;
+
+    if (jsonSerializer_streamPeek(reader) != '{') {
+        LOG_ERROR("Expected json object at position %zu", reader->pos);
+        return ERROR;
+    }
+    reader->pos += 1;
+
+    struct complex_type_entries_head *entries = NULL;
+    dynType_complex_entries(type, &entries);
+    //members are usually in descriptor order, so the next entry is tried before looking up the name
+    struct complex_type_entry *next = TAILQ_FIRST(entries);
+    int nextIndex = 0;
+
+    //a member given twice would overwrite (and leak) the value parsed first, so duplicates are rejected
+    int nrOfEntries = 0;
+    struct complex_type_entry *entry = NULL;
+    TAILQ_FOREACH(entry, entries, entries) {
+        nrOfEntries += 1;
+    }
+    uint64_t seen[nrOfEntries / 64 + 1];
+    memset(seen, 0, sizeof(seen));
+
+    bool done = jsonSerializer_streamPeek(reader) == '}';
+    if (done) {
+        reader->pos += 1;
+    }
+
+    while (status == OK && !done) {
+        int index = -1;
+        status = jsonSerializer_streamParseString(reader);
+        if (status == OK) {
+            if (next != NULL && strcmp(next->name, reader->scratch.buf) == 0) {
+                index = nextIndex;
+            } else {
+                index = dynType_complex_indexForName(type, reader->scratch.buf);
+            }
+            if (index < 0) {
+                LOG_ERROR("Cannot find index for member '%s'", reader->scratch.buf);
+                status = ERROR;
+            } else if (seen[index / 64] & (1ULL << (index % 64))) {
+                LOG_ERROR("Duplicate member '%s'", reader->scratch.buf);
+                status = ERROR;
+            } else {
+                seen[index / 64] |= 1ULL << (index % 64);
+            }
+        }
+
+        if (status == OK && jsonSerializer_streamPeek(reader) == ':') {
+            reader->pos += 1;
+        } else if (status == OK) {
+            status = ERROR;
+            LOG_ERROR("Expected ':' at position %zu", reader->pos);
+        }
+
+        void *valp = NULL;
+        dyn_type *valType = NULL;
+        if (status == OK) {
+            status = dynType_complex_valLocAt(type, index, inst, &valp);
+        }
+        if (status == OK) {
+            status = dynType_complex_dynTypeAt(type, index, &valType);
+        }
+        if (status == OK) {
+            status = jsonSerializer_streamParseAny(valType, reader, valp);
+        }
+
+        if (status == OK) {
+            if (index == nextIndex && next != NULL) {
+                next = TAILQ_NEXT(next, entries);
+                nextIndex += 1;
+            }
+            char c = jsonSerializer_streamPeek(reader);
+            reader->pos += 1;
+            if (c == '}') {
+                done = true;
+            } else if (c != ',') {
+                status = ERROR;
+                LOG_ERROR("Expected ',' or '}' at position %zu", reader->pos - 1);
+            }
+        }
+    }
+
+    return status;
+}
+
+static int jsonSerializer_streamParseSequence(dyn_type *seq, struct json_reader *reader, void *seqLoc) {
+    assert(dynType_type(seq) == DYN_TYPE_SEQUENCE);
+    int status = OK;
+
+    if (jsonSerializer_streamPeek(reader) != '[') {
+        LOG_ERROR("Expected json array at position %zu", reader->pos);
+        return ERROR;
+    }
+    reader->pos += 1;
+
+    uint32_t size = 0;
+    status = jsonSerializer_streamCountItems(reader, &size);
+    if (status == OK) {
+        status = dynType_sequence_allocIn(seq, reader->arena, seqLoc, size);
+    }
+
+    bool done = size == 0;
+    if (status == OK && done) {
+        //only whitespace before the ']' found by counting
+        jsonSerializer_streamPeek(reader);
+        reader->pos += 1;
+    }
+
+    dyn_type *itemType = dynType_sequence_itemType(seq);
+    while (status == OK && !done) {
+        void *valLoc = NULL;
+        status = dynType_sequence_increaseLengthAndReturnLastLoc(seq, seqLoc, &valLoc);
+        if (status == OK) {
+            status = jsonSerializer_streamParseAny(itemType, reader, valLoc);
+        }
+        if (status == OK) {
+            char c = jsonSerializer_streamPeek(reader);
+            reader->pos += 1;
+            if (c == ']') {
+                done = true;
+            } else if (c != ',') {
+                status = ERROR;
+                LOG_ERROR("Expected ',' or ']' at position %zu", reader->pos - 1);
+            }
+        }
+    }
+
+    return status;
+}
+
+/*
+ * Counts the items of the array starting at the current position (after the '['), so the sequence buffer is
+ * allocated once.
+ */
+static int jsonSerializer_streamCountItems(struct json_reader *reader, uint32_t *count) {
+    uint32_t commas = 0;
+    unsigned int depth = 0;
+    bool inString = false;
+    bool empty = true;
+
+    size_t i;
+    for (i = reader->pos; i < reader->len; i += 1) {
+        char c = reader->input[i];
+        if (inString) {
+            if (c == '\\') {
+                i += 1;
+            } else if (c == '"') {
+                inString = false;
+            }
+            continue;
+        }
+
+        switch (c) {
+            case '"' :
+                inString = true;
+                empty = false;
+                break;
+            case '[' :
+            case '{' :
+                depth += 1;
+                empty = false;
+                break;
+            case ']' :
+            case '}' :
+                if (depth == 0) {
+                    *count = empty ? 0 : commas + 1;
+                    return OK;
+                }
+                depth -= 1;
+                break;
+            case ',' :
+                if (depth == 0) {
+                    commas += 1;
+                }
+                break;
+            case ' ' :
+            case '\t' :
+            case '\n' :
+            case '\r' :
+                break;
+            default :
+                empty = false;
+                break;
+        }
+    }
+
+    LOG_ERROR("Unterminated json array starting at position %zu", reader->pos);
+    return ERROR;
+}
+
+static char jsonSerializer_streamPeek(struct json_reader *reader) {
+    while (reader->pos < reader->len) {
+        char c = reader->input[reader->pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            return c;
+        }
+        reader->pos += 1;
+    }
+    return '\0';
+}
+
+static int jsonSerializer_streamParseLiteral(struct json_reader *reader, const char *literal) {
+    int status = OK;
+    size_t size = strlen(literal);
+    jsonSerializer_streamPeek(reader);
+    if (reader->pos + size <= reader->len && strncmp(reader->input + reader->pos, literal, size) == 0) {
+        reader->pos += size;
+    } else {
+        status = ERROR;
+        LOG_ERROR("Expected '%s' at position %zu", literal, reader->pos);
+    }
+    return status;
+}
+
+static int jsonSerializer_streamParseNumber(struct json_reader *reader, char *number, size_t size) {
+    int status = OK;
+    size_t len = 0;
+
+    jsonSerializer_streamPeek(reader);
+    while (reader->pos < reader->len) {
+        char c = reader->input[reader->pos];
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            if (len + 1 >= size) {
+                status = ERROR;
+                break;
+            }
+            number[len++] = c;
+            reader->pos += 1;
+        } else {
+            break;
+        }
+    }
+    number[len] = '\0';
+
+    if (status != OK || len == 0) {
+        status = ERROR;
+        LOG_ERROR("Expected json number at position %zu", reader->pos);
+    }
+
+    return status;
+}
+
+/*
+ * Decodes the string at the current position into the scratch buffer of the reader.
+ */
+static int jsonSerializer_streamParseString(struct json_reader *reader) {
+    int status = OK;
+    struct json_buffer *scratch = &reader->scratch;
+    scratch->len = 0;
+
+    if (jsonSerializer_streamPeek(reader) != '"') {
+        LOG_ERROR("Expected json string at position %zu", reader->pos);
+        return ERROR;
+    }
+    reader->pos += 1;
+
+    bool done = false;
+    while (status == OK && !done) {
+        size_t start = reader->pos;
+        while (reader->pos < reader->len) {
+            unsigned char c = (unsigned char) reader->input[reader->pos];
+            if (c == '"' || c == '\\' || c < 0x20) {
+                break;
+            }
+            reader->pos += 1;
+        }
+        status = jsonSerializer_bufferAppend(scratch, reader->input + start, reader->pos - start);
+
+        if (status != OK) {
+            break;
+        } else if (reader->pos >= reader->len) {
+            status = ERROR;
+            LOG_ERROR("Unterminated json string");
+            break;
+        }
+
+        char c = reader->input[reader->pos];
+        reader->pos += 1;
+        if (c == '"') {
+            done = true;
+        } else if (c == '\\' && reader->pos < reader->len) {
+            char esc = reader->input[reader->pos];
+            reader->pos += 1;
+            char out = '\0';
+            unsigned long cp = 0;
+            switch (esc) {
+                case '"' :
+                case '\\' :
+                case '/' :
+                    out = esc;
+                    break;
+                case 'b' : out = '\b'; break;
+                case 'f' : out = '\f'; break;
+                case 'n' : out = '\n'; break;
+                case 'r' : out = '\r'; break;
+                case 't' : out = '\t'; break;
+                case 'u' :
+                    if (reader->pos + 4 <= reader->len) {
+                        char hex[5];
+                        memcpy(hex, reader->input + reader->pos, 4);
+                        hex[4] = '\0';
+                        char *end = NULL;
+                        cp = strtoul(hex, &end, 16);
+                        status = *end == '\0' ? OK : ERROR;
+                        reader->pos += 4;
+                    } else {
+                        status = ERROR;
+                    }
+                    //surrogate pair
+                    if (status == OK && cp >= 0xD800 && cp <= 0xDBFF && reader->pos + 6 <= reader->len
+                            && reader->input[reader->pos] == '\\' && reader->input[reader->pos + 1] == 'u') {
+                        char hex[5];
+                        memcpy(hex, reader->input + reader->pos + 2, 4);
+                        hex[4] = '\0';
+                        unsigned long low = strtoul(hex, NULL, 16);
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                            reader->pos += 6;
+                        }
+                    }
+                    //texts are NUL terminated, an embedded NUL would silently truncate the text
+                    if (status == OK && cp == 0) {
+                        status = ERROR;
+                    }
+                    break;
+                default :
+                    status = ERROR;
+                    break;
+            }
+
+            if (status == OK && esc != 'u') {
+                status = jsonSerializer_bufferAppend(scratch, &out, 1);
+            } else if (status == OK) {
+                //UTF-8
+                char utf8[4];
+                size_t n = 0;
+                if (cp < 0x80) {
+                    utf8[n++] = (char) cp;
+                } else if (cp < 0x800) {
+                    utf8[n++] = (char) (0xC0 | (cp >> 6));
+                    utf8[n++] = (char) (0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    utf8[n++] = (char) (0xE0 | (cp >> 12));
+                    utf8[n++] = (char) (0x80 | ((cp >> 6) & 0x3F));
+                    utf8[n++] = (char) (0x80 | (cp & 0x3F));
+                } else {
+                    utf8[n++] = (char) (0xF0 | (cp >> 18));
+                    utf8[n++] = (char) (0x80 | ((cp >> 12) & 0x3F));
+                    utf8[n++] = (char) (0x80 | ((cp >> 6) & 0x3F));
+                    utf8[n++] = (char) (0x80 | (cp & 0x3F));
+                }
+                status = jsonSerializer_bufferAppend(scratch, utf8, n);
+            } else {
+                LOG_ERROR("Invalid escape in json string at position %zu", reader->pos);
+            }
+        } else {
+            status = ERROR;
+            LOG_ERROR("Invalid character in json string at position %zu", reader->pos - 1);
+        }
+    }
+
+    if (status == OK) {
+        status = jsonSerializer_bufferGrow(scratch, 1);
+    }
+    if (status == OK) {
+        scratch->buf[scratch->len] = '\0';
+    }
+
+    return status;
+}
+
+int jsonSerializer_serializeStream(dyn_type *type, const void *input, char **output, size_t *outputLen) {
+    int status = OK;
+
+    struct json_buffer writer;
+    writer.buf = NULL;
+    writer.len = 0;
+    writer.cap = 0;
+
+    status = jsonSerializer_bufferGrow(&writer, JSON_STREAM_INITIAL_SIZE);
+    if (status == OK) {
+        status = jsonSerializer_streamWriteAny(type, &writer, input);
+    }
+    if (status == OK) {
+        status = jsonSerializer_bufferGrow(&writer, 1);
+    }
+
+    if (status == OK) {
+        writer.buf[writer.len] = '\0';
+        *output = writer.buf;
+        if (outputLen != NULL) {
+            *outputLen = writer.len;
+        }
+    } else {
+        free(writer.buf);
+    }
+
+    return status;
+}
+
+static int jsonSerializer_streamWriteAny(dyn_type *type, struct json_buffer *writer, const void *input) {
+    int status = OK;
+
+    int descriptor = dynType_descriptorType(type);
+    dyn_type *subType = NULL;
+    char number[32];
+    int len = -1;
+
+    switch (descriptor) {
+        case 'Z' :
+            if (*(const bool *) input) {
+                status = jsonSerializer_bufferAppend(writer, "true", 4);
+            } else {
+                status = jsonSerializer_bufferAppend(writer, "false", 5);
+            }
+            break;
+        case 'B' :
+            len = snprintf(number, sizeof(number), "%lld", (long long) *(const char *) input);
+            break;
+        case 'S' :
+            len = snprintf(number, sizeof(number), "%lld", (long long) *(const int16_t *) input);
+            break;
+        case 'I' :
+            len = snprintf(number, sizeof(number), "%lld", (long long) *(const int32_t *) input);
+            break;
+        case 'J' :
+            len = snprintf(number, sizeof(number), "%lld", (long long) *(const int64_t *) input);
+            break;
+        case 'N' :
+            len = snprintf(number, sizeof(number), "%lld", (long long) *(const int *) input);
+            break;
+        case 'b' :
+            len = snprintf(number, sizeof(number), "%llu", (unsigned long long) *(const uint8_t *) input);
+            break;
+        case 's' :
+            len = snprintf(number, sizeof(number), "%llu", (unsigned long long) *(const uint16_t *) input);
+            break;
+        case 'i' :
+            len = snprintf(number, sizeof(number), "%llu", (unsigned long long) *(const uint32_t *) input);
+            break;
+        case 'j' :
+            len = snprintf(number, sizeof(number), "%llu", (unsigned long long) *(const uint64_t *) input);
+            break;
+        case 'F' :
+            status = jsonSerializer_streamWriteReal(writer, (double) *(const float *) input);
+            break;
+        case 'D' :
+            status = jsonSerializer_streamWriteReal(writer, *(const double *) input);
+            break;
+        case 't' :
+            status = jsonSerializer_streamWriteText(writer, *(const char **) input);
+            break;
+        case '*' :
+            status = dynType_typedPointer_getTypedType(type, &subType);
+            if (status == OK && *(void **) input == NULL) {
+                status = jsonSerializer_bufferAppend(writer, "null", 4);
+            } else if (status == OK) {
+                status = jsonSerializer_streamWriteAny(subType, writer, *(void **) input);
+            }
+            break;
+        case '{' :
+            status = jsonSerializer_streamWriteComplex(type, writer, input);
+            break;
+        case '[' :
+            status = jsonSerializer_streamWriteSequence(type, writer, input);
+            break;
+        case 'P' :
+            LOG_WARNING("Untyped pointer not supported for serialization. ignoring");
+            status = jsonSerializer_bufferAppend(writer, "null", 4);
+            break;
+        default :
+            LOG_ERROR("Unsupported descriptor '%c'", descriptor);
+            status = ERROR;
+            break;
+    }
+
+    if (status == OK && len >= 0) {
+        status = jsonSerializer_bufferAppend(writer, number, (size_t) len);
+    }
+
+    return status;
+}
+
+static int jsonSerializer_streamWriteComplex(dyn_type *type, struct json_buffer *writer, const void *input) {
+    assert(dynType_type(type) == DYN_TYPE_COMPLEX);
+    int status = OK;
+
+    //nested structs are flattened in the layout, the '{' and '}' ops open and close the json objects
+    const struct dyn_type_layout *layout = dynType_layout(type);
+    assert(layout != NULL);
+    bool first = true;
+    unsigned int i;
+    for (i = 0; status == OK && i < layout->nrOfOps; i += 1) {
+        const struct dyn_type_op *op = &layout->ops[i];
+        const void *valLoc = (const char *) input + op->offset;
+        if (op->descriptor == '}') {
+            status = jsonSerializer_bufferAppend(writer, "}", 1);
+            first = false;
+            continue;
+        } else if (op->descriptor == 'P') {
+            //untyped pointers are left out, as by jsonSerializer_serialize
+            continue;
+        }
+
+        if (!first) {
+            status = jsonSerializer_bufferAppend(writer, ",", 1);
+        }
+        if (status == OK && op->name != NULL) {
+            status = jsonSerializer_streamWriteText(writer, op->name);
+            if (status == OK) {
+                status = jsonSerializer_bufferAppend(writer, ":", 1);
+            }
+        }
+        if (status == OK && op->descriptor == '{') {
+            status = jsonSerializer_bufferAppend(writer, "{", 1);
+            first = true;
+        } else if (status == OK) {
+            status = jsonSerializer_streamWriteAny(op->type, writer, valLoc);
+            first = false;
+        }
+    }
+
+    return status;
+}
+
+static int jsonSerializer_streamWriteSequence(dyn_type *type, struct json_buffer *writer, const void *input) {
+    assert(dynType_type(type) == DYN_TYPE_SEQUENCE);
+    int status = OK;
+
+    dyn_type *itemType = dynType_sequence_itemType(type);
+    uint32_t len = dynType_sequence_length((void *) input);
+
+    status = jsonSerializer_bufferAppend(writer, "[", 1);
+
+    uint32_t i;
+    for (i = 0; i < len && status == OK; i += 1) {
+        void *itemLoc = NULL;
+        if (i > 0) {
+            status = jsonSerializer_bufferAppend(writer, ",", 1);
+        }
+        if (status == OK) {
+            status = dynType_sequence_locForIndex(type, (void *) input, i, &itemLoc);
+        }
+        if (status == OK) {
+            status = jsonSerializer_streamWriteAny(itemType, writer, itemLoc);
+        }
+    }
+
+    if (status == OK) {
+        status = jsonSerializer_bufferAppend(writer, "]", 1);
+    }
+
+    return status;
+}
+
+static int jsonSerializer_streamWriteText(struct json_buffer *writer, const char *text) {
+    int status = OK;
+
+    if (text == NULL) {
+        return jsonSerializer_bufferAppend(writer, "null", 4);
+    }
+
+    status = jsonSerializer_bufferAppend(writer, "\"", 1);
+
+    const char *start = text;
+    const char *c;
+    for (c = text; *c != '\0' && status == OK; c += 1) {
+        unsigned char uc = (unsigned char) *c;
+        if (uc >= 0x20 && uc != '"' && uc != '\\') {
+            continue;
+        }
+
+        //write the unescaped part before the escaped character
+        status = jsonSerializer_bufferAppend(writer, start, (size_t) (c - start));
+        start = c + 1;
+
+        char esc[8];
+        int len = 2;
+        esc[0] = '\\';
+        switch (uc) {
+            case '"' : esc[1] = '"'; break;
+            case '\\' : esc[1] = '\\'; break;
+            case '\b' : esc[1] = 'b'; break;
+            case '\f' : esc[1] = 'f'; break;
+            case '\n' : esc[1] = 'n'; break;
+            case '\r' : esc[1] = 'r'; break;
+            case '\t' : esc[1] = 't'; break;
+            default :
+                len = snprintf(esc, sizeof(esc), "\\u%04x", uc);
+                break;
+        }
+        if (status == OK) {
+            status = jsonSerializer_bufferAppend(writer, esc, (size_t) len);
+        }
+    }
+
+    if (status == OK) {
+        status = jsonSerializer_bufferAppend(writer, start, (size_t) (c - start));
+    }
+    if (status == OK) {
+        status = jsonSerializer_bufferAppend(writer, "\"", 1);
+    }
+
+    return status;
+}
+
+static int jsonSerializer_streamWriteReal(struct json_buffer *writer, double val) {
+    int status = OK;
+
+    if (!isfinite(val)) {
+        LOG_ERROR("Cannot write %f as json number", val);
+        return ERROR;
+    }
+
+    //same precision as jansson, a real always gets a fraction or exponent
+    char number[40];
+    int len = snprintf(number, sizeof(number) - 2, "%.17g", val);
+    if (strpbrk(number, ".eE") == NULL) {
+        number[len++] = '.';
+        number[len++] = '0';
+        number[len] = '\0';
+    }
+    status = jsonSerializer_bufferAppend(writer, number, (size_t) len);
+
+    return status;
+}
+
+static int jsonSerializer_bufferGrow(struct json_buffer *buffer, size_t size) {
+    int status = OK;
+
+    if (buffer->len + size > buffer->cap) {
+        size_t cap = buffer->cap == 0 ? JSON_STREAM_INITIAL_SIZE : buffer->cap;
+        while (buffer->len + size > cap) {
+            cap *= 2;
+        }
+        char *buf = realloc(buffer->buf, cap);
+        if (buf != NULL) {
+            buffer->buf = buf;
+            buffer->cap = cap;
+        } else {
+            status = ERROR;
+            LOG_ERROR("Cannot grow json buffer to %zu bytes", cap);
+        }
+    }
+
+    return status;
+}
+
+static int jsonSerializer_bufferAppend(struct json_buffer *buffer, const char *data, size_t size) {
+    int status = jsonSerializer_bufferGrow(buffer, size);
+    if (status == OK && size > 0) {
+        memcpy(buffer->buf + buffer->len, data, size);
+        buffer->len += size;
+    }
+    return status;
+}
@@ -0,0 +1,431 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+#include <CppUTest/TestHarness.h>
+#include <float.h>
+#include <assert.h>
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C" {
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ffi.h>
+
+#include "dyn_common.h"
+#include "dyn_type.h"
+#include "dyn_interface.h"
+#include "json_serializer.h"
+#include "json_rpc.h"
+#include "binary_serializer.h"
+#include "binary_rpc.h"
+
+static void stdLog(void*, int level, const char *file, int line, const char *msg, ...) {
+    va_list ap;
+    const char *levels[5] = {"NIL", "ERROR", "WARNING", "INFO", "DEBUG"};
+    fprintf(stderr, "%s: FILE:%s, LINE:%i, MSG:",levels[level], file, line);
+    va_start(ap, msg);
+    vfprintf(stderr, msg, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+}
+
+    struct tst_seq {
+        uint32_t cap;
+        uint32_t len;
+        double *buf;
+    };
+
+    //StatsResult={DDD[D average min max input}
+    struct tst_StatsResult {
+        double average;
+        double min;
+        double max;
+        struct tst_seq input;
+    };
+
+    struct tst_serv {
+        void *handle;
+        int (*add)(void *, double, double, double *);
+        int (*sub)(void *, double, double, double *);
+        int (*sqrt)(void *, double, double *);
+        int (*stats)(void *, struct tst_seq, struct tst_StatsResult **);
+    };
+
+    struct tst_serv_example4 {
+        void *handle;
+        int (*getName_example4)(void *, char** name);
+    };
+
+    static int add(void*, double a, double b, double *result) {
+        *result = a + b;
+        return 0;
+    }
+
+    static int addFails(void*, double, double, double *) {
+        return 3;
+    }
+
+    static int stats(void*, struct tst_seq input, struct tst_StatsResult **out) {
+        double total = 0.0;
+        double max = DBL_MIN;
+        double min = DBL_MAX;
+
+        unsigned int i;
+        for (i = 0; i < input.len; i += 1) {
+            total += input.buf[i];
+            if (input.buf[i] > max) {
+                max = input.buf[i];
+            }
+            if (input.buf[i] < min) {
+                min = input.buf[i];
+            }
+        }
+
+        struct tst_StatsResult *result = (struct tst_StatsResult *) calloc(1, sizeof(*result));
+        if (input.len > 0) {
+            result->average = total / input.len;
+        }
+        result->min = min;
+        result->max = max;
+        result->input.buf = (double *) calloc(input.len, sizeof(double));
+        memcpy(result->input.buf, input.buf, input.len * sizeof(double));
+        result->input.len = input.len;
+        result->input.cap = input.len;
+
+        *out = result;
+        return 0;
+    }
+
+    static int getName_example4(void*, char** result) {
+        *result = strdup("allocatedInFunction");
+        return 0;
+    }
+
+    static dyn_interface_type *parseInterface(const char *file) {
+        dyn_interface_type *intf = NULL;
+        FILE *desc = fopen(file, "r");
+        CHECK(desc != NULL);
+        int rc = dynInterface_parse(desc, &intf);
+        CHECK_EQUAL(0, rc);
+        fclose(desc);
+        return intf;
+    }
+
+    static struct method_entry *findMethod(dyn_interface_type *intf, const char *name) {
+        struct methods_head *head;
+        dynInterface_methods(intf, &head);
+        struct method_entry *entry = NULL;
+        TAILQ_FOREACH(entry, head, entries) {
+            if (strcmp(entry->name, name) == 0) {
+                break;
+            }
+        }
+        CHECK(entry != NULL);
+        return entry;
+    }
+
+    static double elapsedUs(struct timespec *begin, struct timespec *end) {
+        return (end->tv_sec - begin->tv_sec) * 1000000.0 + (end->tv_nsec - begin->tv_nsec) / 1000.0;
+    }
+
+    static void callPre(void) {
+        dyn_interface_type *intf = parseInterface("descriptors/example1.descriptor");
+        struct method_entry *method = findMethod(intf, "add");
+
+        struct tst_serv serv;
+        serv.handle = NULL;
+        serv.add = add;
+
+        void *handle = NULL;
+        double a = 1.0;
+        double b = 2.0;
+        double result = 0.0;
+        double *out = &result;
+        void *args[4];
+        args[0] = &handle;
+        args[1] = &a;
+        args[2] = &b;
+        args[3] = &out;
+
+        void *request = NULL;
+        size_t requestLen = 0;
+        int rc = binaryRpc_prepareInvokeRequest(method->dynFunc, method->index, method->id, args, &request, &requestLen);
+        CHECK_EQUAL(0, rc);
+        CHECK_EQUAL(8 + 2 * sizeof(double), requestLen);
+
+        void *reply = NULL;
+        size_t replyLen = 0;
+        rc = binaryRpc_call(intf, &serv, request, requestLen, &reply, &replyLen);
+        CHECK_EQUAL(0, rc);
+
+        rc = binaryRpc_handleReply(method->dynFunc, reply, replyLen, args);
+        CHECK_EQUAL(0, rc);
+        CHECK_EQUAL(3.0, result);
+
+        free(request);
+        free(reply);
+        dynInterface_destroy(intf);
+    }
+
+    static void callOut(void) {
+        dyn_interface_type *intf = parseInterface("descriptors/example1.descriptor");
+        struct method_entry *method = findMethod(intf, "stats");
+
+        struct tst_serv serv;
+        serv.handle = NULL;
+        serv.stats = stats;
+
+        double values[3] = {1.0, 2.0, 6.0};
+        struct tst_seq input;
+        input.cap = 3;
+        input.len = 3;
+        input.buf = values;
+
+        void *handle = NULL;
+        struct tst_StatsResult *result = NULL;
+        void *out = &result;
+        void *args[3];
+        args[0] = &handle;
+        args[1] = &input;
+        args[2] = &out;
+
+        void *request = NULL;
+        size_t requestLen = 0;
+        int rc = binaryRpc_prepareInvokeRequest(method->dynFunc, method->index, method->id, args, &request, &requestLen);
+        CHECK_EQUAL(0, rc);
+
+        void *reply = NULL;
+        size_t replyLen = 0;
+        rc = binaryRpc_call(intf, &serv, request, requestLen, &reply, &replyLen);
+        CHECK_EQUAL(0, rc);
+
+        rc = binaryRpc_handleReply(method->dynFunc, reply, replyLen, args);
+        CHECK_EQUAL(0, rc);
+        CHECK(result != NULL);
+        CHECK_EQUAL(3.0, result->average);
+        CHECK_EQUAL(1.0, result->min);
+        CHECK_EQUAL(6.0, result->max);
+        CHECK_EQUAL(3, result->input.len);
+        CHECK_EQUAL(2.0, result->input.buf[1]);
+
+        free(result->input.buf);
+        free(result);
+        free(request);
+        free(reply);
+        dynInterface_destroy(intf);
+    }
+
+    static void callOutChar(void) {
+        dyn_interface_type *intf = parseInterface("descriptors/example4.descriptor");
+        struct method_entry *method = findMethod(intf, "getName");
+
+        struct tst_serv_example4 serv;
+        serv.handle = NULL;
+        serv.getName_example4 = getName_example4;
+
+        void *handle = NULL;
+        char *result = NULL;
+        void *out = &result;
+        void *args[2];
+        args[0] = &handle;
+        args[1] = &out;
+
+        void *request = NULL;
+        size_t requestLen = 0;
+        int rc = binaryRpc_prepareInvokeRequest(method->dynFunc, method->index, method->id, args, &request, &requestLen);
+        CHECK_EQUAL(0, rc);
+
+        void *reply = NULL;
+        size_t replyLen = 0;
+        rc = binaryRpc_call(intf, &serv, request, requestLen, &reply, &replyLen);
+        CHECK_EQUAL(0, rc);
+
+        rc = binaryRpc_handleReply(method->dynFunc, reply, replyLen, args);
+        CHECK_EQUAL(0, rc);
+        STRCMP_EQUAL("allocatedInFunction", result);
+
+        free(result);
+        free(request);
+        free(reply);
+        dynInterface_destroy(intf);
+    }
+
+    static void callErrors(void) {
+        dyn_interface_type *intf = parseInterface("descriptors/example1.descriptor");
+        struct method_entry *method = findMethod(intf, "add");
+
+        struct tst_serv serv;
+        serv.handle = NULL;
+        serv.add = addFails;
+
+        void *handle = NULL;
+        double a = 1.0;
+        double b = 2.0;
+        double result = 0.0;
+        double *out = &result;
+        void *args[4];
+        args[0] = &handle;
+        args[1] = &a;
+        args[2] = &b;
+        args[3] = &out;
+
+        void *request = NULL;
+        size_t requestLen = 0;
+        int rc = binaryRpc_prepareInvokeRequest(method->dynFunc, method->index, method->id, args, &request, &requestLen);
+        CHECK_EQUAL(0, rc);
+
+        //status of the remote function is returned in the reply
+        void *reply = NULL;
+        size_t replyLen = 0;
+        rc = binaryRpc_call(intf, &serv, request, requestLen, &reply, &replyLen);
+        CHECK_EQUAL(0, rc);
+        rc = binaryRpc_handleReply(method->dynFunc, reply, replyLen, args);
+        CHECK(rc != 0);
+        free(reply);
+        free(request);
+
+        //request for a different signature
+        reply = NULL;
+        rc = binaryRpc_prepareInvokeRequest(method->dynFunc, method->index, "add(DD)I", args, &request, &requestLen);
+        CHECK_EQUAL(0, rc);
+        rc = binaryRpc_call(intf, &serv, request, requestLen, &reply, &replyLen);
+        CHECK(rc != 0);
+
+        //truncated request
+        rc = binaryRpc_call(intf, &serv, request, 3, &reply, &replyLen);
+        CHECK(rc != 0);
+        CHECK(reply == NULL);
+
+        free(request);
+        dynInterface_destroy(intf);
+    }
+
+    static void compareWithJson(void) {
+        dyn_interface_type *intf = parseInterface("descriptors/example1.descriptor");
+        struct method_entry *method = findMethod(intf, "add");
+
+        struct tst_serv serv;
+        serv.handle = NULL;
+        serv.add = add;
+
+        void *handle = NULL;
+        double a = 1.0;
+        double b = 2.0;
+        double result = 0.0;
+        double *out = &result;
+        void *args[4];
+        args[0] = &handle;
+        args[1] = &a;
+        args[2] = &b;
+        args[3] = &out;
+
+        const int nrOfCalls = 20000;
+        struct timespec begin;
+        struct timespec end;
+        int rc = 0;
+        size_t jsonBytes = 0;
+        size_t binaryBytes = 0;
+
+        int i;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (i = 0; i < nrOfCalls && rc == 0; i += 1) {
+            char *request = NULL;
+            char *reply = NULL;
+            rc = jsonRpc_prepareInvokeRequest(method->dynFunc, method->id, args, &request);
+            if (rc == 0) {
+                rc = jsonRpc_call(intf, &serv, request, &reply);
+            }
+            if (rc == 0) {
+                rc = jsonRpc_handleReply(method->dynFunc, reply, args);
+                jsonBytes = strlen(request) + strlen(reply);
+            }
+            free(request);
+            free(reply);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        CHECK_EQUAL(0, rc);
+        CHECK_EQUAL(3.0, result);
+        double jsonUs = elapsedUs(&begin, &end) / nrOfCalls;
+
+        result = 0.0;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (i = 0; i < nrOfCalls && rc == 0; i += 1) {
+            void *request = NULL;
+            size_t requestLen = 0;
+            void *reply = NULL;
+            size_t replyLen = 0;
+            rc = binaryRpc_prepareInvokeRequest(method->dynFunc, method->index, method->id, args, &request, &requestLen);
+            if (rc == 0) {
+                rc = binaryRpc_call(intf, &serv, request, requestLen, &reply, &replyLen);
+            }
+            if (rc == 0) {
+                rc = binaryRpc_handleReply(method->dynFunc, reply, replyLen, args);
+                binaryBytes = requestLen + replyLen;
+            }
+            free(request);
+            free(reply);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        CHECK_EQUAL(0, rc);
+        CHECK_EQUAL(3.0, result);
+        double binaryUs = elapsedUs(&begin, &end) / nrOfCalls;
+
+        printf("\nadd(DD)D round trip: json %.2f us (%zu bytes), binary %.2f us (%zu bytes)\n", jsonUs, jsonBytes, binaryUs, binaryBytes);
+        CHECK(binaryBytes < jsonBytes);
+
+        dynInterface_destroy(intf);
+    }
+}
+
+TEST_GROUP(BinaryRpcTests) {
+    void setup() {
+        int lvl = 1;
+        dynCommon_logSetup(stdLog, NULL, lvl);
+        dynType_logSetup(stdLog, NULL,lvl);
+        dynFunction_logSetup(stdLog, NULL,lvl);
+        dynInterface_logSetup(stdLog, NULL,lvl);
+        jsonSerializer_logSetup(stdLog, NULL, lvl);
+        jsonRpc_logSetup(stdLog, NULL, lvl);
+        binarySerializer_logSetup(stdLog, NULL, lvl);
+        binaryRpc_logSetup(stdLog, NULL, lvl);
+    }
+};
+
+TEST(BinaryRpcTests, callPre) {
+    callPre();
+}
+
+TEST(BinaryRpcTests, callOut) {
+    callOut();
+}
+
+TEST(BinaryRpcTests, callOutChar) {
+    callOutChar();
+}
+
+TEST(BinaryRpcTests, callErrors) {
+    callErrors();
+}
+
+TEST(BinaryRpcTests, compareWithJson) {
+    compareWithJson();
+}
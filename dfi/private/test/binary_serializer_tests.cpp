@@ -0,0 +1,289 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+#include <CppUTest/TestHarness.h>
+#include "CppUTest/CommandLineTestRunner.h"                                                                                                                                                                        
+
+extern "C" {
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <ffi.h>
+
+#include "dyn_common.h"
+#include "dyn_type.h"
+#include "binary_serializer.h"
+
+static void stdLog(void*, int level, const char *file, int line, const char *msg, ...) {
+	va_list ap;
+	const char *levels[5] = {"NIL", "ERROR", "WARNING", "INFO", "DEBUG"};
+	fprintf(stderr, "%s: FILE:%s, LINE:%i, MSG:",levels[level], file, line);
+	va_start(ap, msg);
+	vfprintf(stderr, msg, ap);
+	fprintf(stderr, "\n");
+	va_end(ap);
+}
+
+/*********** example 1 ************************/
+/** all primitive types ***********************/
+const char *bin_example1_descriptor = "{BSIJsijFDNZb a b c d e f g h i j k l}";
+
+struct bin_example1 {
+	char a;
+	int16_t b;
+	int32_t c;
+	int64_t d;
+	uint16_t e;
+	uint32_t f;
+	uint64_t g;
+	float h;
+	double i;
+	int j;
+	bool k;
+	unsigned char l;
+};
+
+static void roundTripTest1(void) {
+	struct bin_example1 ex;
+	ex.a = 1;
+	ex.b = -2;
+	ex.c = 3;
+	ex.d = -4;
+	ex.e = 5;
+	ex.f = 6;
+	ex.g = 7;
+	ex.h = 8.8f;
+	ex.i = 9.9;
+	ex.j = 10;
+	ex.k = true;
+	ex.l = 12;
+
+	dyn_type *type = NULL;
+	void *out = NULL;
+	size_t outLen = 0;
+	struct bin_example1 *result = NULL;
+	int rc = dynType_parseWithStr(bin_example1_descriptor, "ex1", NULL, &type);
+	CHECK_EQUAL(0, rc);
+	rc = binarySerializer_serialize(type, &ex, &out, &outLen);
+	CHECK_EQUAL(0, rc);
+	CHECK_EQUAL(1 + 2 + 4 + 8 + 2 + 4 + 8 + 4 + 8 + 4 + 1 + 1, outLen);
+
+	rc = binarySerializer_deserialize(type, out, outLen, (void **)&result);
+	CHECK_EQUAL(0, rc);
+	CHECK_EQUAL(1, result->a);
+	CHECK_EQUAL(-2, result->b);
+	CHECK_EQUAL(3, result->c);
+	CHECK_EQUAL(-4, result->d);
+	CHECK_EQUAL(5, result->e);
+	CHECK_EQUAL(6, result->f);
+	CHECK_EQUAL(7, result->g);
+	CHECK_EQUAL(8.8f, result->h);
+	CHECK_EQUAL(9.9, result->i);
+	CHECK_EQUAL(10, result->j);
+	CHECK_EQUAL(true, result->k);
+	CHECK_EQUAL(12, result->l);
+
+	dynType_free(type, result);
+	dynType_destroy(type);
+	free(out);
+}
+
+/*********** example 2 ************************/
+/** nested types, text and pointers ***********/
+const char *bin_example2_descriptor = "{*{JJ a b}{SS c d}t*{JJ a b} sub1 sub2 name sub3}";
+
+struct bin_example2_sub {
+	int64_t a;
+	int64_t b;
+};
+
+struct bin_example2 {
+	struct bin_example2_sub *sub1;
+	struct {
+		int16_t c;
+		int16_t d;
+	} sub2;
+	char *name;
+	struct bin_example2_sub *sub3;
+};
+
+static void roundTripTest2(void) {
+	struct bin_example2_sub sub1;
+	sub1.a = 1;
+	sub1.b = 2;
+
+	struct bin_example2 ex;
+	ex.sub1 = &sub1;
+	ex.sub2.c = 3;
+	ex.sub2.d = 4;
+	ex.name = (char *) "binary";
+	ex.sub3 = NULL;
+
+	dyn_type *type = NULL;
+	void *out = NULL;
+	size_t outLen = 0;
+	struct bin_example2 *result = NULL;
+	int rc = dynType_parseWithStr(bin_example2_descriptor, "ex2", NULL, &type);
+	CHECK_EQUAL(0, rc);
+	rc = binarySerializer_serialize(type, &ex, &out, &outLen);
+	CHECK_EQUAL(0, rc);
+
+	rc = binarySerializer_deserialize(type, out, outLen, (void **)&result);
+	CHECK_EQUAL(0, rc);
+	CHECK(result->sub1 != NULL);
+	CHECK_EQUAL(1, result->sub1->a);
+	CHECK_EQUAL(2, result->sub1->b);
+	CHECK_EQUAL(3, result->sub2.c);
+	CHECK_EQUAL(4, result->sub2.d);
+	STRCMP_EQUAL("binary", result->name);
+	POINTERS_EQUAL(NULL, result->sub3);
+
+	//truncated input must be rejected
+	void *truncated = NULL;
+	rc = binarySerializer_deserialize(type, out, outLen - 1, &truncated);
+	CHECK_EQUAL(1, rc);
+
+	dynType_free(type, result);
+	dynType_destroy(type);
+	free(out);
+}
+
+/*********** example 3 ************************/
+/** sequence of references ********************/
+const char *bin_example3_descriptor = "Tperson={ti name age};[Lperson;";
+
+struct bin_example3_person {
+	const char *name;
+	uint32_t age;
+};
+
+struct bin_example3 {
+	uint32_t cap;
+	uint32_t len;
+	struct bin_example3_person **buf;
+};
+
+static void roundTripTest3(void) {
+	struct bin_example3_person p1;
+	p1.name = "John";
+	p1.age = 33;
+
+	struct bin_example3_person p2;
+	p2.name = "Peter";
+	p2.age = 44;
+
+	struct bin_example3 seq;
+	seq.buf = (struct bin_example3_person **) calloc(2, sizeof(void *));
+	seq.len = seq.cap = 2;
+	seq.buf[0] = &p1;
+	seq.buf[1] = &p2;
+
+	dyn_type *type = NULL;
+	void *out = NULL;
+	size_t outLen = 0;
+	struct bin_example3 *result = NULL;
+	int rc = dynType_parseWithStr(bin_example3_descriptor, "ex3", NULL, &type);
+	CHECK_EQUAL(0, rc);
+	rc = binarySerializer_serialize(type, &seq, &out, &outLen);
+	CHECK_EQUAL(0, rc);
+
+	rc = binarySerializer_deserialize(type, out, outLen, (void **)&result);
+	CHECK_EQUAL(0, rc);
+	CHECK_EQUAL(2, result->len);
+	STRCMP_EQUAL("John", result->buf[0]->name);
+	CHECK_EQUAL(33, result->buf[0]->age);
+	STRCMP_EQUAL("Peter", result->buf[1]->name);
+	CHECK_EQUAL(44, result->buf[1]->age);
+
+	dynType_free(type, result);
+	free(seq.buf);
+	dynType_destroy(type);
+	free(out);
+}
+
+static void arenaTest(void) {
+	//more persons than fit in the first block of the arena
+	const unsigned int nrOfPersons = 1000;
+	struct bin_example3_person *persons = (struct bin_example3_person *) calloc(nrOfPersons, sizeof(*persons));
+	struct bin_example3 seq;
+	seq.buf = (struct bin_example3_person **) calloc(nrOfPersons, sizeof(void *));
+	seq.len = seq.cap = nrOfPersons;
+	for (unsigned int i = 0; i < nrOfPersons; i += 1) {
+		persons[i].name = i % 2 == 0 ? "John" : "Peter";
+		persons[i].age = i;
+		seq.buf[i] = &persons[i];
+	}
+
+	dyn_type *type = NULL;
+	void *out = NULL;
+	size_t outLen = 0;
+	struct bin_example3 *result = NULL;
+	int rc = dynType_parseWithStr(bin_example3_descriptor, "ex3", NULL, &type);
+	CHECK_EQUAL(0, rc);
+	rc = binarySerializer_serialize(type, &seq, &out, &outLen);
+	CHECK_EQUAL(0, rc);
+
+	rc = binarySerializer_deserializeInArena(type, out, outLen, (void **)&result);
+	CHECK_EQUAL(0, rc);
+	CHECK_EQUAL(nrOfPersons, result->len);
+	for (unsigned int i = 0; i < nrOfPersons; i += 1) {
+		STRCMP_EQUAL(persons[i].name, result->buf[i]->name);
+		CHECK_EQUAL(i, result->buf[i]->age);
+	}
+	dynType_freeArena(type, result);
+
+	//truncated input must be rejected, without leaking the arena
+	void *truncated = NULL;
+	rc = binarySerializer_deserializeInArena(type, out, outLen - 1, &truncated);
+	CHECK_EQUAL(1, rc);
+
+	free(seq.buf);
+	free(persons);
+	dynType_destroy(type);
+	free(out);
+}
+
+}
+
+TEST_GROUP(BinarySerializerTests) {
+	void setup() {
+		int lvl = 1;
+		dynCommon_logSetup(stdLog, NULL, lvl);
+		dynType_logSetup(stdLog, NULL,lvl);
+		binarySerializer_logSetup(stdLog, NULL, lvl);
+	}
+};
+
+TEST(BinarySerializerTests, RoundTripTest1) {
+	roundTripTest1();
+}
+
+TEST(BinarySerializerTests, RoundTripTest2) {
+	roundTripTest2();
+}
+
+TEST(BinarySerializerTests, RoundTripTest3) {
+	roundTripTest3();
+}
+
+TEST(BinarySerializerTests, ArenaTest) {
+	arenaTest();
+}
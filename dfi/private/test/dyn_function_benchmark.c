@@ -0,0 +1,96 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * Compares the cost of a call through ffi_call with the cost of the same call through dynFunction_call.
+ * Not part of the unit tests, run it with the number of calls as optional argument.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ffi.h>
+
+#include "dyn_function.h"
+
+#define BENCHMARK_DESCRIPTOR "add(#am=handle;PII#am=out;*I)N"
+#define BENCHMARK_DEFAULT_CALLS 1000000
+
+static int benchmarkAdd(void *handle, int32_t a, int32_t b, int32_t *out) {
+    *out = a + b + *(int32_t *)handle;
+    return 0;
+}
+
+static double elapsedNs(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1e9 + (end.tv_nsec - start->tv_nsec);
+}
+
+int main(int argc, char **argv) {
+    int32_t calls = argc > 1 ? atoi(argv[1]) : BENCHMARK_DEFAULT_CALLS;
+    if (calls <= 0) {
+        fprintf(stderr, "Usage: %s [calls]\n", argv[0]);
+        return 1;
+    }
+
+    dyn_function_type *dynFunc = NULL;
+    if (dynFunction_parseWithStr(BENCHMARK_DESCRIPTOR, NULL, &dynFunc) != 0) {
+        fprintf(stderr, "Cannot parse %s\n", BENCHMARK_DESCRIPTOR);
+        return 1;
+    }
+
+    void (*fp)(void) = (void(*)(void)) benchmarkAdd;
+    int32_t offset = 1;
+    void *handle = &offset;
+    int32_t a = 0;
+    int32_t b = 2;
+    int32_t result = 0;
+    int32_t *out = &result;
+    void *args[4] = {&handle, &a, &b, &out};
+    ffi_sarg rVal = 0;
+
+    //the same call through libffi, as dynFunction_call does for signatures without a direct call
+    ffi_type *argTypes[4] = {&ffi_type_pointer, &ffi_type_sint32, &ffi_type_sint32, &ffi_type_pointer};
+    ffi_cif cif;
+    if (ffi_prep_cif(&cif, FFI_DEFAULT_ABI, 4, &ffi_type_sint, argTypes) != FFI_OK) {
+        fprintf(stderr, "Cannot prepare the ffi cif\n");
+        dynFunction_destroy(dynFunc);
+        return 1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (a = 0; a < calls; a += 1) {
+        ffi_call(&cif, fp, &rVal, args);
+    }
+    double ffiNs = elapsedNs(&start) / calls;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (a = 0; a < calls; a += 1) {
+        dynFunction_call(dynFunc, fp, &rVal, args);
+    }
+    double dynNs = elapsedNs(&start) / calls;
+
+    printf("%s: ffi_call %.1f ns/call, dynFunction_call (%s) %.1f ns/call\n", BENCHMARK_DESCRIPTOR, ffiNs,
+           dynFunction_hasDirectCall(dynFunc) ? "direct" : "libffi", dynNs);
+
+    int status = result == calls + 2 && rVal == 0 ? 0 : 1;
+    dynFunction_destroy(dynFunc);
+    return status;
+}
@@ -25,6 +25,7 @@ extern "C" {
     #include <stdlib.h>
     #include <string.h>
     #include <ctype.h>
+    #include <ffi.h>
 
 
     #include "dyn_common.h"
@@ -60,7 +61,7 @@ extern "C" {
         int32_t b = 4;
         int32_t c = 8;
         void *values[3];
-        int32_t rVal = 0;
+        ffi_sarg rVal = 0;
         values[0] = &a;
         values[1] = &b;
         values[2] = &c;
@@ -162,7 +163,7 @@ extern "C" {
         args[0] = &ptr;
         args[1] = &a;
         args[2] = &input;
-        int rVal = 0;
+        ffi_sarg rVal = 0;
         rc = dynFunction_call(dynFunc, fp, &rVal, args);
         CHECK_EQUAL(0, rc);
         CHECK_EQUAL(4.0, result);
@@ -222,6 +223,84 @@ extern "C" {
         dynFunction_destroy(dynFunc);
     }
 
+    #define EXAMPLE5_DESCRIPTOR "example(BSsZJP)B"
+
+    static int8_t example5Func(int8_t a, int16_t b, uint16_t c, bool d, int64_t e, void *f) {
+        CHECK_EQUAL(-2, a);
+        CHECK_EQUAL(-300, b);
+        CHECK_EQUAL(60000, c);
+        CHECK(d);
+        CHECK(e == -5000000000LL);
+        CHECK(f == (void *) example5Func);
+        return -7;
+    }
+
+    #define EXAMPLE6_DESCRIPTOR "example(#am=handle;Pt#am=out;*J)P"
+
+    static void *example6Func(void *handle, const char *text, int64_t *out) {
+        *out = (int64_t) strlen(text) + 0x100000000LL;
+        return handle;
+    }
+
+    static void test_directCall(void) {
+        dyn_function_type *dynFunc = NULL;
+        int rc;
+
+        rc = dynFunction_parseWithStr(EXAMPLE5_DESCRIPTOR, NULL, &dynFunc);
+        CHECK_EQUAL(0, rc);
+        if (DYN_FUNCTION_DIRECT_CALL && sizeof(void *) == 8) {
+            CHECK(dynFunction_hasDirectCall(dynFunc));
+        }
+        int8_t a = -2;
+        int16_t b = -300;
+        uint16_t c = 60000;
+        bool d = true;
+        int64_t e = -5000000000LL;
+        void *f = (void *) example5Func;
+        void *args[6] = {&a, &b, &c, &d, &e, &f};
+        ffi_sarg rVal = 0;
+        rc = dynFunction_call(dynFunc, (void(*)(void)) example5Func, &rVal, args);
+        CHECK_EQUAL(0, rc);
+        CHECK_EQUAL(-7, rVal);
+        dynFunction_destroy(dynFunc);
+
+        dynFunc = NULL;
+        rc = dynFunction_parseWithStr(EXAMPLE6_DESCRIPTOR, NULL, &dynFunc);
+        CHECK_EQUAL(0, rc);
+        CHECK(dynFunction_hasDirectCall(dynFunc) == (DYN_FUNCTION_DIRECT_CALL != 0));
+        int handle = 0;
+        void *handlePtr = &handle;
+        const char *text = "hello";
+        int64_t out = 0;
+        int64_t *outPtr = &out;
+        void *args2[3] = {&handlePtr, &text, &outPtr};
+        void *result = NULL;
+        rc = dynFunction_call(dynFunc, (void(*)(void)) example6Func, &result, args2);
+        CHECK_EQUAL(0, rc);
+        CHECK(result == &handle);
+        CHECK(out == 0x100000005LL);
+        dynFunction_destroy(dynFunc);
+
+        //doubles, structs and more than 6 arguments go through libffi
+        dynFunc = NULL;
+        rc = dynFunction_parseWithStr(EXAMPLE3_DESCRIPTOR, NULL, &dynFunc);
+        CHECK_EQUAL(0, rc);
+        CHECK(!dynFunction_hasDirectCall(dynFunc));
+        dynFunction_destroy(dynFunc);
+
+        dynFunc = NULL;
+        rc = dynFunction_parseWithStr(EXAMPLE4_DESCRIPTOR, NULL, &dynFunc);
+        CHECK_EQUAL(0, rc);
+        CHECK(!dynFunction_hasDirectCall(dynFunc));
+        dynFunction_destroy(dynFunc);
+
+        dynFunc = NULL;
+        rc = dynFunction_parseWithStr("example(IIIIIII)V", NULL, &dynFunc);
+        CHECK_EQUAL(0, rc);
+        CHECK(!dynFunction_hasDirectCall(dynFunc));
+        dynFunction_destroy(dynFunc);
+    }
+
     #define INVALID_FUNC_DESCRIPTOR "example$[D)V"//$ is an invalid symbol, missing (
 
     static void test_invalidDynFunc(void) {
@@ -268,6 +347,10 @@ TEST(DynFunctionTests, DynFuncTest4) {
     test_example4();
 }
 
+TEST(DynFunctionTests, DirectCallTest) {
+    test_directCall();
+}
+
 TEST(DynFunctionTests, InvalidDynFuncTest) {
     test_invalidDynFunc();
     test_invalidDynFuncType();
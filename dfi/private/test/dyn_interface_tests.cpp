@@ -181,6 +181,59 @@ extern "C" {
         fclose(desc); desc=NULL;
 
     }
+
+    static void testShared(void) {
+        int status = 0;
+        dyn_interface_type *first = NULL;
+        dyn_interface_type *second = NULL;
+        dyn_interface_type *other = NULL;
+
+        FILE *desc = fopen("descriptors/example1.descriptor", "r");
+        assert(desc != NULL);
+        status = dynInterface_parseShared(desc, &first);
+        CHECK_EQUAL(0, status);
+        fclose(desc);
+
+        desc = fopen("descriptors/example1.descriptor", "r");
+        assert(desc != NULL);
+        status = dynInterface_parseShared(desc, &second);
+        CHECK_EQUAL(0, status);
+        fclose(desc);
+        CHECK(first == second);
+
+        desc = fopen("descriptors/example3.descriptor", "r");
+        assert(desc != NULL);
+        status = dynInterface_parseShared(desc, &other);
+        CHECK_EQUAL(0, status);
+        fclose(desc);
+        CHECK(first != other);
+
+        char *name = NULL;
+        dynInterface_getName(first, &name);
+        STRCMP_EQUAL("calculator", name);
+
+        dyn_interface_type *invalid = NULL;
+        desc = fopen("descriptors/invalids/noVersion.descriptor", "r");
+        assert(desc != NULL);
+        status = dynInterface_parseShared(desc, &invalid);
+        CHECK_EQUAL(1, status);
+        CHECK(invalid == NULL);
+        fclose(desc);
+
+        //still in use by second
+        dynInterface_release(first);
+        CHECK_EQUAL(4, dynInterface_nrOfMethods(second));
+        dynInterface_release(second);
+        dynInterface_release(other);
+
+        //parsed again after the last release
+        desc = fopen("descriptors/example1.descriptor", "r");
+        assert(desc != NULL);
+        status = dynInterface_parseShared(desc, &first);
+        CHECK_EQUAL(0, status);
+        fclose(desc);
+        dynInterface_release(first);
+    }
 }
 
 
@@ -205,3 +258,7 @@ TEST(DynInterfaceTests, test2) {
 TEST(DynInterfaceTests, testInvalid) {
     testInvalid();
 }
+
+TEST(DynInterfaceTests, testShared) {
+    testShared();
+}
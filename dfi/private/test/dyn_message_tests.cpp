@@ -219,6 +219,29 @@ static void msg_invalid(void) {
 
 }
 
+static void msg_shared(void) {
+	int status = 0;
+	dyn_message_type *first = NULL;
+	dyn_message_type *second = NULL;
+
+	FILE *desc = fopen("descriptors/msg_example1.descriptor", "r");
+	assert(desc != NULL);
+	status = dynMessage_parseShared(desc, &first);
+	CHECK_EQUAL(0, status);
+	fclose(desc);
+
+	desc = fopen("descriptors/msg_example1.descriptor", "r");
+	assert(desc != NULL);
+	status = dynMessage_parseShared(desc, &second);
+	CHECK_EQUAL(0, status);
+	fclose(desc);
+	CHECK(first == second);
+
+	dynMessage_release(first);
+	checkMessageVersion(second, "1.0.0");
+	dynMessage_release(second);
+}
+
 }
 
 
@@ -251,3 +274,7 @@ TEST(DynMessageTests, msg_test4) {
 TEST(DynMessageTests, msg_invalid) {
 	msg_invalid();
 }
+
+TEST(DynMessageTests, msg_shared) {
+	msg_shared();
+}
@@ -21,6 +21,7 @@
 
 extern "C" {
     #include <stdarg.h>
+    #include <string.h>
     
     #include "dyn_common.h"
     #include "dyn_type.h"
@@ -295,3 +296,113 @@ TEST(DynTypeTests, SequenceWithPointerTest) {
     dynType_destroy(type);
 }
 
+
+TEST(DynTypeTests, LayoutTest) {
+    dyn_type *type = NULL;
+    int rc = dynType_parseWithStr("{D{II a b}t[D x y z s}", NULL, NULL, &type);
+    CHECK_EQUAL(0, rc);
+
+    const struct dyn_type_layout *layout = dynType_layout(type);
+    CHECK(layout != NULL);
+    CHECK_EQUAL(9, layout->nrOfOps);
+    CHECK(!layout->plain);
+
+    const char descriptors[] = "{D{II}t[}";
+    const size_t offsets[] = {0, 0, 8, 8, 12, 16, 16, 24, 40};
+    for (unsigned int i = 0; i < layout->nrOfOps; i += 1) {
+        CHECK_EQUAL(descriptors[i], layout->ops[i].descriptor);
+        CHECK_EQUAL(offsets[i], layout->ops[i].offset);
+    }
+    CHECK_EQUAL(8, layout->ops[0].end);
+    CHECK_EQUAL(5, layout->ops[2].end);
+    STRCMP_EQUAL("y", layout->ops[2].name);
+    STRCMP_EQUAL("b", layout->ops[4].name);
+
+    const struct dyn_type_layout *itemLayout = dynType_layout(dynType_sequence_itemType(layout->ops[7].type));
+    CHECK(itemLayout != NULL);
+    CHECK_EQUAL(1, itemLayout->nrOfOps);
+    CHECK(itemLayout->plain);
+
+    dynType_destroy(type);
+}
+
+TEST(DynTypeTests, ArenaTest) {
+    struct point {
+        double x;
+        double y;
+    };
+
+    struct example {
+        char *name;
+        struct {
+            uint32_t cap;
+            uint32_t len;
+            double *buf;
+        } values;
+        struct point *point;
+    };
+
+    dyn_type *type = NULL;
+    int rc = dynType_parseWithStr("{t[D*{DD x y} name values point}", NULL, NULL, &type);
+    CHECK_EQUAL(0, rc);
+
+    //a small arena, so the values do not fit in the first block
+    struct example *ex = NULL;
+    rc = dynType_allocArena(type, 16, (void **)&ex);
+    CHECK_EQUAL(0, rc);
+
+    dyn_arena *arena = dynType_arena(type, ex);
+    dyn_type *pointType = NULL;
+    dynType_complex_dynTypeAt(type, 2, &pointType);
+    dynType_typedPointer_getTypedType(pointType, &pointType);
+    rc = dynType_allocIn(pointType, arena, (void **)&ex->point);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(0.0, ex->point->x);
+    ex->point->y = 1.0;
+    dyn_type *nameType = NULL;
+    dynType_complex_dynTypeAt(type, 0, &nameType);
+    rc = dynType_text_allocAndInitIn(nameType, arena, &ex->name, "in the arena");
+    CHECK_EQUAL(0, rc);
+    STRCMP_EQUAL("in the arena", ex->name);
+
+    dyn_type *valuesType = NULL;
+    dynType_complex_dynTypeAt(type, 1, &valuesType);
+    rc = dynType_sequence_allocIn(valuesType, arena, &ex->values, 1000);
+    CHECK_EQUAL(0, rc);
+    CHECK_EQUAL(1000, ex->values.cap);
+    for (int i = 0; i < 1000; i += 1) {
+        CHECK_EQUAL(0.0, ex->values.buf[i]);
+        ex->values.buf[i] = i;
+    }
+    CHECK_EQUAL(0, (uintptr_t) ex->values.buf % sizeof(double));
+
+    //all memory is freed at once (checked by the memory leak detection)
+    dynType_freeArena(type, ex);
+    dynType_destroy(type);
+}
+
+TEST(DynTypeTests, FreeByValueReferenceTest) {
+    struct sub {
+        char *text;
+        int32_t n;
+    };
+
+    struct example {
+        struct sub sub;
+        char *other;
+    };
+
+    dyn_type *type = NULL;
+    int rc = dynType_parseWithStr("Tsub={tI text n};{lsub;t sub other}", NULL, NULL, &type);
+    CHECK_EQUAL(0, rc);
+
+    struct example *ex = NULL;
+    rc = dynType_alloc(type, (void **)&ex);
+    CHECK_EQUAL(0, rc);
+    ex->sub.text = strdup("text in a struct by value");
+    ex->other = strdup("other");
+
+    //the text of the by value member is freed as well (checked by the memory leak detection)
+    dynType_free(type, ex);
+    dynType_destroy(type);
+}
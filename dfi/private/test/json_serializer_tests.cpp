@@ -25,6 +25,7 @@ extern "C" {
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
 
 #include <ffi.h>
 
@@ -526,6 +527,235 @@ void writeTest3(void) {
 }
 
 
+static void streamParseTests(void) {
+	const char *descriptors[] = {example1_descriptor, example2_descriptor, example3_descriptor, example4_descriptor,
+			example5_descriptor, example7_descriptor, example8_descriptor};
+	const char *inputs[] = {example1_input, example2_input, example3_input, example4_input,
+			example5_input, example7_input, example8_input};
+	void (*checks[])(void *) = {check_example1, check_example2, check_example3, check_example4,
+			check_example5, check_example7, check_example8};
+
+	unsigned int i;
+	for (i = 0; i < sizeof(descriptors) / sizeof(descriptors[0]); i += 1) {
+		dyn_type *type = NULL;
+		void *inst = NULL;
+		int rc = dynType_parseWithStr(descriptors[i], NULL, NULL, &type);
+		CHECK_EQUAL(0, rc);
+		rc = jsonSerializer_deserializeStream(type, inputs[i], strlen(inputs[i]), &inst);
+		CHECK_EQUAL(0, rc);
+		checks[i](inst);
+		dynType_free(type, inst);
+		dynType_destroy(type);
+	}
+
+	dyn_type *type = NULL;
+	struct ex6_sequence *seq = NULL;
+	int rc = dynType_parseWithStr(example6_descriptor, NULL, NULL, &type);
+	CHECK_EQUAL(0, rc);
+	rc = jsonSerializer_deserializeStream(type, example6_input, strlen(example6_input), (void **)&seq);
+	CHECK_EQUAL(0, rc);
+	check_example6((*seq));
+	dynType_free(type, seq);
+
+	//invalid input
+	const char *invalid[] = {"[{\"v1\":0.1,\"v2\":0.2}", "[{\"v1\":0.1,\"v3\":0.2}]", "[{\"v1\":\"a\"}]", "[] x", ""};
+	for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i += 1) {
+		seq = NULL;
+		rc = jsonSerializer_deserializeStream(type, invalid[i], strlen(invalid[i]), (void **)&seq);
+		CHECK(rc != 0);
+		CHECK(seq == NULL);
+	}
+	dynType_destroy(type);
+}
+
+static void arenaParseTests(void) {
+	const char *descriptors[] = {example1_descriptor, example2_descriptor, example3_descriptor, example4_descriptor,
+			example5_descriptor, example7_descriptor, example8_descriptor};
+	const char *inputs[] = {example1_input, example2_input, example3_input, example4_input,
+			example5_input, example7_input, example8_input};
+	void (*checks[])(void *) = {check_example1, check_example2, check_example3, check_example4,
+			check_example5, check_example7, check_example8};
+
+	unsigned int i;
+	for (i = 0; i < sizeof(descriptors) / sizeof(descriptors[0]); i += 1) {
+		dyn_type *type = NULL;
+		void *inst = NULL;
+		int rc = dynType_parseWithStr(descriptors[i], NULL, NULL, &type);
+		CHECK_EQUAL(0, rc);
+		rc = jsonSerializer_deserializeInArena(type, inputs[i], strlen(inputs[i]), &inst);
+		CHECK_EQUAL(0, rc);
+		checks[i](inst);
+		dynType_freeArena(type, inst);
+		dynType_destroy(type);
+	}
+
+	dyn_type *type = NULL;
+	struct ex6_sequence *seq = NULL;
+	int rc = dynType_parseWithStr(example6_descriptor, NULL, NULL, &type);
+	CHECK_EQUAL(0, rc);
+	rc = jsonSerializer_deserializeInArena(type, example6_input, strlen(example6_input), (void **)&seq);
+	CHECK_EQUAL(0, rc);
+	check_example6((*seq));
+	dynType_freeArena(type, seq);
+
+	//invalid input, the arena is freed on failure
+	const char *invalid[] = {"[{\"v1\":0.1,\"v2\":0.2}", "[{\"v1\":0.1,\"v3\":0.2}]", "[{\"v1\":\"a\"}]", "[] x", ""};
+	for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i += 1) {
+		seq = NULL;
+		rc = jsonSerializer_deserializeInArena(type, invalid[i], strlen(invalid[i]), (void **)&seq);
+		CHECK(rc != 0);
+		CHECK(seq == NULL);
+	}
+	dynType_destroy(type);
+}
+
+static void streamWriteTests(void) {
+	struct write_example1 ex1;
+	memset(&ex1, 0, sizeof(ex1));
+	ex1.a=1;
+	ex1.d=-4;
+	ex1.g=18446744073709551615ULL;
+	ex1.h=8.8f;
+	ex1.i=9.0;
+	ex1.k=true;
+
+	dyn_type *type = NULL;
+	char *result = NULL;
+	size_t len = 0;
+	int rc = dynType_parseWithStr(write_example1_descriptor, "ex1", NULL, &type);
+	CHECK_EQUAL(0, rc);
+	rc = jsonSerializer_serializeStream(type, &ex1, &result, &len);
+	CHECK_EQUAL(0, rc);
+	CHECK_EQUAL(strlen(result), len);
+	STRCMP_CONTAINS("{\"a\":1,\"b\":0,", result);
+	STRCMP_CONTAINS("\"d\":-4", result);
+	STRCMP_CONTAINS("\"g\":18446744073709551615", result);
+	STRCMP_CONTAINS("\"h\":8.8", result);
+	STRCMP_CONTAINS("\"i\":9.0", result);
+	STRCMP_CONTAINS("\"k\":true", result);
+
+	struct write_example1 *parsed = NULL;
+	rc = jsonSerializer_deserializeStream(type, result, len, (void **)&parsed);
+	CHECK_EQUAL(0, rc);
+	CHECK(memcmp(&ex1, parsed, sizeof(ex1)) == 0);
+	dynType_free(type, parsed);
+	dynType_destroy(type);
+	free(result);
+
+	//texts, sequences and pointers
+	rc = dynType_parseWithStr(example5_descriptor, NULL, NULL, &type);
+	CHECK_EQUAL(0, rc);
+	struct leaf leaf;
+	leaf.name = "quote \" backslash \\ tab \t \xc3\xa9";
+	leaf.age = 3;
+	struct node node;
+	node.left = NULL;
+	node.right = NULL;
+	node.value = &leaf;
+	struct example5 ex5;
+	ex5.head = &node;
+	rc = jsonSerializer_serializeStream(type, &ex5, &result, &len);
+	CHECK_EQUAL(0, rc);
+	STRCMP_CONTAINS("\"left\":null", result);
+	STRCMP_CONTAINS("quote \\\" backslash \\\\ tab \\t", result);
+
+	struct example5 *parsed5 = NULL;
+	rc = jsonSerializer_deserializeStream(type, result, len, (void **)&parsed5);
+	CHECK_EQUAL(0, rc);
+	CHECK(parsed5->head->left == NULL);
+	STRCMP_EQUAL(leaf.name, parsed5->head->value->name);
+	CHECK_EQUAL(3, parsed5->head->value->age);
+	dynType_free(type, parsed5);
+	dynType_destroy(type);
+	free(result);
+
+	const char *escaped = "{\"a\":\"\\u00e9\\ud83d\\ude00\\/\"}";
+	struct example7 *parsed7 = NULL;
+	rc = dynType_parseWithStr(example7_descriptor, NULL, NULL, &type);
+	CHECK_EQUAL(0, rc);
+	rc = jsonSerializer_deserializeStream(type, escaped, strlen(escaped), (void **)&parsed7);
+	CHECK_EQUAL(0, rc);
+	STRCMP_EQUAL("\xc3\xa9\xf0\x9f\x98\x80/", parsed7->a);
+	dynType_free(type, parsed7);
+
+	//duplicate members and embedded NULs are rejected
+	const char *invalid[] = {"{\"a\":\"x\",\"a\":\"y\"}", "{\"a\":\"x\\u0000y\"}"};
+	unsigned int i;
+	for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i += 1) {
+		parsed7 = NULL;
+		rc = jsonSerializer_deserializeStream(type, invalid[i], strlen(invalid[i]), (void **)&parsed7);
+		CHECK(rc != 0);
+		CHECK(parsed7 == NULL);
+	}
+	dynType_destroy(type);
+}
+
+static double elapsedMs(struct timespec *begin, struct timespec *end) {
+	return (end->tv_sec - begin->tv_sec) * 1000.0 + (end->tv_nsec - begin->tv_nsec) / 1000000.0;
+}
+
+static void streamBenchmark(void) {
+	const uint32_t nrOfSamples = 100000;
+	dyn_type *type = NULL;
+	int rc = dynType_parseWithStr(example6_descriptor, NULL, NULL, &type);
+	CHECK_EQUAL(0, rc);
+
+	struct ex6_sequence seq;
+	seq.cap = seq.len = nrOfSamples;
+	seq.buf = (struct ex6_sample *) calloc(nrOfSamples, sizeof(struct ex6_sample));
+	uint32_t i;
+	for (i = 0; i < nrOfSamples; i += 1) {
+		seq.buf[i].v1 = i * 0.5;
+		seq.buf[i].v2 = i * 0.25;
+	}
+
+	struct timespec begin;
+	struct timespec end;
+	char *domResult = NULL;
+	char *streamResult = NULL;
+	size_t streamLen = 0;
+	struct ex6_sequence *domSeq = NULL;
+	struct ex6_sequence *streamSeq = NULL;
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	rc = jsonSerializer_serialize(type, &seq, &domResult);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	CHECK_EQUAL(0, rc);
+	double domWrite = elapsedMs(&begin, &end);
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	rc = jsonSerializer_serializeStream(type, &seq, &streamResult, &streamLen);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	CHECK_EQUAL(0, rc);
+	double streamWrite = elapsedMs(&begin, &end);
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	rc = jsonSerializer_deserialize(type, domResult, (void **)&domSeq);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	CHECK_EQUAL(0, rc);
+	double domRead = elapsedMs(&begin, &end);
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	rc = jsonSerializer_deserializeStream(type, streamResult, streamLen, (void **)&streamSeq);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	CHECK_EQUAL(0, rc);
+	double streamRead = elapsedMs(&begin, &end);
+
+	CHECK_EQUAL(nrOfSamples, streamSeq->len);
+	CHECK_EQUAL(nrOfSamples, domSeq->len);
+	CHECK(memcmp(seq.buf, streamSeq->buf, nrOfSamples * sizeof(struct ex6_sample)) == 0);
+	CHECK(memcmp(domSeq->buf, streamSeq->buf, nrOfSamples * sizeof(struct ex6_sample)) == 0);
+
+	printf("\n%u samples (%zu bytes json): write dom %.1f ms, stream %.1f ms; read dom %.1f ms, stream %.1f ms\n",
+			nrOfSamples, streamLen, domWrite, streamWrite, domRead, streamRead);
+
+	dynType_free(type, domSeq);
+	dynType_free(type, streamSeq);
+	free(domResult);
+	free(streamResult);
+	free(seq.buf);
+	dynType_destroy(type);
+}
 
 }
 
@@ -555,4 +785,20 @@ TEST(JsonSerializerTests, WriteTest3) {
 	writeTest3();
 }
 
+TEST(JsonSerializerTests, StreamParseTests) {
+	streamParseTests();
+}
+
+TEST(JsonSerializerTests, ArenaParseTests) {
+	arenaParseTests();
+}
+
+TEST(JsonSerializerTests, StreamWriteTests) {
+	streamWriteTests();
+}
+
+TEST(JsonSerializerTests, StreamBenchmark) {
+	streamBenchmark();
+}
+
 
@@ -0,0 +1,44 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+#ifndef __BINARY_RPC_H_
+#define __BINARY_RPC_H_
+
+#include <stddef.h>
+#include "dfi_log_util.h"
+#include "dyn_type.h"
+#include "dyn_function.h"
+#include "dyn_interface.h"
+
+/*
+ * Compact binary alternative for json_rpc, using the binary serializer for the values.
+ * A request holds the index of the method in the interface and a hash of its signature, followed by the standard arguments.
+ * A reply holds the return value of the function and, when that is 0, a presence byte and value for every output argument.
+ * Both sides must use the same descriptor.
+ */
+
+//logging
+DFI_SETUP_LOG_HEADER(binaryRpc);
+
+int binaryRpc_call(dyn_interface_type *intf, void *service, const void *request, size_t requestLen, void **out, size_t *outLen);
+
+
+int binaryRpc_prepareInvokeRequest(dyn_function_type *func, int methodIndex, const char *id, void *args[], void **out, size_t *outLen);
+int binaryRpc_handleReply(dyn_function_type *func, const void *reply, size_t replyLen, void *args[]);
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+#ifndef __BINARY_SERIALIZER_H_
+#define __BINARY_SERIALIZER_H_
+
+#include <stddef.h>
+#include "dfi_log_util.h"
+#include "dyn_type.h"
+
+/*
+ * Compact binary encoding of dyn_type instances. Fields are written in descriptor order without
+ * names, scalars as fixed width little endian values, text and sequences prefixed with a uint32 length
+ * and typed pointers prefixed with a presence byte. Both sides must use the same descriptor.
+ */
+
+//logging
+DFI_SETUP_LOG_HEADER(binarySerializer);
+
+int binarySerializer_deserialize(dyn_type *type, const void *input, size_t inputLen, void **result);
+
+/*
+ * Deserializes into an arena (see dynType_allocArena), the result must be freed with dynType_freeArena.
+ */
+int binarySerializer_deserializeInArena(dyn_type *type, const void *input, size_t inputLen, void **result);
+
+int binarySerializer_serialize(dyn_type *type, const void *input, void **output, size_t *outputLen);
+
+/*
+ * Appends the instance at input to *output, which holds *outputLen bytes in *outputCap bytes allocated with malloc
+ * (or is NULL), growing it when needed. Lets several values of different types share one buffer.
+ */
+int binarySerializer_serializeTo(dyn_type *type, const void *input, char **output, size_t *outputLen, size_t *outputCap);
+
+/*
+ * Reads a value of type at *offset of input into loc (dynType_size(type) bytes) and advances *offset past it.
+ */
+int binarySerializer_deserializeFrom(dyn_type *type, const void *input, size_t inputLen, size_t *offset, void *loc);
+
+#endif
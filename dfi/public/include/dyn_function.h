@@ -32,6 +32,18 @@
  * am=out #output pointer
  */
 
+/**
+ * Whether dynFunction_call can call small signatures without libffi, see dynFunction_call.
+ * Define DYN_FUNCTION_DIRECT_CALL as 0 to always use libffi.
+ */
+#ifndef DYN_FUNCTION_DIRECT_CALL
+#if defined(__x86_64__) || defined(__aarch64__) || defined(__i386__) || defined(__arm__)
+#define DYN_FUNCTION_DIRECT_CALL 1
+#else
+#define DYN_FUNCTION_DIRECT_CALL 0
+#endif
+#endif
+
 typedef struct _dyn_function_type dyn_function_type;
 
 DFI_SETUP_LOG_HEADER(dynFunction);
@@ -52,7 +64,16 @@ enum dyn_function_argument_meta dynFunction_argumentMetaForIndex(dyn_function_ty
 dyn_type * dynFunction_returnType(dyn_function_type *dynFunction);
 
 void dynFunction_destroy(dyn_function_type *dynFunc);
+
+/**
+ * Calls fn with the values pointed to by argValues. As with ffi_call, an integral return value smaller than a ffi_arg
+ * is widened to a ffi_arg, so returnValue must be large enough to hold one.
+ * Functions with a few integer or pointer arguments returning void, an integer or a pointer (e.g. handle, scalars and
+ * an output pointer) are called directly through a trampoline selected when the function is parsed, other functions
+ * through libffi.
+ */
 int dynFunction_call(dyn_function_type *dynFunc, void(*fn)(void), void *returnValue, void **argValues);
+bool dynFunction_hasDirectCall(dyn_function_type *dynFunc);
 
 int dynFunction_createClosure(dyn_function_type *func, void (*bind)(void *, void **, void*), void *userData, void(**fn)(void));
 int dynFunction_getFnPointer(dyn_function_type *func, void (**fn)(void));
@@ -54,6 +54,13 @@ struct method_entry {
 int dynInterface_parse(FILE *descriptor, dyn_interface_type **out);
 void dynInterface_destroy(dyn_interface_type *intf);
 
+/*
+ * Same as dynInterface_parse, but returns the interface already parsed from a descriptor with the same content if there is
+ * one. The result is shared and must not be changed, release it with dynInterface_release instead of destroying it.
+ */
+int dynInterface_parseShared(FILE *descriptor, dyn_interface_type **out);
+void dynInterface_release(dyn_interface_type *intf);
+
 int dynInterface_getName(dyn_interface_type *intf, char **name);
 int dynInterface_getVersion(dyn_interface_type *intf, version_pt* version);
 int dynInterface_getVersionString(dyn_interface_type *intf, char **version);
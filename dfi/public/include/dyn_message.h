@@ -44,6 +44,13 @@ typedef struct _dyn_message_type dyn_message_type;
 int dynMessage_parse(FILE *descriptor, dyn_message_type **out);
 void dynMessage_destroy(dyn_message_type *msg);
 
+/*
+ * Same as dynMessage_parse, but returns the message already parsed from a descriptor with the same content if there is
+ * one. The result is shared and must not be changed, release it with dynMessage_release instead of destroying it.
+ */
+int dynMessage_parseShared(FILE *descriptor, dyn_message_type **out);
+void dynMessage_release(dyn_message_type *msg);
+
 int dynMessage_getName(dyn_message_type *msg, char **name);
 int dynMessage_getVersion(dyn_message_type *msg, version_pt* version);
 int dynMessage_getVersionString(dyn_message_type *msg, char **version);
@@ -112,6 +112,38 @@ struct complex_type_entry {
     TAILQ_ENTRY(complex_type_entry) entries;
 };
 
+/*
+ * Compiled layout of a type, created when the type is parsed. Nested structs (also by value references) are flattened
+ * into one array of ops: a '{' op opens a struct and its 'end' is the index of the matching '}' op, all other ops are
+ * values. Offsets are relative to the start of the instance, so a struct is walked without recursion or name lookups.
+ * Sequences ('['), typed pointers ('*') and texts ('t') point outside the instance, their items and target are
+ * described by the layout of their own type.
+ */
+struct dyn_type_op {
+    char descriptor;    //descriptor type of the value, '{' and '}' open and close a struct
+    const char *name;   //member name, NULL for the type itself and for '}'
+    size_t offset;
+    size_t size;
+    dyn_type *type;     //type of the value (references resolved)
+    unsigned int end;   //'{' only
+};
+
+struct dyn_type_layout {
+    unsigned int nrOfOps;
+    struct dyn_type_op *ops;
+    bool plain;         //no texts, sequences or typed pointers, instances do not own other memory
+};
+
+/*
+ * Arena for instances that are freed at once, e.g. a deserialized message. An arena instance is allocated at the start
+ * of one block that also holds the arena, the other allocations (texts, sequence buffers, pointed to instances) take
+ * memory from that block with a bump pointer and only allocate more blocks when it is full. Freeing the instance with
+ * dynType_freeArena frees all blocks without walking the instance, so arena instances must only refer to memory of
+ * their own arena and must not be freed with dynType_free.
+ * Functions taking a dyn_arena allocate on the heap when the arena is NULL.
+ */
+typedef struct _dyn_arena dyn_arena;
+
 //logging
 DFI_SETUP_LOG_HEADER(dynType);
 
@@ -123,11 +155,19 @@ void dynType_destroy(dyn_type *type);
 int dynType_alloc(dyn_type *type, void **bufLoc);
 void dynType_free(dyn_type *type, void *loc);
 
+//arena
+int dynType_allocArena(dyn_type *type, size_t capacity, void **instance);
+void dynType_freeArena(dyn_type *type, void *instance);
+dyn_arena * dynType_arena(dyn_type *type, void *instance);
+int dynType_allocIn(dyn_type *type, dyn_arena *arena, void **bufLoc);
+void * dynArena_alloc(dyn_arena *arena, size_t size);
+
 void dynType_print(dyn_type *type, FILE *stream);
 size_t dynType_size(dyn_type *type);
 int dynType_type(dyn_type *type);
 int dynType_descriptorType(dyn_type *type);
 const char * dynType_getMetaInfo(dyn_type *type, const char *name);
+const struct dyn_type_layout * dynType_layout(dyn_type *type);
 
 //complexType
 int dynType_complex_indexForName(dyn_type *type, const char *name);
@@ -138,6 +178,7 @@ int dynType_complex_entries(dyn_type *type, struct complex_type_entries_head **e
 
 //sequence
 int dynType_sequence_alloc(dyn_type *type, void *inst, uint32_t cap);
+int dynType_sequence_allocIn(dyn_type *type, dyn_arena *arena, void *inst, uint32_t cap);
 int dynType_sequence_locForIndex(dyn_type *type, void *seqLoc, int index, void **valLoc);
 int dynType_sequence_increaseLengthAndReturnLastLoc(dyn_type *type, void *seqLoc, void **valLoc);
 dyn_type * dynType_sequence_itemType(dyn_type *type);
@@ -148,6 +189,7 @@ int dynType_typedPointer_getTypedType(dyn_type *type, dyn_type **typedType);
 
 //text
 int dynType_text_allocAndInit(dyn_type *type, void *textLoc, const char *value);
+int dynType_text_allocAndInitIn(dyn_type *type, dyn_arena *arena, void *textLoc, const char *value);
 
 //simple
 void dynType_simple_setValue(dyn_type *type, void *inst, void *in);
@@ -34,4 +34,17 @@ int jsonSerializer_deserializeJson(dyn_type *type, json_t *input, void **result)
 int jsonSerializer_serialize(dyn_type *type, const void* input, char **output);
 int jsonSerializer_serializeJson(dyn_type *type, const void* input, json_t **out);
 
+/*
+ * Streaming variants, which write the JSON text directly from the instance into a growing buffer and parse the text
+ * directly into a new instance, without building a jansson tree. The JSON is the same as for the functions above,
+ * members are written in descriptor order.
+ */
+int jsonSerializer_deserializeStream(dyn_type *type, const char *input, size_t inputLen, void **result);
+int jsonSerializer_serializeStream(dyn_type *type, const void *input, char **output, size_t *outputLen);
+
+/*
+ * Streaming deserialization into an arena (see dynType_allocArena), the result must be freed with dynType_freeArena.
+ */
+int jsonSerializer_deserializeInArena(dyn_type *type, const char *input, size_t inputLen, void **result);
+
 #endif
@@ -20,6 +20,8 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <pthread.h>
+#include <time.h>
 #include <curl/curl.h>
 #include <jansson.h>
 
@@ -37,6 +39,7 @@
 #define MAX_OVERHEAD_LENGTH           64
 #define DEFAULT_CURL_TIMEOUT          10
 #define DEFAULT_CURL_CONECTTIMEOUT    10
+#define DEFAULT_WATCH_RETRY_DELAY     1
 
 typedef enum {
 	GET, PUT, DELETE
@@ -45,17 +48,53 @@ typedef enum {
 static const char* etcd_server;
 static int etcd_port = 0;
 
+/* every thread keeps its own curl handle, so its connection to etcd is reused between requests.
+ * The key is created by the first request and deleted by etcd_fini */
+static pthread_key_t etcd_curlHandleKey;
+static bool etcd_curlHandleKeyCreated = false;
+static pthread_mutex_t etcd_curlHandleKeyLock = PTHREAD_MUTEX_INITIALIZER;
+
 struct MemoryStruct {
 	char *memory;
 	size_t size;
 };
 
+struct etcd_watch {
+	long id;
+	char *key;
+	long long index;
+	etcd_watch_callback callback;
+	void *arg;
+	CURL *curl;
+	char *url;
+	struct MemoryStruct reply;
+	bool active; /* the long poll is added to the multi handle */
+	time_t retryTime; /* when not active, the time the long poll is started again */
+	bool removed;
+	struct etcd_watch *next;
+};
+
+struct etcd_watch_loop {
+	CURLM *multi;
+	pthread_mutex_t lock; /* protects watches, nextId, the removed flags, runner and callbackId */
+	pthread_cond_t callbackDone;
+	struct etcd_watch *watches;
+	long nextId;
+	pthread_t runner; /* the thread running the loop */
+	long callbackId; /* id of the watch whose callback is in progress, 0 if none */
+};
+
 
 /**
  * Static function declarations
  */
 static int performRequest(char* url, request_t request, void* callback, void* reqData, void* repData);
 static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp);
+static char* etcd_createWatchUrl(const char* key, long long index);
+static int etcd_parseWatchReply(const char* reply, long long index, char** action, char** prevValue, char** value, char** rkey, long long* modifiedIndex);
+static void etcd_watch_destroy(struct etcd_watch *watch);
+static int etcd_watch_arm(etcd_watch_loop_t *loop, struct etcd_watch *watch);
+static void etcd_watch_handleDone(etcd_watch_loop_t *loop, struct etcd_watch *watch, CURLcode result);
 /**
  * External function definition
  */
@@ -77,6 +116,22 @@ int etcd_init(const char* server, int port, int flags) {
 	return status;
 }
 
+/**
+ * etcd_fini
+ */
+void etcd_fini(void) {
+	pthread_mutex_lock(&etcd_curlHandleKeyLock);
+	if (etcd_curlHandleKeyCreated) {
+		CURL *curl = pthread_getspecific(etcd_curlHandleKey);
+		if (curl != NULL) {
+			curl_easy_cleanup(curl);
+		}
+		pthread_key_delete(etcd_curlHandleKey);
+		etcd_curlHandleKeyCreated = false;
+	}
+	pthread_mutex_unlock(&etcd_curlHandleKeyLock);
+}
+
 
 /**
  * etcd_get
@@ -291,6 +346,54 @@ int etcd_set(const char* key, const char* value, int ttl, bool prevExist) {
 }
 
 
+/**
+ * etcd_refresh
+ */
+int etcd_refresh(const char* key, int ttl) {
+	json_error_t error;
+	json_t* js_root = NULL;
+	json_t* js_node = NULL;
+	int retVal = -1;
+	char *url;
+	char request[MAX_OVERHEAD_LENGTH];
+	int res;
+	struct MemoryStruct reply;
+
+	/* Skip leading '/', etcd cannot handle this. */
+	while(*key == '/') {
+		key++;
+	}
+
+	reply.memory = calloc(1, 1); /* will be grown as needed by the realloc above */
+	reply.size = 0; /* no data at this point */
+
+	asprintf(&url, "http://%s:%d/v2/keys/%s", etcd_server, etcd_port, key);
+	snprintf(request, MAX_OVERHEAD_LENGTH, "ttl=%d;refresh=true;prevExist=true", ttl);
+
+	res = performRequest(url, PUT, WriteMemoryCallback, request, (void*) &reply);
+	free(url);
+
+	if (res == CURLE_OK) {
+		js_root = json_loads(reply.memory, 0, &error);
+		if (js_root != NULL) {
+			js_node = json_object_get(js_root, ETCD_JSON_NODE);
+		}
+		if (js_node != NULL) {
+			retVal = 0;
+		}
+		if (js_root != NULL) {
+			json_decref(js_root);
+		}
+	}
+
+	if (reply.memory) {
+		free(reply.memory);
+	}
+
+	return retVal;
+}
+
+
 /**
  * etcd_set_with_check
  */
@@ -320,15 +423,6 @@ int etcd_set_with_check(const char* key, const char* value, int ttl, bool always
  * etcd_watch
  */
 int etcd_watch(const char* key, long long index, char** action, char** prevValue, char** value, char** rkey, long long* modifiedIndex) {
-	json_error_t error;
-	json_t* js_root = NULL;
-	json_t* js_node = NULL;
-	json_t* js_prevNode = NULL;
-	json_t* js_action = NULL;
-	json_t* js_value = NULL;
-	json_t* js_rkey = NULL;
-	json_t* js_prevValue = NULL;
-	json_t* js_modIndex = NULL;
 	int retVal = -1;
 	char *url = NULL;
 	int res;
@@ -337,58 +431,12 @@ int etcd_watch(const char* key, long long index, char** action, char** prevValue
 	reply.memory = malloc(1); /* will be grown as needed by the realloc above */
 	reply.size = 0; /* no data at this point */
 
-	if (index != 0)
-		asprintf(&url, "http://%s:%d/v2/keys/%s?wait=true&recursive=true&waitIndex=%lld", etcd_server, etcd_port, key, index);
-	else
-		asprintf(&url, "http://%s:%d/v2/keys/%s?wait=true&recursive=true", etcd_server, etcd_port, key);
+	url = etcd_createWatchUrl(key, index);
 	res = performRequest(url, GET, WriteMemoryCallback, NULL, (void*) &reply);
 	if(url)
 		free(url);
 	if (res == CURLE_OK) {
-		js_root = json_loads(reply.memory, 0, &error);
-
-		if (js_root != NULL) {
-			js_action = json_object_get(js_root, ETCD_JSON_ACTION);
-			js_node = json_object_get(js_root, ETCD_JSON_NODE);
-			js_prevNode = json_object_get(js_root, ETCD_JSON_PREVNODE);
-			retVal = 0;
-		}
-		if (js_prevNode != NULL) {
-			js_prevValue = json_object_get(js_prevNode, ETCD_JSON_VALUE);
-		}
-		if (js_node != NULL) {
-			js_rkey = json_object_get(js_node, ETCD_JSON_KEY);
-			js_value = json_object_get(js_node, ETCD_JSON_VALUE);
-			js_modIndex = json_object_get(js_node, ETCD_JSON_MODIFIEDINDEX);
-		}
-		if (js_prevNode != NULL) {
-			js_prevValue = json_object_get(js_prevNode, ETCD_JSON_VALUE);
-		}
-		if ((prevValue != NULL) && (js_prevValue != NULL) && (json_is_string(js_prevValue))) {
-
-			*prevValue = strdup(json_string_value(js_prevValue));
-		}
-		if(modifiedIndex != NULL) {
-			if ((js_modIndex != NULL) && (json_is_integer(js_modIndex))) {
-				*modifiedIndex = json_integer_value(js_modIndex);
-			} else {
-				*modifiedIndex = index;
-			}
-		}
-		if ((rkey != NULL) && (js_rkey != NULL) && (json_is_string(js_rkey))) {
-			*rkey = strdup(json_string_value(js_rkey));
-
-		}
-		if ((action != NULL)  && (js_action != NULL)  && (json_is_string(js_action))) {
-			*action = strdup(json_string_value(js_action));
-		}
-		if ((value != NULL) && (js_value != NULL) && (json_is_string(js_value))) {
-			*value = strdup(json_string_value(js_value));
-		}
-		if (js_root != NULL) {
-			json_decref(js_root);
-		}
-
+		retVal = etcd_parseWatchReply(reply.memory, index, action, prevValue, value, rkey, modifiedIndex);
 	}
 
 	if (reply.memory) {
@@ -439,6 +487,226 @@ int etcd_del(const char* key) {
 	return retVal;
 }
 
+/**
+ * etcd_watch_loop_create
+ */
+int etcd_watch_loop_create(etcd_watch_loop_t **out) {
+	etcd_watch_loop_t *loop = calloc(1, sizeof(*loop));
+	if (loop == NULL) {
+		return -1;
+	}
+
+	loop->multi = curl_multi_init();
+	if (loop->multi == NULL) {
+		free(loop);
+		return -1;
+	}
+	pthread_mutex_init(&loop->lock, NULL);
+	pthread_cond_init(&loop->callbackDone, NULL);
+	loop->nextId = 1;
+	loop->runner = pthread_self();
+
+	*out = loop;
+	return 0;
+}
+
+/**
+ * etcd_watch_loop_destroy
+ */
+void etcd_watch_loop_destroy(etcd_watch_loop_t *loop) {
+	struct etcd_watch *watch = loop->watches;
+
+	while (watch != NULL) {
+		struct etcd_watch *next = watch->next;
+		if (watch->active) {
+			curl_multi_remove_handle(loop->multi, watch->curl);
+		}
+		etcd_watch_destroy(watch);
+		watch = next;
+	}
+
+	curl_multi_cleanup(loop->multi);
+	pthread_cond_destroy(&loop->callbackDone);
+	pthread_mutex_destroy(&loop->lock);
+	free(loop);
+}
+
+/**
+ * etcd_watch_loop_add
+ */
+int etcd_watch_loop_add(etcd_watch_loop_t *loop, const char* key, long long index, etcd_watch_callback callback, void* arg, long* watchId) {
+	struct etcd_watch *watch = calloc(1, sizeof(*watch));
+	if (watch == NULL) {
+		return -1;
+	}
+
+	watch->key = strdup(key);
+	watch->index = index;
+	watch->callback = callback;
+	watch->arg = arg;
+
+	/* the long poll is started by the next etcd_watch_loop_run */
+	pthread_mutex_lock(&loop->lock);
+	watch->id = loop->nextId++;
+	watch->next = loop->watches;
+	loop->watches = watch;
+	pthread_mutex_unlock(&loop->lock);
+
+	if (watchId != NULL) {
+		*watchId = watch->id;
+	}
+
+	return 0;
+}
+
+/**
+ * etcd_watch_loop_remove
+ */
+int etcd_watch_loop_remove(etcd_watch_loop_t *loop, long watchId) {
+	int retVal = -1;
+	struct etcd_watch *watch;
+
+	pthread_mutex_lock(&loop->lock);
+	for (watch = loop->watches; watch != NULL; watch = watch->next) {
+		if (watch->id == watchId && !watch->removed) {
+			watch->removed = true;
+			retVal = 0;
+			break;
+		}
+	}
+	/* a callback running on another thread can still use its arg, wait for it. From the callback itself this would deadlock */
+	if (retVal == 0 && !pthread_equal(pthread_self(), loop->runner)) {
+		while (loop->callbackId == watchId) {
+			pthread_cond_wait(&loop->callbackDone, &loop->lock);
+		}
+	}
+	pthread_mutex_unlock(&loop->lock);
+
+	return retVal;
+}
+
+/**
+ * etcd_watch_loop_run
+ */
+int etcd_watch_loop_run(etcd_watch_loop_t *loop, int timeoutMs) {
+	struct etcd_watch **prev;
+	struct etcd_watch *watch;
+	CURLMsg *msg;
+	int running = 0;
+	int numfds = 0;
+	int msgsLeft = 0;
+	time_t now;
+
+	/* drop the removed watches and (re)start the added and failed ones */
+	pthread_mutex_lock(&loop->lock);
+	loop->runner = pthread_self();
+	now = time(NULL);
+	prev = &loop->watches;
+	while ((watch = *prev) != NULL) {
+		if (watch->removed) {
+			*prev = watch->next;
+			if (watch->active) {
+				curl_multi_remove_handle(loop->multi, watch->curl);
+			}
+			etcd_watch_destroy(watch);
+		} else {
+			if (!watch->active && now >= watch->retryTime && etcd_watch_arm(loop, watch) != 0) {
+				fprintf(stderr, "[ETCDLIB] Error: cannot start watch on %s\n", watch->key);
+				watch->retryTime = now + DEFAULT_WATCH_RETRY_DELAY;
+			}
+			prev = &watch->next;
+		}
+	}
+	pthread_mutex_unlock(&loop->lock);
+
+	if (curl_multi_perform(loop->multi, &running) != CURLM_OK) {
+		return -1;
+	}
+	if (curl_multi_wait(loop->multi, NULL, 0, timeoutMs, &numfds) != CURLM_OK) {
+		return -1;
+	}
+	if (curl_multi_perform(loop->multi, &running) != CURLM_OK) {
+		return -1;
+	}
+
+	while ((msg = curl_multi_info_read(loop->multi, &msgsLeft)) != NULL) {
+		if (msg->msg == CURLMSG_DONE) {
+			watch = NULL;
+			curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**) &watch);
+			if (watch != NULL) {
+				etcd_watch_handleDone(loop, watch, msg->data.result);
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+static char* etcd_createWatchUrl(const char* key, long long index) {
+	char *url = NULL;
+
+	if (index != 0)
+		asprintf(&url, "http://%s:%d/v2/keys/%s?wait=true&recursive=true&waitIndex=%lld", etcd_server, etcd_port, key, index);
+	else
+		asprintf(&url, "http://%s:%d/v2/keys/%s?wait=true&recursive=true", etcd_server, etcd_port, key);
+
+	return url;
+}
+
+static int etcd_parseWatchReply(const char* reply, long long index, char** action, char** prevValue, char** value, char** rkey, long long* modifiedIndex) {
+	json_error_t error;
+	json_t* js_root = NULL;
+	json_t* js_node = NULL;
+	json_t* js_prevNode = NULL;
+	json_t* js_action = NULL;
+	json_t* js_value = NULL;
+	json_t* js_rkey = NULL;
+	json_t* js_prevValue = NULL;
+	json_t* js_modIndex = NULL;
+	int retVal = -1;
+
+	js_root = json_loads(reply, 0, &error);
+
+	if (js_root != NULL) {
+		js_action = json_object_get(js_root, ETCD_JSON_ACTION);
+		js_node = json_object_get(js_root, ETCD_JSON_NODE);
+		js_prevNode = json_object_get(js_root, ETCD_JSON_PREVNODE);
+		retVal = 0;
+	}
+	if (js_node != NULL) {
+		js_rkey = json_object_get(js_node, ETCD_JSON_KEY);
+		js_value = json_object_get(js_node, ETCD_JSON_VALUE);
+		js_modIndex = json_object_get(js_node, ETCD_JSON_MODIFIEDINDEX);
+	}
+	if (js_prevNode != NULL) {
+		js_prevValue = json_object_get(js_prevNode, ETCD_JSON_VALUE);
+	}
+	if ((prevValue != NULL) && (js_prevValue != NULL) && (json_is_string(js_prevValue))) {
+		*prevValue = strdup(json_string_value(js_prevValue));
+	}
+	if(modifiedIndex != NULL) {
+		if ((js_modIndex != NULL) && (json_is_integer(js_modIndex))) {
+			*modifiedIndex = json_integer_value(js_modIndex);
+		} else {
+			*modifiedIndex = index;
+		}
+	}
+	if ((rkey != NULL) && (js_rkey != NULL) && (json_is_string(js_rkey))) {
+		*rkey = strdup(json_string_value(js_rkey));
+	}
+	if ((action != NULL)  && (js_action != NULL)  && (json_is_string(js_action))) {
+		*action = strdup(json_string_value(js_action));
+	}
+	if ((value != NULL) && (js_value != NULL) && (json_is_string(js_value))) {
+		*value = strdup(json_string_value(js_value));
+	}
+	if (js_root != NULL) {
+		json_decref(js_root);
+	}
+
+	return retVal;
+}
 
 static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp) {
 	size_t realsize = size * nmemb;
@@ -458,10 +726,43 @@ static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, voi
 	return realsize;
 }
 
+static void etcd_destroyCurlHandle(void *handle) {
+	curl_easy_cleanup((CURL*) handle);
+}
+
+static CURL* etcd_getCurlHandle(void) {
+	CURL *curl = NULL;
+
+	pthread_mutex_lock(&etcd_curlHandleKeyLock);
+	if (!etcd_curlHandleKeyCreated) {
+		etcd_curlHandleKeyCreated = (pthread_key_create(&etcd_curlHandleKey, etcd_destroyCurlHandle) == 0);
+	}
+	pthread_mutex_unlock(&etcd_curlHandleKeyLock);
+	if (!etcd_curlHandleKeyCreated) {
+		return NULL;
+	}
+
+	curl = pthread_getspecific(etcd_curlHandleKey);
+	if (curl == NULL) {
+		curl = curl_easy_init();
+		if (curl != NULL) {
+			pthread_setspecific(etcd_curlHandleKey, curl);
+		}
+	} else {
+		/* clears the options of the previous request, but keeps the open connections */
+		curl_easy_reset(curl);
+	}
+
+	return curl;
+}
+
 static int performRequest(char* url, request_t request, void* callback, void* reqData, void* repData) {
 	CURL *curl = NULL;
 	CURLcode res = 0;
-	curl = curl_easy_init();
+	curl = etcd_getCurlHandle();
+	if (curl == NULL) {
+		return CURLE_FAILED_INIT;
+	}
 	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
 	curl_easy_setopt(curl, CURLOPT_TIMEOUT, DEFAULT_CURL_TIMEOUT);
 	curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, DEFAULT_CURL_CONECTTIMEOUT);
@@ -481,7 +782,106 @@ static int performRequest(char* url, request_t request, void* callback, void* re
 	}
 
 	res = curl_easy_perform(curl);
-	curl_easy_cleanup(curl);
 
 	return res;
 }
+
+static void etcd_watch_destroy(struct etcd_watch *watch) {
+	if (watch->curl != NULL) {
+		curl_easy_cleanup(watch->curl);
+	}
+	free(watch->url);
+	free(watch->reply.memory);
+	free(watch->key);
+	free(watch);
+}
+
+/* (re)starts the long poll of a watch on the given index, called from the thread running the loop */
+static int etcd_watch_arm(etcd_watch_loop_t *loop, struct etcd_watch *watch) {
+	if (watch->curl == NULL) {
+		watch->curl = curl_easy_init();
+		if (watch->curl == NULL) {
+			return -1;
+		}
+		curl_easy_setopt(watch->curl, CURLOPT_NOSIGNAL, 1);
+		curl_easy_setopt(watch->curl, CURLOPT_TIMEOUT, DEFAULT_CURL_TIMEOUT);
+		curl_easy_setopt(watch->curl, CURLOPT_CONNECTTIMEOUT, DEFAULT_CURL_CONECTTIMEOUT);
+		curl_easy_setopt(watch->curl, CURLOPT_FOLLOWLOCATION, 1L);
+		curl_easy_setopt(watch->curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
+		curl_easy_setopt(watch->curl, CURLOPT_WRITEDATA, (void*) &watch->reply);
+		curl_easy_setopt(watch->curl, CURLOPT_PRIVATE, (void*) watch);
+	}
+
+	free(watch->url);
+	watch->url = etcd_createWatchUrl(watch->key, watch->index);
+	curl_easy_setopt(watch->curl, CURLOPT_URL, watch->url);
+
+	free(watch->reply.memory);
+	watch->reply.memory = malloc(1);
+	watch->reply.size = 0;
+
+	if (curl_multi_add_handle(loop->multi, watch->curl) != CURLM_OK) {
+		return -1;
+	}
+	watch->active = true;
+
+	return 0;
+}
+
+static void etcd_watch_handleDone(etcd_watch_loop_t *loop, struct etcd_watch *watch, CURLcode result) {
+	char *action = NULL;
+	char *prevValue = NULL;
+	char *value = NULL;
+	char *rkey = NULL;
+	long long modIndex = 0;
+	bool changed = false;
+	bool missed = false;
+	bool removed;
+
+	curl_multi_remove_handle(loop->multi, watch->curl);
+	watch->active = false;
+
+	if (result == CURLE_OK && etcd_parseWatchReply(watch->reply.memory, watch->index, &action, &prevValue, &value, &rkey, &modIndex) == 0) {
+		if (action != NULL) {
+			watch->index = modIndex + 1;
+			changed = true;
+		} else {
+			/* error reply, e.g. the index is already cleared from the etcd history, continue from the current index */
+			watch->index = 0;
+			missed = true;
+		}
+	}
+
+	pthread_mutex_lock(&loop->lock);
+	removed = watch->removed;
+	if (!removed && (changed || missed)) {
+		loop->callbackId = watch->id;
+	}
+	pthread_mutex_unlock(&loop->lock);
+
+	if (!removed && (changed || missed)) {
+		watch->callback(action, prevValue, value, rkey, modIndex, watch->arg);
+
+		pthread_mutex_lock(&loop->lock);
+		loop->callbackId = 0;
+		removed = watch->removed;
+		pthread_cond_broadcast(&loop->callbackDone);
+		pthread_mutex_unlock(&loop->lock);
+	}
+
+	free(action);
+	free(prevValue);
+	free(value);
+	free(rkey);
+
+	if (removed) {
+		return;
+	}
+	if (result == CURLE_OPERATION_TIMEDOUT || result == CURLE_OK) {
+		/* a long poll without changes is restarted on the same index */
+		etcd_watch_arm(loop, watch);
+	} else {
+		/* etcd is not reachable, the next etcd_watch_loop_run after the delay tries again */
+		watch->retryTime = time(NULL) + DEFAULT_WATCH_RETRY_DELAY;
+	}
+}
@@ -39,6 +39,15 @@
 
 typedef void (*etcd_key_value_callback) (const char *key, const char *value, void* arg);
 
+/*
+ * Called by etcd_watch_loop_run for every change of a watched key. The strings are only valid during the call.
+ * action is NULL when etcd could not report all changes since the last one (e.g. the index was already cleared
+ * from the etcd history); the watch then continues with the current index and the caller should re-read the key.
+ */
+typedef void (*etcd_watch_callback) (const char *action, const char *prevValue, const char *value, const char *rkey, long long modifiedIndex, void* arg);
+
+typedef struct etcd_watch_loop etcd_watch_loop_t;
+
 /**
  * @desc Initialize the ETCD-LIB  with the server/port where Etcd can be reached.
  * @param const char* server. String containing the IP-number of the server.
@@ -48,6 +57,14 @@ typedef void (*etcd_key_value_callback) (const char *key, const char *value, voi
  */
 int etcd_init(const char* server, int port, int flags);
 
+/**
+ * @desc Release the resources etcdlib keeps per process: deletes the thread specific key of the per thread curl handles,
+ *       so no destructor of etcdlib is left behind when etcdlib is unloaded, and frees the handle of the calling thread.
+ *       Threads that made requests should have ended before, the handles of threads that are still alive are leaked.
+ *       Requests made after etcd_fini create a new key.
+ */
+void etcd_fini(void);
+
 /**
  * @desc Retrieve a single value from Etcd.
  * @param const char* key. The Etcd-key (Note: a leading '/' should be avoided)
@@ -87,6 +104,15 @@ int etcd_set(const char* key, const char* value, int ttl, bool prevExist);
  */
 int etcd_set_with_check(const char* key, const char* value, int ttl, bool always_write);
 
+/**
+ * @desc Refreshing the TTL of an existing Etcd-key without changing its value. Watchers are not notified.
+ *       Needs etcd 2.3 or newer, older versions would set the value to an empty string.
+ * @param const char* key. The Etcd-key (Note: a leading '/' should be avoided)
+ * @param int ttl. The new TTL value
+ * @return 0 on success, non zero otherwise (e.g. when the key does not exist (anymore))
+ */
+int etcd_refresh(const char* key, int ttl);
+
 /**
  * @desc Deleting an Etcd-key
  * @param const char* key. The Etcd-key (Note: a leading '/' should be avoided)
@@ -107,4 +133,49 @@ int etcd_del(const char* key);
  */
 int etcd_watch(const char* key, long long index, char** action, char** prevValue, char** value, char** rkey, long long* modifiedIndex);
 
+/**
+ * @desc Create a loop which runs many etcd watches on a single thread, using one non blocking request per watch.
+ * @param etcd_watch_loop_t** loop. The created loop.
+ * @return 0 on success, non zero otherwise
+ */
+int etcd_watch_loop_create(etcd_watch_loop_t** loop);
+
+/**
+ * @desc Destroy a watch loop and all its watches. Must not be called while etcd_watch_loop_run is running.
+ * @param etcd_watch_loop_t* loop. The loop to destroy.
+ */
+void etcd_watch_loop_destroy(etcd_watch_loop_t* loop);
+
+/**
+ * @desc Add a (recursive) watch to the loop. The watch is started by the next etcd_watch_loop_run call and
+ *       is restarted after every change, so no change is missed between two callbacks. Can be called from any thread.
+ * @param etcd_watch_loop_t* loop. The loop.
+ * @param const char* key. The Etcd-key (Note: a leading '/' should be avoided)
+ * @param long long index. The Etcd-index which the watch has to be started on, 0 for the current index.
+ * @param etcd_watch_callback callback. Callback function which is called for every change
+ * @param void* arg. Argument is passed to the callback function
+ * @param long* watchId. If not NULL, the id of the watch which can be used with etcd_watch_loop_remove.
+ * @return 0 on success, non zero otherwise
+ */
+int etcd_watch_loop_add(etcd_watch_loop_t* loop, const char* key, long long index, etcd_watch_callback callback, void* arg, long* watchId);
+
+/**
+ * @desc Remove a watch from the loop. Can be called from any thread, including from a callback. When called from
+ *       another thread than the one running the loop, waits until a callback of the watch in progress returned, so
+ *       the callback argument can be released afterwards. Must then not be called with a lock held that the callback takes.
+ * @param etcd_watch_loop_t* loop. The loop.
+ * @param long watchId. The id returned by etcd_watch_loop_add.
+ * @return 0 on success, non zero if the watch is unknown
+ */
+int etcd_watch_loop_remove(etcd_watch_loop_t* loop, long watchId);
+
+/**
+ * @desc Process the watches of the loop once: waits at most timeoutMs for changes and calls the callbacks of the
+ *       changed watches. Should be called repeatedly from a single thread.
+ * @param etcd_watch_loop_t* loop. The loop.
+ * @param int timeoutMs. The maximum time to wait for changes in milliseconds.
+ * @return 0 on success, non zero otherwise
+ */
+int etcd_watch_loop_run(etcd_watch_loop_t* loop, int timeoutMs);
+
 #endif /*ETCDLIB_H_ */
@@ -30,7 +30,7 @@
 #include <stdlib.h>
 
 #define PUBSUB_PUBLISHER_SERVICE_NAME           "pubsub.publisher"
-#define PUBSUB_PUBLISHER_SERVICE_VERSION	      "2.0.0"
+#define PUBSUB_PUBLISHER_SERVICE_VERSION	      "2.1.0"
  
 //properties
 #define PUBSUB_PUBLISHER_TOPIC                  "pubsub.topic"
@@ -80,6 +80,28 @@ struct pubsub_publisher {
      * Returns 0 on success.
      */
     int (*sendMultipart)(void *handle, unsigned int msgTypeId, const void *msg, int flags);
+
+    /**
+     * allocMsg allocates a zero initialized msg of the msg type from a msg pool of the publisher, to be filled in place.
+     * An allocated msg must be given back with sendAndFreeMsg or, when it is not sent, with freeMsg.
+     * Texts, sequences and pointers in the msg are owned by the msg: they are freed when the msg goes back to the pool.
+     * The msg is still serialized when it is sent, the pool only saves the allocation and release of the msg by the caller.
+     * Since version 2.1.0, these functions can be NULL for publishers without a msg pool.
+     * Returns 0 on success.
+     */
+    int (*allocMsg)(void *handle, unsigned int msgTypeId, void **msg);
+
+    /**
+     * sendAndFreeMsg sends a msg of allocMsg like send and gives it back to the pool, the msg cannot be used after sendAndFreeMsg returns.
+     * Returns 0 on success.
+     */
+    int (*sendAndFreeMsg)(void *handle, unsigned int msgTypeId, void *msg);
+
+    /**
+     * freeMsg gives a msg of allocMsg back to the pool without sending it.
+     * Returns 0 on success.
+     */
+    int (*freeMsg)(void *handle, unsigned int msgTypeId, void *msg);
  
 };
 typedef struct pubsub_publisher pubsub_publisher_t;
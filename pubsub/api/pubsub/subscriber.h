@@ -37,8 +37,12 @@
 #define PUBSUB_SUBSCRIBER_SCOPE                "pubsub.scope"
 #define PUBSUB_SUBSCRIBER_STRATEGY             "pubsub.strategy"
 #define PUBSUB_SUBSCRIBER_CONFIG               "pubsub.config"
+#define PUBSUB_SUBSCRIBER_DISPATCH_THREADS     "pubsub.dispatch.threads" // threads calling the subscribers of the topic, default 0 (receive thread)
+#define PUBSUB_SUBSCRIBER_DISPATCH_ORDER       "pubsub.dispatch.order"   // keep messages ordered per "subscriber" (default) or per "msg_type"
+#define PUBSUB_SUBSCRIBER_MSG_ARENA            "pubsub.msg.arena"        // "true" to receive messages allocated in one arena, default false
 
 #define PUBSUB_SUBSCRIBER_SCOPE_DEFAULT        "default"
+#define PUBSUB_SUBSCRIBER_DISPATCH_ORDER_MSG_TYPE "msg_type"
  
 struct pubsub_multipart_callbacks_struct {
     void *handle;
@@ -61,6 +65,13 @@ struct pubsub_subscriber_struct {
      * The callbacks argument is only valid inside the receive function, use the getMultipart callback, with retain=true, to keep multipart messages in memory.
      * results of the localMsgTypeIdForMsgType callback are valid during the complete lifecycle of the component, not just a single receive call.
      *
+     * When the pubsubadmin delivers a message of a publisher in the same framework directly (PSA_LOCAL_DELIVERY), msg is owned by the publisher
+     * and only valid inside the receive function; release is ignored in that case. The same instance is handed to every local subscriber,
+     * possibly concurrently, so msg must be treated as read-only. Subscribers with dispatch threads receive a deserialized copy instead.
+     *
+     * A subscriber registered with pubsub.msg.arena=true receives messages deserialized in one arena, which the pubsubadmin frees at once
+     * after the receive function returns. These messages are also only valid inside the receive function and release is ignored.
+     *
      * Return 0 implies a successful handling. If return is not 0, the msg will always be released by the pubsubadmin.
      *
      * this method can be  NULL.
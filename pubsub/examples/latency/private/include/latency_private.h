@@ -0,0 +1,65 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * latency_private.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef LATENCY_PRIVATE_H_
+#define LATENCY_PRIVATE_H_
+
+#include <stdint.h>
+
+#include "celix_errno.h"
+#include "service_reference.h"
+#include "publisher.h"
+#include "subscriber.h"
+
+#define MSG_LATENCY_NAME		"latency" //Has to match the message name in the msg descriptor!
+
+/* Topic to publish and receive on, "latency_compact" sends the compact wire header */
+#define LATENCY_TOPIC				"LATENCY_TOPIC"
+#define LATENCY_TOPIC_DEFAULT			"latency"
+
+/* Microseconds between two sends, 0 sends as fast as possible */
+#define LATENCY_SEND_INTERVAL_US		"LATENCY_SEND_INTERVAL_US"
+#define LATENCY_SEND_INTERVAL_US_DEFAULT	1000
+/* Number of received messages summarized in one report line */
+#define LATENCY_REPORT_COUNT			"LATENCY_REPORT_COUNT"
+#define LATENCY_REPORT_COUNT_DEFAULT		10000
+
+struct latency_msg {
+	int64_t seqNr;
+	int64_t sendTime; //CLOCK_MONOTONIC in ns, only comparable on the same host
+};
+
+typedef struct latency_meter *latency_meter_pt;
+
+latency_meter_pt latency_create(unsigned int sendIntervalUs, unsigned int reportCount);
+void latency_destroy(latency_meter_pt meter);
+
+celix_status_t latency_publishSvcAdded(void *handle, service_reference_pt reference, void *service);
+celix_status_t latency_publishSvcRemoved(void *handle, service_reference_pt reference, void *service);
+
+int latency_receive(void *handle, const char *msgType, unsigned int msgTypeId, void *msg, pubsub_multipart_callbacks_t *callbacks, bool *release);
+
+#endif /* LATENCY_PRIVATE_H_ */
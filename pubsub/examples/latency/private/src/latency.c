@@ -0,0 +1,172 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * latency.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "celix_threads.h"
+
+#include "latency_private.h"
+
+struct latency_meter {
+	unsigned int sendIntervalUs;
+	unsigned int reportCount;
+
+	celix_thread_mutex_t pubLock;
+	pubsub_publisher_pt publisher;
+	celix_thread_t sendThread;
+	bool running;
+
+	/* Only touched by the delivering thread of the subscription */
+	int64_t expectedSeqNr;
+	unsigned long nrReceived;
+	unsigned long nrLost;
+	int64_t minLatency;
+	int64_t maxLatency;
+	int64_t sumLatency;
+	int64_t windowStart;
+};
+
+static int64_t latency_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void latency_resetStats(latency_meter_pt meter) {
+	meter->nrReceived = 0;
+	meter->nrLost = 0;
+	meter->minLatency = INT64_MAX;
+	meter->maxLatency = 0;
+	meter->sumLatency = 0;
+	meter->windowStart = latency_now();
+}
+
+static void* latency_sendThread(void *arg) {
+	latency_meter_pt meter = (latency_meter_pt)arg;
+	pubsub_publisher_pt publisher = meter->publisher;
+
+	unsigned int msgId = 0;
+	if (publisher->localMsgTypeIdForMsgType(publisher->handle, MSG_LATENCY_NAME, &msgId) != 0) {
+		printf("LATENCY: Cannot retrieve msgId for message '%s'\n", MSG_LATENCY_NAME);
+		return NULL;
+	}
+
+	struct latency_msg msg;
+	msg.seqNr = 0;
+	while (__atomic_load_n(&meter->running, __ATOMIC_ACQUIRE)) {
+		msg.sendTime = latency_now();
+		if (publisher->send(publisher->handle, msgId, &msg) == 0) {
+			msg.seqNr++;
+		}
+		if (meter->sendIntervalUs > 0) {
+			usleep(meter->sendIntervalUs);
+		}
+	}
+
+	printf("LATENCY: Sent %lld messages\n", (long long)msg.seqNr);
+	return NULL;
+}
+
+latency_meter_pt latency_create(unsigned int sendIntervalUs, unsigned int reportCount) {
+	latency_meter_pt meter = calloc(1, sizeof(*meter));
+	meter->sendIntervalUs = sendIntervalUs;
+	meter->reportCount = reportCount > 0 ? reportCount : LATENCY_REPORT_COUNT_DEFAULT;
+	celixThreadMutex_create(&meter->pubLock, NULL);
+	latency_resetStats(meter);
+	return meter;
+}
+
+void latency_destroy(latency_meter_pt meter) {
+	celixThreadMutex_destroy(&meter->pubLock);
+	free(meter);
+}
+
+celix_status_t latency_publishSvcAdded(void *handle, service_reference_pt reference, void *service) {
+	latency_meter_pt meter = (latency_meter_pt)handle;
+
+	celixThreadMutex_lock(&meter->pubLock);
+	if (meter->publisher == NULL) {
+		meter->publisher = (pubsub_publisher_pt)service;
+		meter->running = true;
+		celixThread_create(&meter->sendThread, NULL, latency_sendThread, meter);
+	}
+	celixThreadMutex_unlock(&meter->pubLock);
+
+	return CELIX_SUCCESS;
+}
+
+celix_status_t latency_publishSvcRemoved(void *handle, service_reference_pt reference, void *service) {
+	latency_meter_pt meter = (latency_meter_pt)handle;
+
+	celixThreadMutex_lock(&meter->pubLock);
+	if (meter->publisher == service) {
+		__atomic_store_n(&meter->running, false, __ATOMIC_RELEASE);
+		celixThread_join(meter->sendThread, NULL);
+		meter->publisher = NULL;
+	}
+	celixThreadMutex_unlock(&meter->pubLock);
+
+	return CELIX_SUCCESS;
+}
+
+int latency_receive(void *handle, const char *msgType, unsigned int msgTypeId, void *msg, pubsub_multipart_callbacks_t *callbacks, bool *release) {
+	latency_meter_pt meter = (latency_meter_pt)handle;
+	struct latency_msg *lmsg = (struct latency_msg *)msg;
+
+	int64_t latency = latency_now() - lmsg->sendTime;
+
+	if (lmsg->seqNr > meter->expectedSeqNr) {
+		meter->nrLost += (unsigned long)(lmsg->seqNr - meter->expectedSeqNr);
+	}
+	meter->expectedSeqNr = lmsg->seqNr + 1;
+
+	meter->nrReceived++;
+	meter->sumLatency += latency;
+	if (latency < meter->minLatency) {
+		meter->minLatency = latency;
+	}
+	if (latency > meter->maxLatency) {
+		meter->maxLatency = latency;
+	}
+
+	if (meter->nrReceived == meter->reportCount) {
+		double seconds = (latency_now() - meter->windowStart) / 1000000000.0;
+		printf("LATENCY: %lu msgs (%.0f msgs/s), min %.1f us, avg %.1f us, max %.1f us, %lu lost\n",
+				meter->nrReceived,
+				seconds > 0 ? meter->nrReceived / seconds : 0.0,
+				meter->minLatency / 1000.0,
+				(meter->sumLatency / (double)meter->nrReceived) / 1000.0,
+				meter->maxLatency / 1000.0,
+				meter->nrLost);
+		latency_resetStats(meter);
+	}
+
+	return 0;
+}
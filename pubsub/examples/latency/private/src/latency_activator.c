@@ -0,0 +1,106 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * latency_activator.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "bundle_activator.h"
+#include "service_tracker.h"
+#include "constants.h"
+
+#include "latency_private.h"
+
+struct latencyActivator {
+	const char *topic;
+	latency_meter_pt meter;
+	pubsub_subscriber_t subsvc;
+	service_registration_pt subReg;
+	service_tracker_pt pubTracker;
+};
+
+static unsigned int latency_getUIntProperty(bundle_context_pt context, const char *name, unsigned int defaultValue) {
+	const char *value = NULL;
+	bundleContext_getProperty(context, name, &value);
+	return value != NULL ? (unsigned int)strtoul(value, NULL, 10) : defaultValue;
+}
+
+celix_status_t bundleActivator_create(bundle_context_pt context, void **userData) {
+	struct latencyActivator *act = calloc(1, sizeof(*act));
+
+	bundleContext_getProperty(context, LATENCY_TOPIC, &act->topic);
+	if (act->topic == NULL) {
+		act->topic = LATENCY_TOPIC_DEFAULT;
+	}
+
+	act->meter = latency_create(
+			latency_getUIntProperty(context, LATENCY_SEND_INTERVAL_US, LATENCY_SEND_INTERVAL_US_DEFAULT),
+			latency_getUIntProperty(context, LATENCY_REPORT_COUNT, LATENCY_REPORT_COUNT_DEFAULT));
+
+	*userData = act;
+	return CELIX_SUCCESS;
+}
+
+celix_status_t bundleActivator_start(void *userData, bundle_context_pt context) {
+	struct latencyActivator *act = (struct latencyActivator *)userData;
+
+	act->subsvc.handle = act->meter;
+	act->subsvc.receive = latency_receive;
+
+	properties_pt props = properties_create();
+	properties_set(props, PUBSUB_SUBSCRIBER_TOPIC, act->topic);
+	bundleContext_registerService(context, PUBSUB_SUBSCRIBER_SERVICE_NAME, &act->subsvc, props, &act->subReg);
+
+	char filter[128];
+	snprintf(filter, 128, "(&(%s=%s)(%s=%s))",
+			(char*) OSGI_FRAMEWORK_OBJECTCLASS, PUBSUB_PUBLISHER_SERVICE_NAME,
+			PUBSUB_PUBLISHER_TOPIC, act->topic);
+
+	service_tracker_customizer_pt customizer = NULL;
+	serviceTrackerCustomizer_create(act->meter, NULL, latency_publishSvcAdded, NULL, latency_publishSvcRemoved, &customizer);
+	serviceTracker_createWithFilter(context, filter, customizer, &act->pubTracker);
+
+	return serviceTracker_open(act->pubTracker);
+}
+
+celix_status_t bundleActivator_stop(void *userData, bundle_context_pt context) {
+	struct latencyActivator *act = (struct latencyActivator *)userData;
+
+	serviceTracker_close(act->pubTracker);
+	serviceRegistration_unregister(act->subReg);
+	act->subReg = NULL;
+
+	return CELIX_SUCCESS;
+}
+
+celix_status_t bundleActivator_destroy(void *userData, bundle_context_pt context) {
+	struct latencyActivator *act = (struct latencyActivator *)userData;
+
+	serviceTracker_destroy(act->pubTracker);
+	latency_destroy(act->meter);
+	free(act);
+
+	return CELIX_SUCCESS;
+}
@@ -29,6 +29,9 @@ extern "C" {
 #define PUBSUB_PUBLISHERMOCK_LOCAL_MSG_TYPE_ID_FOR_MSG_TYPE_METHOD "pubsub__publisherMock_localMsgTypeIdForMsgType"
 #define PUBSUB_PUBLISHERMOCK_SEND_METHOD "pubsub__publisherMock_send"
 #define PUBSUB_PUBLISHERMOCK_SEND_MULTIPART_METHOD "pubsub__publisherMock_sendMultipart"
+#define PUBSUB_PUBLISHERMOCK_ALLOC_MSG_METHOD "pubsub__publisherMock_allocMsg"
+#define PUBSUB_PUBLISHERMOCK_SEND_AND_FREE_MSG_METHOD "pubsub__publisherMock_sendAndFreeMsg"
+#define PUBSUB_PUBLISHERMOCK_FREE_MSG_METHOD "pubsub__publisherMock_freeMsg"
 
 
 /*============================================================================
@@ -57,6 +57,42 @@ static int pubsub__publisherMock_sendMultipart(void *handle, unsigned int msgTyp
         .returnIntValue();
 }
 
+/*============================================================================
+  MOCK - mock function for pubsub_publisher->allocMsg
+  ============================================================================*/
+static int pubsub__publisherMock_allocMsg(void *handle, unsigned int msgTypeId, void **msg) {
+    return mock(PUBSUB_PUBLISHERMOCK_SCOPE)
+        .actualCall(PUBSUB_PUBLISHERMOCK_ALLOC_MSG_METHOD)
+        .withPointerParameter("handle", handle)
+        .withParameter("msgTypeId", msgTypeId)
+        .withOutputParameter("msg", msg)
+        .returnIntValue();
+}
+
+/*============================================================================
+  MOCK - mock function for pubsub_publisher->sendAndFreeMsg
+  ============================================================================*/
+static int pubsub__publisherMock_sendAndFreeMsg(void *handle, unsigned int msgTypeId, void *msg) {
+    return mock(PUBSUB_PUBLISHERMOCK_SCOPE)
+        .actualCall(PUBSUB_PUBLISHERMOCK_SEND_AND_FREE_MSG_METHOD)
+        .withPointerParameter("handle", handle)
+        .withParameter("msgTypeId", msgTypeId)
+        .withPointerParameter("msg", msg)
+        .returnIntValue();
+}
+
+/*============================================================================
+  MOCK - mock function for pubsub_publisher->freeMsg
+  ============================================================================*/
+static int pubsub__publisherMock_freeMsg(void *handle, unsigned int msgTypeId, void *msg) {
+    return mock(PUBSUB_PUBLISHERMOCK_SCOPE)
+        .actualCall(PUBSUB_PUBLISHERMOCK_FREE_MSG_METHOD)
+        .withPointerParameter("handle", handle)
+        .withParameter("msgTypeId", msgTypeId)
+        .withPointerParameter("msg", msg)
+        .returnIntValue();
+}
+
 /*============================================================================
   MOCK - mock setup for publisher service
   ============================================================================*/
@@ -65,4 +101,7 @@ void pubsub_publisherMock_init(pubsub_publisher_t* srv, void* handle) {
     srv->localMsgTypeIdForMsgType = pubsub__publisherMock_localMsgTypeIdForMsgType;
     srv->send = pubsub__publisherMock_send;
     srv->sendMultipart = pubsub__publisherMock_sendMultipart;
+    srv->allocMsg = pubsub__publisherMock_allocMsg;
+    srv->sendAndFreeMsg = pubsub__publisherMock_sendAndFreeMsg;
+    srv->freeMsg = pubsub__publisherMock_freeMsg;
 }
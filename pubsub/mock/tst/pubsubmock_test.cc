@@ -75,3 +75,26 @@ TEST(pubsubmock, publishermock) {
 
 }
 
+
+TEST(pubsubmock, publishermockallocmsg) {
+    unsigned int msgId = 11;
+    void *pooledMsg = (void*)0x44;
+
+    mock(PUBSUB_PUBLISHERMOCK_SCOPE).expectOneCall(PUBSUB_PUBLISHERMOCK_ALLOC_MSG_METHOD)
+        .withParameter("handle", mockHandle)
+        .withParameter("msgTypeId", msgId)
+        .withOutputParameterReturning("msg", &pooledMsg, sizeof(pooledMsg));
+
+    mock(PUBSUB_PUBLISHERMOCK_SCOPE).expectOneCall(PUBSUB_PUBLISHERMOCK_SEND_AND_FREE_MSG_METHOD)
+        .withParameter("handle", mockHandle)
+        .withParameter("msgTypeId", msgId)
+        .withParameter("msg", pooledMsg);
+
+    pubsub_publisher_t* srv = &mockSrv;
+
+    //allocate a msg from the pool, fill it in place and send it
+    void *msg = NULL;
+    srv->allocMsg(srv->handle, msgId, &msg);
+    POINTERS_EQUAL(pooledMsg, msg);
+    srv->sendAndFreeMsg(srv->handle, msgId, msg);
+}
@@ -0,0 +1,78 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * shm_ring.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef _SHM_RING_H_
+#define _SHM_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "celix_errno.h"
+
+/*
+ * Broadcast ring buffer in a POSIX shared memory segment. There is exactly one writer (the owner of the
+ * segment) and any number of readers, each with its own read position. The writer never waits for
+ * readers: a reader that falls more than the ring capacity behind loses the overwritten messages.
+ * Readers sleep on a futex in the segment and are woken up by the writer.
+ */
+
+typedef struct shm_ring *shm_ring_pt;
+
+typedef struct shm_ring_msg {
+	unsigned int type;
+	unsigned char major;
+	unsigned char minor;
+	const char *payload;       // points into the shared segment, valid until shmRing_releaseMessage
+	unsigned int payloadSize;
+} shm_ring_msg_t;
+
+typedef struct shm_ring_statistics {
+	unsigned long nrMsgsWritten;     // number of messages written (writer)
+	unsigned long nrMsgsTooLarge;    // number of messages rejected because they do not fit in the ring (writer)
+	unsigned long nrMsgsRead;        // number of messages handed out by shmRing_nextMessage (reader)
+	unsigned long nrOverruns;        // number of times the reader was overtaken by the writer (reader)
+	unsigned long nrCorruptRecords;  // number of records with an inconsistent header (reader)
+} shm_ring_statistics_t;
+
+/* Writer side: creates (and on destroy unlinks) the named segment */
+celix_status_t shmRing_create(const char *name, unsigned int capacity, shm_ring_pt *out);
+/* Reader side: maps an existing segment, reading starts at the current write position */
+celix_status_t shmRing_open(const char *name, shm_ring_pt *out);
+void shmRing_destroy(shm_ring_pt ring);
+
+int shmRing_write(shm_ring_pt ring, unsigned int type, unsigned char major, unsigned char minor, const void *payload, unsigned int payloadSize);
+
+bool shmRing_nextMessage(shm_ring_pt ring, shm_ring_msg_t *msg);
+/* Returns false if the writer overwrote the current message while it was in use, results based on it must be dropped */
+bool shmRing_messageIntact(shm_ring_pt ring);
+void shmRing_releaseMessage(shm_ring_pt ring);
+
+void shmRing_wait(shm_ring_pt ring, unsigned int timeoutMs);
+void shmRing_wakeup(shm_ring_pt ring);
+
+void shmRing_getStatistics(shm_ring_pt ring, shm_ring_statistics_t *stats);
+
+#endif /* _SHM_RING_H_ */
@@ -0,0 +1,386 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * shm_ring.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include "shm_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#define SHM_RING_MAGIC          0x43534852  /* "CSHR" */
+#define SHM_RING_VERSION        1
+#define SHM_RING_HEADER_SIZE    64
+#define SHM_RING_ALIGN          16
+#define SHM_RING_GUARD_SIZE     4096
+#define SHM_RING_PAD_TYPE       0          /* Real msg type ids are never 0 */
+#define SHM_RING_MIN_CAPACITY   4096
+
+/* Lives at the start of the shared segment */
+struct shm_ring_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t capacity;      // size of the data area, power of two
+	uint32_t nrWaiters;     // readers sleeping on futexSeq
+	uint32_t futexSeq;      // incremented for every written message
+	uint32_t reserved;
+	uint64_t writeReserve;  // position up to which the writer may be writing
+	uint64_t writePos;      // position up to which the data is complete
+};
+
+/* Precedes every message in the data area, records never wrap around the end of the ring */
+struct shm_ring_record {
+	uint32_t size;          // record size including this header, multiple of SHM_RING_ALIGN
+	uint32_t type;
+	uint32_t payloadSize;
+	unsigned char major;
+	unsigned char minor;
+	uint16_t reserved;
+};
+
+struct shm_ring {
+	char *name;
+	bool owner;
+	int fd;
+	void *map;
+	size_t mapSize;
+	struct shm_ring_header *header;
+	char *data;
+	uint32_t mask;
+
+	uint64_t pos;           // writer: next write position, reader: next read position
+	uint32_t currentSize;   // reader: size of the record handed out by shmRing_nextMessage
+
+	shm_ring_statistics_t stats;
+};
+
+static celix_status_t shmRing_map(shm_ring_pt ring, size_t size);
+static unsigned int shmRing_roundUpPow2(unsigned int v);
+static void shmRing_futexWait(uint32_t *addr, uint32_t val, unsigned int timeoutMs);
+static void shmRing_futexWake(uint32_t *addr);
+
+celix_status_t shmRing_create(const char *name, unsigned int capacity, shm_ring_pt *out) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	if (capacity < SHM_RING_MIN_CAPACITY) {
+		capacity = SHM_RING_MIN_CAPACITY;
+	}
+	capacity = shmRing_roundUpPow2(capacity);
+
+	shm_ring_pt ring = calloc(1, sizeof(*ring));
+	ring->name = strdup(name);
+	ring->owner = true;
+	ring->fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0660);
+	if (ring->fd == -1) {
+		perror("shmRing_create:shm_open");
+		status = CELIX_FILE_IO_EXCEPTION;
+	}
+
+	size_t size = SHM_RING_HEADER_SIZE + capacity + SHM_RING_GUARD_SIZE;
+	if (status == CELIX_SUCCESS && ftruncate(ring->fd, size) != 0) {
+		perror("shmRing_create:ftruncate");
+		status = CELIX_FILE_IO_EXCEPTION;
+	}
+
+	if (status == CELIX_SUCCESS) {
+		status = shmRing_map(ring, size);
+	}
+
+	if (status == CELIX_SUCCESS) {
+		/* The segment is zero filled by ftruncate, the guard area after the data stays zero */
+		ring->header->capacity = capacity;
+		ring->header->version = SHM_RING_VERSION;
+		ring->mask = capacity - 1;
+		__atomic_store_n(&ring->header->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+		*out = ring;
+	} else {
+		if (ring->fd != -1) {
+			close(ring->fd);
+			shm_unlink(name);
+		}
+		free(ring->name);
+		free(ring);
+	}
+
+	return status;
+}
+
+celix_status_t shmRing_open(const char *name, shm_ring_pt *out) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	shm_ring_pt ring = calloc(1, sizeof(*ring));
+	ring->name = strdup(name);
+	ring->owner = false;
+	/* Read-write, readers register themselves in nrWaiters */
+	ring->fd = shm_open(name, O_RDWR, 0);
+	if (ring->fd == -1) {
+		perror("shmRing_open:shm_open");
+		status = CELIX_FILE_IO_EXCEPTION;
+	}
+
+	struct stat st;
+	if (status == CELIX_SUCCESS && fstat(ring->fd, &st) != 0) {
+		perror("shmRing_open:fstat");
+		status = CELIX_FILE_IO_EXCEPTION;
+	}
+
+	if (status == CELIX_SUCCESS && (size_t)st.st_size < SHM_RING_HEADER_SIZE + SHM_RING_MIN_CAPACITY + SHM_RING_GUARD_SIZE) {
+		printf("SHM_RING: Segment %s is too small (%ld bytes)\n", name, (long)st.st_size);
+		status = CELIX_ILLEGAL_STATE;
+	}
+
+	if (status == CELIX_SUCCESS) {
+		status = shmRing_map(ring, st.st_size);
+	}
+
+	if (status == CELIX_SUCCESS) {
+		uint32_t capacity = ring->header->capacity;
+		if (__atomic_load_n(&ring->header->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC || ring->header->version != SHM_RING_VERSION ||
+				capacity == 0 || (capacity & (capacity - 1)) != 0 || SHM_RING_HEADER_SIZE + (size_t)capacity + SHM_RING_GUARD_SIZE > ring->mapSize) {
+			printf("SHM_RING: Segment %s has an invalid header\n", name);
+			status = CELIX_ILLEGAL_STATE;
+		} else {
+			ring->mask = capacity - 1;
+			ring->pos = __atomic_load_n(&ring->header->writePos, __ATOMIC_ACQUIRE);
+		}
+	}
+
+	if (status == CELIX_SUCCESS) {
+		*out = ring;
+	} else {
+		ring->owner = false;
+		shmRing_destroy(ring);
+	}
+
+	return status;
+}
+
+void shmRing_destroy(shm_ring_pt ring) {
+	if (ring->map != NULL) {
+		munmap(ring->map, ring->mapSize);
+	}
+	if (ring->fd != -1) {
+		close(ring->fd);
+	}
+	if (ring->owner) {
+		shm_unlink(ring->name);
+	}
+	free(ring->name);
+	free(ring);
+}
+
+int shmRing_write(shm_ring_pt ring, unsigned int type, unsigned char major, unsigned char minor, const void *payload, unsigned int payloadSize) {
+	struct shm_ring_header *hdr = ring->header;
+	uint32_t capacity = hdr->capacity;
+	uint64_t recSize = (sizeof(struct shm_ring_record) + (uint64_t)payloadSize + SHM_RING_ALIGN - 1) & ~((uint64_t)SHM_RING_ALIGN - 1);
+
+	/* Keep at least half of the ring for the messages written before, so readers have a chance to keep up */
+	if (recSize > capacity / 2) {
+		ring->stats.nrMsgsTooLarge++;
+		return -1;
+	}
+
+	uint64_t pos = ring->pos;
+	uint32_t offset = pos & ring->mask;
+	uint32_t remaining = capacity - offset;
+	uint64_t total = recSize > remaining ? remaining + recSize : recSize;
+
+	/* Announce the region that is about to be overwritten before touching it */
+	__atomic_store_n(&hdr->writeReserve, pos + total, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	struct shm_ring_record rec;
+	memset(&rec, 0, sizeof(rec));
+	if (recSize > remaining) {
+		rec.size = remaining;
+		rec.type = SHM_RING_PAD_TYPE;
+		memcpy(ring->data + offset, &rec, sizeof(rec));
+		pos += remaining;
+		offset = 0;
+	}
+
+	rec.size = recSize;
+	rec.type = type;
+	rec.payloadSize = payloadSize;
+	rec.major = major;
+	rec.minor = minor;
+	memcpy(ring->data + offset, &rec, sizeof(rec));
+	memcpy(ring->data + offset + sizeof(rec), payload, payloadSize);
+	pos += recSize;
+	ring->pos = pos;
+
+	__atomic_store_n(&hdr->writePos, pos, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&hdr->futexSeq, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&hdr->nrWaiters, __ATOMIC_SEQ_CST) > 0) {
+		shmRing_futexWake(&hdr->futexSeq);
+	}
+
+	ring->stats.nrMsgsWritten++;
+	return 0;
+}
+
+bool shmRing_nextMessage(shm_ring_pt ring, shm_ring_msg_t *msg) {
+	struct shm_ring_header *hdr = ring->header;
+	uint32_t capacity = ring->mask + 1;
+
+	while (true) {
+		uint64_t writePos = __atomic_load_n(&hdr->writePos, __ATOMIC_ACQUIRE);
+		if (ring->pos == writePos) {
+			return false;
+		}
+		if (writePos - ring->pos > capacity) {
+			ring->stats.nrOverruns++;
+			ring->pos = writePos;
+			return false;
+		}
+
+		uint32_t offset = ring->pos & ring->mask;
+		struct shm_ring_record rec;
+		memcpy(&rec, ring->data + offset, sizeof(rec));
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&hdr->writeReserve, __ATOMIC_RELAXED) - ring->pos > capacity) {
+			/* Overtaken while reading the record header */
+			ring->stats.nrOverruns++;
+			ring->pos = __atomic_load_n(&hdr->writePos, __ATOMIC_ACQUIRE);
+			continue;
+		}
+
+		if (rec.size < sizeof(rec) || (rec.size % SHM_RING_ALIGN) != 0 || rec.size > capacity - offset || rec.payloadSize > rec.size - sizeof(rec)) {
+			ring->stats.nrCorruptRecords++;
+			ring->pos = writePos;
+			continue;
+		}
+
+		if (rec.type == SHM_RING_PAD_TYPE) {
+			ring->pos += rec.size;
+			continue;
+		}
+
+		msg->type = rec.type;
+		msg->major = rec.major;
+		msg->minor = rec.minor;
+		msg->payload = ring->data + offset + sizeof(rec);
+		msg->payloadSize = rec.payloadSize;
+		ring->currentSize = rec.size;
+		ring->stats.nrMsgsRead++;
+		return true;
+	}
+}
+
+bool shmRing_messageIntact(shm_ring_pt ring) {
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&ring->header->writeReserve, __ATOMIC_RELAXED) - ring->pos <= (uint64_t)ring->mask + 1;
+}
+
+void shmRing_releaseMessage(shm_ring_pt ring) {
+	ring->pos += ring->currentSize;
+	ring->currentSize = 0;
+}
+
+void shmRing_wait(shm_ring_pt ring, unsigned int timeoutMs) {
+	struct shm_ring_header *hdr = ring->header;
+
+	uint32_t seq = __atomic_load_n(&hdr->futexSeq, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&hdr->writePos, __ATOMIC_ACQUIRE) != ring->pos) {
+		return;
+	}
+
+	__atomic_add_fetch(&hdr->nrWaiters, 1, __ATOMIC_SEQ_CST);
+	shmRing_futexWait(&hdr->futexSeq, seq, timeoutMs);
+	__atomic_sub_fetch(&hdr->nrWaiters, 1, __ATOMIC_SEQ_CST);
+}
+
+void shmRing_wakeup(shm_ring_pt ring) {
+	shmRing_futexWake(&ring->header->futexSeq);
+}
+
+void shmRing_getStatistics(shm_ring_pt ring, shm_ring_statistics_t *stats) {
+	*stats = ring->stats;
+}
+
+static celix_status_t shmRing_map(shm_ring_pt ring, size_t size) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0);
+	if (map == MAP_FAILED) {
+		perror("shmRing:mmap");
+		status = CELIX_FILE_IO_EXCEPTION;
+	} else {
+		ring->map = map;
+		ring->mapSize = size;
+		ring->header = map;
+		ring->data = (char *)map + SHM_RING_HEADER_SIZE;
+	}
+
+	return status;
+}
+
+static unsigned int shmRing_roundUpPow2(unsigned int v) {
+	unsigned int p = SHM_RING_MIN_CAPACITY;
+	while (p < v && p < (UINT_MAX / 2 + 1)) {
+		p <<= 1;
+	}
+	return p;
+}
+
+#ifdef __linux__
+static void shmRing_futexWait(uint32_t *addr, uint32_t val, unsigned int timeoutMs) {
+	struct timespec timeout;
+	timeout.tv_sec = timeoutMs / 1000;
+	timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+	/* Not FUTEX_PRIVATE_FLAG, the futex word is shared between processes */
+	syscall(SYS_futex, addr, FUTEX_WAIT, val, &timeout, NULL, 0);
+}
+
+static void shmRing_futexWake(uint32_t *addr) {
+	syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+#else
+/* No futex available, poll the sequence number */
+static void shmRing_futexWait(uint32_t *addr, uint32_t val, unsigned int timeoutMs) {
+	unsigned int waited = 0;
+	struct timespec delay = {0, 100000L};
+	while (__atomic_load_n(addr, __ATOMIC_SEQ_CST) == val && waited < timeoutMs * 10) {
+		nanosleep(&delay, NULL);
+		waited++;
+	}
+}
+
+static void shmRing_futexWake(uint32_t *addr) {
+}
+#endif
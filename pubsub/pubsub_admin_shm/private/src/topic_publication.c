@@ -0,0 +1,498 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * topic_publication.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "array_list.h"
+#include "celixbool.h"
+#include "service_registration.h"
+#include "utils.h"
+#include "service_factory.h"
+#include "version.h"
+
+#include "topic_publication.h"
+#include "pubsub_msg_type_index.h"
+#include "pubsub_msg_pool.h"
+#include "pubsub_common.h"
+#include "publisher.h"
+#include "shm_ring.h"
+
+#include "pubsub_serializer.h"
+
+#define EP_ADDRESS_LEN		512
+#define SHM_NAME_LEN		128
+
+struct topic_publication {
+	char* endpoint;
+	char* shmName;
+	shm_ring_pt ring; // single writer, guarded by tp_lock
+	service_registration_pt svcFactoryReg;
+	array_list_pt pub_ep_list; //List<pubsub_endpoint>
+	hash_map_pt boundServices; //<bundle_pt,bound_service>
+	celix_thread_mutex_t tp_lock;
+	pubsub_msg_type_index_pt msgTypeIndex; // Local indices of the msg types of all bound services, guarded by tp_lock
+	pubsub_serializer_service_t *serializer;
+
+	/* Subscriptions in this framework, never locked while holding tp_lock */
+	celix_thread_mutex_t localSubscriptions_lock; //Recursive, held while delivering to the local subscriptions
+	celix_thread_mutexattr_t localSubscriptions_attr;
+	array_list_pt localSubscriptions; //List<topic_subscription_pt>
+	int nrLocalSubscriptions; //Read without lock on the send path
+};
+
+typedef struct publish_bundle_bound_service {
+	topic_publication_pt parent;
+	pubsub_publisher_t service;
+	bundle_pt bundle;
+	char *scope;
+	char *topic;
+	hash_map_pt msgTypes;
+	pubsub_msg_serializer_t **msgSerializers; // by local msg type index of the parent
+	unsigned int nrOfMsgSerializers;
+	pubsub_msg_pool_pt msgPool; // msgs allocated for the bundle with allocMsg
+	unsigned short getCount;
+	celix_thread_mutex_t mp_lock;
+}* publish_bundle_bound_service_pt;
+
+
+static celix_status_t pubsub_topicPublicationGetService(void* handle, bundle_pt bundle, service_registration_pt registration, void **service);
+static celix_status_t pubsub_topicPublicationUngetService(void* handle, bundle_pt bundle, service_registration_pt registration, void **service);
+
+static publish_bundle_bound_service_pt pubsub_createPublishBundleBoundService(topic_publication_pt tp,bundle_pt bundle);
+static void pubsub_destroyPublishBundleBoundService(publish_bundle_bound_service_pt boundSvc);
+
+static int pubsub_topicPublicationSend(void* handle,unsigned int msgTypeId, const void *msg);
+
+static int pubsub_localMsgTypeIdForUUID(void* handle, const char* msgType, unsigned int* msgTypeId);
+static int pubsub_topicPublicationAllocMsg(void* handle, unsigned int msgTypeId, void **msg);
+static int pubsub_topicPublicationSendAndFreeMsg(void* handle, unsigned int msgTypeId, void *msg);
+static int pubsub_topicPublicationFreeMsg(void* handle, unsigned int msgTypeId, void *msg);
+static void deliver_local_msg(topic_publication_pt pub, pubsub_msg_serializer_t *msgSer, const void *msg);
+
+
+celix_status_t pubsub_topicPublicationCreate(pubsub_endpoint_pt pubEP, pubsub_serializer_service_t *best_serializer, char* hostId, topic_publication_pt *out){
+	celix_status_t status = CELIX_SUCCESS;
+	static unsigned int shmCounter = 0;
+
+	unsigned int ringSize = SHM_RING_DEFAULT_SIZE;
+	const char *ringSizeProp = NULL;
+	if(pubEP->topic_props != NULL){
+		ringSizeProp = properties_get(pubEP->topic_props, PUBSUB_SHM_RING_SIZE_KEY);
+	}
+	if(ringSizeProp != NULL){
+		ringSize = (unsigned int)strtoul(ringSizeProp, NULL, 10);
+	}
+
+	/* Segment names must be unique on this host */
+	char *shmName = malloc(SHM_NAME_LEN);
+	snprintf(shmName, SHM_NAME_LEN, "/celix_psa_shm_%d_%ld_%u", (int)getpid(), pubEP->serviceID, __atomic_add_fetch(&shmCounter, 1, __ATOMIC_SEQ_CST));
+
+	shm_ring_pt ring = NULL;
+	status = shmRing_create(shmName, ringSize, &ring);
+	if(status != CELIX_SUCCESS){
+		printf("PSA_SHM_TP: Cannot create shared memory segment %s for topic %s.\n", shmName, pubEP->topic);
+		free(shmName);
+		return status;
+	}
+
+	char* ep = malloc(EP_ADDRESS_LEN);
+	snprintf(ep,EP_ADDRESS_LEN,"%s%s%s",SHM_URL_PREFIX,hostId,shmName);
+
+	topic_publication_pt pub = calloc(1,sizeof(*pub));
+
+	arrayList_create(&(pub->pub_ep_list));
+	pub->boundServices = hashMap_create(NULL,NULL,NULL,NULL);
+	celixThreadMutex_create(&(pub->tp_lock),NULL);
+	pubsubMsgTypeIndex_create(&pub->msgTypeIndex);
+
+	pub->endpoint = ep;
+	pub->shmName = shmName;
+	pub->ring = ring;
+	pub->serializer = best_serializer;
+
+	arrayList_create(&(pub->localSubscriptions));
+	celixThreadMutexAttr_create(&(pub->localSubscriptions_attr));
+	celixThreadMutexAttr_settype(&(pub->localSubscriptions_attr), CELIX_THREAD_MUTEX_RECURSIVE);
+	celixThreadMutex_create(&(pub->localSubscriptions_lock), &(pub->localSubscriptions_attr));
+
+	pubsub_topicPublicationAddPublisherEP(pub,pubEP);
+
+	*out = pub;
+
+	return status;
+}
+
+celix_status_t pubsub_topicPublicationDestroy(topic_publication_pt pub){
+	celix_status_t status = CELIX_SUCCESS;
+
+	celixThreadMutex_lock(&(pub->tp_lock));
+
+	free(pub->endpoint);
+	arrayList_destroy(pub->pub_ep_list);
+
+	hash_map_iterator_pt iter = hashMapIterator_create(pub->boundServices);
+	while(hashMapIterator_hasNext(iter)){
+		publish_bundle_bound_service_pt bound = hashMapIterator_nextValue(iter);
+		pubsub_destroyPublishBundleBoundService(bound);
+	}
+	hashMapIterator_destroy(iter);
+	hashMap_destroy(pub->boundServices,false,false);
+
+	pub->svcFactoryReg = NULL;
+	pub->serializer = NULL;
+
+	shm_ring_statistics_t stats;
+	shmRing_getStatistics(pub->ring, &stats);
+	printf("PSA_SHM_TP: %lu msgs written to %s, %lu msgs too large for the ring\n", stats.nrMsgsWritten, pub->shmName, stats.nrMsgsTooLarge);
+
+	/* Unlinks the segment, subscribers still mapping it keep a valid mapping until they disconnect */
+	shmRing_destroy(pub->ring);
+	free(pub->shmName);
+
+	celixThreadMutex_unlock(&(pub->tp_lock));
+
+	celixThreadMutex_destroy(&(pub->tp_lock));
+	pubsubMsgTypeIndex_destroy(pub->msgTypeIndex);
+
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	arrayList_destroy(pub->localSubscriptions);
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+	celixThreadMutex_destroy(&(pub->localSubscriptions_lock));
+	celixThreadMutexAttr_destroy(&(pub->localSubscriptions_attr));
+
+	free(pub);
+
+	return status;
+}
+
+celix_status_t pubsub_topicPublicationStart(bundle_context_pt bundle_context,topic_publication_pt pub,service_factory_pt* svcFactory){
+	celix_status_t status = CELIX_SUCCESS;
+
+	/* Let's register the new service */
+
+	pubsub_endpoint_pt pubEP = (pubsub_endpoint_pt)arrayList_get(pub->pub_ep_list,0);
+
+	if(pubEP!=NULL){
+		service_factory_pt factory = calloc(1, sizeof(*factory));
+		factory->handle = pub;
+		factory->getService = pubsub_topicPublicationGetService;
+		factory->ungetService = pubsub_topicPublicationUngetService;
+
+		properties_pt props = properties_create();
+		properties_set(props,PUBSUB_PUBLISHER_SCOPE,pubEP->scope);
+		properties_set(props,PUBSUB_PUBLISHER_TOPIC,pubEP->topic);
+
+		status = bundleContext_registerServiceFactory(bundle_context,PUBSUB_PUBLISHER_SERVICE_NAME,factory,props,&(pub->svcFactoryReg));
+
+		if(status != CELIX_SUCCESS){
+			properties_destroy(props);
+			printf("PSA_SHM_TP: Cannot register ServiceFactory for topic %s, topic %s (bundle %ld).\n",pubEP->scope, pubEP->topic,pubEP->serviceID);
+		}
+		else{
+			*svcFactory = factory;
+		}
+	}
+	else{
+		printf("PSA_SHM_TP: Cannot find pubsub_endpoint after adding it...Should never happen!\n");
+		status = CELIX_SERVICE_EXCEPTION;
+	}
+
+	return status;
+}
+
+celix_status_t pubsub_topicPublicationStop(topic_publication_pt pub){
+	return serviceRegistration_unregister(pub->svcFactoryReg);
+}
+
+celix_status_t pubsub_topicPublicationAddPublisherEP(topic_publication_pt pub,pubsub_endpoint_pt ep){
+
+	celixThreadMutex_lock(&(pub->tp_lock));
+	ep->endpoint = strdup(pub->endpoint);
+	arrayList_add(pub->pub_ep_list,ep);
+	celixThreadMutex_unlock(&(pub->tp_lock));
+
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_topicPublicationRemovePublisherEP(topic_publication_pt pub,pubsub_endpoint_pt ep){
+
+	celixThreadMutex_lock(&(pub->tp_lock));
+	arrayList_removeElement(pub->pub_ep_list,ep);
+	celixThreadMutex_unlock(&(pub->tp_lock));
+
+	return CELIX_SUCCESS;
+}
+
+array_list_pt pubsub_topicPublicationGetPublisherList(topic_publication_pt pub){
+	array_list_pt list = NULL;
+	celixThreadMutex_lock(&(pub->tp_lock));
+	list = arrayList_clone(pub->pub_ep_list);
+	celixThreadMutex_unlock(&(pub->tp_lock));
+	return list;
+}
+
+celix_status_t pubsub_topicPublicationAddLocalSubscription(topic_publication_pt pub, topic_subscription_pt sub){
+
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	if(!arrayList_contains(pub->localSubscriptions,sub)){
+		arrayList_add(pub->localSubscriptions,sub);
+		__atomic_store_n(&pub->nrLocalSubscriptions, arrayList_size(pub->localSubscriptions), __ATOMIC_RELEASE);
+	}
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_topicPublicationRemoveLocalSubscription(topic_publication_pt pub, topic_subscription_pt sub){
+
+	/* Blocks until a delivery in progress to this subscription is finished */
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	arrayList_removeElement(pub->localSubscriptions,sub);
+	__atomic_store_n(&pub->nrLocalSubscriptions, arrayList_size(pub->localSubscriptions), __ATOMIC_RELEASE);
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+
+	return CELIX_SUCCESS;
+}
+
+
+static celix_status_t pubsub_topicPublicationGetService(void* handle, bundle_pt bundle, service_registration_pt registration, void **service) {
+	celix_status_t  status = CELIX_SUCCESS;
+
+	topic_publication_pt publish = (topic_publication_pt)handle;
+
+	celixThreadMutex_lock(&(publish->tp_lock));
+
+	publish_bundle_bound_service_pt bound = (publish_bundle_bound_service_pt)hashMap_get(publish->boundServices,bundle);
+	if(bound==NULL){
+		bound = pubsub_createPublishBundleBoundService(publish,bundle);
+		if(bound!=NULL){
+			hashMap_put(publish->boundServices,bundle,bound);
+		}
+	}
+	else{
+		bound->getCount++;
+	}
+
+	if (bound != NULL) {
+		*service = &bound->service;
+	}
+
+	celixThreadMutex_unlock(&(publish->tp_lock));
+
+	return status;
+}
+
+static celix_status_t pubsub_topicPublicationUngetService(void* handle, bundle_pt bundle, service_registration_pt registration, void **service)  {
+
+	topic_publication_pt publish = (topic_publication_pt)handle;
+
+	celixThreadMutex_lock(&(publish->tp_lock));
+
+	publish_bundle_bound_service_pt bound = (publish_bundle_bound_service_pt)hashMap_get(publish->boundServices,bundle);
+	if(bound!=NULL){
+
+		bound->getCount--;
+		if(bound->getCount==0){
+			pubsub_destroyPublishBundleBoundService(bound);
+			hashMap_remove(publish->boundServices,bundle);
+		}
+
+	}
+	else{
+		long bundleId = -1;
+		bundle_getBundleId(bundle,&bundleId);
+		printf("PSA_SHM_TP: Unexpected ungetService call for bundle %ld.\n", bundleId);
+	}
+
+	/* service should be never used for unget, so let's set the pointer to NULL */
+	*service = NULL;
+
+	celixThreadMutex_unlock(&(publish->tp_lock));
+
+	return CELIX_SUCCESS;
+}
+
+static int pubsub_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *inMsg) {
+	int status = 0;
+	publish_bundle_bound_service_pt bound = (publish_bundle_bound_service_pt) handle;
+
+	celixThreadMutex_lock(&(bound->parent->tp_lock));
+	celixThreadMutex_lock(&(bound->mp_lock));
+
+	pubsub_msg_serializer_t* msgSer = pubsubMsgTypeIndex_getSerializer(bound->msgSerializers, bound->nrOfMsgSerializers, pubsubMsgTypeIndex_get(bound->parent->msgTypeIndex, msgTypeId));
+
+	if (msgSer != NULL) {
+		int major=0, minor=0;
+
+		if (msgSer->msgVersion != NULL){
+			version_getMajor(msgSer->msgVersion, &major);
+			version_getMinor(msgSer->msgVersion, &minor);
+		}
+
+		void* serializedOutput = NULL;
+		size_t serializedOutputLen = 0;
+		if (msgSer->serialize(msgSer,inMsg,&serializedOutput, &serializedOutputLen) == CELIX_SUCCESS) {
+			/* The serialized message is copied once into the ring, subscribers deserialize it from there */
+			if (shmRing_write(bound->parent->ring, msgTypeId, (unsigned char)major, (unsigned char)minor, serializedOutput, serializedOutputLen) != 0) {
+				printf("PSA_SHM_TP: Message of %zu bytes does not fit in the shared memory ring of topic %s\n", serializedOutputLen, bound->topic);
+				status = -1;
+			}
+			free(serializedOutput);
+		}
+		else {
+			printf("PSA_SHM_TP: Cannot serialize msg type id %d\n", msgTypeId);
+			status = -1;
+		}
+
+	} else {
+		printf("PSA_SHM_TP: No msg serializer available for msg type id %d\n", msgTypeId);
+		status=-1;
+	}
+
+	celixThreadMutex_unlock(&(bound->mp_lock));
+	celixThreadMutex_unlock(&(bound->parent->tp_lock));
+
+	/* Subscribers in this framework get the message directly, outside the locks */
+	if(msgSer != NULL && __atomic_load_n(&bound->parent->nrLocalSubscriptions, __ATOMIC_ACQUIRE) > 0){
+		deliver_local_msg(bound->parent, msgSer, inMsg);
+	}
+
+	return status;
+}
+
+static void deliver_local_msg(topic_publication_pt pub, pubsub_msg_serializer_t *msgSer, const void *msg){
+
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	unsigned int i = 0;
+	for(;i<arrayList_size(pub->localSubscriptions);i++){
+		topic_subscription_pt sub = (topic_subscription_pt)arrayList_get(pub->localSubscriptions,i);
+		pubsub_topicSubscriptionDeliverLocal(sub, msgSer, msg);
+	}
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+}
+
+static int pubsub_topicPublicationAllocMsg(void* handle, unsigned int msgTypeId, void **msg){
+	publish_bundle_bound_service_pt bound = (publish_bundle_bound_service_pt) handle;
+
+	celixThreadMutex_lock(&(bound->parent->tp_lock));
+	int localIndex = pubsubMsgTypeIndex_get(bound->parent->msgTypeIndex, msgTypeId);
+	celixThreadMutex_unlock(&(bound->parent->tp_lock));
+
+	if (bound->msgPool == NULL || pubsubMsgPool_alloc(bound->msgPool, localIndex, msg) != CELIX_SUCCESS) {
+		printf("PSA_SHM_TP: Cannot allocate a msg for msg type id %d\n", msgTypeId);
+		return -1;
+	}
+	return 0;
+}
+
+static int pubsub_topicPublicationSendAndFreeMsg(void* handle, unsigned int msgTypeId, void *msg){
+	int status = pubsub_topicPublicationSend(handle, msgTypeId, msg);
+	pubsub_topicPublicationFreeMsg(handle, msgTypeId, msg);
+	return status;
+}
+
+static int pubsub_topicPublicationFreeMsg(void* handle, unsigned int msgTypeId, void *msg){
+	publish_bundle_bound_service_pt bound = (publish_bundle_bound_service_pt) handle;
+
+	celixThreadMutex_lock(&(bound->parent->tp_lock));
+	int localIndex = pubsubMsgTypeIndex_get(bound->parent->msgTypeIndex, msgTypeId);
+	celixThreadMutex_unlock(&(bound->parent->tp_lock));
+
+	if (bound->msgPool == NULL || pubsubMsgPool_free(bound->msgPool, localIndex, msg) != CELIX_SUCCESS) {
+		printf("PSA_SHM_TP: Cannot free a pooled msg for msg type id %d\n", msgTypeId);
+		return -1;
+	}
+	return 0;
+}
+
+static int pubsub_localMsgTypeIdForUUID(void* handle, const char* msgType, unsigned int* msgTypeId){
+	*msgTypeId = utils_stringHash(msgType);
+	return 0;
+}
+
+static publish_bundle_bound_service_pt pubsub_createPublishBundleBoundService(topic_publication_pt tp,bundle_pt bundle){
+
+	publish_bundle_bound_service_pt bound = calloc(1, sizeof(*bound));
+
+	if (bound != NULL) {
+
+		bound->parent = tp;
+		bound->bundle = bundle;
+		bound->getCount = 1;
+		celixThreadMutex_create(&bound->mp_lock,NULL);
+
+		if(tp->serializer != NULL){
+			tp->serializer->createSerializerMap(tp->serializer->handle,bundle,&bound->msgTypes);
+			pubsubMsgTypeIndex_bind(tp->msgTypeIndex,bound->msgTypes,&bound->msgSerializers,&bound->nrOfMsgSerializers);
+			pubsubMsgPool_create(bound->msgSerializers,bound->nrOfMsgSerializers,PUBSUB_MSG_POOL_DEFAULT_MAX_PER_TYPE,&bound->msgPool);
+		}
+
+		pubsub_endpoint_pt pubEP = (pubsub_endpoint_pt)arrayList_get(bound->parent->pub_ep_list,0);
+		bound->scope=strdup(pubEP->scope);
+		bound->topic=strdup(pubEP->topic);
+
+		bound->service.handle = bound;
+		bound->service.localMsgTypeIdForMsgType = pubsub_localMsgTypeIdForUUID;
+		bound->service.send = pubsub_topicPublicationSend;
+		bound->service.sendMultipart = NULL;  //Multipart not supported for shared memory
+		bound->service.allocMsg = pubsub_topicPublicationAllocMsg;
+		bound->service.sendAndFreeMsg = pubsub_topicPublicationSendAndFreeMsg;
+		bound->service.freeMsg = pubsub_topicPublicationFreeMsg;
+
+	}
+
+	return bound;
+}
+
+static void pubsub_destroyPublishBundleBoundService(publish_bundle_bound_service_pt boundSvc){
+
+	celixThreadMutex_lock(&boundSvc->mp_lock);
+
+	if(boundSvc->msgPool != NULL){
+		pubsubMsgPool_destroy(boundSvc->msgPool);
+	}
+
+	if(boundSvc->parent->serializer != NULL && boundSvc->msgTypes != NULL){
+		boundSvc->parent->serializer->destroySerializerMap(boundSvc->parent->serializer->handle, boundSvc->msgTypes);
+	}
+	free(boundSvc->msgSerializers);
+
+	if(boundSvc->scope!=NULL){
+		free(boundSvc->scope);
+	}
+
+	if(boundSvc->topic!=NULL){
+		free(boundSvc->topic);
+	}
+
+	celixThreadMutex_unlock(&boundSvc->mp_lock);
+	celixThreadMutex_destroy(&boundSvc->mp_lock);
+
+	free(boundSvc);
+
+}
@@ -0,0 +1,652 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * topic_subscription.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "utils.h"
+#include "celix_errno.h"
+#include "constants.h"
+#include "version.h"
+
+#include "topic_subscription.h"
+#include "pubsub_msg_type_index.h"
+#include "pubsub_topic_trie.h"
+#include "topic_publication.h"
+#include "subscriber.h"
+#include "publisher.h"
+#include "shm_ring.h"
+
+#include "pubsub_serializer.h"
+
+#define SHM_WAIT_TIMEOUT_MS	100
+#define SHM_HOST_ID_LEN		256
+#define SHM_NAME_LEN		256
+
+struct topic_subscription{
+	char* hostId;
+	service_tracker_pt tracker;
+	array_list_pt sub_ep_list;
+	bool running;
+	celix_thread_mutex_t ts_lock;
+	bundle_context_pt context;
+
+	pubsub_serializer_service_t *serializer;
+
+	hash_map_pt servicesMap; // key = service, value = subscriber_msg_types
+	pubsub_msg_type_index_pt msgTypeIndex; // Local indices of the msg types of all subscribers, guarded by ts_lock
+	hash_map_pt connectionMap; // key = URL, value = shm_connection
+	celix_thread_mutex_t connectionMap_lock;
+
+	unsigned int nrSubscribers;
+	unsigned int localDeliveries; // local deliveries calling subscribers outside ts_lock, guarded by ts_lock
+	celix_thread_cond_t localDeliveries_cond;
+};
+
+/* The msg serializers of a subscriber, indexed by the local msg type index of the subscription */
+typedef struct subscriber_msg_types{
+	hash_map_pt msgTypes;
+	pubsub_msg_serializer_t **msgSerializers;
+	unsigned int nrOfMsgSerializers;
+	bool arena; // deserialize the messages in one arena
+}* subscriber_msg_types_pt;
+
+/* A subscriber of a locally published msg, copied under ts_lock and called without it */
+struct local_delivery{
+	pubsub_subscriber_pt subsvc;
+	pubsub_msg_serializer_t *msgSer;
+	bool arena;
+	bool sameVersion; // receives the publisher's instance
+};
+
+/* A mapped publication segment, read by its own thread */
+typedef struct shm_connection {
+	topic_subscription_pt sub;
+	shm_ring_pt ring;
+	bool running;
+	celix_thread_t recv_thread;
+}* shm_connection_pt;
+
+static celix_status_t topicsub_subscriberTracked(void * handle, service_reference_pt reference, void * service);
+static celix_status_t topicsub_subscriberUntracked(void * handle, service_reference_pt reference, void * service);
+static void* shm_recv_thread_func(void* arg);
+static bool checkVersion(version_pt msgVersion,unsigned char major, unsigned char minor);
+static int pubsub_localMsgTypeIdForMsgType(void* handle, const char* msgType, unsigned int* msgTypeId);
+static void closeConnection(const char *url, shm_connection_pt conn);
+
+
+celix_status_t pubsub_topicSubscriptionCreate(bundle_context_pt bundle_context, char* hostId,char* scope, char* topic ,pubsub_serializer_service_t *best_serializer, topic_subscription_pt* out){
+	celix_status_t status = CELIX_SUCCESS;
+
+	topic_subscription_pt ts = (topic_subscription_pt) calloc(1,sizeof(*ts));
+	ts->context = bundle_context;
+	ts->hostId = strdup(hostId);
+
+	ts->running = false;
+	ts->nrSubscribers = 0;
+	ts->serializer = best_serializer;
+
+	celixThreadMutex_create(&ts->ts_lock,NULL);
+	celixThreadCondition_init(&ts->localDeliveries_cond, NULL);
+	pubsubMsgTypeIndex_create(&ts->msgTypeIndex);
+	arrayList_create(&ts->sub_ep_list);
+	ts->servicesMap = hashMap_create(NULL, NULL, NULL, NULL);
+	ts->connectionMap =  hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+	celixThreadMutex_create(&ts->connectionMap_lock, NULL);
+
+	char filter[128];
+	memset(filter,0,128);
+	char *filterTopic = pubsubTopic_createFilterValue(topic); // Wildcard topics contain '*', which has a meaning in filters
+	if(strncmp(PUBSUB_SUBSCRIBER_SCOPE_DEFAULT, scope, strlen(PUBSUB_SUBSCRIBER_SCOPE_DEFAULT)) == 0) {
+		// default scope, means that subscriber has not defined a scope property
+		snprintf(filter, 128, "(&(%s=%s)(%s=%s))",
+				(char*) OSGI_FRAMEWORK_OBJECTCLASS, PUBSUB_SUBSCRIBER_SERVICE_NAME,
+				PUBSUB_SUBSCRIBER_TOPIC,filterTopic);
+
+	} else {
+		snprintf(filter, 128, "(&(%s=%s)(%s=%s)(%s=%s))",
+				(char*) OSGI_FRAMEWORK_OBJECTCLASS, PUBSUB_SUBSCRIBER_SERVICE_NAME,
+				PUBSUB_SUBSCRIBER_TOPIC,filterTopic,
+				PUBSUB_SUBSCRIBER_SCOPE,scope);
+	}
+	free(filterTopic);
+
+	service_tracker_customizer_pt customizer = NULL;
+	status += serviceTrackerCustomizer_create(ts,NULL,topicsub_subscriberTracked,NULL,topicsub_subscriberUntracked,&customizer);
+	status += serviceTracker_createWithFilter(bundle_context, filter, customizer, &ts->tracker);
+
+	if (status == CELIX_SUCCESS) {
+		*out=ts;
+	}
+
+	return status;
+}
+
+celix_status_t pubsub_topicSubscriptionDestroy(topic_subscription_pt ts){
+	celix_status_t status = CELIX_SUCCESS;
+
+	celixThreadMutex_lock(&ts->ts_lock);
+	ts->running = false;
+	free(ts->hostId);
+	serviceTracker_destroy(ts->tracker);
+	arrayList_clear(ts->sub_ep_list);
+	arrayList_destroy(ts->sub_ep_list);
+	hashMap_destroy(ts->servicesMap,false,false);
+
+	celixThreadMutex_lock(&ts->connectionMap_lock);
+	hashMap_destroy(ts->connectionMap,false,false);
+	celixThreadMutex_unlock(&ts->connectionMap_lock);
+	celixThreadMutex_destroy(&ts->connectionMap_lock);
+
+	celixThreadMutex_unlock(&ts->ts_lock);
+
+	celixThreadMutex_destroy(&ts->ts_lock);
+	celixThreadCondition_destroy(&ts->localDeliveries_cond);
+	pubsubMsgTypeIndex_destroy(ts->msgTypeIndex);
+
+	free(ts);
+
+	return status;
+}
+
+celix_status_t pubsub_topicSubscriptionStart(topic_subscription_pt ts){
+	celix_status_t status = CELIX_SUCCESS;
+
+	status = serviceTracker_open(ts->tracker);
+
+	ts->running = true;
+
+	return status;
+}
+
+celix_status_t pubsub_topicSubscriptionStop(topic_subscription_pt ts){
+	celix_status_t status = CELIX_SUCCESS;
+
+	ts->running = false;
+
+	/* Take the connections out of the map first, the receive threads may be busy delivering */
+	celixThreadMutex_lock(&ts->connectionMap_lock);
+	hash_map_pt connections = ts->connectionMap;
+	ts->connectionMap = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+	celixThreadMutex_unlock(&ts->connectionMap_lock);
+
+	hash_map_iterator_pt it = hashMapIterator_create(connections);
+	while(hashMapIterator_hasNext(it)) {
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(it);
+		char *url = hashMapEntry_getKey(entry);
+		closeConnection(url, hashMapEntry_getValue(entry));
+		free(url);
+	}
+	hashMapIterator_destroy(it);
+	hashMap_destroy(connections, false, false);
+
+	status = serviceTracker_close(ts->tracker);
+
+	return status;
+}
+
+celix_status_t pubsub_topicSubscriptionConnectPublisher(topic_subscription_pt ts, char* pubURL) {
+
+	printf("pubsub_topicSubscriptionConnectPublisher : pubURL = %s\n", pubURL);
+
+	celix_status_t status = CELIX_SUCCESS;
+
+	char host[SHM_HOST_ID_LEN];
+	char name[SHM_NAME_LEN];
+	if(sscanf(pubURL, SHM_URL_PREFIX "%255[^/]%255s", host, name) != 2){
+		printf("PSA_SHM_TS: Cannot parse publisher url %s\n", pubURL);
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	if(strcmp(host, ts->hostId) != 0){
+		printf("PSA_SHM_TS: Publisher %s is not on this host (%s), ignoring it\n", pubURL, ts->hostId);
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	celixThreadMutex_lock(&ts->connectionMap_lock);
+
+	if(!hashMap_containsKey(ts->connectionMap, pubURL)){
+
+		shm_ring_pt ring = NULL;
+		status = shmRing_open(name, &ring);
+
+		if (status == CELIX_SUCCESS){
+			shm_connection_pt conn = calloc(1, sizeof(*conn));
+			conn->sub = ts;
+			conn->ring = ring;
+			conn->running = true;
+			status = celixThread_create(&conn->recv_thread, NULL, shm_recv_thread_func, conn);
+			if (status == CELIX_SUCCESS){
+				hashMap_put(ts->connectionMap, strdup(pubURL), conn);
+			}
+			else{
+				shmRing_destroy(ring);
+				free(conn);
+			}
+		}
+		else{
+			printf("PSA_SHM_TS: Cannot map shared memory segment %s\n", name);
+		}
+	}
+
+	celixThreadMutex_unlock(&ts->connectionMap_lock);
+
+	return status;
+}
+
+/* Connections are made directly, there is no receive loop that has to own them */
+celix_status_t pubsub_topicSubscriptionAddConnectPublisherToPendingList(topic_subscription_pt ts, char* pubURL) {
+	return pubsub_topicSubscriptionConnectPublisher(ts, pubURL);
+}
+
+celix_status_t pubsub_topicSubscriptionAddDisconnectPublisherToPendingList(topic_subscription_pt ts, char* pubURL) {
+	return pubsub_topicSubscriptionDisconnectPublisher(ts, pubURL);
+}
+
+celix_status_t pubsub_topicSubscriptionDisconnectPublisher(topic_subscription_pt ts, char* pubURL){
+	printf("pubsub_topicSubscriptionDisconnectPublisher : pubURL = %s\n", pubURL);
+	celix_status_t status = CELIX_SUCCESS;
+
+	celixThreadMutex_lock(&ts->connectionMap_lock);
+	hash_map_entry_pt entry = hashMap_getEntry(ts->connectionMap, pubURL);
+	char *url = NULL;
+	shm_connection_pt conn = NULL;
+	if (entry != NULL){
+		url = hashMapEntry_getKey(entry);
+		conn = hashMapEntry_getValue(entry);
+		hashMap_remove(ts->connectionMap, pubURL);
+	}
+	celixThreadMutex_unlock(&ts->connectionMap_lock);
+
+	if (conn != NULL){
+		closeConnection(url, conn);
+		free(url);
+	}
+
+	return status;
+}
+
+celix_status_t pubsub_topicSubscriptionAddSubscriber(topic_subscription_pt ts, pubsub_endpoint_pt subEP){
+	celix_status_t status = CELIX_SUCCESS;
+
+	celixThreadMutex_lock(&ts->ts_lock);
+	arrayList_add(ts->sub_ep_list,subEP);
+	celixThreadMutex_unlock(&ts->ts_lock);
+
+	return status;
+
+}
+
+celix_status_t pubsub_topicIncreaseNrSubscribers(topic_subscription_pt ts) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	celixThreadMutex_lock(&ts->ts_lock);
+	ts->nrSubscribers++;
+	celixThreadMutex_unlock(&ts->ts_lock);
+
+	return status;
+}
+
+celix_status_t pubsub_topicSubscriptionRemoveSubscriber(topic_subscription_pt ts, pubsub_endpoint_pt subEP){
+	celix_status_t status = CELIX_SUCCESS;
+
+	celixThreadMutex_lock(&ts->ts_lock);
+	arrayList_removeElement(ts->sub_ep_list,subEP);
+	celixThreadMutex_unlock(&ts->ts_lock);
+
+	return status;
+}
+
+celix_status_t pubsub_topicDecreaseNrSubscribers(topic_subscription_pt ts) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	celixThreadMutex_lock(&ts->ts_lock);
+	ts->nrSubscribers--;
+	celixThreadMutex_unlock(&ts->ts_lock);
+
+	return status;
+}
+
+unsigned int pubsub_topicGetNrSubscribers(topic_subscription_pt ts) {
+	return ts->nrSubscribers;
+}
+
+array_list_pt pubsub_topicSubscriptionGetSubscribersList(topic_subscription_pt sub){
+	return sub->sub_ep_list;
+}
+
+
+celix_status_t pubsub_topicSubscriptionDeliverLocal(topic_subscription_pt ts, pubsub_msg_serializer_t *pubMsgSer, const void *msg){
+	celix_status_t status = CELIX_SUCCESS;
+
+	unsigned int msgTypeId = pubMsgSer->msgId;
+	int major=0, minor=0;
+	if(pubMsgSer->msgVersion != NULL){
+		version_getMajor(pubMsgSer->msgVersion, &major);
+		version_getMinor(pubMsgSer->msgVersion, &minor);
+	}
+
+	celixThreadMutex_lock(&ts->ts_lock);
+
+	unsigned int nrOfSubscribers = hashMap_size(ts->servicesMap);
+	struct local_delivery deliveries[nrOfSubscribers > 0 ? nrOfSubscribers : 1];
+	unsigned int nrOfDeliveries = 0;
+
+	int localIndex = pubsubMsgTypeIndex_get(ts->msgTypeIndex, msgTypeId);
+	hash_map_iterator_pt iter = hashMapIterator_create(ts->servicesMap);
+	while (hashMapIterator_hasNext(iter)) {
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+		pubsub_subscriber_pt subsvc = hashMapEntry_getKey(entry);
+		subscriber_msg_types_pt subMsgTypes = hashMapEntry_getValue(entry);
+
+		pubsub_msg_serializer_t *msgSer = pubsubMsgTypeIndex_getSerializer(subMsgTypes->msgSerializers, subMsgTypes->nrOfMsgSerializers, localIndex);
+		if (msgSer == NULL) {
+			printf("PSA_SHM_TS: Serializer not available for message %d.\n",msgTypeId);
+			continue;
+		}
+
+		int cmp = -1;
+		if(msgSer->msgVersion != NULL && pubMsgSer->msgVersion != NULL){
+			version_compareTo(msgSer->msgVersion, pubMsgSer->msgVersion, &cmp);
+		}
+		if(cmp != 0 && !checkVersion(msgSer->msgVersion,(unsigned char)major,(unsigned char)minor)){
+			int subMajor=0,subMinor=0;
+			version_getMajor(msgSer->msgVersion,&subMajor);
+			version_getMinor(msgSer->msgVersion,&subMinor);
+			printf("PSA_SHM_TS: Version mismatch for primary message '%s' (have %d.%d, received %d.%d). NOT sending any part of the whole message.\n",
+					msgSer->msgName,subMajor,subMinor,major,minor);
+			continue;
+		}
+
+		deliveries[nrOfDeliveries].subsvc = subsvc;
+		deliveries[nrOfDeliveries].msgSer = msgSer;
+		deliveries[nrOfDeliveries].arena = subMsgTypes->arena;
+		deliveries[nrOfDeliveries].sameVersion = cmp == 0;
+		nrOfDeliveries++;
+	}
+	hashMapIterator_destroy(iter);
+
+	if(nrOfDeliveries > 0){
+		ts->localDeliveries++; // keeps the subscribers and their serializers until they are called
+	}
+	celixThreadMutex_unlock(&ts->ts_lock);
+
+	void *serializedOutput = NULL; // for version conversions
+	size_t serializedOutputLen = 0;
+	bool serialized = false;
+
+	unsigned int i = 0;
+	for(;i<nrOfDeliveries;i++){
+		struct local_delivery *delivery = &deliveries[i];
+		pubsub_msg_serializer_t *msgSer = delivery->msgSer;
+		pubsub_multipart_callbacks_t mp_callbacks;
+		mp_callbacks.handle = ts;
+		mp_callbacks.localMsgTypeIdForMsgType = pubsub_localMsgTypeIdForMsgType;
+		mp_callbacks.getMultipart = NULL;
+		bool release = true;
+
+		if(delivery->sameVersion){
+			/* Same message layout on both sides, hand over the publisher's instance, read-only and only during the call */
+			delivery->subsvc->receive(delivery->subsvc->handle, msgSer->msgName, msgTypeId, (void*)msg, &mp_callbacks, &release);
+			if(!release){
+				printf("PSA_SHM_TS: Locally delivered message %s is owned by the publisher, it cannot be retained.\n",msgSer->msgName);
+			}
+			continue;
+		}
+
+		/* Compatible but different version, convert through the serializer */
+		if(!serialized){
+			serialized = pubMsgSer->serialize(pubMsgSer, msg, &serializedOutput, &serializedOutputLen) == CELIX_SUCCESS;
+		}
+		void *msgInst = NULL;
+		bool arena = delivery->arena && msgSer->deserializeInArena != NULL;
+		celix_status_t convertStatus = CELIX_SERVICE_EXCEPTION;
+		if(serialized && arena){
+			convertStatus = msgSer->deserializeInArena(msgSer, serializedOutput, serializedOutputLen, &msgInst);
+		}
+		else if(serialized){
+			convertStatus = msgSer->deserialize(msgSer, serializedOutput, serializedOutputLen, &msgInst);
+		}
+
+		if(convertStatus == CELIX_SUCCESS){
+			delivery->subsvc->receive(delivery->subsvc->handle, msgSer->msgName, msgTypeId, msgInst, &mp_callbacks, &release);
+			if(arena){
+				msgSer->freeArenaMsg(msgSer,msgInst);
+			}
+			else if(release){
+				msgSer->freeMsg(msgSer,msgInst);
+			}
+		}
+		else{
+			printf("PSA_SHM_TS: Cannot convert msgType %s for local delivery.\n",msgSer->msgName);
+			status = CELIX_SERVICE_EXCEPTION;
+		}
+	}
+	free(serializedOutput);
+
+	if(nrOfDeliveries > 0){
+		celixThreadMutex_lock(&ts->ts_lock);
+		if(--ts->localDeliveries == 0){
+			celixThreadCondition_broadcast(&ts->localDeliveries_cond);
+		}
+		celixThreadMutex_unlock(&ts->ts_lock);
+	}
+
+	return status;
+}
+
+static celix_status_t topicsub_subscriberTracked(void * handle, service_reference_pt reference, void * service){
+	celix_status_t status = CELIX_SUCCESS;
+	topic_subscription_pt ts = handle;
+
+	celixThreadMutex_lock(&ts->ts_lock);
+	if (!hashMap_containsKey(ts->servicesMap, service)) {
+		bundle_pt bundle = NULL;
+		hash_map_pt msgTypes = NULL;
+
+		serviceReference_getBundle(reference, &bundle);
+
+		if(ts->serializer != NULL && bundle!=NULL){
+			ts->serializer->createSerializerMap(ts->serializer->handle,bundle,&msgTypes);
+			if(msgTypes != NULL){
+				subscriber_msg_types_pt subMsgTypes = calloc(1, sizeof(*subMsgTypes));
+				subMsgTypes->msgTypes = msgTypes;
+				pubsubMsgTypeIndex_bind(ts->msgTypeIndex, msgTypes, &subMsgTypes->msgSerializers, &subMsgTypes->nrOfMsgSerializers);
+
+				const char *arena = NULL;
+				serviceReference_getProperty(reference, PUBSUB_SUBSCRIBER_MSG_ARENA, &arena);
+				subMsgTypes->arena = arena != NULL && strcmp(arena, "true") == 0;
+
+				hashMap_put(ts->servicesMap, service, subMsgTypes);
+				printf("PSA_SHM_TS: New subscriber registered.\n");
+			}
+		}
+		else{
+			printf("PSA_SHM_TS: Cannot register new subscriber.\n");
+			status = CELIX_SERVICE_EXCEPTION;
+		}
+	}
+	celixThreadMutex_unlock(&ts->ts_lock);
+
+	return status;
+
+}
+
+static celix_status_t topicsub_subscriberUntracked(void * handle, service_reference_pt reference, void * service){
+	celix_status_t status = CELIX_SUCCESS;
+	topic_subscription_pt ts = handle;
+
+	celixThreadMutex_lock(&ts->ts_lock);
+	if (hashMap_containsKey(ts->servicesMap, service)) {
+		subscriber_msg_types_pt subMsgTypes = hashMap_remove(ts->servicesMap, service);
+		while(ts->localDeliveries > 0){
+			celixThreadCondition_wait(&ts->localDeliveries_cond, &ts->ts_lock); // running local deliveries still use the subscriber and its serializers
+		}
+		if(subMsgTypes!=NULL && ts->serializer!=NULL){
+			ts->serializer->destroySerializerMap(ts->serializer->handle,subMsgTypes->msgTypes);
+			free(subMsgTypes->msgSerializers);
+			free(subMsgTypes);
+			printf("PSA_SHM_TS: Subscriber unregistered.\n");
+		}
+		else{
+			printf("PSA_SHM_TS: Cannot unregister subscriber.\n");
+			status = CELIX_SERVICE_EXCEPTION;
+		}
+	}
+	celixThreadMutex_unlock(&ts->ts_lock);
+
+	return status;
+}
+
+
+/* Deserializes the message in place from the shared segment and hands it to all subscribers */
+static void process_msg(topic_subscription_pt sub, shm_ring_pt ring, shm_ring_msg_t *msg){
+
+	celixThreadMutex_lock(&sub->ts_lock);
+
+	int localIndex = pubsubMsgTypeIndex_get(sub->msgTypeIndex, msg->type);
+	hash_map_iterator_pt iter = hashMapIterator_create(sub->servicesMap);
+	while (hashMapIterator_hasNext(iter)) {
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+		pubsub_subscriber_pt subsvc = hashMapEntry_getKey(entry);
+		subscriber_msg_types_pt subMsgTypes = hashMapEntry_getValue(entry);
+
+		pubsub_msg_serializer_t *msgSer = pubsubMsgTypeIndex_getSerializer(subMsgTypes->msgSerializers, subMsgTypes->nrOfMsgSerializers, localIndex);
+		if (msgSer == NULL) {
+			printf("PSA_SHM_TS: Serializer not available for message %d.\n",msg->type);
+		}
+		else{
+			void *msgInst = NULL;
+			bool validVersion = checkVersion(msgSer->msgVersion,msg->major,msg->minor);
+			bool arena = subMsgTypes->arena && msgSer->deserializeInArena != NULL;
+
+			if(validVersion){
+
+				celix_status_t status;
+				if(arena){
+					status = msgSer->deserializeInArena(msgSer, (const void *) msg->payload, msg->payloadSize, &msgInst);
+				}
+				else{
+					status = msgSer->deserialize(msgSer, (const void *) msg->payload, msg->payloadSize, &msgInst);
+				}
+
+				if (status == CELIX_SUCCESS && !shmRing_messageIntact(ring)) {
+					/* The publisher wrapped around while we were deserializing, the result cannot be trusted */
+					if(arena){
+						msgSer->freeArenaMsg(msgSer,msgInst);
+					}
+					else{
+						msgSer->freeMsg(msgSer,msgInst);
+					}
+					printf("PSA_SHM_TS: Message %s was overwritten while being read, dropping it.\n",msgSer->msgName);
+				}
+				else if (status == CELIX_SUCCESS) {
+					bool release = true;
+					pubsub_multipart_callbacks_t mp_callbacks;
+					mp_callbacks.handle = sub;
+					mp_callbacks.localMsgTypeIdForMsgType = pubsub_localMsgTypeIdForMsgType;
+					mp_callbacks.getMultipart = NULL;
+
+					subsvc->receive(subsvc->handle, msgSer->msgName, msg->type, msgInst, &mp_callbacks, &release);
+
+					if(arena){
+						msgSer->freeArenaMsg(msgSer,msgInst);
+					}
+					else if(release){
+						msgSer->freeMsg(msgSer,msgInst);
+					}
+				}
+				else{
+					printf("PSA_SHM_TS: Cannot deserialize msgType %s.\n",msgSer->msgName);
+				}
+
+			}
+			else{
+				int major=0,minor=0;
+				version_getMajor(msgSer->msgVersion,&major);
+				version_getMinor(msgSer->msgVersion,&minor);
+				printf("PSA_SHM_TS: Version mismatch for primary message '%s' (have %d.%d, received %u.%u). NOT sending any part of the whole message.\n",
+						msgSer->msgName,major,minor,msg->major,msg->minor);
+			}
+
+		}
+	}
+	hashMapIterator_destroy(iter);
+
+	celixThreadMutex_unlock(&sub->ts_lock);
+}
+
+static void* shm_recv_thread_func(void * arg) {
+	shm_connection_pt conn = (shm_connection_pt) arg;
+
+	while (conn->running) {
+		shm_ring_msg_t msg;
+		if (shmRing_nextMessage(conn->ring, &msg)) {
+			process_msg(conn->sub, conn->ring, &msg);
+			shmRing_releaseMessage(conn->ring);
+		}
+		else {
+			shmRing_wait(conn->ring, SHM_WAIT_TIMEOUT_MS);
+		}
+	}
+
+	return NULL;
+}
+
+static void closeConnection(const char *url, shm_connection_pt conn) {
+	conn->running = false;
+	shmRing_wakeup(conn->ring);
+	celixThread_join(conn->recv_thread, NULL);
+
+	shm_ring_statistics_t stats;
+	shmRing_getStatistics(conn->ring, &stats);
+	printf("PSA_SHM_TS: Reception statistics for %s: %lu msgs read, %lu overruns, %lu corrupt records\n",
+			url, stats.nrMsgsRead, stats.nrOverruns, stats.nrCorruptRecords);
+
+	shmRing_destroy(conn->ring);
+	free(conn);
+}
+
+static bool checkVersion(version_pt msgVersion,unsigned char major, unsigned char minor){
+	bool check=false;
+	int msgMajor=0,msgMinor=0;
+
+	if(msgVersion!=NULL){
+		version_getMajor(msgVersion,&msgMajor);
+		version_getMinor(msgVersion,&msgMinor);
+		if(major==((unsigned char)msgMajor)){ /* Different major means incompatible */
+			check = (minor>=((unsigned char)msgMinor)); /* Compatible only if the provider has a minor equals or greater (means compatible update) */
+		}
+	}
+
+	return check;
+}
+
+static int pubsub_localMsgTypeIdForMsgType(void* handle, const char* msgType, unsigned int* msgTypeId){
+	*msgTypeId = utils_stringHash(msgType);
+	return 0;
+}
@@ -0,0 +1,203 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+#include <CppUTest/TestHarness.h>
+#include "CppUTest/CommandLineTestRunner.h"
+
+extern "C" {
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "shm_ring.h"
+
+#define RING_CAPACITY   4096    //the minimal capacity, a record takes the payload size plus a 16 byte header, rounded up to 16
+#define RECORD_HEADER   16
+
+static shm_ring_pt writer = NULL;
+static shm_ring_pt reader = NULL;
+static char ringName[64];
+
+static void setupRings(void) {
+    snprintf(ringName, sizeof(ringName), "/celix_shm_ring_test_%d", (int)getpid());
+    shm_unlink(ringName);
+    int rc = shmRing_create(ringName, RING_CAPACITY, &writer);
+    CHECK_EQUAL(0, rc);
+    rc = shmRing_open(ringName, &reader);
+    CHECK_EQUAL(0, rc);
+}
+
+static void teardownRings(void) {
+    shmRing_destroy(reader);
+    shmRing_destroy(writer);
+}
+
+static int writeMsg(unsigned int type, unsigned int payloadSize) {
+    char *payload = (char *)malloc(payloadSize);
+    memset(payload, (int)type, payloadSize);
+    int rc = shmRing_write(writer, type, 1, 2, payload, payloadSize);
+    free(payload);
+    return rc;
+}
+
+static void readMsg(unsigned int type, unsigned int payloadSize) {
+    shm_ring_msg_t msg;
+    bool found = shmRing_nextMessage(reader, &msg);
+    CHECK(found);
+    CHECK_EQUAL(type, msg.type);
+    CHECK_EQUAL(1, msg.major);
+    CHECK_EQUAL(2, msg.minor);
+    CHECK_EQUAL(payloadSize, msg.payloadSize);
+    for (unsigned int i = 0; i < payloadSize; i++) {
+        CHECK_EQUAL((char)type, msg.payload[i]);
+    }
+    CHECK(shmRing_messageIntact(reader));
+    shmRing_releaseMessage(reader);
+}
+
+static void writeAndRead(void) {
+    for (unsigned int type = 1; type <= 3; type++) {
+        int rc = writeMsg(type, 10 * type);
+        CHECK_EQUAL(0, rc);
+    }
+    for (unsigned int type = 1; type <= 3; type++) {
+        readMsg(type, 10 * type);
+    }
+
+    shm_ring_msg_t msg;
+    CHECK(!shmRing_nextMessage(reader, &msg));
+}
+
+static void wrapAroundPadding(void) {
+    //three records of 1024 bytes, the writer ends at offset 3072
+    for (unsigned int type = 1; type <= 3; type++) {
+        int rc = writeMsg(type, 1024 - RECORD_HEADER);
+        CHECK_EQUAL(0, rc);
+        readMsg(type, 1024 - RECORD_HEADER);
+    }
+
+    //does not fit in the remaining 1024 bytes, so the end of the ring is padded and the record starts at offset 0
+    int rc = writeMsg(4, 1500);
+    CHECK_EQUAL(0, rc);
+    readMsg(4, 1500);
+
+    rc = writeMsg(5, 100);
+    CHECK_EQUAL(0, rc);
+    readMsg(5, 100);
+
+    shm_ring_statistics_t stats;
+    shmRing_getStatistics(reader, &stats);
+    CHECK_EQUAL(5, stats.nrMsgsRead);
+    CHECK_EQUAL(0, stats.nrOverruns);
+    CHECK_EQUAL(0, stats.nrCorruptRecords);
+}
+
+static void overrun(void) {
+    //five records of 1024 bytes overwrite the first one before the reader started
+    for (unsigned int type = 1; type <= 5; type++) {
+        int rc = writeMsg(type, 1024 - RECORD_HEADER);
+        CHECK_EQUAL(0, rc);
+    }
+
+    shm_ring_msg_t msg;
+    CHECK(!shmRing_nextMessage(reader, &msg));
+
+    shm_ring_statistics_t stats;
+    shmRing_getStatistics(reader, &stats);
+    CHECK_EQUAL(1, stats.nrOverruns);
+
+    //the reader continues at the current write position
+    int rc = writeMsg(6, 100);
+    CHECK_EQUAL(0, rc);
+    readMsg(6, 100);
+}
+
+static void messageIntact(void) {
+    int rc = writeMsg(1, 1024 - RECORD_HEADER);
+    CHECK_EQUAL(0, rc);
+
+    shm_ring_msg_t msg;
+    CHECK(shmRing_nextMessage(reader, &msg));
+
+    //the ring is full, the message in use is not overwritten yet
+    for (unsigned int type = 2; type <= 4; type++) {
+        rc = writeMsg(type, 1024 - RECORD_HEADER);
+        CHECK_EQUAL(0, rc);
+    }
+    CHECK(shmRing_messageIntact(reader));
+
+    //the next record is written over the message in use
+    rc = writeMsg(5, 1024 - RECORD_HEADER);
+    CHECK_EQUAL(0, rc);
+    CHECK(!shmRing_messageIntact(reader));
+    shmRing_releaseMessage(reader);
+}
+
+static void tooLarge(void) {
+    //a record may take at most half of the ring
+    int rc = writeMsg(1, RING_CAPACITY / 2 - RECORD_HEADER + 1);
+    CHECK(rc != 0);
+
+    shm_ring_statistics_t stats;
+    shmRing_getStatistics(writer, &stats);
+    CHECK_EQUAL(1, stats.nrMsgsTooLarge);
+    CHECK_EQUAL(0, stats.nrMsgsWritten);
+
+    shm_ring_msg_t msg;
+    CHECK(!shmRing_nextMessage(reader, &msg));
+
+    rc = writeMsg(2, RING_CAPACITY / 2 - RECORD_HEADER);
+    CHECK_EQUAL(0, rc);
+    readMsg(2, RING_CAPACITY / 2 - RECORD_HEADER);
+}
+
+}
+
+TEST_GROUP(ShmRingTests) {
+    void setup() {
+        setupRings();
+    }
+
+    void teardown() {
+        teardownRings();
+    }
+};
+
+TEST(ShmRingTests, WriteAndRead) {
+    writeAndRead();
+}
+
+TEST(ShmRingTests, WrapAroundPadding) {
+    wrapAroundPadding();
+}
+
+TEST(ShmRingTests, Overrun) {
+    overrun();
+}
+
+TEST(ShmRingTests, MessageIntact) {
+    messageIntact();
+}
+
+TEST(ShmRingTests, TooLarge) {
+    tooLarge();
+}
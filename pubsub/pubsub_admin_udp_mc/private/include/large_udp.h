@@ -34,12 +34,24 @@
 
 typedef struct largeUdp  *largeUdp_pt;
 
+typedef struct largeUdp_statistics {
+	unsigned long nrRecvCalls;        // number of receive system calls
+	unsigned long nrPartsReceived;    // number of valid datagrams received
+	unsigned long nrCorruptParts;     // number of datagrams with an inconsistent header
+	unsigned long nrMsgsReassembled;  // number of completely received messages
+	unsigned long nrMsgsTimedOut;     // number of incomplete messages evicted after the reassembly timeout
+	unsigned long nrMsgsDropped;      // number of incomplete messages evicted because too many were pending
+	unsigned long nrPoolMisses;       // number of reassembly buffers which had to be allocated
+} largeUdp_statistics_t;
+
 largeUdp_pt largeUdp_create(unsigned int maxNrUdpReceptions);
 void largeUdp_destroy(largeUdp_pt handle);
 
 int largeUdp_sendto(largeUdp_pt handle, int fd, void *buf, size_t count, int flags, struct sockaddr_in *dest_addr, size_t addrlen);
 int largeUdp_sendmsg(largeUdp_pt handle, int fd, struct iovec *largeMsg_iovec, int len, int flags, struct sockaddr_in *dest_addr, size_t addrlen);
-bool largeUdp_dataAvailable(largeUdp_pt handle, int fd, unsigned int *index, unsigned int *size);
-int largeUdp_read(largeUdp_pt handle, unsigned int index, void ** buffer, unsigned int size);
+int largeUdp_receive(largeUdp_pt handle, int fd);
+bool largeUdp_nextMessage(largeUdp_pt handle, void **buffer, unsigned int *size);
+void largeUdp_releaseBuffer(largeUdp_pt handle, void *buffer);
+void largeUdp_getStatistics(largeUdp_pt handle, largeUdp_statistics_t *stats);
 
 #endif /* _LARGE_UDP_H_ */
@@ -27,7 +27,10 @@
 #ifndef PUBSUB_ADMIN_UDP_MC_IMPL_H_
 #define PUBSUB_ADMIN_UDP_MC_IMPL_H_
 
+#include <stdio.h>
+
 #include "pubsub_admin.h"
+#include "pubsub_wildcard_subscriptions.h"
 #include "log_helper.h"
 
 #define PUBSUB_ADMIN_TYPE	"udp_mc"
@@ -49,6 +52,7 @@ struct pubsub_admin {
 
 	celix_thread_mutex_t subscriptionsLock;
 	hash_map_pt subscriptions; //<topic(string),topic_subscription>
+	pubsub_wildcard_subscriptions_pt wildcardSubscriptions; //the subscriptions with a wildcard topic, protected by subscriptionsLock
 
 	celix_thread_mutex_t pendingSubscriptionsLock;
 	celix_thread_mutexattr_t pendingSubscriptionsAttr;
@@ -68,6 +72,8 @@ struct pubsub_admin {
 	char* mcIpAddress; // The multicast IP address
 
 	int sendSocket;
+
+	bool localDelivery; // Publications hand messages directly to subscriptions of the same framework (PSA_LOCAL_DELIVERY)
 	void* zmq_context; // to be removed
 
 };
@@ -89,5 +95,8 @@ celix_status_t pubsubAdmin_serializerRemoved(void * handle, service_reference_pt
 
 celix_status_t pubsubAdmin_matchEndpoint(pubsub_admin_pt admin, pubsub_endpoint_pt endpoint, double* score);
 
+/* Shell command printing the receive statistics of all subscriptions, handle is the pubsub_admin_pt */
+celix_status_t pubsubAdmin_executeStatsCommand(void *handle, char *commandLine, FILE *out, FILE *err);
+
 
 #endif /* PUBSUB_ADMIN_UDP_MC_IMPL_H_ */
@@ -32,18 +32,53 @@
 #include "pubsub_common.h"
 
 #include "pubsub_serializer.h"
+#include "topic_subscription.h"
 
 #define UDP_BASE_PORT	49152
 #define UDP_MAX_PORT	65000
 
+/* Topic properties to enable batching of small messages into a single datagram */
+#define PUBSUB_UDP_MC_BATCH_ENABLED_KEY		"udp_mc.batch.enabled"
+#define PUBSUB_UDP_MC_BATCH_MAX_SIZE_KEY	"udp_mc.batch.max_size"
+#define PUBSUB_UDP_MC_BATCH_MAX_LATENCY_KEY	"udp_mc.batch.max_latency_us"
+
+#define UDP_BATCH_DEFAULT_MAX_SIZE		8192
+#define UDP_BATCH_LIMIT_MAX_SIZE		60000
+#define UDP_BATCH_DEFAULT_MAX_LATENCY	1000
+
+/* Msg type id used for a datagram containing a batch of messages, the msg type index rejects it as msg id (see PUBSUB_MSG_TYPE_INDEX_FIRST_MSG_ID) */
+#define UDP_BATCH_MSG_TYPE	0
+
+/*
+ * Subscriptions announce themselves to a publication by sending a compact header with this msg type
+ * and the publisherId of the publication to the multicast address on the port of the publication
+ * plus UDP_ANNOUNCE_PORT_OFFSET, so the publication does not receive its own messages.
+ */
+#define UDP_JOIN_MSG_TYPE			1
+#define UDP_ANNOUNCE_PORT_OFFSET	1
+
 typedef struct pubsub_udp_msg {
     struct pubsub_msg_header header;
     unsigned int payloadSize;
     char payload[];
 } pubsub_udp_msg_t;
 
+/*
+ * Payload of a batch message is a sequence of entries, each one followed by payloadSize bytes.
+ * This is a wire format: an entry is not copied as is, but encoded field by field in UDP_BATCH_ENTRY_SIZE
+ * bytes, with type and payloadSize as 32 bit values in network byte order and no padding.
+ */
+typedef struct pubsub_udp_batch_entry {
+    unsigned int type;
+    unsigned char major;
+    unsigned char minor;
+    unsigned int payloadSize;
+} pubsub_udp_batch_entry_t;
+
+#define UDP_BATCH_ENTRY_SIZE	10
+
 typedef struct topic_publication *topic_publication_pt;
-celix_status_t pubsub_topicPublicationCreate(int sendSocket, pubsub_endpoint_pt pubEP, pubsub_serializer_service_t *best_serializer, char* bindIP, topic_publication_pt *out);
+celix_status_t pubsub_topicPublicationCreate(int sendSocket, pubsub_endpoint_pt pubEP, pubsub_serializer_service_t *best_serializer, char* bindIP, char* ifIp, topic_publication_pt *out);
 celix_status_t pubsub_topicPublicationDestroy(topic_publication_pt pub);
 
 celix_status_t pubsub_topicPublicationAddPublisherEP(topic_publication_pt pub,pubsub_endpoint_pt ep);
@@ -54,4 +89,7 @@ celix_status_t pubsub_topicPublicationStop(topic_publication_pt pub);
 
 array_list_pt pubsub_topicPublicationGetPublisherList(topic_publication_pt pub);
 
+celix_status_t pubsub_topicPublicationAddLocalSubscription(topic_publication_pt pub, topic_subscription_pt sub);
+celix_status_t pubsub_topicPublicationRemoveLocalSubscription(topic_publication_pt pub, topic_subscription_pt sub);
+
 #endif /* TOPIC_PUBLICATION_H_ */
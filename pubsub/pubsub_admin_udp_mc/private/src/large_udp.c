@@ -30,9 +30,14 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <errno.h>
+#include <time.h>
 #include <array_list.h>
+#include <hash_map.h>
 #include <pthread.h>
+#include <sys/socket.h>
 
 #define MAX_UDP_MSG_SIZE 65535   /* 2^16 -1 */
 #define IP_HEADER_SIZE  20
@@ -40,12 +45,32 @@
 //#define MTU_SIZE    1500
 #define MTU_SIZE    8000
 #define MAX_MSG_VECTOR_LEN 64
+#define MAX_MMSG_BATCH_LEN 16
+#define MAX_RECV_BATCH_LEN 8
+#define POOL_BUFFER_SIZE    MAX_UDP_MSG_SIZE
+#define REASSEMBLY_TIMEOUT_MS 1000
 
 //#define NO_IP_FRAGMENTATION
 
+#if defined(__APPLE__) && defined(__MACH__)
+struct mmsghdr {
+	struct msghdr msg_hdr;
+	unsigned int msg_len;
+};
+#endif
+
+typedef struct largeUdp_buffer {
+	unsigned int capacity;
+	char data[];
+} *largeUdp_buffer_pt;
+
 struct largeUdp {
 	unsigned int maxNrLists;
-	array_list_pt udpPartLists;
+	hash_map_pt udpPartLists; // <msg_ident, udpPartList>, messages being reassembled
+	array_list_pt completedLists; // List<udpPartList>, reassembled messages not yet read
+	array_list_pt bufferPool; // List<largeUdp_buffer>, free reassembly buffers of POOL_BUFFER_SIZE
+	char *recvBuffers; // MAX_RECV_BATCH_LEN datagram buffers, allocated at first reception
+	largeUdp_statistics_t stats;
 	pthread_mutex_t dbLock;
 };
 
@@ -53,7 +78,8 @@ typedef struct udpPartList {
 	unsigned int msg_ident;
 	unsigned int msg_size;
 	unsigned int nrPartsRemaining;
-	char *data;
+	struct timespec lastUpdate;
+	largeUdp_buffer_pt buffer;
 } *udpPartList_pt;
 
 
@@ -75,6 +101,14 @@ typedef struct msg_part {
 	char data[MAX_PART_SIZE];
 } msg_part_t;
 
+static int largeUdp_sendBatch(int fd, struct mmsghdr *msgs, unsigned int nrMsgs, int flags);
+
+static largeUdp_buffer_pt largeUdp_acquireBuffer(largeUdp_pt handle, unsigned int size);
+static void largeUdp_putBuffer(largeUdp_pt handle, largeUdp_buffer_pt buffer);
+static void largeUdp_destroyPartList(largeUdp_pt handle, udpPartList_pt udpPartList);
+static void largeUdp_evictPartLists(largeUdp_pt handle, struct timespec *now);
+static void largeUdp_processPart(largeUdp_pt handle, char *datagram, unsigned int len, struct timespec *now);
+
 //
 // Create a handle
 //
@@ -84,10 +118,27 @@ largeUdp_pt largeUdp_create(unsigned int maxNrUdpReceptions)
 	largeUdp_pt handle = calloc(sizeof(*handle), 1);
 	if(handle != NULL) {
 		handle->maxNrLists = maxNrUdpReceptions;
-		if(arrayList_create(&handle->udpPartLists) != CELIX_SUCCESS) {
+		handle->udpPartLists = hashMap_create(NULL, NULL, NULL, NULL);
+		if(arrayList_create(&handle->completedLists) != CELIX_SUCCESS || arrayList_create(&handle->bufferPool) != CELIX_SUCCESS) {
+			hashMap_destroy(handle->udpPartLists, false, false);
+			if(handle->completedLists != NULL) {
+				arrayList_destroy(handle->completedLists);
+			}
 			free(handle);
-			handle = NULL;
+			return NULL;
+		}
+
+		/* One reassembly buffer per message that can be pending, so receiving does not allocate */
+		unsigned int i;
+		for(i = 0; i < handle->maxNrLists; i++) {
+			largeUdp_buffer_pt buffer = malloc(sizeof(*buffer) + POOL_BUFFER_SIZE);
+			if(buffer == NULL) {
+				break;
+			}
+			buffer->capacity = POOL_BUFFER_SIZE;
+			arrayList_add(handle->bufferPool, buffer);
 		}
+
 		pthread_mutex_init(&handle->dbLock, 0);
 	}
 
@@ -102,20 +153,30 @@ void largeUdp_destroy(largeUdp_pt handle)
 	printf("### Destroying large UDP\n");
 	if(handle != NULL) {
 		pthread_mutex_lock(&handle->dbLock);
-		int nrUdpLists = arrayList_size(handle->udpPartLists);
-		int i;
-		for(i=0; i < nrUdpLists; i++) {
-			udpPartList_pt udpPartList = arrayList_remove(handle->udpPartLists, i);
-			if(udpPartList) {
-				if(udpPartList->data) {
-					free(udpPartList->data);
-					udpPartList->data = NULL;
-				}
-				free(udpPartList);
-			}
+		hash_map_iterator_pt iter = hashMapIterator_create(handle->udpPartLists);
+		while(hashMapIterator_hasNext(iter)) {
+			udpPartList_pt udpPartList = hashMapIterator_nextValue(iter);
+			free(udpPartList->buffer);
+			free(udpPartList);
 		}
-		arrayList_destroy(handle->udpPartLists);
+		hashMapIterator_destroy(iter);
+		hashMap_destroy(handle->udpPartLists, false, false);
 		handle->udpPartLists = NULL;
+
+		int i;
+		for(i = 0; i < arrayList_size(handle->completedLists); i++) {
+			udpPartList_pt udpPartList = arrayList_get(handle->completedLists, i);
+			free(udpPartList->buffer);
+			free(udpPartList);
+		}
+		arrayList_destroy(handle->completedLists);
+
+		for(i = 0; i < arrayList_size(handle->bufferPool); i++) {
+			free(arrayList_get(handle->bufferPool, i));
+		}
+		arrayList_destroy(handle->bufferPool);
+
+		free(handle->recvBuffers);
 		pthread_mutex_unlock(&handle->dbLock);
 		pthread_mutex_destroy(&handle->dbLock);
 		free(handle);
@@ -124,75 +185,121 @@ void largeUdp_destroy(largeUdp_pt handle)
 
 //
 // Write large data to UDP. This function splits the data in chunks and sends these chunks with a header over UDP.
+// Where available the chunks are handed to the kernel in batches of MAX_MMSG_BATCH_LEN using sendmmsg().
 //
 int largeUdp_sendmsg(largeUdp_pt handle, int fd, struct iovec *largeMsg_iovec, int len, int flags, struct sockaddr_in *dest_addr, size_t addrlen)
 {
 	int n;
 	int result = 0;
-	msg_part_header_t header;
+	unsigned int msg_ident = (unsigned int)random();
+	unsigned int total_msg_size = 0;
 
 	int written = 0;
-	header.msg_ident = (unsigned int)random();
-	header.total_msg_size = 0;
 	for(n = 0; n < len ;n++) {
-		header.total_msg_size += largeMsg_iovec[n].iov_len;
+		total_msg_size += largeMsg_iovec[n].iov_len;
 	}
-	int nr_buffers = (header.total_msg_size / MAX_PART_SIZE) + 1;
+	int nr_buffers = (total_msg_size / MAX_PART_SIZE) + 1;
 
-	struct iovec msg_iovec[MAX_MSG_VECTOR_LEN];
-	struct msghdr msg;
-	msg.msg_name = dest_addr;
-	msg.msg_namelen = addrlen;
-	msg.msg_flags = 0;
-	msg.msg_iov = msg_iovec;
-	msg.msg_iovlen = 2; // header and payload;
-	msg.msg_control = NULL;
-	msg.msg_controllen = 0;
+	msg_part_header_t headers[MAX_MMSG_BATCH_LEN];
+	struct iovec msg_iovec[MAX_MMSG_BATCH_LEN][MAX_MSG_VECTOR_LEN];
+	struct mmsghdr msgs[MAX_MMSG_BATCH_LEN];
+	int nrMsgs = 0;
 
-	msg.msg_iov[0].iov_base = &header;
-	msg.msg_iov[0].iov_len = sizeof(header);
+	for(n = 0; n < nr_buffers && result == 0; n++) {
+		msg_part_header_t *header = &headers[nrMsgs];
+		struct msghdr *msg = &msgs[nrMsgs].msg_hdr;
 
-	for(n = 0; n < nr_buffers; n++) {
+		header->msg_ident = msg_ident;
+		header->total_msg_size = total_msg_size;
+		header->part_msg_size = (((total_msg_size - n * MAX_PART_SIZE) >  MAX_PART_SIZE) ?  MAX_PART_SIZE  : (total_msg_size - n * MAX_PART_SIZE));
+		header->offset = n * MAX_PART_SIZE;
 
-		header.part_msg_size = (((header.total_msg_size - n * MAX_PART_SIZE) >  MAX_PART_SIZE) ?  MAX_PART_SIZE  : (header.total_msg_size - n * MAX_PART_SIZE));
-		header.offset = n * MAX_PART_SIZE;
-		int remainingOffset = header.offset;
+		msg->msg_name = dest_addr;
+		msg->msg_namelen = addrlen;
+		msg->msg_flags = 0;
+		msg->msg_iov = msg_iovec[nrMsgs];
+		msg->msg_control = NULL;
+		msg->msg_controllen = 0;
+
+		msg->msg_iov[0].iov_base = header;
+		msg->msg_iov[0].iov_len = sizeof(*header);
+
+		int remainingOffset = header->offset;
 		int recvPart = 0;
 		// find the start of the part
 		while(remainingOffset > largeMsg_iovec[recvPart].iov_len) {
 			remainingOffset -= largeMsg_iovec[recvPart].iov_len;
 			recvPart++;
 		}
-		int remainingData = header.part_msg_size;
+		int remainingData = header->part_msg_size;
 		int sendPart = 1;
-		msg.msg_iovlen = 1;
+		msg->msg_iovlen = 1;
 
 		// fill in the output iovec from the input iovec in such a way that all UDP frames are filled maximal.
 		while(remainingData > 0) {
 			int partLen = ( (largeMsg_iovec[recvPart].iov_len - remainingOffset) <= remainingData ? (largeMsg_iovec[recvPart].iov_len -remainingOffset) : remainingData);
-			msg.msg_iov[sendPart].iov_base = largeMsg_iovec[recvPart].iov_base + remainingOffset;
-			msg.msg_iov[sendPart].iov_len = partLen;
+			msg->msg_iov[sendPart].iov_base = largeMsg_iovec[recvPart].iov_base + remainingOffset;
+			msg->msg_iov[sendPart].iov_len = partLen;
 			remainingData -= partLen;
 			remainingOffset = 0;
 			sendPart++;
 			recvPart++;
-			msg.msg_iovlen++;
+			msg->msg_iovlen++;
 		}
-		int tmp, tmptot;
-		for(tmp = 0, tmptot=0; tmp < msg.msg_iovlen; tmp++) {
-			tmptot += msg.msg_iov[tmp].iov_len;
+		nrMsgs++;
+
+		if(nrMsgs == MAX_MMSG_BATCH_LEN || n == nr_buffers - 1) {
+			int w = largeUdp_sendBatch(fd, msgs, nrMsgs, flags);
+			if(w == -1) {
+				result =  -1;
+			}
+			else {
+				written += w;
+			}
+			nrMsgs = 0;
 		}
+	}
 
-		int w = sendmsg(fd, &msg, 0);
+	return (result == 0 ? written : result);
+}
+
+//
+// Sends a set of prepared UDP frames. Returns the number of bytes written or -1 on error.
+//
+static int largeUdp_sendBatch(int fd, struct mmsghdr *msgs, unsigned int nrMsgs, int flags)
+{
+	int written = 0;
+	unsigned int sent = 0;
+
+#if defined(__APPLE__) && defined(__MACH__)
+	// No sendmmsg() on OSX, fall back to one syscall per frame
+	for(sent = 0; sent < nrMsgs; sent++) {
+		int w = sendmsg(fd, &msgs[sent].msg_hdr, flags);
 		if(w == -1) {
-			perror("send()");
-			result =  -1;
-			break;
+			perror("sendmsg()");
+			return -1;
 		}
 		written += w;
 	}
+#else
+	while(sent < nrMsgs) {
+		int nrSent = sendmmsg(fd, &msgs[sent], nrMsgs - sent, flags);
+		if(nrSent == -1) {
+			if(errno == EINTR) {
+				continue;
+			}
+			perror("sendmmsg()");
+			return -1;
+		}
+		int i;
+		for(i = 0; i < nrSent; i++) {
+			written += msgs[sent + i].msg_len;
+		}
+		sent += nrSent;
+	}
+#endif
 
-	return (result == 0 ? written : result);
+	return written;
 }
 
 //
@@ -243,107 +350,70 @@ int largeUdp_sendto(largeUdp_pt handle, int fd, void *buf, size_t count, int fla
 }
 
 //
-// Reads data from the filedescriptor which has date (determined by epoll()) and stores it in the internal structure
-// If the message is completely reassembled true is returned and the index and size have valid values
+// Reads the datagrams available on the filedescriptor (determined by epoll()) and stores them in the internal structure.
+// Where available up to MAX_RECV_BATCH_LEN datagrams are read with a single recvmmsg() call.
+// Returns the number of completely reassembled messages which can be retrieved with largeUdp_nextMessage, or -1 on error.
 //
-bool largeUdp_dataAvailable(largeUdp_pt handle, int fd, unsigned int *index, unsigned int *size) {
-	msg_part_header_t header;
-	int result = false;
-	// Only read the header, we don't know yet where to store the payload
-	if(recv(fd, &header, sizeof(header), MSG_PEEK) < 0) {
-		perror("read()");
-		return false;
-	}
-
-	struct iovec msg_vec[2];
-	struct msghdr msg;
-	msg.msg_name = NULL;
-	msg.msg_namelen = 0;
-	msg.msg_flags = 0;
-	msg.msg_iov = msg_vec;
-	msg.msg_iovlen = 2; // header and payload;
-	msg.msg_control = NULL;
-	msg.msg_controllen = 0;
-
-	msg.msg_iov[0].iov_base = &header;
-	msg.msg_iov[0].iov_len = sizeof(header);
+int largeUdp_receive(largeUdp_pt handle, int fd)
+{
+	int i;
+	int nrReceived = 0;
+	int result = 0;
 
 	pthread_mutex_lock(&handle->dbLock);
 
-	int nrUdpLists = arrayList_size(handle->udpPartLists);
-	int i;
-	bool found = false;
-	for(i = 0; i < nrUdpLists; i++) {
-		udpPartList_pt udpPartList = arrayList_get(handle->udpPartLists, i);
-		if(udpPartList->msg_ident == header.msg_ident) {
-			found = true;
-
-			//sanity check
-			if(udpPartList->msg_size != header.total_msg_size) {
-				// Corruption occurred. Remove the existing administration and build up a new one.
-				arrayList_remove(handle->udpPartLists, i);
-				free(udpPartList->data);
-				free(udpPartList);
-				found = false;
-				break;
-			}
+	if(handle->recvBuffers == NULL) {
+		handle->recvBuffers = malloc(MAX_RECV_BATCH_LEN * MAX_UDP_MSG_SIZE);
+		if(handle->recvBuffers == NULL) {
+			pthread_mutex_unlock(&handle->dbLock);
+			return -1;
+		}
+	}
 
-			msg.msg_iov[1].iov_base = &udpPartList->data[header.offset];
-			msg.msg_iov[1].iov_len = header.part_msg_size;
-			if(recvmsg(fd, &msg, 0)<0){
-				found=true;
-				result=false;
-				break;
-			}
+	struct iovec msg_vec[MAX_RECV_BATCH_LEN];
+	struct mmsghdr msgs[MAX_RECV_BATCH_LEN];
+	memset(msgs, 0, sizeof(msgs));
+	for(i = 0; i < MAX_RECV_BATCH_LEN; i++) {
+		msg_vec[i].iov_base = handle->recvBuffers + i * MAX_UDP_MSG_SIZE;
+		msg_vec[i].iov_len = MAX_UDP_MSG_SIZE;
+		msgs[i].msg_hdr.msg_iov = &msg_vec[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
 
-			udpPartList->nrPartsRemaining--;
-			if(udpPartList->nrPartsRemaining == 0) {
-				*index = i;
-				*size = udpPartList->msg_size;
-				result = true;
-				break;
-			} else {
-				result = false; // not complete
-				break;
-			}
-		}
+#if defined(__APPLE__) && defined(__MACH__)
+	// No recvmmsg() on OSX, read a single datagram
+	int len = recvmsg(fd, &msgs[0].msg_hdr, MSG_DONTWAIT);
+	if(len >= 0) {
+		msgs[0].msg_len = len;
+		nrReceived = 1;
+	}
+	else {
+		nrReceived = -1;
 	}
+#else
+	nrReceived = recvmmsg(fd, msgs, MAX_RECV_BATCH_LEN, MSG_DONTWAIT, NULL);
+#endif
 
-	if(found == false) {
-		udpPartList_pt udpPartList = NULL;
-		if(nrUdpLists == handle->maxNrLists) {
-			// remove list at index 0
-			udpPartList = arrayList_remove(handle->udpPartLists, 0);
-			fprintf(stderr, "ERROR: Removing entry for id %d: %d parts not received\n",udpPartList->msg_ident, udpPartList->nrPartsRemaining );
-			free(udpPartList->data);
-			free(udpPartList);
-			nrUdpLists--;
+	if(nrReceived < 0) {
+		if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+			perror("recvmmsg()");
+			result = -1;
 		}
-		udpPartList = calloc(sizeof(*udpPartList), 1);
-		udpPartList->msg_ident =  header.msg_ident;
-		udpPartList->msg_size =  header.total_msg_size;
-		udpPartList->nrPartsRemaining = header.total_msg_size / MAX_PART_SIZE;
-		udpPartList->data = calloc(sizeof(char), header.total_msg_size);
+		nrReceived = 0;
+	}
+	handle->stats.nrRecvCalls++;
 
-		msg.msg_iov[1].iov_base = &udpPartList->data[header.offset];
-		msg.msg_iov[1].iov_len = header.part_msg_size;
-		if(recvmsg(fd, &msg, 0)<0){
-			free(udpPartList->data);
-			free(udpPartList);
-			result=false;
-		}
-		else{
-			arrayList_add(handle->udpPartLists, udpPartList);
-
-			if(udpPartList->nrPartsRemaining == 0) {
-				*index = nrUdpLists;
-				*size = udpPartList->msg_size;
-				result = true;
-			} else {
-				result = false;
-			}
-		}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
 
+	for(i = 0; i < nrReceived; i++) {
+		largeUdp_processPart(handle, msg_vec[i].iov_base, msgs[i].msg_len, &now);
+	}
+
+	largeUdp_evictPartLists(handle, &now);
+
+	if(result == 0) {
+		result = arrayList_size(handle->completedLists);
 	}
 
 	pthread_mutex_unlock(&handle->dbLock);
@@ -352,21 +422,181 @@ bool largeUdp_dataAvailable(largeUdp_pt handle, int fd, unsigned int *index, uns
 }
 
 //
-// Read out the message which is indicated available by the largeUdp_dataAvailable function
+// Retrieves the next completely reassembled message. The returned buffer must be handed back with largeUdp_releaseBuffer.
 //
-int largeUdp_read(largeUdp_pt handle, unsigned int index, void ** buffer, unsigned int size)
+bool largeUdp_nextMessage(largeUdp_pt handle, void **buffer, unsigned int *size)
 {
-	int result = 0;
+	bool result = false;
 	pthread_mutex_lock(&handle->dbLock);
 
-	udpPartList_pt udpPartList = arrayList_remove(handle->udpPartLists, index);
-	if(udpPartList) {
-		*buffer = udpPartList->data;
+	if(!arrayList_isEmpty(handle->completedLists)) {
+		udpPartList_pt udpPartList = arrayList_remove(handle->completedLists, 0);
+		*buffer = udpPartList->buffer->data;
+		*size = udpPartList->msg_size;
 		free(udpPartList);
-	} else {
-		result = -1;
+		result = true;
 	}
+
 	pthread_mutex_unlock(&handle->dbLock);
 
 	return result;
 }
+
+//
+// Returns a buffer retrieved with largeUdp_nextMessage to the buffer pool
+//
+void largeUdp_releaseBuffer(largeUdp_pt handle, void *buffer)
+{
+	if(buffer != NULL) {
+		largeUdp_buffer_pt buf = (largeUdp_buffer_pt)((char*)buffer - offsetof(struct largeUdp_buffer, data));
+		pthread_mutex_lock(&handle->dbLock);
+		largeUdp_putBuffer(handle, buf);
+		pthread_mutex_unlock(&handle->dbLock);
+	}
+}
+
+void largeUdp_getStatistics(largeUdp_pt handle, largeUdp_statistics_t *stats)
+{
+	pthread_mutex_lock(&handle->dbLock);
+	*stats = handle->stats;
+	pthread_mutex_unlock(&handle->dbLock);
+}
+
+//
+// Stores one received datagram in the reassembly administration. Must be called with dbLock taken.
+//
+static void largeUdp_processPart(largeUdp_pt handle, char *datagram, unsigned int len, struct timespec *now)
+{
+	msg_part_header_t header;
+
+	if(len < sizeof(header)) {
+		handle->stats.nrCorruptParts++;
+		return;
+	}
+	memcpy(&header, datagram, sizeof(header));
+
+	if(header.part_msg_size != len - sizeof(header) || header.offset > header.total_msg_size || header.part_msg_size > header.total_msg_size - header.offset) {
+		handle->stats.nrCorruptParts++;
+		return;
+	}
+	handle->stats.nrPartsReceived++;
+
+	udpPartList_pt udpPartList = hashMap_get(handle->udpPartLists, (void*)(uintptr_t)header.msg_ident);
+
+	//sanity check
+	if(udpPartList != NULL && udpPartList->msg_size != header.total_msg_size) {
+		// Corruption occurred. Remove the existing administration and build up a new one.
+		hashMap_remove(handle->udpPartLists, (void*)(uintptr_t)header.msg_ident);
+		largeUdp_destroyPartList(handle, udpPartList);
+		handle->stats.nrCorruptParts++;
+		udpPartList = NULL;
+	}
+
+	if(udpPartList == NULL) {
+		if(hashMap_size(handle->udpPartLists) >= handle->maxNrLists) {
+			// remove the least recently updated entry
+			udpPartList_pt oldest = NULL;
+			hash_map_iterator_pt iter = hashMapIterator_create(handle->udpPartLists);
+			while(hashMapIterator_hasNext(iter)) {
+				udpPartList_pt candidate = hashMapIterator_nextValue(iter);
+				if(oldest == NULL || candidate->lastUpdate.tv_sec < oldest->lastUpdate.tv_sec ||
+						(candidate->lastUpdate.tv_sec == oldest->lastUpdate.tv_sec && candidate->lastUpdate.tv_nsec < oldest->lastUpdate.tv_nsec)) {
+					oldest = candidate;
+				}
+			}
+			hashMapIterator_destroy(iter);
+			fprintf(stderr, "ERROR: Removing entry for id %u: %u parts not received\n", oldest->msg_ident, oldest->nrPartsRemaining);
+			hashMap_remove(handle->udpPartLists, (void*)(uintptr_t)oldest->msg_ident);
+			largeUdp_destroyPartList(handle, oldest);
+			handle->stats.nrMsgsDropped++;
+		}
+
+		udpPartList = calloc(sizeof(*udpPartList), 1);
+		udpPartList->msg_ident = header.msg_ident;
+		udpPartList->msg_size = header.total_msg_size;
+		udpPartList->nrPartsRemaining = (header.total_msg_size / MAX_PART_SIZE) + 1;
+		udpPartList->buffer = largeUdp_acquireBuffer(handle, header.total_msg_size);
+		if(udpPartList->buffer == NULL) {
+			free(udpPartList);
+			handle->stats.nrMsgsDropped++;
+			return;
+		}
+		hashMap_put(handle->udpPartLists, (void*)(uintptr_t)header.msg_ident, udpPartList);
+	}
+
+	memcpy(&udpPartList->buffer->data[header.offset], datagram + sizeof(header), header.part_msg_size);
+	udpPartList->lastUpdate = *now;
+	udpPartList->nrPartsRemaining--;
+
+	if(udpPartList->nrPartsRemaining == 0) {
+		hashMap_remove(handle->udpPartLists, (void*)(uintptr_t)header.msg_ident);
+		arrayList_add(handle->completedLists, udpPartList);
+		handle->stats.nrMsgsReassembled++;
+	}
+}
+
+//
+// Removes the messages of which no part has been received during REASSEMBLY_TIMEOUT_MS. Must be called with dbLock taken.
+//
+static void largeUdp_evictPartLists(largeUdp_pt handle, struct timespec *now)
+{
+	hash_map_iterator_pt iter = hashMapIterator_create(handle->udpPartLists);
+	while(hashMapIterator_hasNext(iter)) {
+		udpPartList_pt udpPartList = hashMapIterator_nextValue(iter);
+		long elapsedMs = (now->tv_sec - udpPartList->lastUpdate.tv_sec) * 1000 + (now->tv_nsec - udpPartList->lastUpdate.tv_nsec) / 1000000;
+		if(elapsedMs > REASSEMBLY_TIMEOUT_MS) {
+			fprintf(stderr, "ERROR: Reassembly timeout for id %u: %u parts not received\n", udpPartList->msg_ident, udpPartList->nrPartsRemaining);
+			hashMapIterator_remove(iter);
+			largeUdp_destroyPartList(handle, udpPartList);
+			handle->stats.nrMsgsTimedOut++;
+		}
+	}
+	hashMapIterator_destroy(iter);
+}
+
+static void largeUdp_destroyPartList(largeUdp_pt handle, udpPartList_pt udpPartList)
+{
+	largeUdp_putBuffer(handle, udpPartList->buffer);
+	free(udpPartList);
+}
+
+//
+// Takes a reassembly buffer from the pool, which is filled when the handle is created. Messages larger than
+// the pool buffers get a dedicated buffer.
+//
+static largeUdp_buffer_pt largeUdp_acquireBuffer(largeUdp_pt handle, unsigned int size)
+{
+	largeUdp_buffer_pt buffer = NULL;
+
+	if(size <= POOL_BUFFER_SIZE) {
+		if(!arrayList_isEmpty(handle->bufferPool)) {
+			buffer = arrayList_remove(handle->bufferPool, arrayList_size(handle->bufferPool) - 1);
+		}
+		else {
+			buffer = malloc(sizeof(*buffer) + POOL_BUFFER_SIZE);
+			if(buffer != NULL) {
+				buffer->capacity = POOL_BUFFER_SIZE;
+			}
+			handle->stats.nrPoolMisses++;
+		}
+	}
+	else {
+		buffer = malloc(sizeof(*buffer) + size);
+		if(buffer != NULL) {
+			buffer->capacity = size;
+		}
+		handle->stats.nrPoolMisses++;
+	}
+
+	return buffer;
+}
+
+static void largeUdp_putBuffer(largeUdp_pt handle, largeUdp_buffer_pt buffer)
+{
+	if(buffer->capacity == POOL_BUFFER_SIZE && arrayList_size(handle->bufferPool) < handle->maxNrLists) {
+		arrayList_add(handle->bufferPool, buffer);
+	}
+	else {
+		free(buffer);
+	}
+}
@@ -29,6 +29,8 @@
 #include "bundle_activator.h"
 #include "service_registration.h"
 #include "service_tracker.h"
+#include "command.h"
+#include "shell_constants.h"
 
 #include "pubsub_admin_impl.h"
 
@@ -37,6 +39,8 @@ struct activator {
 	pubsub_admin_service_pt adminService;
 	service_registration_pt registration;
 	service_tracker_pt serializerTracker;
+	command_service_t statsCommand;
+	service_registration_pt statsCommandRegistration;
 };
 
 celix_status_t bundleActivator_create(bundle_context_pt context, void **userData) {
@@ -104,6 +108,15 @@ celix_status_t bundleActivator_start(void * userData, bundle_context_pt context)
 
 		status += serviceTracker_open(activator->serializerTracker);
 
+		activator->statsCommand.handle = activator->admin;
+		activator->statsCommand.executeCommand = pubsubAdmin_executeStatsCommand;
+
+		properties_pt props = properties_create();
+		properties_set(props, OSGI_SHELL_COMMAND_NAME, "psa_udp_mc_stats");
+		properties_set(props, OSGI_SHELL_COMMAND_USAGE, "psa_udp_mc_stats");
+		properties_set(props, OSGI_SHELL_COMMAND_DESCRIPTION, "Prints the received, lost and out of order messages and the latency per publisher of every UDP multicast subscription.");
+		status += bundleContext_registerService(context, OSGI_SHELL_COMMAND_SERVICE_NAME, &activator->statsCommand, props, &activator->statsCommandRegistration);
+
 	}
 
 
@@ -114,6 +127,9 @@ celix_status_t bundleActivator_stop(void * userData, bundle_context_pt context)
 	celix_status_t status = CELIX_SUCCESS;
 	struct activator *activator = userData;
 
+	status += serviceRegistration_unregister(activator->statsCommandRegistration);
+	activator->statsCommandRegistration = NULL;
+
 	status += serviceTracker_close(activator->serializerTracker);
 	status += serviceRegistration_unregister(activator->registration);
 
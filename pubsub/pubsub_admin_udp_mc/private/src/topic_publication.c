@@ -21,6 +21,9 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <poll.h>
 
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -35,7 +38,11 @@
 #include "version.h"
 
 #include "topic_publication.h"
+#include "pubsub_msg_type_index.h"
+#include "pubsub_msg_pool.h"
 #include "pubsub_common.h"
+#include "pubsub_msg_header.h"
+#include "pubsub_late_joiner.h"
 #include "publisher.h"
 #include "large_udp.h"
 
@@ -43,7 +50,7 @@
 
 #define EP_ADDRESS_LEN		32
 
-#define FIRST_SEND_DELAY	2
+#define JOIN_POLL_INTERVAL	200 // ms, how often the join thread checks whether it has to stop
 
 struct topic_publication {
 	int sendSocket;
@@ -52,8 +59,47 @@ struct topic_publication {
 	array_list_pt pub_ep_list; //List<pubsub_endpoint>
 	hash_map_pt boundServices; //<bundle_pt,bound_service>
 	celix_thread_mutex_t tp_lock;
+	pubsub_msg_type_index_pt msgTypeIndex; // Local indices of the msg types of all bound services, guarded by tp_lock
 	pubsub_serializer_service_t *serializer;
 	struct sockaddr_in destAddr;
+
+	/* Wire header, seqNr is guarded by tp_lock */
+	bool compactHeader;
+	unsigned int topicId;
+	unsigned int publisherId;
+	unsigned int seqNr;
+
+	/* Batching of small messages, guarded by tp_lock */
+	bool batchEnabled;
+	unsigned int batchMaxSize;
+	unsigned int batchMaxLatency; // in us
+	char *batchBuffer;
+	unsigned int batchLen;
+	unsigned int batchNrMsgs;
+	struct timespec batchStart;
+	struct pubsub_msg_header batchHeader;
+	largeUdp_pt batchLargeUdpHandle;
+	bool batchRunning;
+	celix_thread_t batchFlushThread;
+	celix_thread_cond_t batchCond;
+
+	/* Late joiners, guarded by tp_lock */
+	int announceSocket; // receives the join announcements of subscriptions, -1 when not available
+	unsigned int nrJoins;
+	unsigned int lateJoinerTimeout; // ms
+	bool lateJoinerWaitDone; // the first send is done waiting
+	struct timespec lateJoinerDeadline;
+	pubsub_lvc_pt lvc; // NULL when no last value cache is configured
+	largeUdp_pt lvcLargeUdpHandle;
+	bool joinRunning;
+	celix_thread_t joinThread;
+	celix_thread_cond_t joinCond;
+
+	/* Subscriptions in this framework, never locked while holding tp_lock */
+	celix_thread_mutex_t localSubscriptions_lock; //Recursive, held while delivering to the local subscriptions
+	celix_thread_mutexattr_t localSubscriptions_attr;
+	array_list_pt localSubscriptions; //List<topic_subscription_pt>
+	int nrLocalSubscriptions; //Read without lock on the send path
 };
 
 typedef struct publish_bundle_bound_service {
@@ -63,6 +109,9 @@ typedef struct publish_bundle_bound_service {
 	char *scope;
 	char *topic;
 	hash_map_pt msgTypes;
+	pubsub_msg_serializer_t **msgSerializers; // by local msg type index of the parent
+	unsigned int nrOfMsgSerializers;
+	pubsub_msg_pool_pt msgPool; // msgs allocated for the bundle with allocMsg
 	unsigned short getCount;
 	celix_thread_mutex_t mp_lock;
 	largeUdp_pt largeUdpHandle;
@@ -70,7 +119,10 @@ typedef struct publish_bundle_bound_service {
 
 
 typedef struct pubsub_msg{
-	pubsub_msg_header_pt header;
+	pubsub_msg_header_pt header; // Only used by publications sending the legacy header
+	unsigned int type;
+	unsigned char major;
+	unsigned char minor;
 	char* payload;
 	unsigned int payloadSize;
 } pubsub_msg_t;
@@ -87,12 +139,28 @@ static void pubsub_destroyPublishBundleBoundService(publish_bundle_bound_service
 static int pubsub_topicPublicationSend(void* handle,unsigned int msgTypeId, const void *msg);
 
 static int pubsub_localMsgTypeIdForUUID(void* handle, const char* msgType, unsigned int* msgTypeId);
+static int pubsub_topicPublicationAllocMsg(void* handle, unsigned int msgTypeId, void **msg);
+static int pubsub_topicPublicationSendAndFreeMsg(void* handle, unsigned int msgTypeId, void *msg);
+static int pubsub_topicPublicationFreeMsg(void* handle, unsigned int msgTypeId, void *msg);
+
+
+static int open_announce_socket(char* mcIp, char* ifIp, unsigned int port);
+static void wait_for_late_joiners(topic_publication_pt pub);
+static int pubsub_topicPublicationSendDatagram(topic_publication_pt pub, largeUdp_pt largeUdpHandle, struct iovec *msg_iovec, int iovec_len);
+static bool pubsub_topicPublicationResendCached(void *handle, struct iovec *parts, unsigned int nrParts);
+static void* pubsub_topicPublicationJoinThread(void *arg);
 
+static int pubsub_topicPublicationEncodeHeader(topic_publication_pt pub, pubsub_msg_t *msg, unsigned char *compactHdr, struct iovec *msg_iovec);
 
-static void delay_first_send_for_late_joiners(void);
+static void pubsub_topicPublicationConfigureBatching(topic_publication_pt pub, properties_pt topic_props);
+static bool pubsub_topicPublicationBatchMsg(topic_publication_pt pub, pubsub_msg_t *msg);
+static bool pubsub_topicPublicationFlushBatch(topic_publication_pt pub);
+static void* pubsub_topicPublicationFlushThread(void *arg);
 
+static void deliver_local_msg(topic_publication_pt pub, pubsub_msg_serializer_t *msgSer, const void *msg);
 
-celix_status_t pubsub_topicPublicationCreate(int sendSocket, pubsub_endpoint_pt pubEP, pubsub_serializer_service_t *best_serializer, char* bindIP, topic_publication_pt *out){
+
+celix_status_t pubsub_topicPublicationCreate(int sendSocket, pubsub_endpoint_pt pubEP, pubsub_serializer_service_t *best_serializer, char* bindIP, char* ifIp, topic_publication_pt *out){
 
 	char* ep = malloc(EP_ADDRESS_LEN);
 	memset(ep,0,EP_ADDRESS_LEN);
@@ -105,6 +173,7 @@ celix_status_t pubsub_topicPublicationCreate(int sendSocket, pubsub_endpoint_pt
 	arrayList_create(&(pub->pub_ep_list));
 	pub->boundServices = hashMap_create(NULL,NULL,NULL,NULL);
 	celixThreadMutex_create(&(pub->tp_lock),NULL);
+	pubsubMsgTypeIndex_create(&pub->msgTypeIndex);
 
 	pub->endpoint = ep;
 	pub->sendSocket = sendSocket;
@@ -114,6 +183,38 @@ celix_status_t pubsub_topicPublicationCreate(int sendSocket, pubsub_endpoint_pt
 
 	pub->serializer = best_serializer;
 
+	arrayList_create(&(pub->localSubscriptions));
+	celixThreadMutexAttr_create(&(pub->localSubscriptions_attr));
+	celixThreadMutexAttr_settype(&(pub->localSubscriptions_attr), CELIX_THREAD_MUTEX_RECURSIVE);
+	celixThreadMutex_create(&(pub->localSubscriptions_lock), &(pub->localSubscriptions_attr));
+
+	pub->compactHeader = pubsubMsgHeader_useCompact(pubEP->topic_props);
+	pub->topicId = utils_stringHash(pubEP->topic);
+	pub->publisherId = utils_stringHash(pub->endpoint);
+	if(pub->compactHeader){
+		printf("PSA_UDP_MC_TP: Using the compact wire header for topic %s.\n", pubEP->topic);
+	}
+
+	celixThreadCondition_init(&pub->joinCond, NULL);
+	pub->lateJoinerTimeout = pubsubLateJoiner_getTimeout(pubEP->topic_props);
+	unsigned int lvcSize = pubsubLateJoiner_getLvcSize(pubEP->topic_props);
+	pub->announceSocket = -1;
+	if(pub->lateJoinerTimeout > 0 || lvcSize > 0){
+		pub->announceSocket = open_announce_socket(bindIP, ifIp, port + UDP_ANNOUNCE_PORT_OFFSET);
+	}
+	pub->lateJoinerWaitDone = (pub->announceSocket < 0 || pub->lateJoinerTimeout == 0);
+
+	if(lvcSize > 0 && pub->announceSocket >= 0 && pubsubLvc_create(lvcSize, &pub->lvc) == CELIX_SUCCESS){
+		pub->lvcLargeUdpHandle = largeUdp_create(1);
+		printf("PSA_UDP_MC_TP: Replaying the last %u messages of topic %s to late joiners.\n", lvcSize, pubEP->topic);
+	}
+
+	pubsub_topicPublicationConfigureBatching(pub, pubEP->topic_props);
+	if(pub->batchEnabled){
+		strncpy(pub->batchHeader.topic, pubEP->topic, MAX_TOPIC_LEN-1);
+		pub->batchHeader.type = UDP_BATCH_MSG_TYPE;
+	}
+
 	pubsub_topicPublicationAddPublisherEP(pub,pubEP);
 
 	*out = pub;
@@ -140,6 +241,21 @@ celix_status_t pubsub_topicPublicationDestroy(topic_publication_pt pub){
 	pub->svcFactoryReg = NULL;
 	pub->serializer = NULL;
 
+	if(pub->batchEnabled){
+		free(pub->batchBuffer);
+		largeUdp_destroy(pub->batchLargeUdpHandle);
+		celixThreadCondition_destroy(&pub->batchCond);
+	}
+
+	if(pub->lvc != NULL){
+		pubsubLvc_destroy(pub->lvc);
+		largeUdp_destroy(pub->lvcLargeUdpHandle);
+	}
+	if(pub->announceSocket >= 0){
+		close(pub->announceSocket);
+	}
+	celixThreadCondition_destroy(&pub->joinCond);
+
 	if(close(pub->sendSocket) != 0){
 		status = CELIX_FILE_IO_EXCEPTION;
 	}
@@ -147,6 +263,13 @@ celix_status_t pubsub_topicPublicationDestroy(topic_publication_pt pub){
 	celixThreadMutex_unlock(&(pub->tp_lock));
 
 	celixThreadMutex_destroy(&(pub->tp_lock));
+	pubsubMsgTypeIndex_destroy(pub->msgTypeIndex);
+
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	arrayList_destroy(pub->localSubscriptions);
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+	celixThreadMutex_destroy(&(pub->localSubscriptions_lock));
+	celixThreadMutexAttr_destroy(&(pub->localSubscriptions_attr));
 
 	free(pub);
 
@@ -170,14 +293,37 @@ celix_status_t pubsub_topicPublicationStart(bundle_context_pt bundle_context,top
 		properties_set(props,PUBSUB_PUBLISHER_SCOPE,pubEP->scope);
 		properties_set(props,PUBSUB_PUBLISHER_TOPIC,pubEP->topic);
 
+		/* The join state has to be complete before the first publisher can send */
+		celixThreadMutex_lock(&(pub->tp_lock));
+		if(pub->announceSocket >= 0){
+			pub->joinRunning = true;
+			if(celixThread_create(&pub->joinThread, NULL, pubsub_topicPublicationJoinThread, pub) != CELIX_SUCCESS){
+				pub->joinRunning = false;
+				pub->lateJoinerWaitDone = true;
+			}
+		}
+		celixThreadMutex_unlock(&(pub->tp_lock));
+
 		status = bundleContext_registerServiceFactory(bundle_context,PUBSUB_PUBLISHER_SERVICE_NAME,factory,props,&(pub->svcFactoryReg));
 
 		if(status != CELIX_SUCCESS){
 			properties_destroy(props);
 			printf("PSA_UDP_MC_PSA_UDP_MC_TP: Cannot register ServiceFactory for topic %s, topic %s (bundle %ld).\n",pubEP->scope, pubEP->topic,pubEP->serviceID);
+
+			celixThreadMutex_lock(&(pub->tp_lock));
+			bool joinWasRunning = pub->joinRunning;
+			pub->joinRunning = false;
+			celixThreadMutex_unlock(&(pub->tp_lock));
+			if(joinWasRunning){
+				celixThread_join(pub->joinThread, NULL);
+			}
 		}
 		else{
 			*svcFactory = factory;
+			if(pub->batchEnabled){
+				pub->batchRunning = true;
+				status = celixThread_create(&pub->batchFlushThread, NULL, pubsub_topicPublicationFlushThread, pub);
+			}
 		}
 	}
 	else{
@@ -189,7 +335,35 @@ celix_status_t pubsub_topicPublicationStart(bundle_context_pt bundle_context,top
 }
 
 celix_status_t pubsub_topicPublicationStop(topic_publication_pt pub){
-	return serviceRegistration_unregister(pub->svcFactoryReg);
+	celix_status_t status = serviceRegistration_unregister(pub->svcFactoryReg);
+
+	celixThreadMutex_lock(&(pub->tp_lock));
+	bool joinWasRunning = pub->joinRunning;
+	pub->joinRunning = false;
+	celixThreadCondition_broadcast(&pub->joinCond);
+	celixThreadMutex_unlock(&(pub->tp_lock));
+	if(joinWasRunning){
+		celixThread_join(pub->joinThread, NULL);
+	}
+
+	if(pub->batchEnabled){
+		celixThreadMutex_lock(&(pub->tp_lock));
+		bool wasRunning = pub->batchRunning;
+		pub->batchRunning = false;
+		celixThreadCondition_signal(&pub->batchCond);
+		celixThreadMutex_unlock(&(pub->tp_lock));
+
+		if(wasRunning){
+			celixThread_join(pub->batchFlushThread, NULL);
+		}
+
+		/* Do not lose what has been published before stopping */
+		celixThreadMutex_lock(&(pub->tp_lock));
+		pubsub_topicPublicationFlushBatch(pub);
+		celixThreadMutex_unlock(&(pub->tp_lock));
+	}
+
+	return status;
 }
 
 celix_status_t pubsub_topicPublicationAddPublisherEP(topic_publication_pt pub,pubsub_endpoint_pt ep){
@@ -219,6 +393,29 @@ array_list_pt pubsub_topicPublicationGetPublisherList(topic_publication_pt pub){
 	return list;
 }
 
+celix_status_t pubsub_topicPublicationAddLocalSubscription(topic_publication_pt pub, topic_subscription_pt sub){
+
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	if(!arrayList_contains(pub->localSubscriptions,sub)){
+		arrayList_add(pub->localSubscriptions,sub);
+		__atomic_store_n(&pub->nrLocalSubscriptions, arrayList_size(pub->localSubscriptions), __ATOMIC_RELEASE);
+	}
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_topicPublicationRemoveLocalSubscription(topic_publication_pt pub, topic_subscription_pt sub){
+
+	/* Blocks until a delivery in progress to this subscription is finished */
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	arrayList_removeElement(pub->localSubscriptions,sub);
+	__atomic_store_n(&pub->nrLocalSubscriptions, arrayList_size(pub->localSubscriptions), __ATOMIC_RELEASE);
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+
+	return CELIX_SUCCESS;
+}
+
 
 static celix_status_t pubsub_topicPublicationGetService(void* handle, bundle_pt bundle, service_registration_pt registration, void **service) {
 	celix_status_t  status = CELIX_SUCCESS;
@@ -278,20 +475,16 @@ static celix_status_t pubsub_topicPublicationUngetService(void* handle, bundle_p
 }
 
 static bool send_pubsub_msg(publish_bundle_bound_service_pt bound, pubsub_msg_t* msg, bool last, pubsub_release_callback_t *releaseCallback){
-	const int iovec_len = 3; // header + size + payload
 	bool ret = true;
 
-	struct iovec msg_iovec[iovec_len];
-	msg_iovec[0].iov_base = msg->header;
-	msg_iovec[0].iov_len = sizeof(*msg->header);
-	msg_iovec[1].iov_base = &msg->payloadSize;
-	msg_iovec[1].iov_len = sizeof(msg->payloadSize);
-	msg_iovec[2].iov_base = msg->payload;
-	msg_iovec[2].iov_len = msg->payloadSize;
-
-	delay_first_send_for_late_joiners();
+	struct iovec msg_iovec[3]; // header (+ size) + payload
+	unsigned char compactHdr[PUBSUB_COMPACT_HEADER_SIZE];
+	int iovec_len = pubsub_topicPublicationEncodeHeader(bound->parent, msg, compactHdr, msg_iovec);
+	msg_iovec[iovec_len].iov_base = msg->payload;
+	msg_iovec[iovec_len].iov_len = msg->payloadSize;
+	iovec_len++;
 
-	if(largeUdp_sendmsg(bound->largeUdpHandle, bound->parent->sendSocket, msg_iovec, iovec_len, 0, &bound->parent->destAddr, sizeof(bound->parent->destAddr)) == -1) {
+	if(pubsub_topicPublicationSendDatagram(bound->parent, bound->largeUdpHandle, msg_iovec, iovec_len) == -1) {
 		perror("send_pubsub_msg:sendSocket");
 		ret = false;
 	}
@@ -309,21 +502,28 @@ static int pubsub_topicPublicationSend(void* handle, unsigned int msgTypeId, con
 	publish_bundle_bound_service_pt bound = (publish_bundle_bound_service_pt) handle;
 
 	celixThreadMutex_lock(&(bound->parent->tp_lock));
+
+	/* The wait releases tp_lock, so it is done before taking mp_lock (the order unget uses) and before any state is read */
+	wait_for_late_joiners(bound->parent);
+
 	celixThreadMutex_lock(&(bound->mp_lock));
 
-	pubsub_msg_serializer_t* msgSer = (pubsub_msg_serializer_t*)hashMap_get(bound->msgTypes, (void*)(intptr_t)msgTypeId);
+	pubsub_msg_serializer_t* msgSer = pubsubMsgTypeIndex_getSerializer(bound->msgSerializers, bound->nrOfMsgSerializers, pubsubMsgTypeIndex_get(bound->parent->msgTypeIndex, msgTypeId));
 
 	if (msgSer != NULL) {
 		int major=0, minor=0;
 
-		pubsub_msg_header_pt msg_hdr = calloc(1,sizeof(struct pubsub_msg_header));
-		strncpy(msg_hdr->topic,bound->topic,MAX_TOPIC_LEN-1);
-		msg_hdr->type = msgTypeId;
-
-
 		if (msgSer->msgVersion != NULL){
 			version_getMajor(msgSer->msgVersion, &major);
 			version_getMinor(msgSer->msgVersion, &minor);
+		}
+
+		/* The compact header is encoded while sending, only the legacy one needs the topic copied in */
+		pubsub_msg_header_pt msg_hdr = NULL;
+		if(!bound->parent->compactHeader){
+			msg_hdr = calloc(1,sizeof(struct pubsub_msg_header));
+			strncpy(msg_hdr->topic,bound->topic,MAX_TOPIC_LEN-1);
+			msg_hdr->type = msgTypeId;
 			msg_hdr->major = major;
 			msg_hdr->minor = minor;
 		}
@@ -334,11 +534,21 @@ static int pubsub_topicPublicationSend(void* handle, unsigned int msgTypeId, con
 
 		pubsub_msg_t *msg = calloc(1,sizeof(pubsub_msg_t));
 		msg->header = msg_hdr;
+		msg->type = msgTypeId;
+		msg->major = major;
+		msg->minor = minor;
 		msg->payload = (char*)serializedOutput;
 		msg->payloadSize = serializedOutputLen;
 
 
-		if(send_pubsub_msg(bound, msg,true, NULL) == false) {
+		bool sent = false;
+		if(bound->parent->batchEnabled){
+			sent = pubsub_topicPublicationBatchMsg(bound->parent, msg);
+		}
+		else{
+			sent = send_pubsub_msg(bound, msg, true, NULL);
+		}
+		if(sent == false) {
 			status = -1;
 		}
 		free(msg_hdr);
@@ -354,9 +564,59 @@ static int pubsub_topicPublicationSend(void* handle, unsigned int msgTypeId, con
 	celixThreadMutex_unlock(&(bound->mp_lock));
 	celixThreadMutex_unlock(&(bound->parent->tp_lock));
 
+	/* Subscribers in this framework get the message directly, outside the locks */
+	if(msgSer != NULL && __atomic_load_n(&bound->parent->nrLocalSubscriptions, __ATOMIC_ACQUIRE) > 0){
+		deliver_local_msg(bound->parent, msgSer, inMsg);
+	}
+
+	return status;
+}
+
+static void deliver_local_msg(topic_publication_pt pub, pubsub_msg_serializer_t *msgSer, const void *msg){
+
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	unsigned int i = 0;
+	for(;i<arrayList_size(pub->localSubscriptions);i++){
+		topic_subscription_pt sub = (topic_subscription_pt)arrayList_get(pub->localSubscriptions,i);
+		pubsub_topicSubscriptionDeliverLocal(sub, msgSer, msg);
+	}
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+}
+
+static int pubsub_topicPublicationAllocMsg(void* handle, unsigned int msgTypeId, void **msg){
+	publish_bundle_bound_service_pt bound = (publish_bundle_bound_service_pt) handle;
+
+	celixThreadMutex_lock(&(bound->parent->tp_lock));
+	int localIndex = pubsubMsgTypeIndex_get(bound->parent->msgTypeIndex, msgTypeId);
+	celixThreadMutex_unlock(&(bound->parent->tp_lock));
+
+	if (bound->msgPool == NULL || pubsubMsgPool_alloc(bound->msgPool, localIndex, msg) != CELIX_SUCCESS) {
+		printf("PSA_UDP_MC_TP: Cannot allocate a msg for msg type id %d\n", msgTypeId);
+		return -1;
+	}
+	return 0;
+}
+
+static int pubsub_topicPublicationSendAndFreeMsg(void* handle, unsigned int msgTypeId, void *msg){
+	int status = pubsub_topicPublicationSend(handle, msgTypeId, msg);
+	pubsub_topicPublicationFreeMsg(handle, msgTypeId, msg);
 	return status;
 }
 
+static int pubsub_topicPublicationFreeMsg(void* handle, unsigned int msgTypeId, void *msg){
+	publish_bundle_bound_service_pt bound = (publish_bundle_bound_service_pt) handle;
+
+	celixThreadMutex_lock(&(bound->parent->tp_lock));
+	int localIndex = pubsubMsgTypeIndex_get(bound->parent->msgTypeIndex, msgTypeId);
+	celixThreadMutex_unlock(&(bound->parent->tp_lock));
+
+	if (bound->msgPool == NULL || pubsubMsgPool_free(bound->msgPool, localIndex, msg) != CELIX_SUCCESS) {
+		printf("PSA_UDP_MC_TP: Cannot free a pooled msg for msg type id %d\n", msgTypeId);
+		return -1;
+	}
+	return 0;
+}
+
 static int pubsub_localMsgTypeIdForUUID(void* handle, const char* msgType, unsigned int* msgTypeId){
 	*msgTypeId = utils_stringHash(msgType);
 	return 0;
@@ -383,6 +643,8 @@ static publish_bundle_bound_service_pt pubsub_createPublishBundleBoundService(to
 
 		if(tp->serializer != NULL){
 			tp->serializer->createSerializerMap(tp->serializer->handle,bundle,&bound->msgTypes);
+			pubsubMsgTypeIndex_bind(tp->msgTypeIndex,bound->msgTypes,&bound->msgSerializers,&bound->nrOfMsgSerializers);
+			pubsubMsgPool_create(bound->msgSerializers,bound->nrOfMsgSerializers,PUBSUB_MSG_POOL_DEFAULT_MAX_PER_TYPE,&bound->msgPool);
 		}
 
 		pubsub_endpoint_pt pubEP = (pubsub_endpoint_pt)arrayList_get(bound->parent->pub_ep_list,0);
@@ -394,6 +656,9 @@ static publish_bundle_bound_service_pt pubsub_createPublishBundleBoundService(to
 		bound->service.localMsgTypeIdForMsgType = pubsub_localMsgTypeIdForUUID;
 		bound->service.send = pubsub_topicPublicationSend;
 		bound->service.sendMultipart = NULL;  //Multipart not supported for UDP
+		bound->service.allocMsg = pubsub_topicPublicationAllocMsg;
+		bound->service.sendAndFreeMsg = pubsub_topicPublicationSendAndFreeMsg;
+		bound->service.freeMsg = pubsub_topicPublicationFreeMsg;
 
 	}
 
@@ -404,9 +669,14 @@ static void pubsub_destroyPublishBundleBoundService(publish_bundle_bound_service
 
 	celixThreadMutex_lock(&boundSvc->mp_lock);
 
+	if(boundSvc->msgPool != NULL){
+		pubsubMsgPool_destroy(boundSvc->msgPool);
+	}
+
 	if(boundSvc->parent->serializer != NULL && boundSvc->msgTypes != NULL){
 		boundSvc->parent->serializer->destroySerializerMap(boundSvc->parent->serializer->handle, boundSvc->msgTypes);
 	}
+	free(boundSvc->msgSerializers);
 
 	if(boundSvc->scope!=NULL){
 		free(boundSvc->scope);
@@ -425,13 +695,304 @@ static void pubsub_destroyPublishBundleBoundService(publish_bundle_bound_service
 
 }
 
-static void delay_first_send_for_late_joiners(){
+/* Socket joined to the multicast address on the announce port of the publication, -1 on failure */
+static int open_announce_socket(char* mcIp, char* ifIp, unsigned int port){
+
+	int announceSocket = socket(AF_INET, SOCK_DGRAM, 0);
+	if(announceSocket < 0){
+		perror("open_announce_socket:socket");
+		return -1;
+	}
+
+	int reuse = 1;
+	if(setsockopt(announceSocket, SOL_SOCKET, SO_REUSEADDR, (char*) &reuse, sizeof(reuse)) != 0){
+		perror("open_announce_socket:SO_REUSEADDR");
+		close(announceSocket);
+		return -1;
+	}
+
+	struct ip_mreq mc_addr;
+	mc_addr.imr_multiaddr.s_addr = inet_addr(mcIp);
+	mc_addr.imr_interface.s_addr = (ifIp != NULL) ? inet_addr(ifIp) : INADDR_ANY;
+	if(setsockopt(announceSocket, IPPROTO_IP, IP_ADD_MEMBERSHIP, (char*) &mc_addr, sizeof(mc_addr)) != 0){
+		perror("open_announce_socket:IP_ADD_MEMBERSHIP");
+		close(announceSocket);
+		return -1;
+	}
+
+	struct sockaddr_in listenAddr;
+	memset(&listenAddr, 0, sizeof(listenAddr));
+	listenAddr.sin_family = AF_INET;
+	listenAddr.sin_addr.s_addr = INADDR_ANY;
+	listenAddr.sin_port = htons(port);
+	if(bind(announceSocket, (struct sockaddr*)&listenAddr, sizeof(listenAddr)) != 0){
+		perror("open_announce_socket:bind");
+		close(announceSocket);
+		return -1;
+	}
+
+	return announceSocket;
+}
+
+/*
+ * Lets the first send(s) of the publication wait until a subscription announced itself,
+ * at most lateJoinerTimeout ms. Must be called with tp_lock taken and no other lock, the wait releases tp_lock.
+ * Messages are only sent or batched after this wait is done, so the functions below never wait.
+ */
+static void wait_for_late_joiners(topic_publication_pt pub){
+
+	if(pub->lateJoinerWaitDone){
+		return;
+	}
+
+	if(pub->lateJoinerDeadline.tv_sec == 0){
+		clock_gettime(CLOCK_REALTIME, &pub->lateJoinerDeadline);
+		pub->lateJoinerDeadline.tv_sec += pub->lateJoinerTimeout / 1000;
+		pub->lateJoinerDeadline.tv_nsec += (pub->lateJoinerTimeout % 1000) * 1000000L;
+		if(pub->lateJoinerDeadline.tv_nsec >= 1000000000L){
+			pub->lateJoinerDeadline.tv_sec++;
+			pub->lateJoinerDeadline.tv_nsec -= 1000000000L;
+		}
+	}
 
-	static bool firstSend = true;
+	int rc = 0;
+	while(pub->nrJoins == 0 && pub->joinRunning && rc != ETIMEDOUT){
+		rc = pthread_cond_timedwait(&pub->joinCond, &(pub->tp_lock), &pub->lateJoinerDeadline);
+	}
 
-	if(firstSend){
-		printf("PSA_UDP_MC_TP: Delaying first send for late joiners...\n");
-		sleep(FIRST_SEND_DELAY);
-		firstSend = false;
+	if(!pub->lateJoinerWaitDone && pub->nrJoins == 0){
+		printf("PSA_UDP_MC_TP: No subscriber joined %s within %u ms, sending anyway.\n", pub->endpoint, pub->lateJoinerTimeout);
 	}
+	pub->lateJoinerWaitDone = true;
+}
+
+/* Sends a datagram of the publication and keeps a copy in the last value cache. Must be called with tp_lock taken. */
+static int pubsub_topicPublicationSendDatagram(topic_publication_pt pub, largeUdp_pt largeUdpHandle, struct iovec *msg_iovec, int iovec_len){
+
+	if(pub->lvc != NULL){
+		pubsubLvc_add(pub->lvc, msg_iovec, iovec_len);
+	}
+
+	return largeUdp_sendmsg(largeUdpHandle, pub->sendSocket, msg_iovec, iovec_len, 0, &pub->destAddr, sizeof(pub->destAddr));
+}
+
+static bool pubsub_topicPublicationResendCached(void *handle, struct iovec *parts, unsigned int nrParts){
+	topic_publication_pt pub = (topic_publication_pt)handle;
+
+	if(largeUdp_sendmsg(pub->lvcLargeUdpHandle, pub->sendSocket, parts, nrParts, 0, &pub->destAddr, sizeof(pub->destAddr)) == -1){
+		perror("pubsub_topicPublicationResendCached:sendSocket");
+		return false;
+	}
+	return true;
+}
+
+/* Receives the join announcements of subscriptions, releases waiting sends and replays the last value cache */
+static void* pubsub_topicPublicationJoinThread(void *arg){
+	topic_publication_pt pub = (topic_publication_pt)arg;
+	unsigned char buf[PUBSUB_COMPACT_HEADER_SIZE];
+	bool running = true;
+
+	while(running){
+		struct pollfd pfd;
+		pfd.fd = pub->announceSocket;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+
+		if(poll(&pfd, 1, JOIN_POLL_INTERVAL) > 0){
+			struct pubsub_msg_compact_header hdr;
+			ssize_t size = recv(pub->announceSocket, buf, sizeof(buf), MSG_DONTWAIT);
+			if(size > 0 && pubsubMsgHeader_decodeCompact(buf, size, &hdr) && hdr.type == UDP_JOIN_MSG_TYPE && hdr.publisherId == pub->publisherId){
+				celixThreadMutex_lock(&(pub->tp_lock));
+				pub->nrJoins++;
+				celixThreadCondition_broadcast(&pub->joinCond);
+				if(pub->lvc != NULL){
+					unsigned int nrSent = pubsubLvc_replay(pub->lvc, pubsub_topicPublicationResendCached, pub);
+					printf("PSA_UDP_MC_TP: Subscriber joined %s, resent %u cached messages.\n", pub->endpoint, nrSent);
+				}
+				celixThreadMutex_unlock(&(pub->tp_lock));
+			}
+		}
+
+		celixThreadMutex_lock(&(pub->tp_lock));
+		running = pub->joinRunning;
+		celixThreadMutex_unlock(&(pub->tp_lock));
+	}
+
+	return NULL;
+}
+
+static void pubsub_topicPublicationConfigureBatching(topic_publication_pt pub, properties_pt topic_props){
+	const char *enabled = NULL;
+	const char *maxSize = NULL;
+	const char *maxLatency = NULL;
+
+	if(topic_props != NULL){
+		enabled = properties_get(topic_props, PUBSUB_UDP_MC_BATCH_ENABLED_KEY);
+		maxSize = properties_get(topic_props, PUBSUB_UDP_MC_BATCH_MAX_SIZE_KEY);
+		maxLatency = properties_get(topic_props, PUBSUB_UDP_MC_BATCH_MAX_LATENCY_KEY);
+	}
+
+	pub->batchEnabled = (enabled != NULL && strcmp(enabled, "true") == 0);
+	if(!pub->batchEnabled){
+		return;
+	}
+
+	pub->batchMaxSize = (maxSize != NULL) ? (unsigned int)strtoul(maxSize, NULL, 10) : UDP_BATCH_DEFAULT_MAX_SIZE;
+	if(pub->batchMaxSize <= UDP_BATCH_ENTRY_SIZE || pub->batchMaxSize > UDP_BATCH_LIMIT_MAX_SIZE){
+		printf("PSA_UDP_MC_TP: Invalid batch size %u, using %u.\n", pub->batchMaxSize, UDP_BATCH_DEFAULT_MAX_SIZE);
+		pub->batchMaxSize = UDP_BATCH_DEFAULT_MAX_SIZE;
+	}
+	pub->batchMaxLatency = (maxLatency != NULL) ? (unsigned int)strtoul(maxLatency, NULL, 10) : UDP_BATCH_DEFAULT_MAX_LATENCY;
+
+	pub->batchBuffer = malloc(pub->batchMaxSize);
+	pub->batchLargeUdpHandle = largeUdp_create(1);
+	celixThreadCondition_init(&pub->batchCond, NULL);
+
+	printf("PSA_UDP_MC_TP: Batching enabled (max size %u bytes, max latency %u us).\n", pub->batchMaxSize, pub->batchMaxLatency);
+}
+
+/*
+ * Appends a message to the pending batch. Messages that do not fit in an empty batch are sent directly,
+ * after the pending batch is flushed to preserve the ordering. Must be called with tp_lock taken.
+ */
+static bool pubsub_topicPublicationBatchMsg(topic_publication_pt pub, pubsub_msg_t *msg){
+	bool ret = true;
+	unsigned int entrySize = UDP_BATCH_ENTRY_SIZE + msg->payloadSize;
+
+	if(pub->batchLen + entrySize > pub->batchMaxSize){
+		ret = pubsub_topicPublicationFlushBatch(pub);
+	}
+
+	if(entrySize > pub->batchMaxSize){
+		struct iovec msg_iovec[3];
+		unsigned char compactHdr[PUBSUB_COMPACT_HEADER_SIZE];
+		int iovec_len = pubsub_topicPublicationEncodeHeader(pub, msg, compactHdr, msg_iovec);
+		msg_iovec[iovec_len].iov_base = msg->payload;
+		msg_iovec[iovec_len].iov_len = msg->payloadSize;
+		iovec_len++;
+
+		if(pubsub_topicPublicationSendDatagram(pub, pub->batchLargeUdpHandle, msg_iovec, iovec_len) == -1) {
+			perror("pubsub_topicPublicationBatchMsg:sendSocket");
+			ret = false;
+		}
+		return ret;
+	}
+
+	unsigned char *entry = (unsigned char *)pub->batchBuffer + pub->batchLen;
+	uint32_t netType = htonl(msg->type);
+	uint32_t netPayloadSize = htonl(msg->payloadSize);
+	memcpy(entry, &netType, sizeof(netType));
+	entry[4] = msg->major;
+	entry[5] = msg->minor;
+	memcpy(entry + 6, &netPayloadSize, sizeof(netPayloadSize));
+	memcpy(entry + UDP_BATCH_ENTRY_SIZE, msg->payload, msg->payloadSize);
+	pub->batchLen += entrySize;
+	pub->batchNrMsgs++;
+
+	if(pub->batchNrMsgs == 1){
+		/* First message of a new batch starts the latency timer */
+		clock_gettime(CLOCK_REALTIME, &pub->batchStart);
+		celixThreadCondition_signal(&pub->batchCond);
+	}
+
+	return ret;
+}
+
+/*
+ * Sends the pending batch (if any) as one datagram. Must be called with tp_lock taken, which is not released
+ * between reading and resetting the batch.
+ */
+static bool pubsub_topicPublicationFlushBatch(topic_publication_pt pub){
+	bool ret = true;
+
+	if(pub->batchNrMsgs == 0){
+		return ret;
+	}
+
+	pubsub_msg_t batchMsg;
+	memset(&batchMsg, 0, sizeof(batchMsg));
+	batchMsg.header = &pub->batchHeader;
+	batchMsg.type = UDP_BATCH_MSG_TYPE;
+	batchMsg.payload = pub->batchBuffer;
+	batchMsg.payloadSize = pub->batchLen;
+
+	struct iovec msg_iovec[3];
+	unsigned char compactHdr[PUBSUB_COMPACT_HEADER_SIZE];
+	int iovec_len = pubsub_topicPublicationEncodeHeader(pub, &batchMsg, compactHdr, msg_iovec);
+	msg_iovec[iovec_len].iov_base = pub->batchBuffer;
+	msg_iovec[iovec_len].iov_len = pub->batchLen;
+	iovec_len++;
+
+	if(pubsub_topicPublicationSendDatagram(pub, pub->batchLargeUdpHandle, msg_iovec, iovec_len) == -1) {
+		perror("pubsub_topicPublicationFlushBatch:sendSocket");
+		ret = false;
+	}
+
+	pub->batchLen = 0;
+	pub->batchNrMsgs = 0;
+
+	return ret;
+}
+
+/* Flushes a pending batch when its oldest message has waited batchMaxLatency us */
+static void* pubsub_topicPublicationFlushThread(void *arg){
+	topic_publication_pt pub = (topic_publication_pt)arg;
+
+	celixThreadMutex_lock(&(pub->tp_lock));
+	while(pub->batchRunning){
+		if(pub->batchNrMsgs == 0){
+			celixThreadCondition_wait(&pub->batchCond, &(pub->tp_lock));
+			continue;
+		}
+
+		struct timespec deadline = pub->batchStart;
+		deadline.tv_sec += pub->batchMaxLatency / 1000000;
+		deadline.tv_nsec += (pub->batchMaxLatency % 1000000) * 1000;
+		if(deadline.tv_nsec >= 1000000000L){
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+
+		struct timespec now;
+		clock_gettime(CLOCK_REALTIME, &now);
+		if(now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec)){
+			pubsub_topicPublicationFlushBatch(pub);
+		}
+		else{
+			pthread_cond_timedwait(&pub->batchCond, &(pub->tp_lock), &deadline);
+		}
+	}
+	celixThreadMutex_unlock(&(pub->tp_lock));
+
+	return NULL;
+}
+
+/*
+ * Fills the iovecs with the wire header of msg and returns the number of iovecs used (at most 2).
+ * compactHdr must hold PUBSUB_COMPACT_HEADER_SIZE bytes. Must be called with tp_lock taken.
+ */
+static int pubsub_topicPublicationEncodeHeader(topic_publication_pt pub, pubsub_msg_t *msg, unsigned char *compactHdr, struct iovec *msg_iovec){
+
+	if(!pub->compactHeader){
+		msg_iovec[0].iov_base = msg->header;
+		msg_iovec[0].iov_len = sizeof(*msg->header);
+		msg_iovec[1].iov_base = &msg->payloadSize;
+		msg_iovec[1].iov_len = sizeof(msg->payloadSize);
+		return 2;
+	}
+
+	struct pubsub_msg_compact_header hdr;
+	hdr.topicId = pub->topicId;
+	hdr.publisherId = pub->publisherId;
+	hdr.type = msg->type;
+	hdr.major = msg->major;
+	hdr.minor = msg->minor;
+	hdr.seqNr = pub->seqNr++;
+	hdr.sendTime = pubsubMsgHeader_now();
+	hdr.payloadSize = msg->payloadSize;
+	pubsubMsgHeader_encodeCompact(&hdr, compactHdr);
+
+	msg_iovec[0].iov_base = compactHdr;
+	msg_iovec[0].iov_len = PUBSUB_COMPACT_HEADER_SIZE;
+	return 1;
 }
@@ -41,10 +41,15 @@
 #include "version.h"
 
 #include "topic_subscription.h"
+#include "pubsub_msg_type_index.h"
+#include "pubsub_topic_trie.h"
 #include "topic_publication.h"
 #include "subscriber.h"
 #include "publisher.h"
 #include "large_udp.h"
+#include "pubsub_msg_header.h"
+#include "pubsub_msg_stats.h"
+#include "pubsub_dispatch_pool.h"
 
 #include "pubsub_serializer.h"
 
@@ -65,7 +70,8 @@ struct topic_subscription{
 	pubsub_serializer_service_t *serializer;
 
 	int topicEpollFd; // EPOLL filedescriptor where the sockets are registered.
-	hash_map_pt servicesMap; // key = service, value = msg types map
+	hash_map_pt servicesMap; // key = service, value = subscriber_msg_types
+	pubsub_msg_type_index_pt msgTypeIndex; // Local indices of the msg types of all subscribers, guarded by ts_lock
 	hash_map_pt socketMap; // key = URL, value = listen-socket
 	celix_thread_mutex_t socketMap_lock;
 
@@ -78,6 +84,44 @@ struct topic_subscription{
 	//array_list_pt rawServices;
 	unsigned int nrSubscribers;
 	largeUdp_pt largeUdpHandle;
+	pubsub_msg_stats_pt stats; // filled from compact headers
+	pubsub_dispatch_pool_pt dispatchPool; // calls the subscribers with dispatch threads, created for the first one, guarded by ts_lock
+	unsigned int localDeliveries; // local deliveries calling subscribers outside ts_lock, guarded by ts_lock
+	celix_thread_cond_t localDeliveries_cond;
+};
+
+/* The msg serializers of a subscriber, indexed by the local msg type index of the subscription, and its dispatch properties */
+typedef struct subscriber_msg_types{
+	hash_map_pt msgTypes;
+	pubsub_msg_serializer_t **msgSerializers;
+	unsigned int nrOfMsgSerializers;
+	bool dispatch;
+	bool orderPerMsgType;
+	bool arena; // deserialize the messages in one arena
+}* subscriber_msg_types_pt;
+
+/* A received payload shared by the dispatch tasks of its subscribers, freed by the last one */
+typedef struct dispatch_payload{
+	unsigned int refCount;
+	unsigned int size;
+	char data[];
+}* dispatch_payload_pt;
+
+typedef struct dispatch_task{
+	topic_subscription_pt sub;
+	pubsub_subscriber_pt subsvc;
+	pubsub_msg_serializer_t *msgSer;
+	unsigned int msgTypeId;
+	bool arena;
+	dispatch_payload_pt payload;
+}* dispatch_task_pt;
+
+/* A subscriber of a locally published msg, copied under ts_lock and called without it */
+struct local_delivery{
+	pubsub_subscriber_pt subsvc;
+	pubsub_msg_serializer_t *msgSer;
+	bool arena;
+	bool sameVersion; // receives the publisher's instance
 };
 
 typedef struct msg_map_entry{
@@ -93,6 +137,11 @@ static void sigusr1_sighandler(int signo);
 static int pubsub_localMsgTypeIdForMsgType(void* handle, const char* msgType, unsigned int* msgTypeId);
 static void connectPendingPublishers(topic_subscription_pt sub);
 static void disconnectPendingPublishers(topic_subscription_pt sub);
+static void announce_join(topic_subscription_pt ts, int recvSocket, char* pubURL, char* mcIp, unsigned short mcPort);
+static void receive_msg(topic_subscription_pt sub, pubsub_subscriber_pt subsvc, pubsub_msg_serializer_t *msgSer, unsigned int msgTypeId, bool arena, const char *payload, unsigned int payloadSize);
+static void dispatch_msg(void *arg);
+static void release_dispatch_payload(dispatch_payload_pt payload);
+static dispatch_payload_pt serialize_local_msg(pubsub_msg_serializer_t *msgSer, const void *msg);
 
 
 celix_status_t pubsub_topicSubscriptionCreate(bundle_context_pt bundle_context, char* ifIp,char* scope, char* topic ,pubsub_serializer_service_t *best_serializer, topic_subscription_pt* out){
@@ -115,6 +164,8 @@ celix_status_t pubsub_topicSubscriptionCreate(bundle_context_pt bundle_context,
 	ts->serializer = best_serializer;
 
 	celixThreadMutex_create(&ts->ts_lock,NULL);
+	celixThreadCondition_init(&ts->localDeliveries_cond, NULL);
+	pubsubMsgTypeIndex_create(&ts->msgTypeIndex);
 	arrayList_create(&ts->sub_ep_list);
 	ts->servicesMap = hashMap_create(NULL, NULL, NULL, NULL);
 	ts->socketMap =  hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
@@ -126,21 +177,24 @@ celix_status_t pubsub_topicSubscriptionCreate(bundle_context_pt bundle_context,
 	celixThreadMutex_create(&ts->socketMap_lock, NULL);
 
 	ts->largeUdpHandle = largeUdp_create(MAX_UDP_SESSIONS);
+	status += pubsubMsgStats_create(&ts->stats);
 
 	char filter[128];
 	memset(filter,0,128);
+	char *filterTopic = pubsubTopic_createFilterValue(topic); // Wildcard topics contain '*', which has a meaning in filters
 	if(strncmp(PUBSUB_SUBSCRIBER_SCOPE_DEFAULT, scope, strlen(PUBSUB_SUBSCRIBER_SCOPE_DEFAULT)) == 0) {
 		// default scope, means that subscriber has not defined a scope property
 		snprintf(filter, 128, "(&(%s=%s)(%s=%s))",
 				(char*) OSGI_FRAMEWORK_OBJECTCLASS, PUBSUB_SUBSCRIBER_SERVICE_NAME,
-				PUBSUB_SUBSCRIBER_TOPIC,topic);
+				PUBSUB_SUBSCRIBER_TOPIC,filterTopic);
 
 	} else {
 		snprintf(filter, 128, "(&(%s=%s)(%s=%s)(%s=%s))",
 				(char*) OSGI_FRAMEWORK_OBJECTCLASS, PUBSUB_SUBSCRIBER_SERVICE_NAME,
-				PUBSUB_SUBSCRIBER_TOPIC,topic,
+				PUBSUB_SUBSCRIBER_TOPIC,filterTopic,
 				PUBSUB_SUBSCRIBER_SCOPE,scope);
 	}
+	free(filterTopic);
 
 	service_tracker_customizer_pt customizer = NULL;
 	status += serviceTrackerCustomizer_create(ts,NULL,topicsub_subscriberTracked,NULL,topicsub_subscriberUntracked,&customizer);
@@ -188,6 +242,7 @@ celix_status_t pubsub_topicSubscriptionDestroy(topic_subscription_pt ts){
 	celixThreadMutex_destroy(&ts->pendingDisconnections_lock);
 
 	largeUdp_destroy(ts->largeUdpHandle);
+	pubsubMsgStats_destroy(ts->stats);
 #if defined(__APPLE__) && defined(__MACH__)
 	//TODO: Use kqueue for OSX
 #else
@@ -197,6 +252,8 @@ celix_status_t pubsub_topicSubscriptionDestroy(topic_subscription_pt ts){
 	celixThreadMutex_unlock(&ts->ts_lock);
 
 	celixThreadMutex_destroy(&ts->ts_lock);
+	celixThreadCondition_destroy(&ts->localDeliveries_cond);
+	pubsubMsgTypeIndex_destroy(ts->msgTypeIndex);
 
 	free(ts);
 
@@ -228,6 +285,15 @@ celix_status_t pubsub_topicSubscriptionStop(topic_subscription_pt ts){
 
 	celixThread_join(ts->recv_thread,NULL);
 
+	/* Delivers the messages still queued before the subscribers are untracked */
+	celixThreadMutex_lock(&ts->ts_lock);
+	pubsub_dispatch_pool_pt dispatchPool = ts->dispatchPool;
+	ts->dispatchPool = NULL;
+	celixThreadMutex_unlock(&ts->ts_lock);
+	if(dispatchPool != NULL){
+		pubsubDispatchPool_destroy(dispatchPool);
+	}
+
 	status = serviceTracker_close(ts->tracker);
 
 	celixThreadMutex_lock(&ts->socketMap_lock);
@@ -250,6 +316,10 @@ celix_status_t pubsub_topicSubscriptionStop(topic_subscription_pt ts){
 	hashMap_clear(ts->socketMap, false, false);
 	celixThreadMutex_unlock(&ts->socketMap_lock);
 
+	largeUdp_statistics_t stats;
+	largeUdp_getStatistics(ts->largeUdpHandle, &stats);
+	printf("PSA_UDP_MC_TS: Reception statistics: %lu msgs reassembled from %lu parts in %lu receive calls, %lu corrupt parts, %lu msgs timed out, %lu msgs dropped, %lu buffer pool misses\n",
+			stats.nrMsgsReassembled, stats.nrPartsReceived, stats.nrRecvCalls, stats.nrCorruptParts, stats.nrMsgsTimedOut, stats.nrMsgsDropped, stats.nrPoolMisses);
 
 	return status;
 }
@@ -329,6 +399,10 @@ celix_status_t pubsub_topicSubscriptionConnectPublisher(topic_subscription_pt ts
 #endif
 			}
 
+			if (status == CELIX_SUCCESS){
+				announce_join(ts, *recvSocket, pubURL, mcIp, mcPort);
+			}
+
 		}
 
 		if (status == CELIX_SUCCESS){
@@ -441,6 +515,145 @@ array_list_pt pubsub_topicSubscriptionGetSubscribersList(topic_subscription_pt s
 }
 
 
+celix_status_t pubsub_topicSubscriptionDeliverLocal(topic_subscription_pt ts, pubsub_msg_serializer_t *pubMsgSer, const void *msg){
+	celix_status_t status = CELIX_SUCCESS;
+
+	struct pubsub_msg_header hdr;
+	int major=0, minor=0;
+	if(pubMsgSer->msgVersion != NULL){
+		version_getMajor(pubMsgSer->msgVersion, &major);
+		version_getMinor(pubMsgSer->msgVersion, &minor);
+	}
+	hdr.type = pubMsgSer->msgId;
+	hdr.major = major;
+	hdr.minor = minor;
+
+	dispatch_payload_pt localPayload = NULL; // the serialized msg, for dispatched subscribers and version conversions
+
+	celixThreadMutex_lock(&ts->ts_lock);
+
+	unsigned int nrOfSubscribers = hashMap_size(ts->servicesMap);
+	struct local_delivery deliveries[nrOfSubscribers > 0 ? nrOfSubscribers : 1];
+	unsigned int nrOfDeliveries = 0;
+
+	int localIndex = pubsubMsgTypeIndex_get(ts->msgTypeIndex, hdr.type);
+	hash_map_iterator_pt iter = hashMapIterator_create(ts->servicesMap);
+	while (hashMapIterator_hasNext(iter)) {
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+		pubsub_subscriber_pt subsvc = hashMapEntry_getKey(entry);
+		subscriber_msg_types_pt subMsgTypes = hashMapEntry_getValue(entry);
+
+		pubsub_msg_serializer_t *msgSer = pubsubMsgTypeIndex_getSerializer(subMsgTypes->msgSerializers, subMsgTypes->nrOfMsgSerializers, localIndex);
+		if (msgSer == NULL) {
+			printf("PSA_UDP_MC_TS: Serializer not available for message %d.\n",hdr.type);
+			continue;
+		}
+
+		int cmp = -1;
+		if(msgSer->msgVersion != NULL && pubMsgSer->msgVersion != NULL){
+			version_compareTo(msgSer->msgVersion, pubMsgSer->msgVersion, &cmp);
+		}
+		if(cmp != 0 && !checkVersion(msgSer->msgVersion,&hdr)){
+			int subMajor=0,subMinor=0;
+			version_getMajor(msgSer->msgVersion,&subMajor);
+			version_getMinor(msgSer->msgVersion,&subMinor);
+			printf("PSA_UDP_MC_TS: Version mismatch for primary message '%s' (have %d.%d, received %u.%u). NOT sending any part of the whole message.\n",
+					msgSer->msgName,subMajor,subMinor,hdr.major,hdr.minor);
+			continue;
+		}
+
+		if(subMsgTypes->dispatch && ts->dispatchPool != NULL){
+			/* The publisher's instance is gone when the task runs, dispatch a serialized copy */
+			if(localPayload == NULL){
+				localPayload = serialize_local_msg(pubMsgSer, msg);
+			}
+			if(localPayload == NULL){
+				printf("PSA_UDP_MC_TS: Cannot serialize msgType %s for local delivery.\n",msgSer->msgName);
+				status = CELIX_SERVICE_EXCEPTION;
+				continue;
+			}
+			dispatch_task_pt task = calloc(1, sizeof(*task));
+			task->sub = ts;
+			task->subsvc = subsvc;
+			task->msgSer = msgSer;
+			task->msgTypeId = hdr.type;
+			task->arena = subMsgTypes->arena;
+			task->payload = localPayload;
+			__atomic_add_fetch(&localPayload->refCount, 1, __ATOMIC_RELAXED);
+
+			unsigned int key = (unsigned int)((uintptr_t)subsvc >> 4);
+			if(subMsgTypes->orderPerMsgType){
+				key ^= hdr.type;
+			}
+			if(pubsubDispatchPool_dispatch(ts->dispatchPool, key, dispatch_msg, task) != CELIX_SUCCESS){
+				release_dispatch_payload(localPayload);
+				free(task);
+			}
+		}
+		else{
+			deliveries[nrOfDeliveries].subsvc = subsvc;
+			deliveries[nrOfDeliveries].msgSer = msgSer;
+			deliveries[nrOfDeliveries].arena = subMsgTypes->arena;
+			deliveries[nrOfDeliveries].sameVersion = cmp == 0;
+			nrOfDeliveries++;
+		}
+	}
+	hashMapIterator_destroy(iter);
+
+	if(nrOfDeliveries > 0){
+		ts->localDeliveries++; // keeps the subscribers and their serializers until they are called
+	}
+	celixThreadMutex_unlock(&ts->ts_lock);
+
+	unsigned int i = 0;
+	for(;i<nrOfDeliveries;i++){
+		struct local_delivery *delivery = &deliveries[i];
+		if(delivery->sameVersion){
+			/* Same message layout on both sides, hand over the publisher's instance, read-only and only during the call */
+			pubsub_multipart_callbacks_t mp_callbacks;
+			mp_callbacks.handle = ts;
+			mp_callbacks.localMsgTypeIdForMsgType = pubsub_localMsgTypeIdForMsgType;
+			mp_callbacks.getMultipart = NULL;
+			bool release = true;
+			delivery->subsvc->receive(delivery->subsvc->handle, delivery->msgSer->msgName, hdr.type, (void*)msg, &mp_callbacks, &release);
+			if(!release){
+				printf("PSA_UDP_MC_TS: Locally delivered message %s is owned by the publisher, it cannot be retained.\n",delivery->msgSer->msgName);
+			}
+			continue;
+		}
+
+		/* Compatible but different version, convert through the serializer */
+		if(localPayload == NULL){
+			localPayload = serialize_local_msg(pubMsgSer, msg);
+		}
+		if(localPayload != NULL){
+			receive_msg(ts, delivery->subsvc, delivery->msgSer, hdr.type, delivery->arena, localPayload->data, localPayload->size);
+		}
+		else{
+			printf("PSA_UDP_MC_TS: Cannot convert msgType %s for local delivery.\n",delivery->msgSer->msgName);
+			status = CELIX_SERVICE_EXCEPTION;
+		}
+	}
+
+	if(localPayload != NULL){
+		release_dispatch_payload(localPayload);
+	}
+
+	if(nrOfDeliveries > 0){
+		celixThreadMutex_lock(&ts->ts_lock);
+		if(--ts->localDeliveries == 0){
+			celixThreadCondition_broadcast(&ts->localDeliveries_cond);
+		}
+		celixThreadMutex_unlock(&ts->ts_lock);
+	}
+
+	return status;
+}
+
+void pubsub_topicSubscriptionPrintStats(topic_subscription_pt ts, FILE *out){
+	pubsubMsgStats_print(ts->stats, out);
+}
+
 static celix_status_t topicsub_subscriberTracked(void * handle, service_reference_pt reference, void * service){
 	celix_status_t status = CELIX_SUCCESS;
 	topic_subscription_pt ts = handle;
@@ -455,7 +668,33 @@ static celix_status_t topicsub_subscriberTracked(void * handle, service_referenc
 		if(ts->serializer != NULL && bundle!=NULL){
 			ts->serializer->createSerializerMap(ts->serializer->handle,bundle,&msgTypes);
 			if(msgTypes != NULL){
-				hashMap_put(ts->servicesMap, service, msgTypes);
+				subscriber_msg_types_pt subMsgTypes = calloc(1, sizeof(*subMsgTypes));
+				subMsgTypes->msgTypes = msgTypes;
+				pubsubMsgTypeIndex_bind(ts->msgTypeIndex, msgTypes, &subMsgTypes->msgSerializers, &subMsgTypes->nrOfMsgSerializers);
+
+				const char *threads = NULL;
+				const char *order = NULL;
+				serviceReference_getProperty(reference, PUBSUB_SUBSCRIBER_DISPATCH_THREADS, &threads);
+				serviceReference_getProperty(reference, PUBSUB_SUBSCRIBER_DISPATCH_ORDER, &order);
+				unsigned int nrOfThreads = threads != NULL ? (unsigned int) strtoul(threads, NULL, 10) : 0;
+				if(nrOfThreads > 0){
+					if(ts->dispatchPool == NULL){
+						if(pubsubDispatchPool_create(nrOfThreads, PUBSUB_DISPATCH_POOL_DEFAULT_QUEUE_SIZE, &ts->dispatchPool) == CELIX_SUCCESS){
+							printf("PSA_UDP_MC_TS: Dispatching messages with %u threads.\n", nrOfThreads);
+						}
+					}
+					else if(nrOfThreads != pubsubDispatchPool_nrOfThreads(ts->dispatchPool)){
+						printf("PSA_UDP_MC_TS: Subscriber asks for %u dispatch threads, the topic already uses %u.\n", nrOfThreads, pubsubDispatchPool_nrOfThreads(ts->dispatchPool));
+					}
+					subMsgTypes->dispatch = ts->dispatchPool != NULL;
+					subMsgTypes->orderPerMsgType = order != NULL && strcmp(order, PUBSUB_SUBSCRIBER_DISPATCH_ORDER_MSG_TYPE) == 0;
+				}
+
+				const char *arena = NULL;
+				serviceReference_getProperty(reference, PUBSUB_SUBSCRIBER_MSG_ARENA, &arena);
+				subMsgTypes->arena = arena != NULL && strcmp(arena, "true") == 0;
+
+				hashMap_put(ts->servicesMap, service, subMsgTypes);
 				printf("PSA_UDP_MC_TS: New subscriber registered.\n");
 			}
 		}
@@ -476,9 +715,17 @@ static celix_status_t topicsub_subscriberUntracked(void * handle, service_refere
 
 	celixThreadMutex_lock(&ts->ts_lock);
 	if (hashMap_containsKey(ts->servicesMap, service)) {
-		hash_map_pt msgTypes = hashMap_remove(ts->servicesMap, service);
-		if(msgTypes!=NULL && ts->serializer!=NULL){
-			ts->serializer->destroySerializerMap(ts->serializer->handle,msgTypes);
+		subscriber_msg_types_pt subMsgTypes = hashMap_remove(ts->servicesMap, service);
+		if(subMsgTypes!=NULL && subMsgTypes->dispatch && ts->dispatchPool!=NULL){
+			pubsubDispatchPool_flush(ts->dispatchPool); // queued messages still use the subscriber and its serializers
+		}
+		while(ts->localDeliveries > 0){
+			celixThreadCondition_wait(&ts->localDeliveries_cond, &ts->ts_lock); // so do running local deliveries
+		}
+		if(subMsgTypes!=NULL && ts->serializer!=NULL){
+			ts->serializer->destroySerializerMap(ts->serializer->handle,subMsgTypes->msgTypes);
+			free(subMsgTypes->msgSerializers);
+			free(subMsgTypes);
 			printf("PSA_ZMQ_TS: Subscriber unregistered.\n");
 		}
 		else{
@@ -493,59 +740,200 @@ static celix_status_t topicsub_subscriberUntracked(void * handle, service_refere
 }
 
 
-static void process_msg(topic_subscription_pt sub,pubsub_udp_msg_t *msg){
+static void deliver_msg(topic_subscription_pt sub, pubsub_msg_header_pt header, const char *payload, unsigned int payloadSize){
 
-	celixThreadMutex_lock(&sub->ts_lock);
+	dispatch_payload_pt dispatchPayload = NULL; // copied for the first dispatched subscriber, the receive buffer is reused
+	int localIndex = pubsubMsgTypeIndex_get(sub->msgTypeIndex, header->type);
 	hash_map_iterator_pt iter = hashMapIterator_create(sub->servicesMap);
 	while (hashMapIterator_hasNext(iter)) {
 		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
 		pubsub_subscriber_pt subsvc = hashMapEntry_getKey(entry);
-		hash_map_pt msgTypes = hashMapEntry_getValue(entry);
+		subscriber_msg_types_pt subMsgTypes = hashMapEntry_getValue(entry);
 
-		pubsub_msg_serializer_t *msgSer = hashMap_get(msgTypes,(void*)(uintptr_t )msg->header.type);
+		pubsub_msg_serializer_t *msgSer = pubsubMsgTypeIndex_getSerializer(subMsgTypes->msgSerializers, subMsgTypes->nrOfMsgSerializers, localIndex);
 		if (msgSer == NULL) {
-			printf("PSA_UDP_MC_TS: Serializer not available for message %d.\n",msg->header.type);
+			printf("PSA_UDP_MC_TS: Serializer not available for message %d.\n",header->type);
 		}
 		else{
-			void *msgInst = NULL;
-			bool validVersion = checkVersion(msgSer->msgVersion,&msg->header);
-
-			if(validVersion){
-
-				celix_status_t status = msgSer->deserialize(msgSer, (const void *) msg->payload, 0, &msgInst);
-
-				if (status == CELIX_SUCCESS) {
-					bool release = true;
-					pubsub_multipart_callbacks_t mp_callbacks;
-					mp_callbacks.handle = sub;
-					mp_callbacks.localMsgTypeIdForMsgType = pubsub_localMsgTypeIdForMsgType;
-					mp_callbacks.getMultipart = NULL;
-
-					subsvc->receive(subsvc->handle, msgSer->msgName, msg->header.type, msgInst, &mp_callbacks, &release);
-
-					if(release){
-						msgSer->freeMsg(msgSer,msgInst);
-					}
+			bool validVersion = checkVersion(msgSer->msgVersion,header);
+
+			if(validVersion && subMsgTypes->dispatch && sub->dispatchPool != NULL){
+				if(dispatchPayload == NULL){
+					dispatchPayload = malloc(sizeof(*dispatchPayload) + payloadSize);
+					dispatchPayload->refCount = 1;
+					dispatchPayload->size = payloadSize;
+					memcpy(dispatchPayload->data, payload, payloadSize);
 				}
-				else{
-					printf("PSA_UDP_MC_TS: Cannot deserialize msgType %s.\n",msgSer->msgName);
+				dispatch_task_pt task = calloc(1, sizeof(*task));
+				task->sub = sub;
+				task->subsvc = subsvc;
+				task->msgSer = msgSer;
+				task->msgTypeId = header->type;
+				task->arena = subMsgTypes->arena;
+				task->payload = dispatchPayload;
+				__atomic_add_fetch(&dispatchPayload->refCount, 1, __ATOMIC_RELAXED);
+
+				unsigned int key = (unsigned int)((uintptr_t)subsvc >> 4);
+				if(subMsgTypes->orderPerMsgType){
+					key ^= header->type;
 				}
-
+				if(pubsubDispatchPool_dispatch(sub->dispatchPool, key, dispatch_msg, task) != CELIX_SUCCESS){
+					release_dispatch_payload(dispatchPayload);
+					free(task);
+				}
+			}
+			else if(validVersion){
+				receive_msg(sub, subsvc, msgSer, header->type, subMsgTypes->arena, payload, payloadSize);
 			}
 			else{
 				int major=0,minor=0;
 				version_getMajor(msgSer->msgVersion,&major);
 				version_getMinor(msgSer->msgVersion,&minor);
 				printf("PSA_UDP_MC_TS: Version mismatch for primary message '%s' (have %d.%d, received %u.%u). NOT sending any part of the whole message.\n",
-						msgSer->msgName,major,minor,msg->header.major,msg->header.minor);
+						msgSer->msgName,major,minor,header->major,header->minor);
 			}
 
 		}
 	}
 	hashMapIterator_destroy(iter);
+
+	if(dispatchPayload != NULL){
+		release_dispatch_payload(dispatchPayload);
+	}
+}
+
+static void receive_msg(topic_subscription_pt sub, pubsub_subscriber_pt subsvc, pubsub_msg_serializer_t *msgSer, unsigned int msgTypeId, bool arena, const char *payload, unsigned int payloadSize){
+	void *msgInst = NULL;
+	celix_status_t status;
+	arena = arena && msgSer->deserializeInArena != NULL;
+	if(arena){
+		status = msgSer->deserializeInArena(msgSer, (const void *) payload, payloadSize, &msgInst);
+	}
+	else{
+		status = msgSer->deserialize(msgSer, (const void *) payload, payloadSize, &msgInst);
+	}
+
+	if (status == CELIX_SUCCESS) {
+		bool release = true;
+		pubsub_multipart_callbacks_t mp_callbacks;
+		mp_callbacks.handle = sub;
+		mp_callbacks.localMsgTypeIdForMsgType = pubsub_localMsgTypeIdForMsgType;
+		mp_callbacks.getMultipart = NULL;
+
+		subsvc->receive(subsvc->handle, msgSer->msgName, msgTypeId, msgInst, &mp_callbacks, &release);
+
+		if(arena){
+			msgSer->freeArenaMsg(msgSer,msgInst);
+		}
+		else if(release){
+			msgSer->freeMsg(msgSer,msgInst);
+		}
+	}
+	else{
+		printf("PSA_UDP_MC_TS: Cannot deserialize msgType %s.\n",msgSer->msgName);
+	}
+}
+
+/* Runs on a thread of the dispatch pool, without ts_lock */
+static void dispatch_msg(void *arg){
+	dispatch_task_pt task = arg;
+	receive_msg(task->sub, task->subsvc, task->msgSer, task->msgTypeId, task->arena, task->payload->data, task->payload->size);
+	release_dispatch_payload(task->payload);
+	free(task);
+}
+
+static void release_dispatch_payload(dispatch_payload_pt payload){
+	if(__atomic_sub_fetch(&payload->refCount, 1, __ATOMIC_ACQ_REL) == 0){
+		free(payload);
+	}
+}
+
+static dispatch_payload_pt serialize_local_msg(pubsub_msg_serializer_t *msgSer, const void *msg){
+	dispatch_payload_pt payload = NULL;
+	void *serializedOutput = NULL;
+	size_t serializedOutputLen = 0;
+	if(msgSer->serialize(msgSer, msg, &serializedOutput, &serializedOutputLen) == CELIX_SUCCESS){
+		payload = malloc(sizeof(*payload) + serializedOutputLen);
+		payload->refCount = 1;
+		payload->size = serializedOutputLen;
+		memcpy(payload->data, serializedOutput, serializedOutputLen);
+	}
+	free(serializedOutput);
+	return payload;
+}
+
+static void process_msg(topic_subscription_pt sub, pubsub_msg_header_pt header, const char *payload, unsigned int payloadSize){
+
+	celixThreadMutex_lock(&sub->ts_lock);
+
+	if(header->type == UDP_BATCH_MSG_TYPE){
+		/* Unpack a batch of small messages sent in a single datagram */
+		unsigned int offset = 0;
+		while(offset + UDP_BATCH_ENTRY_SIZE <= payloadSize){
+			pubsub_udp_batch_entry_t entry;
+			uint32_t netValue;
+			memcpy(&netValue, payload + offset, sizeof(netValue));
+			entry.type = ntohl(netValue);
+			entry.major = (unsigned char)payload[offset + 4];
+			entry.minor = (unsigned char)payload[offset + 5];
+			memcpy(&netValue, payload + offset + 6, sizeof(netValue));
+			entry.payloadSize = ntohl(netValue);
+			offset += UDP_BATCH_ENTRY_SIZE;
+			if(entry.payloadSize > payloadSize - offset){
+				printf("PSA_UDP_MC_TS: Corrupt batch message received, dropping remaining %u bytes.\n", payloadSize - offset);
+				break;
+			}
+
+			struct pubsub_msg_header entryHeader;
+			entryHeader.topic[0] = '\0'; // not used for delivery
+			entryHeader.type = entry.type;
+			entryHeader.major = entry.major;
+			entryHeader.minor = entry.minor;
+			deliver_msg(sub, &entryHeader, payload + offset, entry.payloadSize);
+
+			offset += entry.payloadSize;
+		}
+	}
+	else{
+		deliver_msg(sub, header, payload, payloadSize);
+	}
+
 	celixThreadMutex_unlock(&sub->ts_lock);
 }
 
+/* Publications choose their wire header, a datagram starts with either a compact or a legacy header */
+static void process_datagram(topic_subscription_pt sub, const char *data, unsigned int size){
+
+	if(pubsubMsgHeader_isCompact(data, size)){
+		struct pubsub_msg_compact_header compact;
+		bool valid = pubsubMsgHeader_decodeCompact(data, size, &compact);
+		if(valid && compact.type == UDP_JOIN_MSG_TYPE){
+			return; // join announcement of another subscription, only meant for publications
+		}
+		if(valid && size - PUBSUB_COMPACT_HEADER_SIZE >= compact.payloadSize){
+			struct pubsub_msg_header header;
+			header.topic[0] = '\0'; // not used for delivery
+			header.type = compact.type;
+			header.major = compact.major;
+			header.minor = compact.minor;
+			pubsubMsgStats_update(sub->stats, compact.publisherId, compact.seqNr, compact.sendTime);
+			process_msg(sub, &header, data + PUBSUB_COMPACT_HEADER_SIZE, compact.payloadSize);
+		}
+		else{
+			printf("PSA_UDP_MC_TS: Dropping message with an invalid compact header (size %u)\n", size);
+		}
+		return;
+	}
+
+	pubsub_udp_msg_t *udpMsg = (pubsub_udp_msg_t*)data;
+	if(size >= sizeof(pubsub_udp_msg_t) && size - sizeof(pubsub_udp_msg_t) >= udpMsg->payloadSize) {
+		process_msg(sub, &udpMsg->header, udpMsg->payload, udpMsg->payloadSize);
+	}
+	else {
+		printf("PSA_UDP_MC_TS: Dropping message with inconsistent size %u\n", size);
+	}
+}
+
 static void* udp_recv_thread_func(void * arg) {
 	topic_subscription_pt sub = (topic_subscription_pt) arg;
 
@@ -555,8 +943,8 @@ static void* udp_recv_thread_func(void * arg) {
 	while (sub->running) {
 		int nfds = 0;
 		if(nfds > 0) {
-			pubsub_udp_msg_t* udpMsg = NULL;
-			process_msg(sub, udpMsg);
+			char* data = NULL;
+			process_datagram(sub, data, 0);
 		}
 	}
 #else
@@ -566,19 +954,14 @@ static void* udp_recv_thread_func(void * arg) {
 		int nfds = epoll_wait(sub->topicEpollFd, events, MAX_EPOLL_EVENTS, RECV_THREAD_TIMEOUT * 1000);
 		int i;
 		for(i = 0; i < nfds; i++ ) {
-			unsigned int index;
-			unsigned int size;
-			if(largeUdp_dataAvailable(sub->largeUdpHandle, events[i].data.fd, &index, &size) == true) {
+			if(largeUdp_receive(sub->largeUdpHandle, events[i].data.fd) > 0) {
 				// Handle data
-				pubsub_udp_msg_t *udpMsg = NULL;
-				if(largeUdp_read(sub->largeUdpHandle, index, (void**)&udpMsg, size) != 0) {
-					printf("PSA_UDP_MC_TS: ERROR largeUdp_read with index %d\n", index);
-					continue;
+				char *data = NULL;
+				unsigned int size = 0;
+				while(largeUdp_nextMessage(sub->largeUdpHandle, (void**)&data, &size)) {
+					process_datagram(sub, data, size);
+					largeUdp_releaseBuffer(sub->largeUdpHandle, data);
 				}
-
-				process_msg(sub, udpMsg);
-
-				free(udpMsg);
 			}
 		}
 		connectPendingPublishers(sub);
@@ -589,6 +972,34 @@ static void* udp_recv_thread_func(void * arg) {
 	return NULL;
 }
 
+/* Tells the publication that this subscription joined its multicast group, see UDP_JOIN_MSG_TYPE */
+static void announce_join(topic_subscription_pt ts, int recvSocket, char* pubURL, char* mcIp, unsigned short mcPort){
+
+	struct pubsub_msg_compact_header hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.publisherId = utils_stringHash(pubURL);
+	hdr.type = UDP_JOIN_MSG_TYPE;
+	hdr.sendTime = pubsubMsgHeader_now();
+
+	unsigned char buf[PUBSUB_COMPACT_HEADER_SIZE];
+	pubsubMsgHeader_encodeCompact(&hdr, buf);
+
+	struct in_addr intf;
+	intf.s_addr = inet_addr(ts->ifIpAddress);
+	if(setsockopt(recvSocket, IPPROTO_IP, IP_MULTICAST_IF, &intf, sizeof(intf)) != 0){
+		perror("announce_join:IP_MULTICAST_IF");
+	}
+
+	struct sockaddr_in announceAddr;
+	memset(&announceAddr, 0, sizeof(announceAddr));
+	announceAddr.sin_family = AF_INET;
+	announceAddr.sin_addr.s_addr = inet_addr(mcIp);
+	announceAddr.sin_port = htons(mcPort + UDP_ANNOUNCE_PORT_OFFSET);
+	if(sendto(recvSocket, buf, sizeof(buf), 0, (struct sockaddr*)&announceAddr, sizeof(announceAddr)) == -1){
+		perror("announce_join:sendto");
+	}
+}
+
 static void connectPendingPublishers(topic_subscription_pt sub) {
 	celixThreadMutex_lock(&sub->pendingConnections_lock);
 	while(!arrayList_isEmpty(sub->pendingConnections)) {
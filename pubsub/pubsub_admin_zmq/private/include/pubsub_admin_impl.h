@@ -27,6 +27,8 @@
 #ifndef PUBSUB_ADMIN_ZMQ_IMPL_H_
 #define PUBSUB_ADMIN_ZMQ_IMPL_H_
 
+#include <stdio.h>
+
 #include <czmq.h>
 /* The following undefs prevent the collision between:
  * - sys/syslog.h (which is included within czmq)
@@ -38,6 +40,7 @@
 #undef LOG_WARNING
 
 #include "pubsub_admin.h"
+#include "pubsub_wildcard_subscriptions.h"
 #include "pubsub_admin_match.h"
 #include "log_helper.h"
 
@@ -66,6 +69,7 @@ struct pubsub_admin {
 
 	celix_thread_mutex_t subscriptionsLock;
 	hash_map_pt subscriptions; //<topic(string),topic_subscription>
+	pubsub_wildcard_subscriptions_pt wildcardSubscriptions; //the subscriptions with a wildcard topic, protected by subscriptionsLock
 
 	celix_thread_mutex_t pendingSubscriptionsLock;
 	celix_thread_mutexattr_t pendingSubscriptionsAttr;
@@ -87,6 +91,8 @@ struct pubsub_admin {
 
     unsigned int basePort;
     unsigned int maxPort;
+
+	bool localDelivery; // Publications hand messages directly to subscriptions of the same framework (PSA_LOCAL_DELIVERY)
 };
 
 celix_status_t pubsubAdmin_create(bundle_context_pt context, pubsub_admin_pt *admin);
@@ -106,4 +112,7 @@ celix_status_t pubsubAdmin_serializerRemoved(void * handle, service_reference_pt
 
 celix_status_t pubsubAdmin_matchEndpoint(pubsub_admin_pt admin, pubsub_endpoint_pt endpoint, double* score);
 
+/* Shell command printing the receive statistics of all subscriptions, handle is the pubsub_admin_pt */
+celix_status_t pubsubAdmin_executeStatsCommand(void *handle, char *commandLine, FILE *out, FILE *err);
+
 #endif /* PUBSUB_ADMIN_ZMQ_IMPL_H_ */
@@ -32,6 +32,7 @@
 #include "pubsub_common.h"
 
 #include "pubsub_serializer.h"
+#include "topic_subscription.h"
 
 typedef struct topic_publication *topic_publication_pt;
 
@@ -46,4 +47,7 @@ celix_status_t pubsub_topicPublicationStop(topic_publication_pt pub);
 
 array_list_pt pubsub_topicPublicationGetPublisherList(topic_publication_pt pub);
 
+celix_status_t pubsub_topicPublicationAddLocalSubscription(topic_publication_pt pub, topic_subscription_pt sub);
+celix_status_t pubsub_topicPublicationRemoveLocalSubscription(topic_publication_pt pub, topic_subscription_pt sub);
+
 #endif /* TOPIC_PUBLICATION_H_ */
@@ -27,6 +27,8 @@
 #ifndef TOPIC_SUBSCRIPTION_H_
 #define TOPIC_SUBSCRIPTION_H_
 
+#include <stdio.h>
+
 #include "celix_threads.h"
 #include "array_list.h"
 #include "celixbool.h"
@@ -57,4 +59,12 @@ celix_status_t pubsub_topicIncreaseNrSubscribers(topic_subscription_pt subscript
 celix_status_t pubsub_topicDecreaseNrSubscribers(topic_subscription_pt subscription);
 unsigned int pubsub_topicGetNrSubscribers(topic_subscription_pt subscription);
 
+/* Hands a message of a publication in the same framework directly to the subscribers, msg stays owned by the publisher */
+celix_status_t pubsub_topicSubscriptionDeliverLocal(topic_subscription_pt ts, pubsub_msg_serializer_t *pubMsgSer, const void *msg);
+/* Delivers an already serialized multipart message, frames is a List<zframe_t*> of alternating header and payload frames and is taken over */
+celix_status_t pubsub_topicSubscriptionDeliverLocalMultipart(topic_subscription_pt ts, array_list_pt frames);
+
+/* Prints the sequence and latency statistics of the received compact header messages */
+void pubsub_topicSubscriptionPrintStats(topic_subscription_pt ts, FILE *out);
+
 #endif /*TOPIC_SUBSCRIPTION_H_ */
@@ -29,6 +29,8 @@
 #include "bundle_activator.h"
 #include "service_registration.h"
 #include "service_tracker.h"
+#include "command.h"
+#include "shell_constants.h"
 
 #include "pubsub_admin_impl.h"
 
@@ -38,6 +40,8 @@ struct activator {
 	pubsub_admin_service_pt adminService;
 	service_registration_pt registration;
 	service_tracker_pt serializerTracker;
+	command_service_t statsCommand;
+	service_registration_pt statsCommandRegistration;
 };
 
 celix_status_t bundleActivator_create(bundle_context_pt context, void **userData) {
@@ -105,6 +109,15 @@ celix_status_t bundleActivator_start(void * userData, bundle_context_pt context)
 
 		status += serviceTracker_open(activator->serializerTracker);
 
+		activator->statsCommand.handle = activator->admin;
+		activator->statsCommand.executeCommand = pubsubAdmin_executeStatsCommand;
+
+		properties_pt props = properties_create();
+		properties_set(props, OSGI_SHELL_COMMAND_NAME, "psa_zmq_stats");
+		properties_set(props, OSGI_SHELL_COMMAND_USAGE, "psa_zmq_stats");
+		properties_set(props, OSGI_SHELL_COMMAND_DESCRIPTION, "Prints the received, lost and out of order messages and the latency per publisher of every ZMQ subscription.");
+		status += bundleContext_registerService(context, OSGI_SHELL_COMMAND_SERVICE_NAME, &activator->statsCommand, props, &activator->statsCommandRegistration);
+
 	}
 
 
@@ -115,6 +128,9 @@ celix_status_t bundleActivator_stop(void * userData, bundle_context_pt context)
 	celix_status_t status = CELIX_SUCCESS;
 	struct activator *activator = userData;
 
+	status += serviceRegistration_unregister(activator->statsCommandRegistration);
+	activator->statsCommandRegistration = NULL;
+
 	status += serviceTracker_close(activator->serializerTracker);
 	status += serviceRegistration_unregister(activator->registration);
 
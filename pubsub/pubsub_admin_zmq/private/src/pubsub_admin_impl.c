@@ -59,6 +59,7 @@
 #include "topic_subscription.h"
 #include "topic_publication.h"
 #include "pubsub_endpoint.h"
+#include "pubsub_topic_trie.h"
 #include "pubsub_utils.h"
 #include "subscriber.h"
 
@@ -69,10 +70,14 @@ static const char *DEFAULT_IP = "127.0.0.1";
 static celix_status_t pubsubAdmin_getIpAdress(const char* interface, char** ip);
 static celix_status_t pubsubAdmin_addSubscriptionToPendingList(pubsub_admin_pt admin,pubsub_endpoint_pt subEP);
 static celix_status_t pubsubAdmin_addAnySubscription(pubsub_admin_pt admin,pubsub_endpoint_pt subEP);
+static celix_status_t pubsubAdmin_addWildcardSubscription(pubsub_admin_pt admin,pubsub_endpoint_pt subEP);
+static void pubsubAdmin_connectWildcardSubscription(void *handle, void *value);
+static void pubsubAdmin_disconnectWildcardSubscription(void *handle, void *value);
 
 static celix_status_t pubsubAdmin_getBestSerializer(pubsub_admin_pt admin,pubsub_endpoint_pt ep, pubsub_serializer_service_t **serSvc);
 static void connectTopicPubSubToSerializer(pubsub_admin_pt admin,pubsub_serializer_service_t *serializer,void *topicPubSub,bool isPublication);
 static void disconnectTopicPubSubFromSerializer(pubsub_admin_pt admin,void *topicPubSub,bool isPublication);
+static void detachLocalSubscription(pubsub_admin_pt admin,topic_subscription_pt subscription);
 
 celix_status_t pubsubAdmin_create(bundle_context_pt context, pubsub_admin_pt *admin) {
 	celix_status_t status = CELIX_SUCCESS;
@@ -96,6 +101,7 @@ celix_status_t pubsubAdmin_create(bundle_context_pt context, pubsub_admin_pt *ad
 		(*admin)->bundle_context= context;
 		(*admin)->localPublications = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 		(*admin)->subscriptions = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+		pubsubWildcardSubscriptions_create(&(*admin)->wildcardSubscriptions);
 		(*admin)->pendingSubscriptions = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 		(*admin)->externalPublications = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 		(*admin)->topicSubscriptionsPerSerializer = hashMap_create(NULL, NULL, NULL, NULL);
@@ -183,6 +189,13 @@ celix_status_t pubsubAdmin_create(bundle_context_pt context, pubsub_admin_pt *ad
 			}
 		}
 
+		const char *localDelivery = NULL;
+		bundleContext_getProperty(context, PSA_LOCAL_DELIVERY, &localDelivery);
+		(*admin)->localDelivery = (localDelivery != NULL && strcmp(localDelivery, "true") == 0);
+		if ((*admin)->localDelivery) {
+			logHelper_log((*admin)->loghelper, OSGI_LOGSERVICE_INFO, "PSA_ZMQ: Delivering messages between local publishers and subscribers directly");
+		}
+
 #ifdef BUILD_WITH_ZMQ_SECURITY
 		// Setup authenticator
 		zactor_t* auth = zactor_new (zauth, NULL);
@@ -224,6 +237,7 @@ celix_status_t pubsubAdmin_destroy(pubsub_admin_pt admin)
 
 	celixThreadMutex_lock(&admin->subscriptionsLock);
 	hashMap_destroy(admin->subscriptions,false,false);
+	pubsubWildcardSubscriptions_destroy(admin->wildcardSubscriptions);
 	celixThreadMutex_unlock(&admin->subscriptionsLock);
 
 	celixThreadMutex_lock(&admin->localPublicationsLock);
@@ -377,6 +391,110 @@ static celix_status_t pubsubAdmin_addAnySubscription(pubsub_admin_pt admin,pubsu
 	return status;
 }
 
+static celix_status_t pubsubAdmin_addWildcardSubscription(pubsub_admin_pt admin,pubsub_endpoint_pt subEP){
+	celix_status_t status = CELIX_SUCCESS;
+
+	if(!pubsubTopic_isValidPattern(subEP->topic)){
+		printf("PSA_ZMQ: Invalid wildcard topic %s, '%s' is only allowed as last segment.\n",subEP->topic,PUBSUB_TOPIC_WILDCARD_REST);
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	celixThreadMutex_lock(&admin->subscriptionsLock);
+
+	char* scope_topic = createScopeTopicKey(subEP->scope,subEP->topic);
+	topic_subscription_pt subscription = hashMap_get(admin->subscriptions,scope_topic);
+
+	if(subscription==NULL){
+
+		int i;
+		pubsub_serializer_service_t *best_serializer = NULL;
+		if( (status=pubsubAdmin_getBestSerializer(admin, subEP, &best_serializer)) == CELIX_SUCCESS){
+			status = pubsub_topicSubscriptionCreate(admin->bundle_context, subEP->scope, subEP->topic, best_serializer, &subscription);
+		}
+		else{
+			printf("PSA_ZMQ: Cannot find a serializer for subscribing topic %s. Adding it to pending list.\n",subEP->topic);
+			celixThreadMutex_lock(&admin->noSerializerPendingsLock);
+			arrayList_add(admin->noSerializerSubscriptions,subEP);
+			celixThreadMutex_unlock(&admin->noSerializerPendingsLock);
+		}
+
+		if (status == CELIX_SUCCESS){
+
+			/* Connect the internal publishers of matching topics, the key tells whether a publication matches */
+			celixThreadMutex_lock(&admin->localPublicationsLock);
+			hash_map_iterator_pt lp_iter =hashMapIterator_create(admin->localPublications);
+			while(hashMapIterator_hasNext(lp_iter)){
+				hash_map_entry_pt lp_entry = hashMapIterator_nextEntry(lp_iter);
+				if(!pubsubWildcardSubscriptions_matchesKey(subEP->scope,subEP->topic,(const char*)hashMapEntry_getKey(lp_entry))){
+					continue;
+				}
+				service_factory_pt factory = (service_factory_pt)hashMapEntry_getValue(lp_entry);
+				topic_publication_pt topic_pubs = (topic_publication_pt)factory->handle;
+				array_list_pt topic_publishers = pubsub_topicPublicationGetPublisherList(topic_pubs);
+
+				if(topic_publishers!=NULL){
+					for(i=0;i<arrayList_size(topic_publishers);i++){
+						pubsub_endpoint_pt pubEP = (pubsub_endpoint_pt)arrayList_get(topic_publishers,i);
+						if(pubEP->endpoint !=NULL){
+							status += pubsub_topicSubscriptionConnectPublisher(subscription,pubEP->endpoint);
+						}
+					}
+					arrayList_destroy(topic_publishers);
+				}
+			}
+			hashMapIterator_destroy(lp_iter);
+			celixThreadMutex_unlock(&admin->localPublicationsLock);
+
+			/* Connect also the external publishers of matching topics */
+			celixThreadMutex_lock(&admin->externalPublicationsLock);
+			hash_map_iterator_pt extp_iter =hashMapIterator_create(admin->externalPublications);
+			while(hashMapIterator_hasNext(extp_iter)){
+				hash_map_entry_pt extp_entry = hashMapIterator_nextEntry(extp_iter);
+				array_list_pt ext_pub_list = (array_list_pt)hashMapEntry_getValue(extp_entry);
+				if(ext_pub_list!=NULL && pubsubWildcardSubscriptions_matchesKey(subEP->scope,subEP->topic,(const char*)hashMapEntry_getKey(extp_entry))){
+					for(i=0;i<arrayList_size(ext_pub_list);i++){
+						pubsub_endpoint_pt pubEP = (pubsub_endpoint_pt)arrayList_get(ext_pub_list,i);
+						if(pubEP->endpoint !=NULL){
+							status += pubsub_topicSubscriptionConnectPublisher(subscription,pubEP->endpoint);
+						}
+					}
+				}
+			}
+			hashMapIterator_destroy(extp_iter);
+			celixThreadMutex_unlock(&admin->externalPublicationsLock);
+
+			pubsub_topicSubscriptionAddSubscriber(subscription,subEP);
+
+			status += pubsub_topicSubscriptionStart(subscription);
+
+		}
+
+		if (status == CELIX_SUCCESS){
+			pubsubWildcardSubscriptions_add(admin->wildcardSubscriptions,subEP->scope,subEP->topic,subscription);
+
+			hashMap_put(admin->subscriptions,strdup(scope_topic),subscription);
+			connectTopicPubSubToSerializer(admin, best_serializer, subscription, false);
+		}
+	}
+
+	if (status == CELIX_SUCCESS){
+		pubsub_topicIncreaseNrSubscribers(subscription);
+	}
+
+	free(scope_topic);
+	celixThreadMutex_unlock(&admin->subscriptionsLock);
+
+	return status;
+}
+
+static void pubsubAdmin_connectWildcardSubscription(void *handle, void *value){
+	pubsub_topicSubscriptionAddConnectPublisherToPendingList((topic_subscription_pt)value,(char*)handle);
+}
+
+static void pubsubAdmin_disconnectWildcardSubscription(void *handle, void *value){
+	pubsub_topicSubscriptionAddDisconnectPublisherToPendingList((topic_subscription_pt)value,(char*)handle);
+}
+
 celix_status_t pubsubAdmin_addSubscription(pubsub_admin_pt admin,pubsub_endpoint_pt subEP){
 	celix_status_t status = CELIX_SUCCESS;
 
@@ -386,6 +504,10 @@ celix_status_t pubsubAdmin_addSubscription(pubsub_admin_pt admin,pubsub_endpoint
 		return pubsubAdmin_addAnySubscription(admin,subEP);
 	}
 
+	if(pubsubTopic_isWildcard(subEP->topic)){
+		return pubsubAdmin_addWildcardSubscription(admin,subEP);
+	}
+
 	/* Check if we already know some publisher about this topic, otherwise let's put the subscription in the pending hashmap */
 	celixThreadMutex_lock(&admin->pendingSubscriptionsLock);
 	celixThreadMutex_lock(&admin->subscriptionsLock);
@@ -419,7 +541,10 @@ celix_status_t pubsubAdmin_addSubscription(pubsub_admin_pt admin,pubsub_endpoint
 			if (status==CELIX_SUCCESS){
 
 				/* Try to connect internal publishers */
-				if(factory!=NULL){
+				if(factory!=NULL && admin->localDelivery){
+					status += pubsub_topicPublicationAddLocalSubscription((topic_publication_pt)factory->handle,subscription);
+				}
+				else if(factory!=NULL){
 					topic_publication_pt topic_pubs = (topic_publication_pt)factory->handle;
 					array_list_pt topic_publishers = pubsub_topicPublicationGetPublisherList(topic_pubs);
 
@@ -597,7 +722,15 @@ celix_status_t pubsubAdmin_addPublication(pubsub_admin_pt admin, pubsub_endpoint
 	celixThreadMutex_lock(&admin->subscriptionsLock);
 
 	topic_subscription_pt sub = (topic_subscription_pt) hashMap_get(admin->subscriptions, scope_topic);
-	if (sub != NULL && pubEP->endpoint != NULL) {
+	if (sub != NULL && admin->localDelivery && strcmp(pubEP->frameworkUUID, fwUUID) == 0) {
+		celixThreadMutex_lock(&admin->localPublicationsLock);
+		service_factory_pt factory = (service_factory_pt) hashMap_get(admin->localPublications, scope_topic);
+		if (factory != NULL) {
+			pubsub_topicPublicationAddLocalSubscription((topic_publication_pt) factory->handle, sub);
+		}
+		celixThreadMutex_unlock(&admin->localPublicationsLock);
+	}
+	else if (sub != NULL && pubEP->endpoint != NULL) {
 		pubsub_topicSubscriptionAddConnectPublisherToPendingList(sub, pubEP->endpoint);
 	}
 
@@ -607,6 +740,11 @@ celix_status_t pubsubAdmin_addPublication(pubsub_admin_pt admin, pubsub_endpoint
 		pubsub_topicSubscriptionAddConnectPublisherToPendingList(any_sub, pubEP->endpoint);
 	}
 
+	/* And for the wildcard subscriptions matching the topic */
+	if (pubEP->endpoint != NULL) {
+		pubsubWildcardSubscriptions_match(admin->wildcardSubscriptions, pubEP->scope, pubEP->topic, pubsubAdmin_connectWildcardSubscription, pubEP->endpoint);
+	}
+
 	free(scope_topic);
 
 	celixThreadMutex_unlock(&admin->subscriptionsLock);
@@ -688,7 +826,8 @@ celix_status_t pubsubAdmin_removePublication(pubsub_admin_pt admin,pubsub_endpoi
 	celixThreadMutex_lock(&admin->subscriptionsLock);
 
 	topic_subscription_pt sub = (topic_subscription_pt)hashMap_get(admin->subscriptions,scope_topic);
-	if(sub!=NULL && pubEP->endpoint!=NULL && count == 0){
+	bool localDelivered = admin->localDelivery && strcmp(pubEP->frameworkUUID,fwUUID)==0;
+	if(sub!=NULL && pubEP->endpoint!=NULL && count == 0 && !localDelivered){
 		pubsub_topicSubscriptionAddDisconnectPublisherToPendingList(sub,pubEP->endpoint);
 	}
 
@@ -698,6 +837,11 @@ celix_status_t pubsubAdmin_removePublication(pubsub_admin_pt admin,pubsub_endpoi
 		pubsub_topicSubscriptionAddDisconnectPublisherToPendingList(any_sub,pubEP->endpoint);
 	}
 
+	/* And for the wildcard subscriptions matching the topic */
+	if(pubEP->endpoint!=NULL && count == 0){
+		pubsubWildcardSubscriptions_match(admin->wildcardSubscriptions,pubEP->scope,pubEP->topic,pubsubAdmin_disconnectWildcardSubscription,pubEP->endpoint);
+	}
+
 	free(scope_topic);
 	celixThreadMutex_unlock(&admin->subscriptionsLock);
 
@@ -739,10 +883,14 @@ celix_status_t pubsubAdmin_closeAllSubscriptions(pubsub_admin_pt admin,char* sco
 	celixThreadMutex_lock(&admin->subscriptionsLock);
 	char *scope_topic = createScopeTopicKey(scope, topic);
 	hash_map_entry_pt sub_entry = (hash_map_entry_pt)hashMap_getEntry(admin->subscriptions,scope_topic);
+	if(sub_entry!=NULL && pubsubTopic_isWildcard(topic)){
+		pubsubWildcardSubscriptions_remove(admin->wildcardSubscriptions,scope,topic,hashMapEntry_getValue(sub_entry));
+	}
 	if(sub_entry!=NULL){
 		char* topic = (char*)hashMapEntry_getKey(sub_entry);
 
 		topic_subscription_pt ts = (topic_subscription_pt)hashMapEntry_getValue(sub_entry);
+		detachLocalSubscription(admin, ts);
 		status += pubsub_topicSubscriptionStop(ts);
 		disconnectTopicPubSubFromSerializer(admin, ts, false);
 		status += pubsub_topicSubscriptionDestroy(ts);
@@ -757,6 +905,25 @@ celix_status_t pubsubAdmin_closeAllSubscriptions(pubsub_admin_pt admin,char* sco
 
 }
 
+celix_status_t pubsubAdmin_executeStatsCommand(void *handle, char *commandLine, FILE *out, FILE *err){
+	pubsub_admin_pt admin = handle;
+
+	celixThreadMutex_lock(&admin->subscriptionsLock);
+	if(hashMap_size(admin->subscriptions) == 0){
+		fprintf(out, "No subscriptions\n");
+	}
+	hash_map_iterator_pt iter = hashMapIterator_create(admin->subscriptions);
+	while(hashMapIterator_hasNext(iter)){
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+		fprintf(out, "Subscription %s:\n", (char*)hashMapEntry_getKey(entry));
+		pubsub_topicSubscriptionPrintStats((topic_subscription_pt)hashMapEntry_getValue(entry), out);
+	}
+	hashMapIterator_destroy(iter);
+	celixThreadMutex_unlock(&admin->subscriptionsLock);
+
+	return CELIX_SUCCESS;
+}
+
 
 #ifndef ANDROID
 static celix_status_t pubsubAdmin_getIpAdress(const char* interface, char** ip) {
@@ -931,6 +1098,7 @@ celix_status_t pubsubAdmin_serializerRemoved(void * handle, service_reference_pt
 		for(i=0;i<arrayList_size(topicSubList);i++){
 			topic_subscription_pt topicSub = (topic_subscription_pt)arrayList_get(topicSubList,i);
 			/* Stop the topic subscription */
+			detachLocalSubscription(admin, topicSub);
 			pubsub_topicSubscriptionStop(topicSub);
 			/* Get the endpoints that are going to be orphan */
 			array_list_pt subList = pubsub_topicSubscriptionGetSubscribersList(topicSub);
@@ -985,6 +1153,12 @@ celix_status_t pubsubAdmin_serializerRemoved(void * handle, service_reference_pt
 celix_status_t pubsubAdmin_matchEndpoint(pubsub_admin_pt admin, pubsub_endpoint_pt endpoint, double* score){
 	celix_status_t status = CELIX_SUCCESS;
 
+	/* Endpoints bound by another kind of admin (e.g. shm://) cannot be connected by this one */
+	if (endpoint->endpoint != NULL && strncmp(endpoint->endpoint, "tcp://", strlen("tcp://")) != 0) {
+		*score = 0;
+		return status;
+	}
+
 	celixThreadMutex_lock(&admin->serializerListLock);
 	status = pubsub_admin_match(endpoint->topic_props,PUBSUB_ADMIN_TYPE,admin->serializerList,score);
 	celixThreadMutex_unlock(&admin->serializerListLock);
@@ -1038,3 +1212,20 @@ static void disconnectTopicPubSubFromSerializer(pubsub_admin_pt admin,void *topi
 	celixThreadMutex_unlock(&admin->usedSerializersLock);
 
 }
+
+/* Makes sure no local publication delivers to the subscription anymore */
+static void detachLocalSubscription(pubsub_admin_pt admin,topic_subscription_pt subscription){
+
+	if(!admin->localDelivery){
+		return;
+	}
+
+	celixThreadMutex_lock(&admin->localPublicationsLock);
+	hash_map_iterator_pt iter = hashMapIterator_create(admin->localPublications);
+	while(hashMapIterator_hasNext(iter)){
+		service_factory_pt factory = (service_factory_pt)hashMapIterator_nextValue(iter);
+		pubsub_topicPublicationRemoveLocalSubscription((topic_publication_pt)factory->handle, subscription);
+	}
+	hashMapIterator_destroy(iter);
+	celixThreadMutex_unlock(&admin->localPublicationsLock);
+}
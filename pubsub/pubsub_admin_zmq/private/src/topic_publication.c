@@ -30,6 +30,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <poll.h>
 
 #include "array_list.h"
 #include "celixbool.h"
@@ -39,10 +43,14 @@
 #include "version.h"
 
 #include "pubsub_common.h"
+#include "pubsub_msg_header.h"
+#include "pubsub_late_joiner.h"
 #include "pubsub_utils.h"
 #include "publisher.h"
 
 #include "topic_publication.h"
+#include "pubsub_msg_type_index.h"
+#include "pubsub_msg_pool.h"
 
 #include "pubsub_serializer.h"
 
@@ -55,7 +63,7 @@
 #define EP_ADDRESS_LEN		32
 #define ZMQ_BIND_MAX_RETRY	5
 
-#define FIRST_SEND_DELAY	2
+#define JOIN_POLL_INTERVAL	200 // ms, also bounds the delay of noticing a subscription while sending
 
 struct topic_publication {
 	zsock_t* zmq_socket;
@@ -67,6 +75,32 @@ struct topic_publication {
 	hash_map_pt boundServices; //<bundle_pt,bound_service>
 	pubsub_serializer_service_t *serializer;
 	celix_thread_mutex_t tp_lock;
+	pubsub_msg_type_index_pt msgTypeIndex; // Local indices of the msg types of all bound services, guarded by tp_lock
+
+	/* Wire header, seqNr is guarded by tp_lock */
+	bool compactHeader;
+	unsigned int topicId;
+	unsigned int publisherId;
+	unsigned int seqNr;
+
+	/*
+	 * Late joiners, guarded by tp_lock. When enabled the socket is an XPUB socket and the
+	 * join thread reads the subscriptions from it.
+	 */
+	bool lateJoiners;
+	unsigned int nrJoins;
+	unsigned int lateJoinerTimeout; // ms
+	bool lateJoinerWaitDone; // the first send is done waiting
+	struct timespec lateJoinerDeadline;
+	pubsub_lvc_pt lvc; // NULL when no last value cache is configured
+	bool joinRunning;
+	celix_thread_t joinThread;
+	celix_thread_cond_t joinCond;
+
+	celix_thread_mutex_t localSubscriptions_lock; //Recursive, held while delivering to the local subscriptions
+	celix_thread_mutexattr_t localSubscriptions_attr;
+	array_list_pt localSubscriptions; //List<topic_subscription_pt>
+	int nrLocalSubscriptions; //Read without lock on the send path
 };
 
 typedef struct publish_bundle_bound_service {
@@ -75,6 +109,9 @@ typedef struct publish_bundle_bound_service {
 	bundle_pt bundle;
 	char *topic;
 	hash_map_pt msgTypes;
+	pubsub_msg_serializer_t **msgSerializers; // by local msg type index of the parent
+	unsigned int nrOfMsgSerializers;
+	pubsub_msg_pool_pt msgPool; // msgs allocated for the bundle with allocMsg
 	unsigned short getCount;
 	celix_thread_mutex_t mp_lock; //Protects publish_bundle_bound_service data structure
 	bool mp_send_in_progress;
@@ -86,11 +123,14 @@ typedef struct publish_bundle_bound_service {
  * 2. mp_lock
  * 3. socket_lock
  *
- * tp_lock and socket_lock are independent.
+ * tp_lock and socket_lock are independent, but the socket is only used with socket_lock taken.
+ * localSubscriptions_lock is never taken while holding one of the others,
+ * a subscriber may publish again from within its receive callback.
  */
 
 typedef struct pubsub_msg{
-	pubsub_msg_header_pt header;
+	void* header; // struct pubsub_msg_header or an encoded compact header
+	size_t headerSize;
 	char* payload;
 	int payloadSize;
 }* pubsub_msg_pt;
@@ -106,8 +146,18 @@ static void pubsub_destroyPublishBundleBoundService(publish_bundle_bound_service
 static int pubsub_topicPublicationSend(void* handle,unsigned int msgTypeId, const void *msg);
 static int pubsub_topicPublicationSendMultipart(void *handle, unsigned int msgTypeId, const void *inMsg, int flags);
 static int pubsub_localMsgTypeIdForUUID(void* handle, const char* msgType, unsigned int* msgTypeId);
-
-static void delay_first_send_for_late_joiners(void);
+static int pubsub_topicPublicationAllocMsg(void* handle, unsigned int msgTypeId, void **msg);
+static int pubsub_topicPublicationSendAndFreeMsg(void* handle, unsigned int msgTypeId, void *msg);
+static int pubsub_topicPublicationFreeMsg(void* handle, unsigned int msgTypeId, void *msg);
+
+static void wait_for_late_joiners(topic_publication_pt pub);
+static void cache_msg_parts(topic_publication_pt pub, array_list_pt mp_msg_parts);
+static bool resend_cached_msg(void *handle, struct iovec *parts, unsigned int nrParts);
+static void* pubsub_topicPublicationJoinThread(void *arg);
+static void encode_msg_header(publish_bundle_bound_service_pt bound, pubsub_msg_pt msg, unsigned int msgTypeId, int major, int minor, size_t payloadSize);
+static array_list_pt copy_mp_frames(array_list_pt mp_msg_parts);
+static void deliver_local_msg(topic_publication_pt pub, pubsub_msg_serializer_t *msgSer, const void *msg);
+static void deliver_local_mp_msg(topic_publication_pt pub, array_list_pt frames);
 
 celix_status_t pubsub_topicPublicationCreate(bundle_context_pt bundle_context, pubsub_endpoint_pt pubEP, pubsub_serializer_service_t *best_serializer, char* bindIP, unsigned int basePort, unsigned int maxPort, topic_publication_pt *out){
 	celix_status_t status = CELIX_SUCCESS;
@@ -162,7 +212,12 @@ celix_status_t pubsub_topicPublicationCreate(bundle_context_pt bundle_context, p
 	}
 #endif
 
-	zsock_t* socket = zsock_new (ZMQ_PUB);
+	unsigned int lateJoinerTimeout = pubsubLateJoiner_getTimeout(pubEP->topic_props);
+	unsigned int lvcSize = pubsubLateJoiner_getLvcSize(pubEP->topic_props);
+	bool lateJoiners = (lateJoinerTimeout > 0 || lvcSize > 0);
+
+	/* An XPUB socket passes the subscriptions of connecting subscribers on to the join thread */
+	zsock_t* socket = zsock_new (lateJoiners ? ZMQ_XPUB : ZMQ_PUB);
 	if(socket==NULL){
 		#ifdef BUILD_WITH_ZMQ_SECURITY
 			if (pubEP->is_secure){
@@ -173,6 +228,9 @@ celix_status_t pubsub_topicPublicationCreate(bundle_context_pt bundle_context, p
         perror("Error for zmq_socket");
 		return CELIX_SERVICE_EXCEPTION;
 	}
+	if(lateJoiners){
+		zsock_set_xpub_verbose(socket, 1); // every subscriber, not only the first one per topic
+	}
 #ifdef BUILD_WITH_ZMQ_SECURITY
 	if (pubEP->is_secure){
 		zcert_apply (pub_cert, socket); // apply certificate to socket
@@ -211,13 +269,34 @@ celix_status_t pubsub_topicPublicationCreate(bundle_context_pt bundle_context, p
 	arrayList_create(&(pub->pub_ep_list));
 	pub->boundServices = hashMap_create(NULL,NULL,NULL,NULL);
 	celixThreadMutex_create(&(pub->tp_lock),NULL);
+	pubsubMsgTypeIndex_create(&pub->msgTypeIndex);
 
 	pub->endpoint = ep;
 	pub->zmq_socket = socket;
 	pub->serializer = best_serializer;
 
+	pub->compactHeader = pubsubMsgHeader_useCompact(pubEP->topic_props);
+	pub->topicId = utils_stringHash(pubEP->topic);
+	pub->publisherId = utils_stringHash(pub->endpoint);
+	if(pub->compactHeader){
+		printf("PSA_ZMQ_TP: Using the compact wire header for topic %s.\n", pubEP->topic);
+	}
+
 	celixThreadMutex_create(&(pub->socket_lock),NULL);
 
+	celixThreadCondition_init(&pub->joinCond, NULL);
+	pub->lateJoiners = lateJoiners;
+	pub->lateJoinerTimeout = lateJoinerTimeout;
+	pub->lateJoinerWaitDone = (lateJoinerTimeout == 0);
+	if(lvcSize > 0 && pubsubLvc_create(lvcSize, &pub->lvc) == CELIX_SUCCESS){
+		printf("PSA_ZMQ_TP: Replaying the last %u messages of topic %s to late joiners.\n", lvcSize, pubEP->topic);
+	}
+
+	arrayList_create(&(pub->localSubscriptions));
+	celixThreadMutexAttr_create(&(pub->localSubscriptions_attr));
+	celixThreadMutexAttr_settype(&(pub->localSubscriptions_attr), CELIX_THREAD_MUTEX_RECURSIVE);
+	celixThreadMutex_create(&(pub->localSubscriptions_lock), &(pub->localSubscriptions_attr));
+
 #ifdef BUILD_WITH_ZMQ_SECURITY
 	if (pubEP->is_secure){
 		pub->zmq_cert = pub_cert;
@@ -249,6 +328,11 @@ celix_status_t pubsub_topicPublicationDestroy(topic_publication_pt pub){
 
 	pub->svcFactoryReg = NULL;
 	pub->serializer = NULL;
+
+	if(pub->lvc != NULL){
+		pubsubLvc_destroy(pub->lvc);
+	}
+	celixThreadCondition_destroy(&pub->joinCond);
 #ifdef BUILD_WITH_ZMQ_SECURITY
 	zcert_destroy(&(pub->zmq_cert));
 #endif
@@ -256,6 +340,7 @@ celix_status_t pubsub_topicPublicationDestroy(topic_publication_pt pub){
 	celixThreadMutex_unlock(&(pub->tp_lock));
 
 	celixThreadMutex_destroy(&(pub->tp_lock));
+	pubsubMsgTypeIndex_destroy(pub->msgTypeIndex);
 
 	celixThreadMutex_lock(&(pub->socket_lock));
 	zsock_destroy(&(pub->zmq_socket));
@@ -263,6 +348,12 @@ celix_status_t pubsub_topicPublicationDestroy(topic_publication_pt pub){
 
 	celixThreadMutex_destroy(&(pub->socket_lock));
 
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	arrayList_destroy(pub->localSubscriptions);
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+	celixThreadMutex_destroy(&(pub->localSubscriptions_lock));
+	celixThreadMutexAttr_destroy(&(pub->localSubscriptions_attr));
+
 	free(pub);
 
 	return status;
@@ -286,11 +377,30 @@ celix_status_t pubsub_topicPublicationStart(bundle_context_pt bundle_context,top
 		properties_set(props,PUBSUB_PUBLISHER_SCOPE,pubEP->scope);
 		properties_set(props,"service.version", PUBSUB_PUBLISHER_SERVICE_VERSION);
 
+		/* The join state has to be complete before the first publisher can send */
+		celixThreadMutex_lock(&(pub->tp_lock));
+		if(pub->lateJoiners){
+			pub->joinRunning = true;
+			if(celixThread_create(&pub->joinThread, NULL, pubsub_topicPublicationJoinThread, pub) != CELIX_SUCCESS){
+				pub->joinRunning = false;
+				pub->lateJoinerWaitDone = true;
+			}
+		}
+		celixThreadMutex_unlock(&(pub->tp_lock));
+
 		status = bundleContext_registerServiceFactory(bundle_context,PUBSUB_PUBLISHER_SERVICE_NAME,factory,props,&(pub->svcFactoryReg));
 
 		if(status != CELIX_SUCCESS){
 			properties_destroy(props);
 			printf("PSA_ZMQ_PSA_ZMQ_TP: Cannot register ServiceFactory for topic %s (bundle %ld).\n",pubEP->topic,pubEP->serviceID);
+
+			celixThreadMutex_lock(&(pub->tp_lock));
+			bool joinWasRunning = pub->joinRunning;
+			pub->joinRunning = false;
+			celixThreadMutex_unlock(&(pub->tp_lock));
+			if(joinWasRunning){
+				celixThread_join(pub->joinThread, NULL);
+			}
 		}
 		else{
 			*svcFactory = factory;
@@ -305,7 +415,18 @@ celix_status_t pubsub_topicPublicationStart(bundle_context_pt bundle_context,top
 }
 
 celix_status_t pubsub_topicPublicationStop(topic_publication_pt pub){
-	return serviceRegistration_unregister(pub->svcFactoryReg);
+	celix_status_t status = serviceRegistration_unregister(pub->svcFactoryReg);
+
+	celixThreadMutex_lock(&(pub->tp_lock));
+	bool joinWasRunning = pub->joinRunning;
+	pub->joinRunning = false;
+	celixThreadCondition_broadcast(&pub->joinCond);
+	celixThreadMutex_unlock(&(pub->tp_lock));
+	if(joinWasRunning){
+		celixThread_join(pub->joinThread, NULL);
+	}
+
+	return status;
 }
 
 celix_status_t pubsub_topicPublicationAddPublisherEP(topic_publication_pt pub,pubsub_endpoint_pt ep){
@@ -341,6 +462,29 @@ array_list_pt pubsub_topicPublicationGetPublisherList(topic_publication_pt pub){
 	return list;
 }
 
+celix_status_t pubsub_topicPublicationAddLocalSubscription(topic_publication_pt pub, topic_subscription_pt sub){
+
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	if(!arrayList_contains(pub->localSubscriptions,sub)){
+		arrayList_add(pub->localSubscriptions,sub);
+		__atomic_store_n(&pub->nrLocalSubscriptions, arrayList_size(pub->localSubscriptions), __ATOMIC_RELEASE);
+	}
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_topicPublicationRemoveLocalSubscription(topic_publication_pt pub, topic_subscription_pt sub){
+
+	/* Blocks until a delivery in progress to this subscription is finished */
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	arrayList_removeElement(pub->localSubscriptions,sub);
+	__atomic_store_n(&pub->nrLocalSubscriptions, arrayList_size(pub->localSubscriptions), __ATOMIC_RELEASE);
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+
+	return CELIX_SUCCESS;
+}
+
 
 static celix_status_t pubsub_topicPublicationGetService(void* handle, bundle_pt bundle, service_registration_pt registration, void **service) {
 	celix_status_t  status = CELIX_SUCCESS;
@@ -401,13 +545,11 @@ static bool send_pubsub_msg(zsock_t* zmq_socket, pubsub_msg_pt msg, bool last){
 
 	bool ret = true;
 
-	zframe_t* headerMsg = zframe_new(msg->header, sizeof(struct pubsub_msg_header));
+	zframe_t* headerMsg = zframe_new(msg->header, msg->headerSize);
 	if (headerMsg == NULL) ret=false;
 	zframe_t* payloadMsg = zframe_new(msg->payload, msg->payloadSize);
 	if (payloadMsg == NULL) ret=false;
 
-	delay_first_send_for_late_joiners();
-
 	if( zframe_send(&headerMsg,zmq_socket, ZFRAME_MORE) == -1) ret=false;
 
 	if(!last){
@@ -456,8 +598,14 @@ static int pubsub_topicPublicationSendMultipart(void *handle, unsigned int msgTy
 	int status = 0;
 
 	publish_bundle_bound_service_pt bound = (publish_bundle_bound_service_pt) handle;
+	bool local = __atomic_load_n(&bound->parent->nrLocalSubscriptions, __ATOMIC_ACQUIRE) > 0;
+	array_list_pt localFrames = NULL;
 
 	celixThreadMutex_lock(&(bound->parent->tp_lock));
+
+	/* The wait releases tp_lock, so it is done before taking mp_lock (the order unget uses) and before any state is read */
+	wait_for_late_joiners(bound->parent);
+
 	celixThreadMutex_lock(&(bound->mp_lock));
 	if( (flags & PUBSUB_PUBLISHER_FIRST_MSG) && !(flags & PUBSUB_PUBLISHER_LAST_MSG) && bound->mp_send_in_progress){ //means a real mp_msg
 		printf("PSA_ZMQ_TP: Multipart send already in progress. Cannot process a new one.\n");
@@ -466,20 +614,14 @@ static int pubsub_topicPublicationSendMultipart(void *handle, unsigned int msgTy
 		return -3;
 	}
 
-	pubsub_msg_serializer_t* msgSer = (pubsub_msg_serializer_t*)hashMap_get(bound->msgTypes, (void*)(uintptr_t)msgTypeId);
+	pubsub_msg_serializer_t* msgSer = pubsubMsgTypeIndex_getSerializer(bound->msgSerializers, bound->nrOfMsgSerializers, pubsubMsgTypeIndex_get(bound->parent->msgTypeIndex, msgTypeId));
 
 	if (msgSer!= NULL) {
 		int major=0, minor=0;
 
-		pubsub_msg_header_pt msg_hdr = calloc(1,sizeof(struct pubsub_msg_header));
-		strncpy(msg_hdr->topic,bound->topic,MAX_TOPIC_LEN-1);
-		msg_hdr->type = msgTypeId;
-
 		if (msgSer->msgVersion != NULL){
 			version_getMajor(msgSer->msgVersion, &major);
 			version_getMinor(msgSer->msgVersion, &minor);
-			msg_hdr->major = major;
-			msg_hdr->minor = minor;
 		}
 
 		void *serializedOutput = NULL;
@@ -487,7 +629,7 @@ static int pubsub_topicPublicationSendMultipart(void *handle, unsigned int msgTy
 		msgSer->serialize(msgSer,inMsg,&serializedOutput, &serializedOutputLen);
 
 		pubsub_msg_pt msg = calloc(1,sizeof(struct pubsub_msg));
-		msg->header = msg_hdr;
+		encode_msg_header(bound, msg, msgTypeId, major, minor, serializedOutputLen);
 		msg->payload = (char*)serializedOutput;
 		msg->payloadSize = serializedOutputLen;
 		bool snd = true;
@@ -513,12 +655,29 @@ static int pubsub_topicPublicationSendMultipart(void *handle, unsigned int msgTy
 			}
 			else{
 				arrayList_add(bound->mp_parts,msg);
+				if(local){
+					localFrames = copy_mp_frames(bound->mp_parts);
+				}
+				if(bound->parent->lvc != NULL){
+					cache_msg_parts(bound->parent, bound->mp_parts);
+				}
+				celixThreadMutex_lock(&(bound->parent->socket_lock));
 				snd = send_pubsub_mp_msg(bound->parent->zmq_socket,bound->mp_parts);
+				celixThreadMutex_unlock(&(bound->parent->socket_lock));
 				bound->mp_send_in_progress = false;
 			}
 			break;
 		case PUBSUB_PUBLISHER_FIRST_MSG | PUBSUB_PUBLISHER_LAST_MSG:	//Normal send case
+			if(bound->parent->lvc != NULL){
+				array_list_pt parts = NULL;
+				arrayList_create(&parts);
+				arrayList_add(parts, msg);
+				cache_msg_parts(bound->parent, parts);
+				arrayList_destroy(parts);
+			}
+			celixThreadMutex_lock(&(bound->parent->socket_lock));
 			snd = send_pubsub_msg(bound->parent->zmq_socket,msg,true);
+			celixThreadMutex_unlock(&(bound->parent->socket_lock));
 			break;
 		default:
 			printf("PSA_ZMQ_TP: ERROR: Invalid MP flags combination\n");
@@ -542,10 +701,139 @@ static int pubsub_topicPublicationSendMultipart(void *handle, unsigned int msgTy
 	celixThreadMutex_unlock(&(bound->mp_lock));
 	celixThreadMutex_unlock(&(bound->parent->tp_lock));
 
+	/* Subscribers in this framework get the message directly, outside the locks */
+	if(local && status==0){
+		if(flags == (PUBSUB_PUBLISHER_FIRST_MSG | PUBSUB_PUBLISHER_LAST_MSG)){
+			deliver_local_msg(bound->parent, msgSer, inMsg);
+		}
+		else if(localFrames != NULL){
+			deliver_local_mp_msg(bound->parent, localFrames);
+		}
+	}
+
 	return status;
 
 }
 
+/* Builds the wire header of a message part in the format of the publication. Must be called with tp_lock taken. */
+static void encode_msg_header(publish_bundle_bound_service_pt bound, pubsub_msg_pt msg, unsigned int msgTypeId, int major, int minor, size_t payloadSize){
+
+	if(bound->parent->compactHeader){
+		struct pubsub_msg_compact_header hdr;
+		hdr.topicId = bound->parent->topicId;
+		hdr.publisherId = bound->parent->publisherId;
+		hdr.type = msgTypeId;
+		hdr.major = major;
+		hdr.minor = minor;
+		hdr.seqNr = bound->parent->seqNr++;
+		hdr.sendTime = pubsubMsgHeader_now();
+		hdr.payloadSize = payloadSize;
+
+		msg->header = malloc(PUBSUB_COMPACT_HEADER_SIZE);
+		msg->headerSize = PUBSUB_COMPACT_HEADER_SIZE;
+		pubsubMsgHeader_encodeCompact(&hdr, (unsigned char*)msg->header);
+	}
+	else{
+		pubsub_msg_header_pt msg_hdr = calloc(1,sizeof(struct pubsub_msg_header));
+		strncpy(msg_hdr->topic,bound->topic,MAX_TOPIC_LEN-1);
+		msg_hdr->type = msgTypeId;
+		msg_hdr->major = major;
+		msg_hdr->minor = minor;
+
+		msg->header = msg_hdr;
+		msg->headerSize = sizeof(struct pubsub_msg_header);
+	}
+}
+
+static array_list_pt copy_mp_frames(array_list_pt mp_msg_parts){
+
+	array_list_pt frames = NULL;
+	arrayList_create(&frames);
+
+	unsigned int i = 0;
+	for(;i<arrayList_size(mp_msg_parts);i++){
+		pubsub_msg_pt msg = (pubsub_msg_pt)arrayList_get(mp_msg_parts,i);
+		arrayList_add(frames, zframe_new(msg->header, msg->headerSize));
+		arrayList_add(frames, zframe_new(msg->payload, msg->payloadSize));
+	}
+
+	return frames;
+}
+
+static void deliver_local_msg(topic_publication_pt pub, pubsub_msg_serializer_t *msgSer, const void *msg){
+
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	unsigned int i = 0;
+	for(;i<arrayList_size(pub->localSubscriptions);i++){
+		topic_subscription_pt sub = (topic_subscription_pt)arrayList_get(pub->localSubscriptions,i);
+		pubsub_topicSubscriptionDeliverLocal(sub, msgSer, msg);
+	}
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+}
+
+static void deliver_local_mp_msg(topic_publication_pt pub, array_list_pt frames){
+
+	celixThreadMutex_lock(&(pub->localSubscriptions_lock));
+	unsigned int nrSubs = arrayList_size(pub->localSubscriptions);
+	unsigned int i = 0;
+	for(;i<nrSubs;i++){
+		topic_subscription_pt sub = (topic_subscription_pt)arrayList_get(pub->localSubscriptions,i);
+		array_list_pt subFrames = frames;
+		if(i<nrSubs-1){ //Every subscription takes over its own copy, the last one gets the original
+			unsigned int j = 0;
+			arrayList_create(&subFrames);
+			for(;j<arrayList_size(frames);j++){
+				arrayList_add(subFrames, zframe_dup((zframe_t*)arrayList_get(frames,j)));
+			}
+		}
+		pubsub_topicSubscriptionDeliverLocalMultipart(sub, subFrames);
+	}
+	celixThreadMutex_unlock(&(pub->localSubscriptions_lock));
+
+	if(nrSubs == 0){
+		unsigned int j = 0;
+		for(;j<arrayList_size(frames);j++){
+			zframe_t *frame = (zframe_t*)arrayList_get(frames,j);
+			zframe_destroy(&frame);
+		}
+		arrayList_destroy(frames);
+	}
+}
+
+static int pubsub_topicPublicationAllocMsg(void* handle, unsigned int msgTypeId, void **msg){
+	publish_bundle_bound_service_pt bound = (publish_bundle_bound_service_pt) handle;
+
+	celixThreadMutex_lock(&(bound->parent->tp_lock));
+	int localIndex = pubsubMsgTypeIndex_get(bound->parent->msgTypeIndex, msgTypeId);
+	celixThreadMutex_unlock(&(bound->parent->tp_lock));
+
+	if (bound->msgPool == NULL || pubsubMsgPool_alloc(bound->msgPool, localIndex, msg) != CELIX_SUCCESS) {
+		printf("PSA_ZMQ_TP: Cannot allocate a msg for msg type id %d\n", msgTypeId);
+		return -1;
+	}
+	return 0;
+}
+
+static int pubsub_topicPublicationSendAndFreeMsg(void* handle, unsigned int msgTypeId, void *msg){
+	int status = pubsub_topicPublicationSend(handle, msgTypeId, msg);
+	pubsub_topicPublicationFreeMsg(handle, msgTypeId, msg);
+	return status;
+}
+
+static int pubsub_topicPublicationFreeMsg(void* handle, unsigned int msgTypeId, void *msg){
+	publish_bundle_bound_service_pt bound = (publish_bundle_bound_service_pt) handle;
+
+	celixThreadMutex_lock(&(bound->parent->tp_lock));
+	int localIndex = pubsubMsgTypeIndex_get(bound->parent->msgTypeIndex, msgTypeId);
+	celixThreadMutex_unlock(&(bound->parent->tp_lock));
+
+	if (bound->msgPool == NULL || pubsubMsgPool_free(bound->msgPool, localIndex, msg) != CELIX_SUCCESS) {
+		printf("PSA_ZMQ_TP: Cannot free a pooled msg for msg type id %d\n", msgTypeId);
+		return -1;
+	}
+	return 0;
+}
+
 static int pubsub_localMsgTypeIdForUUID(void* handle, const char* msgType, unsigned int* msgTypeId){
 	*msgTypeId = utils_stringHash(msgType);
 	return 0;
@@ -575,6 +863,8 @@ static publish_bundle_bound_service_pt pubsub_createPublishBundleBoundService(to
 
 		if(tp->serializer != NULL){
 			tp->serializer->createSerializerMap(tp->serializer->handle,bundle,&bound->msgTypes);
+			pubsubMsgTypeIndex_bind(tp->msgTypeIndex,bound->msgTypes,&bound->msgSerializers,&bound->nrOfMsgSerializers);
+			pubsubMsgPool_create(bound->msgSerializers,bound->nrOfMsgSerializers,PUBSUB_MSG_POOL_DEFAULT_MAX_PER_TYPE,&bound->msgPool);
 		}
 
 		arrayList_create(&bound->mp_parts);
@@ -586,6 +876,9 @@ static publish_bundle_bound_service_pt pubsub_createPublishBundleBoundService(to
 		bound->service.localMsgTypeIdForMsgType = pubsub_localMsgTypeIdForUUID;
 		bound->service.send = pubsub_topicPublicationSend;
 		bound->service.sendMultipart = pubsub_topicPublicationSendMultipart;
+		bound->service.allocMsg = pubsub_topicPublicationAllocMsg;
+		bound->service.sendAndFreeMsg = pubsub_topicPublicationSendAndFreeMsg;
+		bound->service.freeMsg = pubsub_topicPublicationFreeMsg;
 
 	}
 
@@ -599,9 +892,14 @@ static void pubsub_destroyPublishBundleBoundService(publish_bundle_bound_service
 	celixThreadMutex_lock(&boundSvc->mp_lock);
 
 
+	if(boundSvc->msgPool != NULL){
+		pubsubMsgPool_destroy(boundSvc->msgPool);
+	}
+
 	if(boundSvc->parent->serializer != NULL && boundSvc->msgTypes != NULL){
 		boundSvc->parent->serializer->destroySerializerMap(boundSvc->parent->serializer->handle, boundSvc->msgTypes);
 	}
+	free(boundSvc->msgSerializers);
 
 	if(boundSvc->mp_parts!=NULL){
 		arrayList_destroy(boundSvc->mp_parts);
@@ -618,13 +916,117 @@ static void pubsub_destroyPublishBundleBoundService(publish_bundle_bound_service
 
 }
 
-static void delay_first_send_for_late_joiners(){
+/*
+ * Lets the first send(s) of the publication wait until a subscriber subscribed,
+ * at most lateJoinerTimeout ms. Must be called with tp_lock taken and no other lock, the wait releases tp_lock.
+ */
+static void wait_for_late_joiners(topic_publication_pt pub){
+
+	if(pub->lateJoinerWaitDone){
+		return;
+	}
+
+	if(pub->lateJoinerDeadline.tv_sec == 0){
+		clock_gettime(CLOCK_REALTIME, &pub->lateJoinerDeadline);
+		pub->lateJoinerDeadline.tv_sec += pub->lateJoinerTimeout / 1000;
+		pub->lateJoinerDeadline.tv_nsec += (pub->lateJoinerTimeout % 1000) * 1000000L;
+		if(pub->lateJoinerDeadline.tv_nsec >= 1000000000L){
+			pub->lateJoinerDeadline.tv_sec++;
+			pub->lateJoinerDeadline.tv_nsec -= 1000000000L;
+		}
+	}
+
+	int rc = 0;
+	while(pub->nrJoins == 0 && pub->joinRunning && rc != ETIMEDOUT){
+		rc = pthread_cond_timedwait(&pub->joinCond, &(pub->tp_lock), &pub->lateJoinerDeadline);
+	}
+
+	if(!pub->lateJoinerWaitDone && pub->nrJoins == 0){
+		printf("PSA_ZMQ_TP: No subscriber joined %s within %u ms, sending anyway.\n", pub->endpoint, pub->lateJoinerTimeout);
+	}
+	pub->lateJoinerWaitDone = true;
+}
+
+/* Stores the header and payload frames of a (multipart) message in the last value cache. Must be called with tp_lock taken. */
+static void cache_msg_parts(topic_publication_pt pub, array_list_pt mp_msg_parts){
+
+	unsigned int nrParts = arrayList_size(mp_msg_parts);
+	struct iovec *frames = calloc(2 * nrParts, sizeof(struct iovec));
+	unsigned int i = 0;
+	for(;i<nrParts;i++){
+		pubsub_msg_pt msg = (pubsub_msg_pt)arrayList_get(mp_msg_parts,i);
+		frames[2*i].iov_base = msg->header;
+		frames[2*i].iov_len = msg->headerSize;
+		frames[2*i+1].iov_base = msg->payload;
+		frames[2*i+1].iov_len = msg->payloadSize;
+	}
+	pubsubLvc_add(pub->lvc, frames, 2 * nrParts);
+	free(frames);
+}
+
+static bool resend_cached_msg(void *handle, struct iovec *parts, unsigned int nrParts){
+	topic_publication_pt pub = (topic_publication_pt)handle;
+	bool ret = true;
+
+	celixThreadMutex_lock(&(pub->socket_lock));
+	unsigned int i = 0;
+	for(;i<nrParts && ret;i++){
+		zframe_t* frame = zframe_new(parts[i].iov_base, parts[i].iov_len);
+		if(zframe_send(&frame, pub->zmq_socket, (i < nrParts-1) ? ZFRAME_MORE : 0) == -1){
+			zframe_destroy(&frame);
+			ret = false;
+		}
+	}
+	celixThreadMutex_unlock(&(pub->socket_lock));
+
+	return ret;
+}
+
+/* Reads the subscriptions from the XPUB socket, releases waiting sends and replays the last value cache */
+static void* pubsub_topicPublicationJoinThread(void *arg){
+	topic_publication_pt pub = (topic_publication_pt)arg;
+	bool running = true;
 
-	static bool firstSend = true;
+	celixThreadMutex_lock(&(pub->socket_lock));
+	int fd = zsock_fd(pub->zmq_socket);
+	celixThreadMutex_unlock(&(pub->socket_lock));
 
-	if(firstSend){
-		printf("PSA_ZMQ_TP: Delaying first send for late joiners...\n");
-		sleep(FIRST_SEND_DELAY);
-		firstSend = false;
+	while(running){
+		/* The fd only signals that the socket state may have changed, the events tell what */
+		struct pollfd pfd;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		poll(&pfd, 1, JOIN_POLL_INTERVAL);
+
+		unsigned int nrJoins = 0;
+		celixThreadMutex_lock(&(pub->socket_lock));
+		while(zsock_events(pub->zmq_socket) & ZMQ_POLLIN){
+			zframe_t* frame = zframe_recv(pub->zmq_socket);
+			if(frame == NULL){
+				break;
+			}
+			/* Subscribers also subscribe to the compact header prefix, count every subscriber once */
+			unsigned char *data = zframe_data(frame);
+			if(zframe_size(frame) > 1 && data[0] == 1 && data[1] != PUBSUB_COMPACT_HEADER_MARKER){
+				nrJoins++;
+			}
+			zframe_destroy(&frame);
+		}
+		celixThreadMutex_unlock(&(pub->socket_lock));
+
+		celixThreadMutex_lock(&(pub->tp_lock));
+		if(nrJoins > 0){
+			pub->nrJoins += nrJoins;
+			celixThreadCondition_broadcast(&pub->joinCond);
+			if(pub->lvc != NULL){
+				unsigned int nrSent = pubsubLvc_replay(pub->lvc, resend_cached_msg, pub);
+				printf("PSA_ZMQ_TP: %u subscriber(s) joined %s, resent %u cached messages.\n", nrJoins, pub->endpoint, nrSent);
+			}
+		}
+		running = pub->joinRunning;
+		celixThreadMutex_unlock(&(pub->tp_lock));
 	}
+
+	return NULL;
 }
@@ -47,6 +47,11 @@
 #include "subscriber.h"
 #include "publisher.h"
 #include "pubsub_utils.h"
+#include "pubsub_topic_trie.h"
+#include "pubsub_msg_type_index.h"
+#include "pubsub_msg_header.h"
+#include "pubsub_msg_stats.h"
+#include "pubsub_dispatch_pool.h"
 
 #ifdef BUILD_WITH_ZMQ_SECURITY
 #include "zmq_crypto.h"
@@ -72,7 +77,8 @@ struct topic_subscription{
 
 	pubsub_serializer_service_t *serializer;
 
-	hash_map_pt servicesMap; // key = service, value = msg types map
+	hash_map_pt servicesMap; // key = service, value = subscriber_msg_types
+	pubsub_msg_type_index_pt msgTypeIndex; // Local indices of the msg types of all subscribers, guarded by ts_lock
 
 	celix_thread_mutex_t pendingConnections_lock;
 	array_list_pt pendingConnections;
@@ -81,11 +87,29 @@ struct topic_subscription{
 	celix_thread_mutex_t pendingDisconnections_lock;
 
 	unsigned int nrSubscribers;
+	pubsub_msg_stats_pt stats; // filled from compact headers
+	pubsub_dispatch_pool_pt dispatchPool; // calls the subscribers with dispatch threads, created for the first one, guarded by ts_lock
+	unsigned int localDeliveries; // local deliveries calling subscribers outside ts_lock, guarded by ts_lock
+	celix_thread_cond_t localDeliveries_cond;
 };
 
+/* The msg serializers of a subscriber, indexed by the local msg type index of the subscription, and its dispatch properties */
+typedef struct subscriber_msg_types{
+	hash_map_pt msgTypes;
+	pubsub_msg_serializer_t **msgSerializers;
+	unsigned int nrOfMsgSerializers;
+	bool dispatch;
+	bool orderPerMsgType;
+	bool arena; // deserialize the messages in one arena
+}* subscriber_msg_types_pt;
+
 typedef struct complete_zmq_msg{
 	zframe_t* header;
 	zframe_t* payload;
+	/* Decoded from the legacy or compact header frame */
+	unsigned int type;
+	unsigned char major;
+	unsigned char minor;
 }* complete_zmq_msg_pt;
 
 typedef struct mp_handle{
@@ -98,15 +122,44 @@ typedef struct msg_map_entry{
 	void* msgInst;
 }* msg_map_entry_pt;
 
+/* The frames of a received (multipart) msg, shared by the dispatch tasks of its subscribers and freed by the last one */
+typedef struct received_msg{
+	unsigned int refCount;
+	array_list_pt msg_list;
+}* received_msg_pt;
+
+typedef struct dispatch_task{
+	pubsub_subscriber_pt subsvc;
+	hash_map_pt msgTypes;
+	pubsub_msg_serializer_t *msgSer;
+	bool arena;
+	received_msg_pt msg;
+}* dispatch_task_pt;
+
+/* A subscriber of a locally published msg, copied under ts_lock and called without it */
+struct local_delivery{
+	pubsub_subscriber_pt subsvc;
+	hash_map_pt msgTypes;
+	pubsub_msg_serializer_t *msgSer;
+	bool arena;
+	bool sameVersion; // receives the publisher's instance
+};
+
 static celix_status_t topicsub_subscriberTracked(void * handle, service_reference_pt reference, void * service);
 static celix_status_t topicsub_subscriberUntracked(void * handle, service_reference_pt reference, void * service);
 static void* zmq_recv_thread_func(void* arg);
-static bool checkVersion(version_pt msgVersion,pubsub_msg_header_pt hdr);
+static bool checkVersion(version_pt msgVersion,unsigned char major,unsigned char minor);
+static bool decode_msg_headers(topic_subscription_pt sub, array_list_pt msg_list);
+static void process_msg(topic_subscription_pt sub,array_list_pt msg_list);
 static void sigusr1_sighandler(int signo);
 static int pubsub_localMsgTypeIdForMsgType(void* handle, const char* msgType, unsigned int* msgTypeId);
 static int pubsub_getMultipart(void *handle, unsigned int msgTypeId, bool retain, void **part);
 static mp_handle_pt create_mp_handle(hash_map_pt svc_msg_db,array_list_pt rcv_msg_list);
 static void destroy_mp_handle(mp_handle_pt mp_handle);
+static void receive_msg(pubsub_subscriber_pt subsvc, hash_map_pt msgTypes, pubsub_msg_serializer_t *msgSer, bool arena, array_list_pt msg_list);
+static void dispatch_msg(void *arg);
+static void release_received_msg(received_msg_pt msg);
+static received_msg_pt serialize_local_msg(pubsub_msg_serializer_t *msgSer, const void *msg, pubsub_msg_header_pt hdr);
 static void connectPendingPublishers(topic_subscription_pt sub);
 static void disconnectPendingPublishers(topic_subscription_pt sub);
 
@@ -166,11 +219,16 @@ celix_status_t pubsub_topicSubscriptionCreate(bundle_context_pt bundle_context,
 	zsock_set_curve_serverkey (zmq_s, pub_key); //apply key of publisher to socket of subscriber
 #endif
 
-	if(strcmp(topic,PUBSUB_ANY_SUB_TOPIC)==0){
+	if(strcmp(topic,PUBSUB_ANY_SUB_TOPIC)==0 || pubsubTopic_isWildcard(topic)){
+		/* Wildcard subscriptions are only connected to publications with a matching topic */
 		zsock_set_subscribe (zmq_s, "");
 	}
 	else{
+		/* Publications send either the legacy header, starting with the topic name, or the compact one, starting with the topic id */
 		zsock_set_subscribe (zmq_s, topic);
+		unsigned char compactPrefix[PUBSUB_COMPACT_HEADER_PREFIX_SIZE];
+		pubsubMsgHeader_compactTopicPrefix(topic, compactPrefix);
+		zmq_setsockopt(zsock_resolve(zmq_s), ZMQ_SUBSCRIBE, compactPrefix, PUBSUB_COMPACT_HEADER_PREFIX_SIZE);
 	}
 
 	topic_subscription_pt ts = (topic_subscription_pt) calloc(1,sizeof(*ts));
@@ -187,6 +245,8 @@ celix_status_t pubsub_topicSubscriptionCreate(bundle_context_pt bundle_context,
 
 	celixThreadMutex_create(&ts->socket_lock, NULL);
 	celixThreadMutex_create(&ts->ts_lock,NULL);
+	celixThreadCondition_init(&ts->localDeliveries_cond, NULL);
+	pubsubMsgTypeIndex_create(&ts->msgTypeIndex);
 	arrayList_create(&ts->sub_ep_list);
 	ts->servicesMap = hashMap_create(NULL, NULL, NULL, NULL);
 
@@ -195,20 +255,24 @@ celix_status_t pubsub_topicSubscriptionCreate(bundle_context_pt bundle_context,
 	celixThreadMutex_create(&ts->pendingConnections_lock, NULL);
 	celixThreadMutex_create(&ts->pendingDisconnections_lock, NULL);
 
+	status += pubsubMsgStats_create(&ts->stats);
+
 	char filter[128];
 	memset(filter,0,128);
+	char *filterTopic = pubsubTopic_createFilterValue(topic); // Wildcard topics contain '*', which has a meaning in filters
 	if(strncmp(PUBSUB_SUBSCRIBER_SCOPE_DEFAULT,scope,strlen(PUBSUB_SUBSCRIBER_SCOPE_DEFAULT)) == 0) {
 		// default scope, means that subscriber has not defined a scope property
 		snprintf(filter, 128, "(&(%s=%s)(%s=%s))",
 				(char*) OSGI_FRAMEWORK_OBJECTCLASS, PUBSUB_SUBSCRIBER_SERVICE_NAME,
-				PUBSUB_SUBSCRIBER_TOPIC,topic);
+				PUBSUB_SUBSCRIBER_TOPIC,filterTopic);
 
 	} else {
 		snprintf(filter, 128, "(&(%s=%s)(%s=%s)(%s=%s))",
 				(char*) OSGI_FRAMEWORK_OBJECTCLASS, PUBSUB_SUBSCRIBER_SERVICE_NAME,
-				PUBSUB_SUBSCRIBER_TOPIC,topic,
+				PUBSUB_SUBSCRIBER_TOPIC,filterTopic,
 				PUBSUB_SUBSCRIBER_SCOPE,scope);
 	}
+	free(filterTopic);
 	service_tracker_customizer_pt customizer = NULL;
 	status += serviceTrackerCustomizer_create(ts,NULL,topicsub_subscriberTracked,NULL,topicsub_subscriberUntracked,&customizer);
 	status += serviceTracker_createWithFilter(bundle_context, filter, customizer, &ts->tracker);
@@ -248,6 +312,8 @@ celix_status_t pubsub_topicSubscriptionDestroy(topic_subscription_pt ts){
 	celixThreadMutex_unlock(&ts->pendingDisconnections_lock);
 	celixThreadMutex_destroy(&ts->pendingDisconnections_lock);
 
+	pubsubMsgStats_destroy(ts->stats);
+
 	celixThreadMutex_unlock(&ts->ts_lock);
 
 	celixThreadMutex_lock(&ts->socket_lock);
@@ -260,6 +326,8 @@ celix_status_t pubsub_topicSubscriptionDestroy(topic_subscription_pt ts){
 	celixThreadMutex_destroy(&ts->socket_lock);
 
 	celixThreadMutex_destroy(&ts->ts_lock);
+	celixThreadCondition_destroy(&ts->localDeliveries_cond);
+	pubsubMsgTypeIndex_destroy(ts->msgTypeIndex);
 
 	free(ts);
 
@@ -289,6 +357,15 @@ celix_status_t pubsub_topicSubscriptionStop(topic_subscription_pt ts){
 
 	celixThread_join(ts->recv_thread,NULL);
 
+	/* Delivers the messages still queued before the subscribers are untracked */
+	celixThreadMutex_lock(&ts->ts_lock);
+	pubsub_dispatch_pool_pt dispatchPool = ts->dispatchPool;
+	ts->dispatchPool = NULL;
+	celixThreadMutex_unlock(&ts->ts_lock);
+	if(dispatchPool != NULL){
+		pubsubDispatchPool_destroy(dispatchPool);
+	}
+
 	status = serviceTracker_close(ts->tracker);
 
 	return status;
@@ -384,6 +461,171 @@ array_list_pt pubsub_topicSubscriptionGetSubscribersList(topic_subscription_pt s
 	return sub->sub_ep_list;
 }
 
+celix_status_t pubsub_topicSubscriptionDeliverLocal(topic_subscription_pt ts, pubsub_msg_serializer_t *pubMsgSer, const void *msg){
+	celix_status_t status = CELIX_SUCCESS;
+
+	struct pubsub_msg_header hdr;
+	int major=0, minor=0;
+	if(pubMsgSer->msgVersion != NULL){
+		version_getMajor(pubMsgSer->msgVersion, &major);
+		version_getMinor(pubMsgSer->msgVersion, &minor);
+	}
+	hdr.type = pubMsgSer->msgId;
+	hdr.major = major;
+	hdr.minor = minor;
+
+	received_msg_pt localMsg = NULL; // the serialized msg, for dispatched subscribers and version conversions
+
+	celixThreadMutex_lock(&ts->ts_lock);
+
+	unsigned int nrOfSubscribers = hashMap_size(ts->servicesMap);
+	struct local_delivery deliveries[nrOfSubscribers > 0 ? nrOfSubscribers : 1];
+	unsigned int nrOfDeliveries = 0;
+
+	int localIndex = pubsubMsgTypeIndex_get(ts->msgTypeIndex, hdr.type);
+	hash_map_iterator_pt iter = hashMapIterator_create(ts->servicesMap);
+	while (hashMapIterator_hasNext(iter)) {
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+		pubsub_subscriber_pt subsvc = hashMapEntry_getKey(entry);
+		subscriber_msg_types_pt subMsgTypes = hashMapEntry_getValue(entry);
+
+		pubsub_msg_serializer_t *msgSer = pubsubMsgTypeIndex_getSerializer(subMsgTypes->msgSerializers, subMsgTypes->nrOfMsgSerializers, localIndex);
+		if (msgSer == NULL) {
+			printf("PSA_ZMQ_TS: Primary message %d not supported. NOT sending any part of the whole message.\n",hdr.type);
+			continue;
+		}
+
+		int cmp = -1;
+		if(msgSer->msgVersion != NULL && pubMsgSer->msgVersion != NULL){
+			version_compareTo(msgSer->msgVersion, pubMsgSer->msgVersion, &cmp);
+		}
+		if(cmp != 0 && !checkVersion(msgSer->msgVersion,hdr.major,hdr.minor)){
+			int subMajor=0,subMinor=0;
+			version_getMajor(msgSer->msgVersion,&subMajor);
+			version_getMinor(msgSer->msgVersion,&subMinor);
+			printf("PSA_ZMQ_TS: Version mismatch for primary message '%s' (have %d.%d, received %u.%u). NOT sending any part of the whole message.\n",
+					msgSer->msgName,subMajor,subMinor,hdr.major,hdr.minor);
+			continue;
+		}
+
+		if(subMsgTypes->dispatch && ts->dispatchPool != NULL){
+			/* The publisher's instance is gone when the task runs, dispatch a serialized copy */
+			if(localMsg == NULL){
+				localMsg = serialize_local_msg(pubMsgSer, msg, &hdr);
+			}
+			if(localMsg == NULL){
+				printf("PSA_ZMQ_TS: Cannot serialize msgType %s for local delivery.\n",msgSer->msgName);
+				status = CELIX_SERVICE_EXCEPTION;
+				continue;
+			}
+			dispatch_task_pt task = calloc(1, sizeof(*task));
+			task->subsvc = subsvc;
+			task->msgTypes = subMsgTypes->msgTypes;
+			task->msgSer = msgSer;
+			task->arena = subMsgTypes->arena;
+			task->msg = localMsg;
+			__atomic_add_fetch(&localMsg->refCount, 1, __ATOMIC_RELAXED);
+
+			unsigned int key = (unsigned int)((uintptr_t)subsvc >> 4);
+			if(subMsgTypes->orderPerMsgType){
+				key ^= hdr.type;
+			}
+			if(pubsubDispatchPool_dispatch(ts->dispatchPool, key, dispatch_msg, task) != CELIX_SUCCESS){
+				release_received_msg(localMsg);
+				free(task);
+			}
+		}
+		else{
+			deliveries[nrOfDeliveries].subsvc = subsvc;
+			deliveries[nrOfDeliveries].msgTypes = subMsgTypes->msgTypes;
+			deliveries[nrOfDeliveries].msgSer = msgSer;
+			deliveries[nrOfDeliveries].arena = subMsgTypes->arena;
+			deliveries[nrOfDeliveries].sameVersion = cmp == 0;
+			nrOfDeliveries++;
+		}
+	}
+	hashMapIterator_destroy(iter);
+
+	if(nrOfDeliveries > 0){
+		ts->localDeliveries++; // keeps the subscribers and their serializers until they are called
+	}
+	celixThreadMutex_unlock(&ts->ts_lock);
+
+	unsigned int i = 0;
+	for(;i<nrOfDeliveries;i++){
+		struct local_delivery *delivery = &deliveries[i];
+		if(delivery->sameVersion){
+			/* Same message layout on both sides, hand over the publisher's instance, read-only and only during the call */
+			pubsub_multipart_callbacks_t mp_callbacks;
+			mp_callbacks.handle = NULL;
+			mp_callbacks.localMsgTypeIdForMsgType = pubsub_localMsgTypeIdForMsgType;
+			mp_callbacks.getMultipart = pubsub_getMultipart;
+			bool release = true;
+			delivery->subsvc->receive(delivery->subsvc->handle, delivery->msgSer->msgName, hdr.type, (void*)msg, &mp_callbacks, &release);
+			if(!release){
+				printf("PSA_ZMQ_TS: Locally delivered message %s is owned by the publisher, it cannot be retained.\n",delivery->msgSer->msgName);
+			}
+			continue;
+		}
+
+		/* Compatible but different version, convert through the serializer */
+		if(localMsg == NULL){
+			localMsg = serialize_local_msg(pubMsgSer, msg, &hdr);
+		}
+		if(localMsg != NULL){
+			receive_msg(delivery->subsvc, delivery->msgTypes, delivery->msgSer, delivery->arena, localMsg->msg_list);
+		}
+		else{
+			printf("PSA_ZMQ_TS: Cannot convert msgType %s for local delivery.\n",delivery->msgSer->msgName);
+			status = CELIX_SERVICE_EXCEPTION;
+		}
+	}
+
+	if(localMsg != NULL){
+		release_received_msg(localMsg);
+	}
+
+	if(nrOfDeliveries > 0){
+		celixThreadMutex_lock(&ts->ts_lock);
+		if(--ts->localDeliveries == 0){
+			celixThreadCondition_broadcast(&ts->localDeliveries_cond);
+		}
+		celixThreadMutex_unlock(&ts->ts_lock);
+	}
+
+	return status;
+}
+
+celix_status_t pubsub_topicSubscriptionDeliverLocalMultipart(topic_subscription_pt ts, array_list_pt frames){
+
+	array_list_pt msg_list = NULL;
+	arrayList_create(&msg_list);
+
+	int i = 0;
+	for(;i+1<arrayList_size(frames);i+=2){
+		complete_zmq_msg_pt c_msg = calloc(1, sizeof(struct complete_zmq_msg));
+		c_msg->header = (zframe_t*)arrayList_get(frames,i);
+		c_msg->payload = (zframe_t*)arrayList_get(frames,i+1);
+		arrayList_add(msg_list, c_msg);
+	}
+	arrayList_destroy(frames);
+
+	if(arrayList_isEmpty(msg_list)){
+		arrayList_destroy(msg_list);
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	celixThreadMutex_lock(&ts->ts_lock);
+	process_msg(ts, msg_list);
+	celixThreadMutex_unlock(&ts->ts_lock);
+
+	return CELIX_SUCCESS;
+}
+
+void pubsub_topicSubscriptionPrintStats(topic_subscription_pt ts, FILE *out){
+	pubsubMsgStats_print(ts->stats, out);
+}
+
 static celix_status_t topicsub_subscriberTracked(void * handle, service_reference_pt reference, void * service){
 	celix_status_t status = CELIX_SUCCESS;
 	topic_subscription_pt ts = handle;
@@ -398,7 +640,33 @@ static celix_status_t topicsub_subscriberTracked(void * handle, service_referenc
 		if(ts->serializer != NULL && bundle!=NULL){
 			ts->serializer->createSerializerMap(ts->serializer->handle,bundle,&msgTypes);
 			if(msgTypes != NULL){
-				hashMap_put(ts->servicesMap, service, msgTypes);
+				subscriber_msg_types_pt subMsgTypes = calloc(1, sizeof(*subMsgTypes));
+				subMsgTypes->msgTypes = msgTypes;
+				pubsubMsgTypeIndex_bind(ts->msgTypeIndex, msgTypes, &subMsgTypes->msgSerializers, &subMsgTypes->nrOfMsgSerializers);
+
+				const char *threads = NULL;
+				const char *order = NULL;
+				serviceReference_getProperty(reference, PUBSUB_SUBSCRIBER_DISPATCH_THREADS, &threads);
+				serviceReference_getProperty(reference, PUBSUB_SUBSCRIBER_DISPATCH_ORDER, &order);
+				unsigned int nrOfThreads = threads != NULL ? (unsigned int) strtoul(threads, NULL, 10) : 0;
+				if(nrOfThreads > 0){
+					if(ts->dispatchPool == NULL){
+						if(pubsubDispatchPool_create(nrOfThreads, PUBSUB_DISPATCH_POOL_DEFAULT_QUEUE_SIZE, &ts->dispatchPool) == CELIX_SUCCESS){
+							printf("PSA_ZMQ_TS: Dispatching messages with %u threads.\n", nrOfThreads);
+						}
+					}
+					else if(nrOfThreads != pubsubDispatchPool_nrOfThreads(ts->dispatchPool)){
+						printf("PSA_ZMQ_TS: Subscriber asks for %u dispatch threads, the topic already uses %u.\n", nrOfThreads, pubsubDispatchPool_nrOfThreads(ts->dispatchPool));
+					}
+					subMsgTypes->dispatch = ts->dispatchPool != NULL;
+					subMsgTypes->orderPerMsgType = order != NULL && strcmp(order, PUBSUB_SUBSCRIBER_DISPATCH_ORDER_MSG_TYPE) == 0;
+				}
+
+				const char *arena = NULL;
+				serviceReference_getProperty(reference, PUBSUB_SUBSCRIBER_MSG_ARENA, &arena);
+				subMsgTypes->arena = arena != NULL && strcmp(arena, "true") == 0;
+
+				hashMap_put(ts->servicesMap, service, subMsgTypes);
 				printf("PSA_ZMQ_TS: New subscriber registered.\n");
 			}
 		}
@@ -418,9 +686,17 @@ static celix_status_t topicsub_subscriberUntracked(void * handle, service_refere
 
 	celixThreadMutex_lock(&ts->ts_lock);
 	if (hashMap_containsKey(ts->servicesMap, service)) {
-		hash_map_pt msgTypes = hashMap_remove(ts->servicesMap, service);
-		if(msgTypes!=NULL && ts->serializer!=NULL){
-			ts->serializer->destroySerializerMap(ts->serializer->handle,msgTypes);
+		subscriber_msg_types_pt subMsgTypes = hashMap_remove(ts->servicesMap, service);
+		if(subMsgTypes!=NULL && subMsgTypes->dispatch && ts->dispatchPool!=NULL){
+			pubsubDispatchPool_flush(ts->dispatchPool); // queued messages still use the subscriber and its serializers
+		}
+		while(ts->localDeliveries > 0){
+			celixThreadCondition_wait(&ts->localDeliveries_cond, &ts->ts_lock); // so do running local deliveries
+		}
+		if(subMsgTypes!=NULL && ts->serializer!=NULL){
+			ts->serializer->destroySerializerMap(ts->serializer->handle,subMsgTypes->msgTypes);
+			free(subMsgTypes->msgSerializers);
+			free(subMsgTypes);
 			printf("PSA_ZMQ_TS: Subscriber unregistered.\n");
 		}
 		else{
@@ -436,69 +712,145 @@ static celix_status_t topicsub_subscriberUntracked(void * handle, service_refere
 
 static void process_msg(topic_subscription_pt sub,array_list_pt msg_list){
 
-	pubsub_msg_header_pt first_msg_hdr = (pubsub_msg_header_pt)zframe_data(((complete_zmq_msg_pt)arrayList_get(msg_list,0))->header);
+	bool valid = decode_msg_headers(sub, msg_list);
+	if(!valid){
+		printf("PSA_ZMQ_TS: Dropping message with an invalid header.\n");
+	}
+	complete_zmq_msg_pt first_msg = (complete_zmq_msg_pt)arrayList_get(msg_list,0);
+
+	received_msg_pt received = calloc(1, sizeof(*received));
+	received->refCount = 1;
+	received->msg_list = msg_list;
 
+	int localIndex = pubsubMsgTypeIndex_get(sub->msgTypeIndex, first_msg->type);
 	hash_map_iterator_pt iter = hashMapIterator_create(sub->servicesMap);
-	while (hashMapIterator_hasNext(iter)) {
+	while (valid && hashMapIterator_hasNext(iter)) {
 		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
 		pubsub_subscriber_pt subsvc = hashMapEntry_getKey(entry);
-		hash_map_pt msgTypes = hashMapEntry_getValue(entry);
+		subscriber_msg_types_pt subMsgTypes = hashMapEntry_getValue(entry);
 
-		pubsub_msg_serializer_t *msgSer = hashMap_get(msgTypes,(void*)(uintptr_t )first_msg_hdr->type);
+		pubsub_msg_serializer_t *msgSer = pubsubMsgTypeIndex_getSerializer(subMsgTypes->msgSerializers, subMsgTypes->nrOfMsgSerializers, localIndex);
 		if (msgSer == NULL) {
-			printf("PSA_ZMQ_TS: Primary message %d not supported. NOT sending any part of the whole message.\n",first_msg_hdr->type);
+			printf("PSA_ZMQ_TS: Primary message %d not supported. NOT sending any part of the whole message.\n",first_msg->type);
 		}
 		else{
-			void *msgInst = NULL;
-			bool validVersion = checkVersion(msgSer->msgVersion,first_msg_hdr);
-
-			if(validVersion){
-
-				celix_status_t status = msgSer->deserialize(msgSer, (const void *) zframe_data(((complete_zmq_msg_pt)arrayList_get(msg_list,0))->payload), 0, &msgInst);
-
-				if (status == CELIX_SUCCESS) {
-					bool release = true;
-					mp_handle_pt mp_handle = create_mp_handle(msgTypes,msg_list);
-					pubsub_multipart_callbacks_t mp_callbacks;
-					mp_callbacks.handle = mp_handle;
-					mp_callbacks.localMsgTypeIdForMsgType = pubsub_localMsgTypeIdForMsgType;
-					mp_callbacks.getMultipart = pubsub_getMultipart;
-					subsvc->receive(subsvc->handle, msgSer->msgName, first_msg_hdr->type, msgInst, &mp_callbacks, &release);
-
-					if(release){
-						msgSer->freeMsg(msgSer,msgInst); // pubsubSerializer_freeMsg(msgType, msgInst);
-					}
-					if(mp_handle!=NULL){
-						destroy_mp_handle(mp_handle);
-					}
+			bool validVersion = checkVersion(msgSer->msgVersion,first_msg->major,first_msg->minor);
+
+			if(validVersion && subMsgTypes->dispatch && sub->dispatchPool != NULL){
+				dispatch_task_pt task = calloc(1, sizeof(*task));
+				task->subsvc = subsvc;
+				task->msgTypes = subMsgTypes->msgTypes;
+				task->msgSer = msgSer;
+				task->arena = subMsgTypes->arena;
+				task->msg = received;
+				__atomic_add_fetch(&received->refCount, 1, __ATOMIC_RELAXED);
+
+				unsigned int key = (unsigned int)((uintptr_t)subsvc >> 4);
+				if(subMsgTypes->orderPerMsgType){
+					key ^= first_msg->type;
 				}
-				else{
-					printf("PSA_ZMQ_TS: Cannot deserialize msgType %s.\n",msgSer->msgName);
+				if(pubsubDispatchPool_dispatch(sub->dispatchPool, key, dispatch_msg, task) != CELIX_SUCCESS){
+					release_received_msg(received);
+					free(task);
 				}
-
+			}
+			else if(validVersion){
+				receive_msg(subsvc, subMsgTypes->msgTypes, msgSer, subMsgTypes->arena, msg_list);
 			}
 			else{
 				int major=0,minor=0;
 				version_getMajor(msgSer->msgVersion,&major);
 				version_getMinor(msgSer->msgVersion,&minor);
 				printf("PSA_ZMQ_TS: Version mismatch for primary message '%s' (have %d.%d, received %u.%u). NOT sending any part of the whole message.\n",
-						msgSer->msgName,major,minor,first_msg_hdr->major,first_msg_hdr->minor);
+						msgSer->msgName,major,minor,first_msg->major,first_msg->minor);
 			}
 
 		}
 	}
 	hashMapIterator_destroy(iter);
 
-	int i = 0;
-	for(;i<arrayList_size(msg_list);i++){
-		complete_zmq_msg_pt c_msg = arrayList_get(msg_list,i);
-		zframe_destroy(&(c_msg->header));
-		zframe_destroy(&(c_msg->payload));
-		free(c_msg);
+	release_received_msg(received);
+}
+
+static void receive_msg(pubsub_subscriber_pt subsvc, hash_map_pt msgTypes, pubsub_msg_serializer_t *msgSer, bool arena, array_list_pt msg_list){
+	complete_zmq_msg_pt first_msg = (complete_zmq_msg_pt)arrayList_get(msg_list,0);
+	void *msgInst = NULL;
+
+	celix_status_t status;
+	arena = arena && msgSer->deserializeInArena != NULL;
+	if(arena){
+		status = msgSer->deserializeInArena(msgSer, (const void *) zframe_data(first_msg->payload), zframe_size(first_msg->payload), &msgInst);
+	}
+	else{
+		status = msgSer->deserialize(msgSer, (const void *) zframe_data(first_msg->payload), zframe_size(first_msg->payload), &msgInst);
+	}
+
+	if (status == CELIX_SUCCESS) {
+		bool release = true;
+		mp_handle_pt mp_handle = create_mp_handle(msgTypes,msg_list);
+		pubsub_multipart_callbacks_t mp_callbacks;
+		mp_callbacks.handle = mp_handle;
+		mp_callbacks.localMsgTypeIdForMsgType = pubsub_localMsgTypeIdForMsgType;
+		mp_callbacks.getMultipart = pubsub_getMultipart;
+		subsvc->receive(subsvc->handle, msgSer->msgName, first_msg->type, msgInst, &mp_callbacks, &release);
+
+		if(arena){
+			msgSer->freeArenaMsg(msgSer,msgInst);
+		}
+		else if(release){
+			msgSer->freeMsg(msgSer,msgInst); // pubsubSerializer_freeMsg(msgType, msgInst);
+		}
+		if(mp_handle!=NULL){
+			destroy_mp_handle(mp_handle);
+		}
+	}
+	else{
+		printf("PSA_ZMQ_TS: Cannot deserialize msgType %s.\n",msgSer->msgName);
 	}
+}
 
-	arrayList_destroy(msg_list);
+/* Runs on a thread of the dispatch pool, without ts_lock */
+static void dispatch_msg(void *arg){
+	dispatch_task_pt task = arg;
+	receive_msg(task->subsvc, task->msgTypes, task->msgSer, task->arena, task->msg->msg_list);
+	release_received_msg(task->msg);
+	free(task);
+}
+
+static void release_received_msg(received_msg_pt msg){
+	if(__atomic_sub_fetch(&msg->refCount, 1, __ATOMIC_ACQ_REL) == 0){
+		int i = 0;
+		for(;i<arrayList_size(msg->msg_list);i++){
+			complete_zmq_msg_pt c_msg = arrayList_get(msg->msg_list,i);
+			zframe_destroy(&(c_msg->header));
+			zframe_destroy(&(c_msg->payload));
+			free(c_msg);
+		}
 
+		arrayList_destroy(msg->msg_list);
+		free(msg);
+	}
+}
+
+/* Wraps the serialized msg in a single part msg without header frame, as if it was received */
+static received_msg_pt serialize_local_msg(pubsub_msg_serializer_t *msgSer, const void *msg, pubsub_msg_header_pt hdr){
+	received_msg_pt received = NULL;
+	void *serializedOutput = NULL;
+	size_t serializedOutputLen = 0;
+	if(msgSer->serialize(msgSer, msg, &serializedOutput, &serializedOutputLen) == CELIX_SUCCESS){
+		complete_zmq_msg_pt c_msg = calloc(1, sizeof(struct complete_zmq_msg));
+		c_msg->payload = zframe_new(serializedOutput, serializedOutputLen);
+		c_msg->type = hdr->type;
+		c_msg->major = hdr->major;
+		c_msg->minor = hdr->minor;
+
+		received = calloc(1, sizeof(*received));
+		received->refCount = 1;
+		arrayList_create(&received->msg_list);
+		arrayList_add(received->msg_list, c_msg);
+	}
+	free(serializedOutput);
+	return received;
 }
 
 static void* zmq_recv_thread_func(void * arg) {
@@ -519,8 +871,6 @@ static void* zmq_recv_thread_func(void * arg) {
 		}
 		else {
 
-			pubsub_msg_header_pt hdr = (pubsub_msg_header_pt) zframe_data(headerMsg);
-
 			if (zframe_more(headerMsg)) {
 
 				zframe_t* payloadMsg = zframe_recv(sub->zmq_socket);
@@ -586,8 +936,8 @@ static void* zmq_recv_thread_func(void * arg) {
 
 			} //zframe_more(headerMsg)
 			else {
-				free(headerMsg);
-				printf("PSA_ZMQ_TS: received message %u for topic %s without payload!\n", hdr->type, hdr->topic);
+				zframe_destroy(&headerMsg);
+				printf("PSA_ZMQ_TS: received message without payload!\n");
 			}
 
 		} // headerMsg != NULL
@@ -624,21 +974,54 @@ static void sigusr1_sighandler(int signo){
 	return;
 }
 
-static bool checkVersion(version_pt msgVersion,pubsub_msg_header_pt hdr){
+static bool checkVersion(version_pt msgVersion,unsigned char hdrMajor,unsigned char hdrMinor){
 	bool check=false;
 	int major=0,minor=0;
 
 	if(msgVersion!=NULL){
 		version_getMajor(msgVersion,&major);
 		version_getMinor(msgVersion,&minor);
-		if(hdr->major==((unsigned char)major)){ /* Different major means incompatible */
-			check = (hdr->minor>=((unsigned char)minor)); /* Compatible only if the provider has a minor equals or greater (means compatible update) */
+		if(hdrMajor==((unsigned char)major)){ /* Different major means incompatible */
+			check = (hdrMinor>=((unsigned char)minor)); /* Compatible only if the provider has a minor equals or greater (means compatible update) */
 		}
 	}
 
 	return check;
 }
 
+/* Fills type and version of every part from its header frame, which can be a legacy or a compact header */
+static bool decode_msg_headers(topic_subscription_pt sub, array_list_pt msg_list){
+
+	unsigned int i = 0;
+	for(;i<arrayList_size(msg_list);i++){
+		complete_zmq_msg_pt c_msg = (complete_zmq_msg_pt)arrayList_get(msg_list,i);
+		const void *data = zframe_data(c_msg->header);
+		size_t size = zframe_size(c_msg->header);
+
+		if(pubsubMsgHeader_isCompact(data, size)){
+			struct pubsub_msg_compact_header compact;
+			if(!pubsubMsgHeader_decodeCompact(data, size, &compact)){
+				return false;
+			}
+			c_msg->type = compact.type;
+			c_msg->major = compact.major;
+			c_msg->minor = compact.minor;
+			pubsubMsgStats_update(sub->stats, compact.publisherId, compact.seqNr, compact.sendTime);
+		}
+		else if(size >= sizeof(struct pubsub_msg_header)){
+			pubsub_msg_header_pt hdr = (pubsub_msg_header_pt)data;
+			c_msg->type = hdr->type;
+			c_msg->major = hdr->major;
+			c_msg->minor = hdr->minor;
+		}
+		else{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 static int pubsub_localMsgTypeIdForMsgType(void* handle, const char* msgType, unsigned int* msgTypeId){
 	*msgTypeId = utils_stringHash(msgType);
 	return 0;
@@ -680,22 +1063,21 @@ static mp_handle_pt create_mp_handle(hash_map_pt svc_msg_db,array_list_pt rcv_ms
 	int i=1; //We skip the first message, it will be handle differently
 	for(;i<arrayList_size(rcv_msg_list);i++){
 		complete_zmq_msg_pt c_msg = (complete_zmq_msg_pt)arrayList_get(rcv_msg_list,i);
-		pubsub_msg_header_pt header = (pubsub_msg_header_pt)zframe_data(c_msg->header);
 
-		pubsub_msg_serializer_t* msgSer = hashMap_get(svc_msg_db, (void*)(uintptr_t)(header->type));
+		pubsub_msg_serializer_t* msgSer = hashMap_get(svc_msg_db, (void*)(uintptr_t)(c_msg->type));
 
 		if (msgSer!= NULL) {
 			void *msgInst = NULL;
 
-			bool validVersion = checkVersion(msgSer->msgVersion,header);
+			bool validVersion = checkVersion(msgSer->msgVersion,c_msg->major,c_msg->minor);
 
 			if(validVersion){
-				celix_status_t status = msgSer->deserialize(msgSer, (const void*)zframe_data(c_msg->payload), 0, &msgInst);
+				celix_status_t status = msgSer->deserialize(msgSer, (const void*)zframe_data(c_msg->payload), zframe_size(c_msg->payload), &msgInst);
 
 				if(status == CELIX_SUCCESS){
 					msg_map_entry_pt entry = calloc(1,sizeof(struct msg_map_entry));
 					entry->msgInst = msgInst;
-					hashMap_put(mp_handle->rcv_msg_map, (void*)(uintptr_t)header->type,entry);
+					hashMap_put(mp_handle->rcv_msg_map, (void*)(uintptr_t)c_msg->type,entry);
 				}
 			}
 		}
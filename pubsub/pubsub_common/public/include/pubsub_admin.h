@@ -36,6 +36,9 @@
 #define PSA_ITF	"PSA_INTERFACE"
 #define PSA_MULTICAST_IP_PREFIX "PSA_MC_PREFIX"
 
+/* When "true", messages between a publisher and a subscriber in the same framework are handed over directly, without serialization */
+#define PSA_LOCAL_DELIVERY	"PSA_LOCAL_DELIVERY"
+
 #define PUBSUB_ADMIN_TYPE_KEY	"pubsub_admin.type"
 
 typedef struct pubsub_admin *pubsub_admin_pt;
@@ -57,10 +60,10 @@ struct pubsub_admin_service {
 	 * - A full matching serializer gives 100 points
 	 * - If QoS = sample
 	 * 		- fallback pubsub_admin order of selection is: udp_mc, zmq. Points allocation is 100,75.
-	 * 		- fallback serializers order of selection is: json, void. Points allocation is 30,20.
+	 * 		- fallback serializers order of selection is: json, binary, void. Points allocation is 30,25,20.
 	 * - If QoS = control
 	 * 		- fallback pubsub_admin order of selection is: zmq,udp_mc. Points allocation is 100,75.
-	 * 		- fallback serializers order of selection is: json, void. Points allocation is 30,20.
+	 * 		- fallback serializers order of selection is: json, binary, void. Points allocation is 30,25,20.
 	 * - If nothing is specified, QoS = sample is assumed, so the same score applies, just divided by two.
 	 *
 	 */
@@ -30,6 +30,7 @@
 #define QOS_ATTRIBUTE_KEY	"attribute.qos"
 #define QOS_TYPE_SAMPLE		"sample"	/* A.k.a. unreliable connection */
 #define QOS_TYPE_CONTROL	"control"	/* A.k.a. reliable connection */
+#define QOS_TYPE_LOCAL		"local"		/* Publishers and subscribers on the same host */
 
 #define PUBSUB_ADMIN_FULL_MATCH_SCORE	200.0F
 #define SERIALIZER_FULL_MATCH_SCORE		100.0F
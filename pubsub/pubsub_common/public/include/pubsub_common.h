@@ -39,6 +39,7 @@
 #define MAX_SCOPE_LEN                           1024
 #define MAX_TOPIC_LEN				1024
 
+/* Legacy wire header, publications can send a compact header instead (see pubsub_msg_header.h) */
 struct pubsub_msg_header{
 	char topic[MAX_TOPIC_LEN];
 	unsigned int type;
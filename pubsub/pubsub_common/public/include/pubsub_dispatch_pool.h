@@ -0,0 +1,56 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_dispatch_pool.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef PUBSUB_DISPATCH_POOL_H_
+#define PUBSUB_DISPATCH_POOL_H_
+
+#include "celix_errno.h"
+
+#define PUBSUB_DISPATCH_POOL_DEFAULT_QUEUE_SIZE	1024
+
+/*
+ * Threads of a topic subscription that call the subscribers, so that the receive thread does not wait
+ * for slow subscribers. Every thread has its own queue (lane) and a key is always dispatched to the same
+ * lane, so tasks with the same key (e.g. the same subscriber) run one at a time in dispatch order,
+ * while tasks of different keys can run in parallel.
+ * Dispatching to a full lane blocks until the lane's thread made room.
+ */
+typedef struct pubsub_dispatch_pool *pubsub_dispatch_pool_pt;
+
+typedef void (*pubsub_dispatch_task_fn)(void *arg);
+
+celix_status_t pubsubDispatchPool_create(unsigned int nrOfThreads, unsigned int queueSize, pubsub_dispatch_pool_pt *out);
+/* Runs the tasks still queued before the threads stop */
+celix_status_t pubsubDispatchPool_destroy(pubsub_dispatch_pool_pt pool);
+
+celix_status_t pubsubDispatchPool_dispatch(pubsub_dispatch_pool_pt pool, unsigned int key, pubsub_dispatch_task_fn task, void *arg);
+
+/* Waits until all tasks dispatched before the call have run. Must not be called from a task. */
+celix_status_t pubsubDispatchPool_flush(pubsub_dispatch_pool_pt pool);
+
+unsigned int pubsubDispatchPool_nrOfThreads(pubsub_dispatch_pool_pt pool);
+
+#endif /* PUBSUB_DISPATCH_POOL_H_ */
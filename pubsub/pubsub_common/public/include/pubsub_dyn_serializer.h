@@ -0,0 +1,59 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_dyn_serializer.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef PUBSUB_DYN_SERIALIZER_H_
+#define PUBSUB_DYN_SERIALIZER_H_
+
+#include "bundle_context.h"
+#include "celix_errno.h"
+#include "hash_map.h"
+
+#include "dyn_type.h"
+
+#include "pubsub_serializer.h"
+
+/*
+ * Common part of the serializers based on the dfi msg descriptors (the .descriptor files in META-INF/descriptors) of a bundle.
+ * It creates the msg serializer maps and allocates and frees the msgs, a serializer bundle only provides the
+ * codec which encodes and decodes a msg of a dyn_type. The functions of the codec return 0 on success.
+ */
+typedef struct pubsub_dyn_codec {
+	int (*encode)(dyn_type *type, const void *msg, void **out, size_t *outLen);
+	int (*decode)(dyn_type *type, const void *input, size_t inputLen, void **out);
+	int (*decodeInArena)(dyn_type *type, const void *input, size_t inputLen, void **out); //can be NULL
+} pubsub_dyn_codec_t;
+
+typedef struct pubsub_dyn_serializer *pubsub_dyn_serializer_pt;
+
+/* The codec must outlive the serializer */
+celix_status_t pubsubDynSerializer_create(bundle_context_pt context, const pubsub_dyn_codec_t *codec, pubsub_dyn_serializer_pt *out);
+celix_status_t pubsubDynSerializer_destroy(pubsub_dyn_serializer_pt serializer);
+
+/* The createSerializerMap and destroySerializerMap functions of the pubsub_serializer_service */
+celix_status_t pubsubDynSerializer_createSerializerMap(pubsub_dyn_serializer_pt serializer, bundle_pt bundle, hash_map_pt *serializerMap);
+celix_status_t pubsubDynSerializer_destroySerializerMap(pubsub_dyn_serializer_pt serializer, hash_map_pt serializerMap);
+
+#endif /* PUBSUB_DYN_SERIALIZER_H_ */
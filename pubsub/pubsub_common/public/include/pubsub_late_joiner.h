@@ -0,0 +1,65 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_late_joiner.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef PUBSUB_LATE_JOINER_H_
+#define PUBSUB_LATE_JOINER_H_
+
+#include <stdbool.h>
+#include <sys/uio.h>
+
+#include "celix_errno.h"
+#include "properties.h"
+
+/*
+ * Topic properties for subscribers joining after a publication started.
+ *
+ * The first send of a publication waits until a subscriber has joined, at most
+ * PUBSUB_LATE_JOINER_TIMEOUT_KEY ms. The publication cannot tell whether any subscriber exists,
+ * so without one the first send blocks for the whole timeout; the default 0 disables waiting. With PUBSUB_LVC_SIZE_KEY > 0 the
+ * publication keeps the last sent messages and sends them again whenever a subscriber joins.
+ */
+#define PUBSUB_LATE_JOINER_TIMEOUT_KEY		"pubsub.late_joiner.timeout_ms"
+#define PUBSUB_LATE_JOINER_DEFAULT_TIMEOUT	0
+#define PUBSUB_LVC_SIZE_KEY					"pubsub.lvc.size"
+#define PUBSUB_LVC_MAX_SIZE					1024
+
+unsigned int pubsubLateJoiner_getTimeout(properties_pt topic_props);
+unsigned int pubsubLateJoiner_getLvcSize(properties_pt topic_props);
+
+/* Bounded cache of the last sent messages, each one stored as a copy of its wire parts. Not thread safe. */
+typedef struct pubsub_lvc *pubsub_lvc_pt;
+
+typedef bool (*pubsub_lvc_send_fn)(void *handle, struct iovec *parts, unsigned int nrParts);
+
+celix_status_t pubsubLvc_create(unsigned int size, pubsub_lvc_pt *out);
+celix_status_t pubsubLvc_destroy(pubsub_lvc_pt lvc);
+
+/* Stores a copy of the message, replacing the oldest one when the cache is full */
+celix_status_t pubsubLvc_add(pubsub_lvc_pt lvc, const struct iovec *parts, unsigned int nrParts);
+/* Calls send for every cached message, oldest first, and returns the number of messages sent */
+unsigned int pubsubLvc_replay(pubsub_lvc_pt lvc, pubsub_lvc_send_fn send, void *handle);
+
+#endif /* PUBSUB_LATE_JOINER_H_ */
@@ -0,0 +1,84 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_msg_header.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef PUBSUB_MSG_HEADER_H_
+#define PUBSUB_MSG_HEADER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "properties.h"
+
+/*
+ * Topic property selecting the wire header of a publication. "legacy" (the default) sends
+ * struct pubsub_msg_header, which every subscriber understands; "compact" sends the header
+ * below and must only be used when all subscribers of the topic accept it.
+ */
+#define PUBSUB_WIRE_HEADER_KEY			"pubsub.wire.header"
+#define PUBSUB_WIRE_HEADER_LEGACY		"legacy"
+#define PUBSUB_WIRE_HEADER_COMPACT		"compact"
+
+/*
+ * The compact header starts with a 0 byte, where the legacy header starts with the (non empty)
+ * topic name, so a subscription can tell both formats apart per message.
+ * Multi byte fields are encoded in network byte order:
+ *
+ *   marker(1) version(1) topicId(4) publisherId(4) type(4) major(1) minor(1) seqNr(4) sendTime(8) payloadSize(4)
+ *
+ * Version 1 was a 28 byte header without publisherId, headers of another version are not decoded.
+ */
+#define PUBSUB_COMPACT_HEADER_MARKER		0x00
+#define PUBSUB_COMPACT_HEADER_VERSION		2
+#define PUBSUB_COMPACT_HEADER_SIZE		32
+#define PUBSUB_COMPACT_HEADER_PREFIX_SIZE	6 // marker, version and topicId, usable as topic filter
+
+struct pubsub_msg_compact_header {
+	unsigned int topicId;	// utils_stringHash of the topic name
+	unsigned int publisherId;	// identifies the publication, seqNr is counted per publication
+	unsigned int type;
+	unsigned char major;
+	unsigned char minor;
+	unsigned int seqNr;	// per publication, wraps around
+	uint64_t sendTime;	// CLOCK_REALTIME in ns
+	unsigned int payloadSize;
+};
+
+typedef struct pubsub_msg_compact_header* pubsub_msg_compact_header_pt;
+
+bool pubsubMsgHeader_useCompact(properties_pt topic_props);
+
+void pubsubMsgHeader_encodeCompact(const struct pubsub_msg_compact_header *hdr, unsigned char *buf);
+bool pubsubMsgHeader_isCompact(const void *buf, size_t len);
+/* Returns false when buf holds no complete compact header of a known version */
+bool pubsubMsgHeader_decodeCompact(const void *buf, size_t len, struct pubsub_msg_compact_header *hdr);
+
+/* Writes the topic filter prefix of the compact header for the given topic in buf (PUBSUB_COMPACT_HEADER_PREFIX_SIZE bytes) */
+void pubsubMsgHeader_compactTopicPrefix(const char *topic, unsigned char *buf);
+
+uint64_t pubsubMsgHeader_now(void);
+
+#endif /* PUBSUB_MSG_HEADER_H_ */
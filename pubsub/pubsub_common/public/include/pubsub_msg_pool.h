@@ -0,0 +1,53 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_msg_pool.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef PUBSUB_MSG_POOL_H_
+#define PUBSUB_MSG_POOL_H_
+
+#include "celix_errno.h"
+
+#include "pubsub_serializer.h"
+
+#define PUBSUB_MSG_POOL_DEFAULT_MAX_PER_TYPE	8
+
+/*
+ * Pool of msgs allocated by a publisher (see allocMsg in publisher.h), per local msg type index
+ * (see pubsub_msg_type_index.h). Msgs are allocated through the msg serializer. A returned msg of a
+ * fixed size type is cleared and kept for the next allocation, up to maxPerType msgs per type; other msgs
+ * own texts, sequences or pointers which the publisher may have replaced, so these are freed.
+ *
+ * The pool is thread safe. It must be destroyed before the msg serializers it uses.
+ */
+typedef struct pubsub_msg_pool *pubsub_msg_pool_pt;
+
+celix_status_t pubsubMsgPool_create(pubsub_msg_serializer_t **msgSerializers, unsigned int nrOfMsgSerializers, unsigned int maxPerType, pubsub_msg_pool_pt *out);
+celix_status_t pubsubMsgPool_destroy(pubsub_msg_pool_pt pool);
+
+/* Returns a zero initialized msg of the msg type with the local index */
+celix_status_t pubsubMsgPool_alloc(pubsub_msg_pool_pt pool, int localIndex, void **msg);
+celix_status_t pubsubMsgPool_free(pubsub_msg_pool_pt pool, int localIndex, void *msg);
+
+#endif /* PUBSUB_MSG_POOL_H_ */
@@ -0,0 +1,47 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_msg_stats.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef PUBSUB_MSG_STATS_H_
+#define PUBSUB_MSG_STATS_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "celix_errno.h"
+
+/*
+ * Per subscription receive statistics, kept per publication (publisherId of the compact header).
+ * Sequence gaps are counted as lost and decremented again when the message arrives out of order.
+ */
+typedef struct pubsub_msg_stats *pubsub_msg_stats_pt;
+
+celix_status_t pubsubMsgStats_create(pubsub_msg_stats_pt *out);
+celix_status_t pubsubMsgStats_destroy(pubsub_msg_stats_pt stats);
+
+void pubsubMsgStats_update(pubsub_msg_stats_pt stats, unsigned int publisherId, unsigned int seqNr, uint64_t sendTime);
+void pubsubMsgStats_print(pubsub_msg_stats_pt stats, FILE *out);
+
+#endif /* PUBSUB_MSG_STATS_H_ */
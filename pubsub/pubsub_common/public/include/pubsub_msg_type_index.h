@@ -0,0 +1,64 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_msg_type_index.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef PUBSUB_MSG_TYPE_INDEX_H_
+#define PUBSUB_MSG_TYPE_INDEX_H_
+
+#include "celix_errno.h"
+#include "hash_map.h"
+
+#include "pubsub_serializer.h"
+
+/* Msg ids below this value are reserved for control msgs of the admins (e.g. the udp_mc batch and join msgs) */
+#define PUBSUB_MSG_TYPE_INDEX_FIRST_MSG_ID	2
+
+/*
+ * Assigns dense local indices to the msg types of a topic publication or subscription when they are registered.
+ * Msg ids are hashes of the msg names; binding the serializer map of a publisher or subscriber
+ * creates an array of its msg serializers indexed by the local index.
+ * The msg id of a registered msg type maps to its own slot of a direct table (the table is rebuilt
+ * with another multiplier or a larger size when two msg ids would share a slot), so finding the serializer
+ * of a msg is two array reads, independent of the number of msg types and subscribers.
+ * A msg name of which the id is already used by another msg name, or of which the id is reserved, is reported and left out.
+ *
+ * The index is not thread safe, it is protected by the lock of the publication or subscription.
+ */
+typedef struct pubsub_msg_type_index *pubsub_msg_type_index_pt;
+
+celix_status_t pubsubMsgTypeIndex_create(pubsub_msg_type_index_pt *out);
+celix_status_t pubsubMsgTypeIndex_destroy(pubsub_msg_type_index_pt index);
+
+/* Creates an array of the msg serializers in msgTypes indexed by their local index, the caller frees the array */
+celix_status_t pubsubMsgTypeIndex_bind(pubsub_msg_type_index_pt index, hash_map_pt msgTypes, pubsub_msg_serializer_t ***serializers, unsigned int *size);
+
+/* Returns the local index of the msg id or -1 when the msg id is unknown */
+int pubsubMsgTypeIndex_get(pubsub_msg_type_index_pt index, unsigned int msgId);
+
+static inline pubsub_msg_serializer_t* pubsubMsgTypeIndex_getSerializer(pubsub_msg_serializer_t **serializers, unsigned int size, int localIndex) {
+	return (localIndex >= 0 && (unsigned int)localIndex < size) ? serializers[localIndex] : NULL;
+}
+
+#endif /* PUBSUB_MSG_TYPE_INDEX_H_ */
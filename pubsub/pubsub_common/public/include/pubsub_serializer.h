@@ -53,6 +53,12 @@ typedef struct pubsub_msg_serializer {
 	celix_status_t (*deserialize)(void* handle, const void* input, size_t inputLen, void** out); //note inputLen can be 0 if predefined size is not needed
 	void (*freeMsg)(void* handle, void* msg);
 
+	celix_status_t (*allocMsg)(void* handle, void** out); //zero initialized msg, can be NULL
+	size_t fixedMsgSize; //msg size when the msg has no texts, sequences or pointers (a cleared msg can be reused), otherwise 0
+
+	celix_status_t (*deserializeInArena)(void* handle, const void* input, size_t inputLen, void** out); //msg and all memory it refers to in one arena, can be NULL
+	void (*freeArenaMsg)(void* handle, void* msg); //frees a msg of deserializeInArena at once
+
 } pubsub_msg_serializer_t;
 
 typedef struct pubsub_serializer_service {
@@ -0,0 +1,70 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_topic_trie.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef PUBSUB_TOPIC_TRIE_H_
+#define PUBSUB_TOPIC_TRIE_H_
+
+#include <stdbool.h>
+
+#include "celix_errno.h"
+
+/*
+ * Hierarchical topics consist of segments separated by a '.', e.g. "sensors.room1.temperature".
+ * A subscriber topic can contain wildcard segments: "*" matches exactly one segment and "**", only
+ * allowed as last segment, matches any number (including zero) of remaining segments.
+ * E.g. "sensors.*.temperature" matches "sensors.room1.temperature" and "sensors.**" matches all of them.
+ */
+#define PUBSUB_TOPIC_SEPARATOR			'.'
+#define PUBSUB_TOPIC_WILDCARD_ONE		"*"
+#define PUBSUB_TOPIC_WILDCARD_REST		"**"
+
+bool pubsubTopic_isWildcard(const char *topic);
+bool pubsubTopic_isValidPattern(const char *pattern);
+bool pubsubTopic_matches(const char *pattern, const char *topic);
+
+/* Returns a newly allocated copy of the topic which can be used as value in a service filter */
+char* pubsubTopic_createFilterValue(const char *topic);
+
+/*
+ * Maps (wildcard) topic patterns to values. Matching a topic only visits the trie nodes along the
+ * segments of the topic, independent of the number of patterns. The trie is not thread safe.
+ */
+typedef struct pubsub_topic_trie *pubsub_topic_trie_pt;
+
+typedef void (*pubsub_topic_trie_match_fn)(void *handle, void *value);
+
+celix_status_t pubsubTopicTrie_create(pubsub_topic_trie_pt *out);
+celix_status_t pubsubTopicTrie_destroy(pubsub_topic_trie_pt trie);
+
+celix_status_t pubsubTopicTrie_add(pubsub_topic_trie_pt trie, const char *pattern, void *value);
+celix_status_t pubsubTopicTrie_remove(pubsub_topic_trie_pt trie, const char *pattern, void *value);
+/* True when the trie has no values, removing the last value of a pattern also removes its nodes */
+bool pubsubTopicTrie_isEmpty(pubsub_topic_trie_pt trie);
+
+/* Calls fn once for every value of which the pattern matches the topic */
+void pubsubTopicTrie_match(pubsub_topic_trie_pt trie, const char *topic, pubsub_topic_trie_match_fn fn, void *handle);
+
+#endif /* PUBSUB_TOPIC_TRIE_H_ */
@@ -0,0 +1,55 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_wildcard_subscriptions.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef PUBSUB_WILDCARD_SUBSCRIPTIONS_H_
+#define PUBSUB_WILDCARD_SUBSCRIPTIONS_H_
+
+#include <stdbool.h>
+
+#include "celix_errno.h"
+
+#include "pubsub_topic_trie.h"
+
+/*
+ * The topic subscriptions of a pubsub admin with a wildcard topic, per scope a topic trie from the topic
+ * pattern to the subscription. The trie of a scope is removed with its last subscription.
+ * Not thread safe, the admins protect it with their subscriptionsLock.
+ */
+typedef struct pubsub_wildcard_subscriptions *pubsub_wildcard_subscriptions_pt;
+
+celix_status_t pubsubWildcardSubscriptions_create(pubsub_wildcard_subscriptions_pt *out);
+celix_status_t pubsubWildcardSubscriptions_destroy(pubsub_wildcard_subscriptions_pt subscriptions);
+
+celix_status_t pubsubWildcardSubscriptions_add(pubsub_wildcard_subscriptions_pt subscriptions, const char *scope, const char *pattern, void *subscription);
+celix_status_t pubsubWildcardSubscriptions_remove(pubsub_wildcard_subscriptions_pt subscriptions, const char *scope, const char *pattern, void *subscription);
+
+/* Calls fn once for every subscription of the scope of which the pattern matches the topic */
+void pubsubWildcardSubscriptions_match(pubsub_wildcard_subscriptions_pt subscriptions, const char *scope, const char *topic, pubsub_topic_trie_match_fn fn, void *handle);
+
+/* Whether the pattern matches a "scope:topic" key (see createScopeTopicKey) of the scope, without looking up the publication */
+bool pubsubWildcardSubscriptions_matchesKey(const char *scope, const char *pattern, const char *scopeTopicKey);
+
+#endif /* PUBSUB_WILDCARD_SUBSCRIPTIONS_H_ */
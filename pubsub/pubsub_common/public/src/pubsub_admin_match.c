@@ -25,17 +25,21 @@
 
 #include "pubsub_admin_match.h"
 
-#define KNOWN_PUBSUB_ADMIN_NUM	2
-#define KNOWN_SERIALIZER_NUM	2
+#define KNOWN_PUBSUB_ADMIN_NUM	3
+#define KNOWN_SERIALIZER_NUM	3
 
-static char* qos_sample_pubsub_admin_prio_list[KNOWN_PUBSUB_ADMIN_NUM] = {"udp_mc","zmq"};
-static char* qos_sample_serializer_prio_list[KNOWN_SERIALIZER_NUM] = {"json","void"};
+/* Shared memory cannot reach other hosts, so it comes last unless the topic is declared host local */
+static char* qos_sample_pubsub_admin_prio_list[KNOWN_PUBSUB_ADMIN_NUM] = {"udp_mc","zmq","shm"};
+static char* qos_sample_serializer_prio_list[KNOWN_SERIALIZER_NUM] = {"json","binary","void"};
 
-static char* qos_control_pubsub_admin_prio_list[KNOWN_PUBSUB_ADMIN_NUM] = {"zmq","udp_mc"};
-static char* qos_control_serializer_prio_list[KNOWN_SERIALIZER_NUM] = {"json","void"};
+static char* qos_control_pubsub_admin_prio_list[KNOWN_PUBSUB_ADMIN_NUM] = {"zmq","udp_mc","shm"};
+static char* qos_control_serializer_prio_list[KNOWN_SERIALIZER_NUM] = {"json","binary","void"};
 
-static double qos_pubsub_admin_score[KNOWN_PUBSUB_ADMIN_NUM] = {100.0F,75.0F};
-static double qos_serializer_score[KNOWN_SERIALIZER_NUM] = {30.0F,20.0F};
+static char* qos_local_pubsub_admin_prio_list[KNOWN_PUBSUB_ADMIN_NUM] = {"shm","zmq","udp_mc"};
+static char* qos_local_serializer_prio_list[KNOWN_SERIALIZER_NUM] = {"binary","json","void"};
+
+static double qos_pubsub_admin_score[KNOWN_PUBSUB_ADMIN_NUM] = {100.0F,75.0F,50.0F};
+static double qos_serializer_score[KNOWN_SERIALIZER_NUM] = {30.0F,25.0F,20.0F};
 
 static void get_serializer_type(service_reference_pt svcRef, char **serializerType);
 static void manage_service_from_reference(service_reference_pt svcRef, void **svc, bool getService);
@@ -79,6 +83,14 @@ celix_status_t pubsub_admin_match(properties_pt endpoint_props, const char *pubs
 				}
 			}
 		}
+		else if(strncmp(requested_qos_type,QOS_TYPE_LOCAL,strlen(QOS_TYPE_LOCAL))==0){
+			for(i=0;i<KNOWN_PUBSUB_ADMIN_NUM;i++){
+				if(strncmp(qos_local_pubsub_admin_prio_list[i],pubsub_admin_type,strlen(pubsub_admin_type))==0){
+					final_score += qos_pubsub_admin_score[i];
+					break;
+				}
+			}
+		}
 		else{
 			printf("Unknown QoS type '%s'\n",requested_qos_type);
 			status = CELIX_ILLEGAL_ARGUMENT;
@@ -142,6 +154,23 @@ celix_status_t pubsub_admin_match(properties_pt endpoint_props, const char *pubs
 				}
 			}
 		}
+		else if(strncmp(requested_qos_type,QOS_TYPE_LOCAL,strlen(QOS_TYPE_LOCAL))==0){
+			bool ser_found = false;
+			for(i=0;i<KNOWN_SERIALIZER_NUM && !ser_found;i++){
+				for(j=0;j<arrayList_size(serializerList) && !ser_found;j++){
+					service_reference_pt svcRef = (service_reference_pt)arrayList_get(serializerList,j);
+					get_serializer_type(svcRef, &serializer_type);
+					if(serializer_type != NULL){
+						if(strncmp(qos_local_serializer_prio_list[i],serializer_type,strlen(serializer_type))==0){
+							ser_found = true;
+						}
+					}
+				}
+				if(ser_found){
+					final_score += qos_serializer_score[i];
+				}
+			}
+		}
 		else{
 			printf("Unknown QoS type '%s'\n",requested_qos_type);
 			status = CELIX_ILLEGAL_ARGUMENT;
@@ -256,6 +285,30 @@ celix_status_t pubsub_admin_get_best_serializer(properties_pt endpoint_props, ar
 				}
 			}
 		}
+		else if(strncmp(requested_qos_type,QOS_TYPE_LOCAL,strlen(QOS_TYPE_LOCAL))==0){
+			bool ser_found = false;
+			for(i=0;i<KNOWN_SERIALIZER_NUM && !ser_found;i++){
+				for(j=0;j<arrayList_size(serializerList) && !ser_found;j++){
+					svcRef = (service_reference_pt)arrayList_get(serializerList,j);
+					char *serializer_type = NULL;
+					get_serializer_type(svcRef, &serializer_type);
+					if(serializer_type != NULL){
+						if(strncmp(qos_local_serializer_prio_list[i],serializer_type,strlen(serializer_type))==0){
+							manage_service_from_reference(svcRef, &svc,true);
+							if(svc==NULL){
+								printf("Cannot get pubsub_serializer_service from serviceReference %p\n",svcRef);
+								status = CELIX_SERVICE_EXCEPTION;
+							}
+							else{
+								*serSvc = svc;
+								ser_found = true;
+								printf("Selected %s serializer as best for QoS=%s\n",qos_local_serializer_prio_list[i],QOS_TYPE_LOCAL);
+							}
+						}
+					}
+				}
+			}
+		}
 		else{
 			printf("Unknown QoS type '%s'\n",requested_qos_type);
 			status = CELIX_ILLEGAL_ARGUMENT;
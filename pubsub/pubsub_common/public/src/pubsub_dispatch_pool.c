@@ -0,0 +1,233 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_dispatch_pool.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "celix_threads.h"
+
+#include "pubsub_dispatch_pool.h"
+
+typedef struct dispatch_task {
+	pubsub_dispatch_task_fn task;
+	void *arg;
+} dispatch_task_t;
+
+typedef struct dispatch_lane {
+	celix_thread_mutex_t mutex;
+	celix_thread_cond_t notEmpty;
+	celix_thread_cond_t notFull;
+	dispatch_task_t *tasks; // ring of queueSize tasks
+	unsigned int head;
+	unsigned int count;
+	bool running;
+	celix_thread_t thread;
+	pubsub_dispatch_pool_pt pool;
+} dispatch_lane_t;
+
+struct pubsub_dispatch_pool {
+	unsigned int nrOfLanes;
+	unsigned int queueSize;
+	dispatch_lane_t *lanes;
+};
+
+typedef struct dispatch_flush {
+	celix_thread_mutex_t mutex;
+	celix_thread_cond_t done;
+	unsigned int remaining;
+} dispatch_flush_t;
+
+static void* pubsubDispatchPool_run(void *arg);
+static void pubsubDispatchPool_flushTask(void *arg);
+
+celix_status_t pubsubDispatchPool_create(unsigned int nrOfThreads, unsigned int queueSize, pubsub_dispatch_pool_pt *out){
+	if(nrOfThreads == 0 || queueSize == 0){
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	pubsub_dispatch_pool_pt pool = calloc(1, sizeof(*pool));
+	if(pool == NULL){
+		return CELIX_ENOMEM;
+	}
+	pool->queueSize = queueSize;
+	pool->lanes = calloc(nrOfThreads, sizeof(*pool->lanes));
+	if(pool->lanes == NULL){
+		free(pool);
+		return CELIX_ENOMEM;
+	}
+
+	celix_status_t status = CELIX_SUCCESS;
+	unsigned int i;
+	for(i = 0; i < nrOfThreads && status == CELIX_SUCCESS; i++){
+		dispatch_lane_t *lane = &pool->lanes[i];
+		lane->tasks = calloc(queueSize, sizeof(*lane->tasks));
+		if(lane->tasks == NULL){
+			status = CELIX_ENOMEM;
+			break;
+		}
+		celixThreadMutex_create(&lane->mutex, NULL);
+		celixThreadCondition_init(&lane->notEmpty, NULL);
+		celixThreadCondition_init(&lane->notFull, NULL);
+		lane->running = true;
+		lane->pool = pool;
+		status = celixThread_create(&lane->thread, NULL, pubsubDispatchPool_run, lane);
+		if(status != CELIX_SUCCESS){
+			celixThreadMutex_destroy(&lane->mutex);
+			celixThreadCondition_destroy(&lane->notEmpty);
+			celixThreadCondition_destroy(&lane->notFull);
+			free(lane->tasks);
+			break;
+		}
+		pool->nrOfLanes++;
+	}
+
+	if(status != CELIX_SUCCESS){
+		pubsubDispatchPool_destroy(pool);
+		return status;
+	}
+
+	*out = pool;
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubDispatchPool_destroy(pubsub_dispatch_pool_pt pool){
+	unsigned int i;
+	for(i = 0; i < pool->nrOfLanes; i++){
+		dispatch_lane_t *lane = &pool->lanes[i];
+		celixThreadMutex_lock(&lane->mutex);
+		lane->running = false;
+		celixThreadCondition_broadcast(&lane->notEmpty);
+		celixThreadMutex_unlock(&lane->mutex);
+	}
+	for(i = 0; i < pool->nrOfLanes; i++){
+		dispatch_lane_t *lane = &pool->lanes[i];
+		celixThread_join(lane->thread, NULL);
+		celixThreadMutex_destroy(&lane->mutex);
+		celixThreadCondition_destroy(&lane->notEmpty);
+		celixThreadCondition_destroy(&lane->notFull);
+		free(lane->tasks);
+	}
+	free(pool->lanes);
+	free(pool);
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubDispatchPool_dispatch(pubsub_dispatch_pool_pt pool, unsigned int key, pubsub_dispatch_task_fn task, void *arg){
+	dispatch_lane_t *lane = &pool->lanes[(key * 2654435761U) % pool->nrOfLanes];
+
+	celixThreadMutex_lock(&lane->mutex);
+	while(lane->running && lane->count == pool->queueSize){
+		celixThreadCondition_wait(&lane->notFull, &lane->mutex);
+	}
+	if(!lane->running){
+		celixThreadMutex_unlock(&lane->mutex);
+		return CELIX_ILLEGAL_STATE;
+	}
+	dispatch_task_t *slot = &lane->tasks[(lane->head + lane->count) % pool->queueSize];
+	slot->task = task;
+	slot->arg = arg;
+	lane->count++;
+	celixThreadCondition_signal(&lane->notEmpty);
+	celixThreadMutex_unlock(&lane->mutex);
+
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubDispatchPool_flush(pubsub_dispatch_pool_pt pool){
+	dispatch_flush_t flush;
+	celixThreadMutex_create(&flush.mutex, NULL);
+	celixThreadCondition_init(&flush.done, NULL);
+	flush.remaining = pool->nrOfLanes;
+
+	unsigned int i;
+	for(i = 0; i < pool->nrOfLanes; i++){
+		dispatch_lane_t *lane = &pool->lanes[i];
+		celixThreadMutex_lock(&lane->mutex);
+		while(lane->running && lane->count == pool->queueSize){
+			celixThreadCondition_wait(&lane->notFull, &lane->mutex);
+		}
+		if(lane->running){
+			dispatch_task_t *slot = &lane->tasks[(lane->head + lane->count) % pool->queueSize];
+			slot->task = pubsubDispatchPool_flushTask;
+			slot->arg = &flush;
+			lane->count++;
+			celixThreadCondition_signal(&lane->notEmpty);
+		}
+		else{
+			pubsubDispatchPool_flushTask(&flush);
+		}
+		celixThreadMutex_unlock(&lane->mutex);
+	}
+
+	celixThreadMutex_lock(&flush.mutex);
+	while(flush.remaining > 0){
+		celixThreadCondition_wait(&flush.done, &flush.mutex);
+	}
+	celixThreadMutex_unlock(&flush.mutex);
+
+	celixThreadMutex_destroy(&flush.mutex);
+	celixThreadCondition_destroy(&flush.done);
+	return CELIX_SUCCESS;
+}
+
+unsigned int pubsubDispatchPool_nrOfThreads(pubsub_dispatch_pool_pt pool){
+	return pool->nrOfLanes;
+}
+
+static void pubsubDispatchPool_flushTask(void *arg){
+	dispatch_flush_t *flush = arg;
+	celixThreadMutex_lock(&flush->mutex);
+	if(--flush->remaining == 0){
+		celixThreadCondition_broadcast(&flush->done);
+	}
+	celixThreadMutex_unlock(&flush->mutex);
+}
+
+static void* pubsubDispatchPool_run(void *arg){
+	dispatch_lane_t *lane = arg;
+	unsigned int queueSize = lane->pool->queueSize;
+
+	celixThreadMutex_lock(&lane->mutex);
+	while(lane->running || lane->count > 0){
+		if(lane->count == 0){
+			celixThreadCondition_wait(&lane->notEmpty, &lane->mutex);
+			continue;
+		}
+		dispatch_task_t task = lane->tasks[lane->head];
+		lane->head = (lane->head + 1) % queueSize;
+		lane->count--;
+		celixThreadCondition_signal(&lane->notFull);
+		celixThreadMutex_unlock(&lane->mutex);
+
+		task.task(task.arg);
+
+		celixThreadMutex_lock(&lane->mutex);
+	}
+	celixThreadCondition_broadcast(&lane->notFull); // dispatchers waiting on a stopped lane give up
+	celixThreadMutex_unlock(&lane->mutex);
+
+	return NULL;
+}
@@ -0,0 +1,366 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_dyn_serializer.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <inttypes.h>
+
+#include "utils.h"
+#include "hash_map.h"
+#include "bundle_context.h"
+
+#include "log_helper.h"
+
+#include "dyn_message.h"
+
+#include "pubsub_dyn_serializer.h"
+
+#define SYSTEM_BUNDLE_ARCHIVE_PATH 		"CELIX_FRAMEWORK_EXTENDER_PATH"
+#define MAX_PATH_LEN    1024
+
+struct pubsub_dyn_serializer {
+	bundle_context_pt bundle_context;
+	log_helper_pt loghelper;
+	const pubsub_dyn_codec_t *codec;
+};
+
+/* The admins call the msg serializer functions with the msg serializer itself, which gives access to the codec */
+typedef struct pubsub_dyn_msg_serializer {
+	pubsub_msg_serializer_t msgSerializer; //first member
+	const pubsub_dyn_codec_t *codec;
+} pubsub_dyn_msg_serializer_t;
+
+static char* pubsubDynSerializer_getMsgDescriptionDir(bundle_pt bundle);
+static void pubsubDynSerializer_addMsgSerializerFromBundle(pubsub_dyn_serializer_pt serializer, const char *root, bundle_pt bundle, hash_map_pt msgTypesMap);
+static void pubsubDynSerializer_fillMsgSerializerMap(pubsub_dyn_serializer_pt serializer, hash_map_pt msgTypesMap,bundle_pt bundle);
+
+celix_status_t pubsubDynSerializer_create(bundle_context_pt context, const pubsub_dyn_codec_t *codec, pubsub_dyn_serializer_pt *serializer) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	*serializer = calloc(1, sizeof(**serializer));
+
+	if (!*serializer) {
+		status = CELIX_ENOMEM;
+	}
+	else{
+
+		(*serializer)->bundle_context= context;
+		(*serializer)->codec = codec;
+
+		if (logHelper_create(context, &(*serializer)->loghelper) == CELIX_SUCCESS) {
+			logHelper_start((*serializer)->loghelper);
+		}
+
+	}
+
+	return status;
+}
+
+celix_status_t pubsubDynSerializer_destroy(pubsub_dyn_serializer_pt serializer) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	logHelper_stop(serializer->loghelper);
+	logHelper_destroy(&serializer->loghelper);
+
+	free(serializer);
+
+	return status;
+}
+
+celix_status_t pubsubDynSerializer_createSerializerMap(pubsub_dyn_serializer_pt serializer, bundle_pt bundle, hash_map_pt* serializerMap) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	hash_map_pt map = hashMap_create(NULL, NULL, NULL, NULL);
+
+	if (map != NULL) {
+		pubsubDynSerializer_fillMsgSerializerMap(serializer, map, bundle);
+	} else {
+		logHelper_log(serializer->loghelper, OSGI_LOGSERVICE_ERROR, "Cannot allocate memory for msg map");
+		status = CELIX_ENOMEM;
+	}
+
+	if (status == CELIX_SUCCESS) {
+		*serializerMap = map;
+	}
+	return status;
+}
+
+celix_status_t pubsubDynSerializer_destroySerializerMap(pubsub_dyn_serializer_pt serializer, hash_map_pt serializerMap) {
+	celix_status_t status = CELIX_SUCCESS;
+	if (serializerMap == NULL) {
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	hash_map_iterator_t iter = hashMapIterator_construct(serializerMap);
+	while (hashMapIterator_hasNext(&iter)) {
+		pubsub_msg_serializer_t* msgSerializer = hashMapIterator_nextValue(&iter);
+		dyn_message_type *dynMsg = (dyn_message_type*)msgSerializer->handle;
+		dynMessage_release(dynMsg); //note msgSer->name and msgSer->version owned by dynType
+		free(msgSerializer); //also contains the service struct and the codec.
+	}
+
+	hashMap_destroy(serializerMap, false, false);
+
+	return status;
+}
+
+
+static dyn_type* pubsubDynSerializer_getType(pubsub_msg_serializer_t* msgSerializer) {
+	dyn_type* dynType = NULL;
+	dyn_message_type *dynMsg = (dyn_message_type*)msgSerializer->handle;
+	dynMessage_getMessageType(dynMsg, &dynType);
+	return dynType;
+}
+
+static celix_status_t pubsubDynSerializer_serialize(pubsub_msg_serializer_t* msgSerializer, const void* msg, void** out, size_t *outLen) {
+	const pubsub_dyn_codec_t *codec = ((pubsub_dyn_msg_serializer_t*)msgSerializer)->codec;
+	dyn_type* dynType = pubsubDynSerializer_getType(msgSerializer);
+
+	if (dynType == NULL || codec->encode(dynType, msg, out, outLen) != 0) {
+		return CELIX_BUNDLE_EXCEPTION;
+	}
+	return CELIX_SUCCESS;
+}
+
+static celix_status_t pubsubDynSerializer_deserialize(pubsub_msg_serializer_t* msgSerializer, const void* input, size_t inputLen, void **out) {
+	const pubsub_dyn_codec_t *codec = ((pubsub_dyn_msg_serializer_t*)msgSerializer)->codec;
+	dyn_type* dynType = pubsubDynSerializer_getType(msgSerializer);
+	void *msg = NULL;
+
+	if (dynType == NULL || codec->decode(dynType, input, inputLen, &msg) != 0) {
+		return CELIX_BUNDLE_EXCEPTION;
+	}
+	*out = msg;
+	return CELIX_SUCCESS;
+}
+
+static void pubsubDynSerializer_freeMsg(pubsub_msg_serializer_t* msgSerializer, void *msg) {
+	dyn_type* dynType = pubsubDynSerializer_getType(msgSerializer);
+	if (dynType != NULL) {
+		dynType_free(dynType, msg);
+	}
+}
+
+static celix_status_t pubsubDynSerializer_deserializeInArena(pubsub_msg_serializer_t* msgSerializer, const void* input, size_t inputLen, void **out) {
+	const pubsub_dyn_codec_t *codec = ((pubsub_dyn_msg_serializer_t*)msgSerializer)->codec;
+	dyn_type* dynType = pubsubDynSerializer_getType(msgSerializer);
+	void *msg = NULL;
+
+	if (dynType == NULL || codec->decodeInArena(dynType, input, inputLen, &msg) != 0) {
+		return CELIX_BUNDLE_EXCEPTION;
+	}
+	*out = msg;
+	return CELIX_SUCCESS;
+}
+
+static void pubsubDynSerializer_freeArenaMsg(pubsub_msg_serializer_t* msgSerializer, void *msg) {
+	dyn_type* dynType = pubsubDynSerializer_getType(msgSerializer);
+	if (dynType != NULL) {
+		dynType_freeArena(dynType, msg);
+	}
+}
+
+static celix_status_t pubsubDynSerializer_allocMsg(pubsub_msg_serializer_t* msgSerializer, void **out) {
+	dyn_type* dynType = pubsubDynSerializer_getType(msgSerializer);
+	void *msg = NULL;
+
+	if (dynType == NULL || dynType_alloc(dynType, &msg) != 0) {
+		return CELIX_ENOMEM;
+	}
+	*out = msg;
+	return CELIX_SUCCESS;
+}
+
+/* A msg of a type without texts, sequences or (typed) pointers owns no memory besides its own struct, so it can be cleared and reused */
+static bool pubsubDynSerializer_isFixedSize(dyn_type *type) {
+	bool fixed = false;
+	if (dynType_type(type) == DYN_TYPE_SIMPLE) {
+		fixed = true;
+	}
+	else if (dynType_type(type) == DYN_TYPE_COMPLEX) {
+		struct complex_type_entries_head *entries = NULL;
+		fixed = dynType_complex_entries(type, &entries) == 0;
+		struct complex_type_entry *entry = NULL;
+		if (fixed) {
+			TAILQ_FOREACH(entry, entries, entries) {
+				if (!pubsubDynSerializer_isFixedSize(entry->type)) {
+					fixed = false;
+					break;
+				}
+			}
+		}
+	}
+	return fixed;
+}
+
+
+static void pubsubDynSerializer_fillMsgSerializerMap(pubsub_dyn_serializer_pt serializer, hash_map_pt msgSerializers, bundle_pt bundle) {
+	char* root = NULL;
+	char* metaInfPath = NULL;
+
+	root = pubsubDynSerializer_getMsgDescriptionDir(bundle);
+
+	if(root != NULL){
+		asprintf(&metaInfPath, "%s/META-INF/descriptors", root);
+
+		pubsubDynSerializer_addMsgSerializerFromBundle(serializer, root, bundle, msgSerializers);
+		pubsubDynSerializer_addMsgSerializerFromBundle(serializer, metaInfPath, bundle, msgSerializers);
+
+		free(metaInfPath);
+		free(root);
+	}
+}
+
+static char* pubsubDynSerializer_getMsgDescriptionDir(bundle_pt bundle)
+{
+	char *root = NULL;
+
+	bool isSystemBundle = false;
+	bundle_isSystemBundle(bundle, &isSystemBundle);
+
+	if(isSystemBundle == true) {
+		bundle_context_pt context;
+		bundle_getContext(bundle, &context);
+
+		const char *prop = NULL;
+
+		bundleContext_getProperty(context, SYSTEM_BUNDLE_ARCHIVE_PATH, &prop);
+
+		if(prop != NULL) {
+			root = strdup(prop);
+		} else {
+			root = getcwd(NULL, 0);
+		}
+	} else {
+		bundle_getEntry(bundle, ".", &root);
+	}
+
+	return root;
+}
+
+
+static void pubsubDynSerializer_addMsgSerializerFromBundle(pubsub_dyn_serializer_pt serializer, const char *root, bundle_pt bundle, hash_map_pt msgSerializers)
+{
+	char path[MAX_PATH_LEN];
+	struct dirent *entry = NULL;
+	DIR *dir = opendir(root);
+
+	if(dir) {
+		entry = readdir(dir);
+	}
+
+	while (entry != NULL) {
+
+		if (strstr(entry->d_name, ".descriptor") != NULL) {
+
+			printf("DMU: Parsing entry '%s'\n", entry->d_name);
+
+			snprintf(path, MAX_PATH_LEN, "%s/%s", root, entry->d_name);
+			FILE *stream = fopen(path,"r");
+
+			if (stream != NULL){
+				dyn_message_type* msgType = NULL;
+
+				//bundles using the same message descriptor share the parsed message
+				int rc = dynMessage_parseShared(stream, &msgType);
+				if (rc == 0 && msgType != NULL) {
+
+					char* msgName = NULL;
+					rc += dynMessage_getName(msgType,&msgName);
+
+					version_pt msgVersion = NULL;
+					rc += dynMessage_getVersion(msgType, &msgVersion);
+
+					if(rc == 0 && msgName != NULL && msgVersion != NULL){
+
+						unsigned int msgId = utils_stringHash(msgName);
+
+						pubsub_dyn_msg_serializer_t *dynMsgSerializer = calloc(1,sizeof(*dynMsgSerializer));
+						pubsub_msg_serializer_t *msgSerializer = &dynMsgSerializer->msgSerializer;
+
+						dynMsgSerializer->codec = serializer->codec;
+						msgSerializer->handle = msgType;
+						msgSerializer->msgId = msgId;
+						msgSerializer->msgName = msgName;
+						msgSerializer->msgVersion = msgVersion;
+						msgSerializer->serialize = (void*) pubsubDynSerializer_serialize;
+						msgSerializer->deserialize = (void*) pubsubDynSerializer_deserialize;
+						msgSerializer->freeMsg = (void*) pubsubDynSerializer_freeMsg;
+						msgSerializer->allocMsg = (void*) pubsubDynSerializer_allocMsg;
+						if (serializer->codec->decodeInArena != NULL) {
+							msgSerializer->deserializeInArena = (void*) pubsubDynSerializer_deserializeInArena;
+							msgSerializer->freeArenaMsg = (void*) pubsubDynSerializer_freeArenaMsg;
+						}
+
+						dyn_type *dynType = NULL;
+						dynMessage_getMessageType(msgType, &dynType);
+						msgSerializer->fixedMsgSize = (dynType != NULL && pubsubDynSerializer_isFixedSize(dynType)) ? dynType_size(dynType) : 0;
+
+						pubsub_msg_serializer_t *clash = hashMap_get(msgSerializers, (void*)(uintptr_t)msgId);
+						if (clash != NULL){
+							if (strcmp(clash->msgName, msgName) == 0) {
+								printf("Cannot add msg %s. Already added from another descriptor.\n", msgName);
+							} else {
+								printf("Cannot add msg %s. Its msg id %u clashes with msg %s!!\n", msgName, msgId, clash->msgName);
+							}
+							free(dynMsgSerializer);
+							dynMessage_release(msgType);
+						}
+						else if (msgId != 0){
+							printf("Adding %u : %s\n", msgId, msgName);
+							hashMap_put(msgSerializers, (void*)(uintptr_t)msgId, msgSerializer);
+						}
+						else{
+							printf("Error creating msg serializer\n");
+							free(dynMsgSerializer);
+							dynMessage_release(msgType);
+						}
+
+					}
+					else{
+						printf("Cannot retrieve name and/or version from msg\n");
+						dynMessage_release(msgType);
+					}
+
+				} else{
+					printf("DMU: cannot parse message from descriptor %s\n.",path);
+				}
+				fclose(stream);
+			}else{
+				printf("DMU: cannot open descriptor file %s\n.",path);
+			}
+
+		}
+		entry = readdir(dir);
+	}
+
+	if(dir) {
+		closedir(dir);
+	}
+}
@@ -0,0 +1,142 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_late_joiner.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pubsub_late_joiner.h"
+
+struct lvc_entry {
+	unsigned int nrParts;
+	struct iovec *parts; // points into the same allocation as the part data
+};
+
+struct pubsub_lvc {
+	unsigned int size;
+	unsigned int count;
+	unsigned int next; // slot of the next message, the oldest one when the cache is full
+	struct lvc_entry *entries;
+};
+
+static unsigned int property_toUInt(properties_pt topic_props, const char *key, unsigned int defaultValue);
+
+unsigned int pubsubLateJoiner_getTimeout(properties_pt topic_props){
+	return property_toUInt(topic_props, PUBSUB_LATE_JOINER_TIMEOUT_KEY, PUBSUB_LATE_JOINER_DEFAULT_TIMEOUT);
+}
+
+unsigned int pubsubLateJoiner_getLvcSize(properties_pt topic_props){
+	unsigned int size = property_toUInt(topic_props, PUBSUB_LVC_SIZE_KEY, 0);
+	if(size > PUBSUB_LVC_MAX_SIZE){
+		printf("PUBSUB_LVC: Last value cache size %u too large, using %u.\n", size, PUBSUB_LVC_MAX_SIZE);
+		size = PUBSUB_LVC_MAX_SIZE;
+	}
+	return size;
+}
+
+celix_status_t pubsubLvc_create(unsigned int size, pubsub_lvc_pt *out){
+	if(size == 0){
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	pubsub_lvc_pt lvc = calloc(1, sizeof(*lvc));
+	if(lvc == NULL){
+		return CELIX_ENOMEM;
+	}
+	lvc->entries = calloc(size, sizeof(struct lvc_entry));
+	if(lvc->entries == NULL){
+		free(lvc);
+		return CELIX_ENOMEM;
+	}
+	lvc->size = size;
+
+	*out = lvc;
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubLvc_destroy(pubsub_lvc_pt lvc){
+	unsigned int i = 0;
+	for(;i<lvc->size;i++){
+		free(lvc->entries[i].parts);
+	}
+	free(lvc->entries);
+	free(lvc);
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubLvc_add(pubsub_lvc_pt lvc, const struct iovec *parts, unsigned int nrParts){
+	size_t dataSize = 0;
+	unsigned int i = 0;
+	for(;i<nrParts;i++){
+		dataSize += parts[i].iov_len;
+	}
+
+	struct iovec *copy = malloc(nrParts * sizeof(struct iovec) + dataSize);
+	if(copy == NULL){
+		return CELIX_ENOMEM;
+	}
+
+	char *data = (char*)(copy + nrParts);
+	for(i=0;i<nrParts;i++){
+		memcpy(data, parts[i].iov_base, parts[i].iov_len);
+		copy[i].iov_base = data;
+		copy[i].iov_len = parts[i].iov_len;
+		data += parts[i].iov_len;
+	}
+
+	struct lvc_entry *entry = &lvc->entries[lvc->next];
+	free(entry->parts);
+	entry->parts = copy;
+	entry->nrParts = nrParts;
+
+	lvc->next = (lvc->next + 1) % lvc->size;
+	if(lvc->count < lvc->size){
+		lvc->count++;
+	}
+
+	return CELIX_SUCCESS;
+}
+
+unsigned int pubsubLvc_replay(pubsub_lvc_pt lvc, pubsub_lvc_send_fn send, void *handle){
+	unsigned int nrSent = 0;
+	unsigned int first = (lvc->next + lvc->size - lvc->count) % lvc->size;
+	unsigned int i = 0;
+	for(;i<lvc->count;i++){
+		struct lvc_entry *entry = &lvc->entries[(first + i) % lvc->size];
+		if(send(handle, entry->parts, entry->nrParts)){
+			nrSent++;
+		}
+	}
+	return nrSent;
+}
+
+static unsigned int property_toUInt(properties_pt topic_props, const char *key, unsigned int defaultValue){
+	const char *value = NULL;
+	if(topic_props != NULL){
+		value = properties_get(topic_props, key);
+	}
+	return (value != NULL) ? (unsigned int)strtoul(value, NULL, 10) : defaultValue;
+}
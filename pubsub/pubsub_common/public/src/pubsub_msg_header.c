@@ -0,0 +1,104 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_msg_header.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "utils.h"
+
+#include "pubsub_msg_header.h"
+
+static void write_uint32(unsigned char *buf, uint32_t value);
+static uint32_t read_uint32(const unsigned char *buf);
+
+bool pubsubMsgHeader_useCompact(properties_pt topic_props){
+	const char *type = NULL;
+	if(topic_props != NULL){
+		type = properties_get(topic_props, PUBSUB_WIRE_HEADER_KEY);
+	}
+	return (type != NULL && strcmp(type, PUBSUB_WIRE_HEADER_COMPACT) == 0);
+}
+
+void pubsubMsgHeader_encodeCompact(const struct pubsub_msg_compact_header *hdr, unsigned char *buf){
+	buf[0] = PUBSUB_COMPACT_HEADER_MARKER;
+	buf[1] = PUBSUB_COMPACT_HEADER_VERSION;
+	write_uint32(buf + 2, hdr->topicId);
+	write_uint32(buf + 6, hdr->publisherId);
+	write_uint32(buf + 10, hdr->type);
+	buf[14] = hdr->major;
+	buf[15] = hdr->minor;
+	write_uint32(buf + 16, hdr->seqNr);
+	write_uint32(buf + 20, (uint32_t)(hdr->sendTime >> 32));
+	write_uint32(buf + 24, (uint32_t)(hdr->sendTime & 0xFFFFFFFF));
+	write_uint32(buf + 28, hdr->payloadSize);
+}
+
+bool pubsubMsgHeader_isCompact(const void *buf, size_t len){
+	return (len > 0 && ((const unsigned char*)buf)[0] == PUBSUB_COMPACT_HEADER_MARKER);
+}
+
+bool pubsubMsgHeader_decodeCompact(const void *buf, size_t len, struct pubsub_msg_compact_header *hdr){
+	const unsigned char *in = (const unsigned char*)buf;
+
+	if(len < PUBSUB_COMPACT_HEADER_SIZE || in[0] != PUBSUB_COMPACT_HEADER_MARKER || in[1] != PUBSUB_COMPACT_HEADER_VERSION){
+		return false;
+	}
+
+	hdr->topicId = read_uint32(in + 2);
+	hdr->publisherId = read_uint32(in + 6);
+	hdr->type = read_uint32(in + 10);
+	hdr->major = in[14];
+	hdr->minor = in[15];
+	hdr->seqNr = read_uint32(in + 16);
+	hdr->sendTime = ((uint64_t)read_uint32(in + 20) << 32) | read_uint32(in + 24);
+	hdr->payloadSize = read_uint32(in + 28);
+
+	return true;
+}
+
+void pubsubMsgHeader_compactTopicPrefix(const char *topic, unsigned char *buf){
+	buf[0] = PUBSUB_COMPACT_HEADER_MARKER;
+	buf[1] = PUBSUB_COMPACT_HEADER_VERSION;
+	write_uint32(buf + 2, utils_stringHash(topic));
+}
+
+uint64_t pubsubMsgHeader_now(void){
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void write_uint32(unsigned char *buf, uint32_t value){
+	uint32_t netValue = htonl(value);
+	memcpy(buf, &netValue, sizeof(netValue));
+}
+
+static uint32_t read_uint32(const unsigned char *buf){
+	uint32_t netValue;
+	memcpy(&netValue, buf, sizeof(netValue));
+	return ntohl(netValue);
+}
@@ -0,0 +1,133 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_msg_pool.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "celix_threads.h"
+
+#include "pubsub_msg_type_index.h"
+#include "pubsub_msg_pool.h"
+
+struct pubsub_msg_pool {
+	celix_thread_mutex_t mutex;
+
+	pubsub_msg_serializer_t **msgSerializers; // by local index
+	unsigned int nrOfMsgSerializers;
+
+	unsigned int maxPerType;
+	void **freeMsgs; // nrOfMsgSerializers * maxPerType
+	unsigned int *nrOfFreeMsgs; // by local index
+};
+
+celix_status_t pubsubMsgPool_create(pubsub_msg_serializer_t **msgSerializers, unsigned int nrOfMsgSerializers, unsigned int maxPerType, pubsub_msg_pool_pt *out){
+	pubsub_msg_pool_pt pool = calloc(1, sizeof(*pool));
+	if(pool == NULL){
+		return CELIX_ENOMEM;
+	}
+
+	pool->msgSerializers = msgSerializers;
+	pool->nrOfMsgSerializers = nrOfMsgSerializers;
+	pool->maxPerType = maxPerType;
+	if(nrOfMsgSerializers > 0 && maxPerType > 0){
+		pool->freeMsgs = calloc(nrOfMsgSerializers * maxPerType, sizeof(*pool->freeMsgs));
+		pool->nrOfFreeMsgs = calloc(nrOfMsgSerializers, sizeof(*pool->nrOfFreeMsgs));
+		if(pool->freeMsgs == NULL || pool->nrOfFreeMsgs == NULL){
+			free(pool->freeMsgs);
+			free(pool->nrOfFreeMsgs);
+			free(pool);
+			return CELIX_ENOMEM;
+		}
+	}
+	celixThreadMutex_create(&pool->mutex, NULL);
+
+	*out = pool;
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubMsgPool_destroy(pubsub_msg_pool_pt pool){
+	if(pool->nrOfFreeMsgs != NULL){
+		unsigned int i;
+		for(i = 0; i < pool->nrOfMsgSerializers; i++){
+			pubsub_msg_serializer_t *msgSer = pool->msgSerializers[i];
+			unsigned int j;
+			for(j = 0; j < pool->nrOfFreeMsgs[i]; j++){
+				msgSer->freeMsg(msgSer, pool->freeMsgs[i * pool->maxPerType + j]);
+			}
+		}
+	}
+	celixThreadMutex_destroy(&pool->mutex);
+	free(pool->freeMsgs);
+	free(pool->nrOfFreeMsgs);
+	free(pool);
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubMsgPool_alloc(pubsub_msg_pool_pt pool, int localIndex, void **msg){
+	pubsub_msg_serializer_t *msgSer = pubsubMsgTypeIndex_getSerializer(pool->msgSerializers, pool->nrOfMsgSerializers, localIndex);
+	if(msgSer == NULL || msgSer->allocMsg == NULL){
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	void *pooled = NULL;
+	celixThreadMutex_lock(&pool->mutex);
+	if(pool->nrOfFreeMsgs != NULL && pool->nrOfFreeMsgs[localIndex] > 0){
+		pooled = pool->freeMsgs[localIndex * pool->maxPerType + --pool->nrOfFreeMsgs[localIndex]];
+	}
+	celixThreadMutex_unlock(&pool->mutex);
+
+	if(pooled != NULL){
+		*msg = pooled;
+		return CELIX_SUCCESS;
+	}
+	return msgSer->allocMsg(msgSer, msg);
+}
+
+celix_status_t pubsubMsgPool_free(pubsub_msg_pool_pt pool, int localIndex, void *msg){
+	pubsub_msg_serializer_t *msgSer = pubsubMsgTypeIndex_getSerializer(pool->msgSerializers, pool->nrOfMsgSerializers, localIndex);
+	if(msgSer == NULL){
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+	if(msg == NULL){
+		return CELIX_SUCCESS;
+	}
+
+	bool pooled = false;
+	if(msgSer->fixedMsgSize > 0){
+		memset(msg, 0, msgSer->fixedMsgSize);
+		celixThreadMutex_lock(&pool->mutex);
+		if(pool->nrOfFreeMsgs != NULL && pool->nrOfFreeMsgs[localIndex] < pool->maxPerType){
+			pool->freeMsgs[localIndex * pool->maxPerType + pool->nrOfFreeMsgs[localIndex]++] = msg;
+			pooled = true;
+		}
+		celixThreadMutex_unlock(&pool->mutex);
+	}
+
+	if(!pooled){
+		msgSer->freeMsg(msgSer, msg);
+	}
+	return CELIX_SUCCESS;
+}
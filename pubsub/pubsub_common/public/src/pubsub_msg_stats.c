@@ -0,0 +1,153 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_msg_stats.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "hash_map.h"
+#include "celix_threads.h"
+
+#include "pubsub_msg_header.h"
+#include "pubsub_msg_stats.h"
+
+#define NR_LATENCY_BUCKETS 10
+
+/* Upper bounds of the latency histogram buckets in us, the last bucket is unbounded */
+static const uint64_t latencyBucketBounds[NR_LATENCY_BUCKETS - 1] = {10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000};
+
+struct publisher_stats {
+	unsigned int publisherId;
+	unsigned int nextSeqNr;
+	uint64_t nrReceived;
+	uint64_t nrLost;
+	uint64_t nrOutOfOrder;
+	uint64_t minLatency;	// ns
+	uint64_t maxLatency;	// ns
+	uint64_t sumLatency;	// ns
+	uint64_t latencyBuckets[NR_LATENCY_BUCKETS];
+};
+
+struct pubsub_msg_stats {
+	celix_thread_mutex_t lock;
+	hash_map_pt publishers; //<publisherId,publisher_stats>
+};
+
+celix_status_t pubsubMsgStats_create(pubsub_msg_stats_pt *out){
+	pubsub_msg_stats_pt stats = calloc(1, sizeof(*stats));
+	if(stats == NULL){
+		return CELIX_ENOMEM;
+	}
+
+	celixThreadMutex_create(&stats->lock, NULL);
+	stats->publishers = hashMap_create(NULL, NULL, NULL, NULL);
+
+	*out = stats;
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubMsgStats_destroy(pubsub_msg_stats_pt stats){
+	celixThreadMutex_lock(&stats->lock);
+	hashMap_destroy(stats->publishers, false, true);
+	celixThreadMutex_unlock(&stats->lock);
+	celixThreadMutex_destroy(&stats->lock);
+	free(stats);
+	return CELIX_SUCCESS;
+}
+
+void pubsubMsgStats_update(pubsub_msg_stats_pt stats, unsigned int publisherId, unsigned int seqNr, uint64_t sendTime){
+	uint64_t now = pubsubMsgHeader_now();
+	uint64_t latency = (now > sendTime) ? now - sendTime : 0;
+	void *key = (void*)(uintptr_t)publisherId;
+
+	celixThreadMutex_lock(&stats->lock);
+
+	struct publisher_stats *pub = hashMap_get(stats->publishers, key);
+	if(pub == NULL){
+		pub = calloc(1, sizeof(*pub));
+		pub->publisherId = publisherId;
+		pub->nextSeqNr = seqNr;
+		pub->minLatency = UINT64_MAX;
+		hashMap_put(stats->publishers, key, pub);
+	}
+
+	/* Signed difference, so the comparison survives wrap around of the sequence number */
+	int32_t diff = (int32_t)(seqNr - pub->nextSeqNr);
+	if(diff >= 0){
+		pub->nrLost += (uint64_t)diff;
+		pub->nextSeqNr = seqNr + 1;
+	}
+	else{
+		pub->nrOutOfOrder++;
+		if(pub->nrLost > 0){
+			pub->nrLost--;
+		}
+	}
+
+	pub->nrReceived++;
+	pub->sumLatency += latency;
+	if(latency < pub->minLatency){
+		pub->minLatency = latency;
+	}
+	if(latency > pub->maxLatency){
+		pub->maxLatency = latency;
+	}
+
+	int bucket = 0;
+	while(bucket < NR_LATENCY_BUCKETS - 1 && latency / 1000 >= latencyBucketBounds[bucket]){
+		bucket++;
+	}
+	pub->latencyBuckets[bucket]++;
+
+	celixThreadMutex_unlock(&stats->lock);
+}
+
+void pubsubMsgStats_print(pubsub_msg_stats_pt stats, FILE *out){
+	celixThreadMutex_lock(&stats->lock);
+
+	if(hashMap_size(stats->publishers) == 0){
+		fprintf(out, "    no messages with a compact header received\n");
+	}
+
+	hash_map_iterator_pt iter = hashMapIterator_create(stats->publishers);
+	while(hashMapIterator_hasNext(iter)){
+		struct publisher_stats *pub = hashMapIterator_nextValue(iter);
+		uint64_t avg = pub->sumLatency / pub->nrReceived;
+
+		fprintf(out, "    publisher %08x: received %" PRIu64 ", lost %" PRIu64 ", out of order %" PRIu64 "\n",
+				pub->publisherId, pub->nrReceived, pub->nrLost, pub->nrOutOfOrder);
+		fprintf(out, "      latency (us): min %" PRIu64 ", avg %" PRIu64 ", max %" PRIu64 "\n",
+				pub->minLatency / 1000, avg / 1000, pub->maxLatency / 1000);
+		fprintf(out, "      histogram (us):");
+		int i;
+		for(i = 0; i < NR_LATENCY_BUCKETS - 1; i++){
+			fprintf(out, " <%" PRIu64 ":%" PRIu64, latencyBucketBounds[i], pub->latencyBuckets[i]);
+		}
+		fprintf(out, " >=%" PRIu64 ":%" PRIu64 "\n", latencyBucketBounds[NR_LATENCY_BUCKETS - 2], pub->latencyBuckets[NR_LATENCY_BUCKETS - 1]);
+	}
+	hashMapIterator_destroy(iter);
+
+	celixThreadMutex_unlock(&stats->lock);
+}
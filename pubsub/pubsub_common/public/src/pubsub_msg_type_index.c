@@ -0,0 +1,235 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_msg_type_index.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pubsub_msg_type_index.h"
+
+#define INITIAL_CAPACITY_BITS	4
+#define MAX_CAPACITY_BITS		16
+
+/* Multipliers tried, in order, for a table size before the table is doubled */
+static const unsigned int multipliers[] = { 2654435761U, 0x85EBCA6BU, 0xC2B2AE35U, 0x27D4EB2FU, 0x165667B1U, 0x9E3779B1U, 0x7FEB352DU, 0x846CA68BU };
+
+/* Direct table from msg id to local index, every registered msg id has a slot of its own. Empty slots have local index -1 */
+struct pubsub_msg_type_index {
+	unsigned int *ids;
+	int *localIndices;
+	unsigned int capacityBits;
+	unsigned int multiplier;
+
+	char **names; // by local index
+	unsigned int *msgIds; // by local index
+	unsigned int size;
+	unsigned int namesCapacity;
+};
+
+static inline unsigned int pubsubMsgTypeIndex_slot(unsigned int msgId, unsigned int multiplier, unsigned int capacityBits){
+	return (msgId * multiplier) >> (32 - capacityBits);
+}
+
+/* Fills the tables with the msg ids of the local indices 0..nrOfIds-1, returns false when two of them share a slot */
+static bool pubsubMsgTypeIndex_fill(unsigned int *ids, int *localIndices, unsigned int capacityBits, unsigned int multiplier, unsigned int *msgIds, unsigned int nrOfIds){
+	unsigned int i;
+	for(i = 0; i < (1U << capacityBits); i++){
+		ids[i] = 0;
+		localIndices[i] = -1;
+	}
+	for(i = 0; i < nrOfIds; i++){
+		unsigned int slot = pubsubMsgTypeIndex_slot(msgIds[i], multiplier, capacityBits);
+		if(localIndices[slot] >= 0){
+			return false;
+		}
+		ids[slot] = msgIds[i];
+		localIndices[slot] = (int)i;
+	}
+	return true;
+}
+
+/* Rebuilds the table for the msg ids of the local indices 0..nrOfIds-1, using the smallest size and first multiplier without shared slots */
+static celix_status_t pubsubMsgTypeIndex_rebuild(pubsub_msg_type_index_pt index, unsigned int nrOfIds){
+	unsigned int bits = INITIAL_CAPACITY_BITS;
+	while((1U << bits) < 2 * nrOfIds){
+		bits++;
+	}
+
+	for(; bits <= MAX_CAPACITY_BITS; bits++){
+		unsigned int *ids = malloc((1U << bits) * sizeof(*ids));
+		int *localIndices = malloc((1U << bits) * sizeof(*localIndices));
+		if(ids == NULL || localIndices == NULL){
+			free(ids);
+			free(localIndices);
+			return CELIX_ENOMEM;
+		}
+
+		unsigned int i;
+		for(i = 0; i < sizeof(multipliers) / sizeof(multipliers[0]); i++){
+			if(pubsubMsgTypeIndex_fill(ids, localIndices, bits, multipliers[i], index->msgIds, nrOfIds)){
+				free(index->ids);
+				free(index->localIndices);
+				index->ids = ids;
+				index->localIndices = localIndices;
+				index->capacityBits = bits;
+				index->multiplier = multipliers[i];
+				return CELIX_SUCCESS;
+			}
+		}
+		free(ids);
+		free(localIndices);
+	}
+
+	return CELIX_BUNDLE_EXCEPTION;
+}
+
+/* Returns the local index of the msg, assigning the next one for unknown msg ids, or -1 when the id is reserved or belongs to another msg name */
+static int pubsubMsgTypeIndex_register(pubsub_msg_type_index_pt index, unsigned int msgId, const char *msgName){
+	if(msgId < PUBSUB_MSG_TYPE_INDEX_FIRST_MSG_ID){
+		printf("PSA: Msg type %s has the reserved msg id %u, ignoring %s.\n", msgName, msgId, msgName);
+		return -1;
+	}
+
+	int localIndex = pubsubMsgTypeIndex_get(index, msgId);
+	if(localIndex >= 0){
+		if(strcmp(index->names[localIndex], msgName) != 0){
+			printf("PSA: Msg types %s and %s have the same msg id %u, ignoring %s.\n", index->names[localIndex], msgName, msgId, msgName);
+			return -1;
+		}
+		return localIndex;
+	}
+
+	if(index->size == index->namesCapacity){
+		unsigned int capacity = 2 * index->namesCapacity;
+		char **names = realloc(index->names, capacity * sizeof(*names));
+		if(names == NULL){
+			return -1;
+		}
+		index->names = names;
+		unsigned int *msgIds = realloc(index->msgIds, capacity * sizeof(*msgIds));
+		if(msgIds == NULL){
+			return -1;
+		}
+		index->msgIds = msgIds;
+		index->namesCapacity = capacity;
+	}
+
+	index->msgIds[index->size] = msgId;
+	unsigned int slot = pubsubMsgTypeIndex_slot(msgId, index->multiplier, index->capacityBits);
+	if((2 * (index->size + 1) > (1U << index->capacityBits) || index->localIndices[slot] >= 0) && pubsubMsgTypeIndex_rebuild(index, index->size + 1) != CELIX_SUCCESS){
+		printf("PSA: Cannot add msg type %s to the msg type index, ignoring %s.\n", msgName, msgName);
+		return -1;
+	}
+
+	localIndex = (int)index->size;
+	index->names[localIndex] = strdup(msgName);
+	index->size++;
+	slot = pubsubMsgTypeIndex_slot(msgId, index->multiplier, index->capacityBits);
+	index->ids[slot] = msgId;
+	index->localIndices[slot] = localIndex;
+
+	return localIndex;
+}
+
+celix_status_t pubsubMsgTypeIndex_create(pubsub_msg_type_index_pt *out){
+	pubsub_msg_type_index_pt index = calloc(1, sizeof(*index));
+	if(index == NULL){
+		return CELIX_ENOMEM;
+	}
+
+	index->namesCapacity = 1U << (INITIAL_CAPACITY_BITS - 1);
+	index->names = calloc(index->namesCapacity, sizeof(*index->names));
+	index->msgIds = calloc(index->namesCapacity, sizeof(*index->msgIds));
+	if(index->names == NULL || index->msgIds == NULL || pubsubMsgTypeIndex_rebuild(index, 0) != CELIX_SUCCESS){
+		pubsubMsgTypeIndex_destroy(index);
+		return CELIX_ENOMEM;
+	}
+
+	*out = index;
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubMsgTypeIndex_destroy(pubsub_msg_type_index_pt index){
+	unsigned int i;
+	for(i = 0; i < index->size; i++){
+		free(index->names[i]);
+	}
+	free(index->names);
+	free(index->msgIds);
+	free(index->ids);
+	free(index->localIndices);
+	free(index);
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubMsgTypeIndex_bind(pubsub_msg_type_index_pt index, hash_map_pt msgTypes, pubsub_msg_serializer_t ***serializers, unsigned int *size){
+	*serializers = NULL;
+	*size = 0;
+	if(msgTypes == NULL){
+		return CELIX_SUCCESS;
+	}
+
+	/* Register first, the array has to cover the indices assigned to the msg types of this map */
+	int maxIndex = -1;
+	hash_map_iterator_pt iter = hashMapIterator_create(msgTypes);
+	while(hashMapIterator_hasNext(iter)){
+		pubsub_msg_serializer_t *msgSer = hashMapIterator_nextValue(iter);
+		int localIndex = pubsubMsgTypeIndex_register(index, msgSer->msgId, msgSer->msgName);
+		if(localIndex > maxIndex){
+			maxIndex = localIndex;
+		}
+	}
+	hashMapIterator_destroy(iter);
+
+	if(maxIndex < 0){
+		return CELIX_SUCCESS;
+	}
+
+	pubsub_msg_serializer_t **array = calloc(maxIndex + 1, sizeof(*array));
+	if(array == NULL){
+		return CELIX_ENOMEM;
+	}
+
+	iter = hashMapIterator_create(msgTypes);
+	while(hashMapIterator_hasNext(iter)){
+		pubsub_msg_serializer_t *msgSer = hashMapIterator_nextValue(iter);
+		int localIndex = pubsubMsgTypeIndex_get(index, msgSer->msgId);
+		if(localIndex >= 0 && strcmp(index->names[localIndex], msgSer->msgName) == 0){
+			array[localIndex] = msgSer;
+		}
+	}
+	hashMapIterator_destroy(iter);
+
+	*serializers = array;
+	*size = maxIndex + 1;
+	return CELIX_SUCCESS;
+}
+
+int pubsubMsgTypeIndex_get(pubsub_msg_type_index_pt index, unsigned int msgId){
+	unsigned int slot = pubsubMsgTypeIndex_slot(msgId, index->multiplier, index->capacityBits);
+	return index->ids[slot] == msgId ? index->localIndices[slot] : -1;
+}
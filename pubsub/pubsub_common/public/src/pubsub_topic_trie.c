@@ -0,0 +1,287 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_topic_trie.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_map.h"
+#include "array_list.h"
+#include "utils.h"
+
+#include "pubsub_topic_trie.h"
+
+struct pubsub_topic_trie_node {
+	hash_map_pt children; //<segment,pubsub_topic_trie_node>
+	array_list_pt values;
+};
+
+struct pubsub_topic_trie {
+	struct pubsub_topic_trie_node *root;
+};
+
+static struct pubsub_topic_trie_node* trieNode_create(void);
+static void trieNode_destroy(struct pubsub_topic_trie_node *node);
+static bool trieNode_isEmpty(struct pubsub_topic_trie_node *node);
+static bool trieNode_remove(struct pubsub_topic_trie_node *node, char *segments, void *value, bool *removed);
+static void trieNode_match(struct pubsub_topic_trie_node *node, char **segments, int nrSegments, int index, pubsub_topic_trie_match_fn fn, void *handle);
+static void trieNode_callValues(struct pubsub_topic_trie_node *node, pubsub_topic_trie_match_fn fn, void *handle);
+
+static bool isSegment(const char *segment, size_t len, const char *expected) {
+	return len == strlen(expected) && strncmp(segment, expected, len) == 0;
+}
+
+bool pubsubTopic_isWildcard(const char *topic) {
+	const char *segment = topic;
+	while (segment != NULL) {
+		size_t len = strcspn(segment, ".");
+		if (isSegment(segment, len, PUBSUB_TOPIC_WILDCARD_ONE) || isSegment(segment, len, PUBSUB_TOPIC_WILDCARD_REST)) {
+			return true;
+		}
+		segment = segment[len] == '\0' ? NULL : segment + len + 1;
+	}
+	return false;
+}
+
+bool pubsubTopic_isValidPattern(const char *pattern) {
+	const char *segment = pattern;
+	while (segment != NULL) {
+		size_t len = strcspn(segment, ".");
+		if (isSegment(segment, len, PUBSUB_TOPIC_WILDCARD_REST) && segment[len] != '\0') {
+			return false;
+		}
+		segment = segment[len] == '\0' ? NULL : segment + len + 1;
+	}
+	return true;
+}
+
+bool pubsubTopic_matches(const char *pattern, const char *topic) {
+	const char *p = pattern;
+	const char *t = topic;
+
+	while (true) {
+		size_t pLen = strcspn(p, ".");
+		if (isSegment(p, pLen, PUBSUB_TOPIC_WILDCARD_REST) && p[pLen] == '\0') {
+			return true;
+		}
+		if (t == NULL) { // the topic has less segments than the pattern
+			return false;
+		}
+		size_t tLen = strcspn(t, ".");
+		if (!isSegment(p, pLen, PUBSUB_TOPIC_WILDCARD_ONE) && (pLen != tLen || strncmp(p, t, pLen) != 0)) {
+			return false;
+		}
+		p += pLen;
+		t += tLen;
+		if (*p == '\0') {
+			return *t == '\0';
+		}
+		p++;
+		t = *t == '\0' ? NULL : t + 1;
+	}
+}
+
+char* pubsubTopic_createFilterValue(const char *topic) {
+	char *value = calloc(2 * strlen(topic) + 1, sizeof(char));
+	char *out = value;
+	const char *in;
+
+	if (value == NULL) {
+		return NULL;
+	}
+	for (in = topic; *in != '\0'; in++) {
+		if (*in == '*' || *in == '(' || *in == ')' || *in == '\\') {
+			*out++ = '\\';
+		}
+		*out++ = *in;
+	}
+
+	return value;
+}
+
+celix_status_t pubsubTopicTrie_create(pubsub_topic_trie_pt *out) {
+	pubsub_topic_trie_pt trie = calloc(1, sizeof(*trie));
+	if (trie == NULL) {
+		return CELIX_ENOMEM;
+	}
+	trie->root = trieNode_create();
+	*out = trie;
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubTopicTrie_destroy(pubsub_topic_trie_pt trie) {
+	trieNode_destroy(trie->root);
+	free(trie);
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubTopicTrie_add(pubsub_topic_trie_pt trie, const char *pattern, void *value) {
+	struct pubsub_topic_trie_node *node = trie->root;
+	char *segments = NULL;
+	char *segment = NULL;
+
+	if (!pubsubTopic_isValidPattern(pattern)) {
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	segments = strdup(pattern);
+	segment = segments;
+	while (segment != NULL) {
+		char *next = strchr(segment, PUBSUB_TOPIC_SEPARATOR);
+		if (next != NULL) {
+			*next++ = '\0';
+		}
+		struct pubsub_topic_trie_node *child = hashMap_get(node->children, segment);
+		if (child == NULL) {
+			child = trieNode_create();
+			hashMap_put(node->children, strdup(segment), child);
+		}
+		node = child;
+		segment = next;
+	}
+	free(segments);
+
+	arrayList_add(node->values, value);
+
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubTopicTrie_remove(pubsub_topic_trie_pt trie, const char *pattern, void *value) {
+	bool removed = false;
+	char *segments = strdup(pattern);
+
+	trieNode_remove(trie->root, segments, value, &removed);
+	free(segments);
+
+	return removed ? CELIX_SUCCESS : CELIX_ILLEGAL_ARGUMENT;
+}
+
+bool pubsubTopicTrie_isEmpty(pubsub_topic_trie_pt trie) {
+	return trieNode_isEmpty(trie->root);
+}
+
+void pubsubTopicTrie_match(pubsub_topic_trie_pt trie, const char *topic, pubsub_topic_trie_match_fn fn, void *handle) {
+	char *segments = strdup(topic);
+	int nrSegments = 1;
+	char *c;
+
+	for (c = segments; *c != '\0'; c++) {
+		if (*c == PUBSUB_TOPIC_SEPARATOR) {
+			nrSegments++;
+		}
+	}
+
+	char *segmentList[nrSegments];
+	int i = 0;
+	segmentList[i++] = segments;
+	for (c = segments; *c != '\0'; c++) {
+		if (*c == PUBSUB_TOPIC_SEPARATOR) {
+			*c = '\0';
+			segmentList[i++] = c + 1;
+		}
+	}
+
+	trieNode_match(trie->root, segmentList, nrSegments, 0, fn, handle);
+
+	free(segments);
+}
+
+static struct pubsub_topic_trie_node* trieNode_create(void) {
+	struct pubsub_topic_trie_node *node = calloc(1, sizeof(*node));
+	node->children = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+	arrayList_create(&node->values);
+	return node;
+}
+
+static void trieNode_destroy(struct pubsub_topic_trie_node *node) {
+	hash_map_iterator_pt iter = hashMapIterator_create(node->children);
+	while (hashMapIterator_hasNext(iter)) {
+		trieNode_destroy(hashMapIterator_nextValue(iter));
+	}
+	hashMapIterator_destroy(iter);
+	hashMap_destroy(node->children, true, false);
+	arrayList_destroy(node->values);
+	free(node);
+}
+
+static bool trieNode_isEmpty(struct pubsub_topic_trie_node *node) {
+	return hashMap_size(node->children) == 0 && arrayList_size(node->values) == 0;
+}
+
+/* Removes the value below node, segments is the remainder of the pattern. Returns whether node became empty */
+static bool trieNode_remove(struct pubsub_topic_trie_node *node, char *segments, void *value, bool *removed) {
+	if (segments == NULL) {
+		*removed = arrayList_removeElement(node->values, value);
+	} else {
+		char *next = strchr(segments, PUBSUB_TOPIC_SEPARATOR);
+		if (next != NULL) {
+			*next++ = '\0';
+		}
+		hash_map_entry_pt entry = hashMap_getEntry(node->children, segments);
+		if (entry != NULL) {
+			struct pubsub_topic_trie_node *child = hashMapEntry_getValue(entry);
+			if (trieNode_remove(child, next, value, removed)) {
+				char *key = hashMapEntry_getKey(entry);
+				hashMap_remove(node->children, key);
+				free(key);
+				trieNode_destroy(child);
+			}
+		}
+	}
+	return trieNode_isEmpty(node);
+}
+
+static void trieNode_match(struct pubsub_topic_trie_node *node, char **segments, int nrSegments, int index, pubsub_topic_trie_match_fn fn, void *handle) {
+	struct pubsub_topic_trie_node *child = hashMap_get(node->children, PUBSUB_TOPIC_WILDCARD_REST);
+	if (child != NULL) {
+		trieNode_callValues(child, fn, handle);
+	}
+
+	if (index == nrSegments) {
+		trieNode_callValues(node, fn, handle);
+		return;
+	}
+
+	/* a topic segment which equals a wildcard only matches through the wildcard child, so no value is reported twice */
+	if (strcmp(segments[index], PUBSUB_TOPIC_WILDCARD_REST) != 0) {
+		child = hashMap_get(node->children, segments[index]);
+		if (child != NULL) {
+			trieNode_match(child, segments, nrSegments, index + 1, fn, handle);
+		}
+	}
+	if (strcmp(segments[index], PUBSUB_TOPIC_WILDCARD_ONE) != 0) {
+		child = hashMap_get(node->children, PUBSUB_TOPIC_WILDCARD_ONE);
+		if (child != NULL) {
+			trieNode_match(child, segments, nrSegments, index + 1, fn, handle);
+		}
+	}
+}
+
+static void trieNode_callValues(struct pubsub_topic_trie_node *node, pubsub_topic_trie_match_fn fn, void *handle) {
+	int i;
+	for (i = 0; i < arrayList_size(node->values); i++) {
+		fn(handle, arrayList_get(node->values, i));
+	}
+}
@@ -0,0 +1,112 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_wildcard_subscriptions.c
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_map.h"
+#include "utils.h"
+
+#include "pubsub_wildcard_subscriptions.h"
+
+struct pubsub_wildcard_subscriptions {
+	hash_map_pt tries; //<scope(string),pubsub_topic_trie_pt>
+};
+
+celix_status_t pubsubWildcardSubscriptions_create(pubsub_wildcard_subscriptions_pt *out) {
+	pubsub_wildcard_subscriptions_pt subscriptions = calloc(1, sizeof(*subscriptions));
+	if (subscriptions == NULL) {
+		return CELIX_ENOMEM;
+	}
+	subscriptions->tries = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+	*out = subscriptions;
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubWildcardSubscriptions_destroy(pubsub_wildcard_subscriptions_pt subscriptions) {
+	hash_map_iterator_pt iter = hashMapIterator_create(subscriptions->tries);
+	while (hashMapIterator_hasNext(iter)) {
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+		free(hashMapEntry_getKey(entry));
+		pubsubTopicTrie_destroy((pubsub_topic_trie_pt) hashMapEntry_getValue(entry));
+	}
+	hashMapIterator_destroy(iter);
+	hashMap_destroy(subscriptions->tries, false, false);
+	free(subscriptions);
+	return CELIX_SUCCESS;
+}
+
+celix_status_t pubsubWildcardSubscriptions_add(pubsub_wildcard_subscriptions_pt subscriptions, const char *scope, const char *pattern, void *subscription) {
+	celix_status_t status = CELIX_SUCCESS;
+	pubsub_topic_trie_pt trie = NULL;
+
+	if (!pubsubTopic_isValidPattern(pattern)) {
+		return CELIX_ILLEGAL_ARGUMENT;
+	}
+
+	trie = hashMap_get(subscriptions->tries, scope);
+	if (trie == NULL) {
+		status = pubsubTopicTrie_create(&trie);
+		if (status == CELIX_SUCCESS) {
+			hashMap_put(subscriptions->tries, strdup(scope), trie);
+		}
+	}
+	if (status == CELIX_SUCCESS) {
+		status = pubsubTopicTrie_add(trie, pattern, subscription);
+	}
+
+	return status;
+}
+
+celix_status_t pubsubWildcardSubscriptions_remove(pubsub_wildcard_subscriptions_pt subscriptions, const char *scope, const char *pattern, void *subscription) {
+	celix_status_t status = CELIX_ILLEGAL_ARGUMENT;
+	hash_map_entry_pt entry = hashMap_getEntry(subscriptions->tries, scope);
+
+	if (entry != NULL) {
+		pubsub_topic_trie_pt trie = hashMapEntry_getValue(entry);
+		status = pubsubTopicTrie_remove(trie, pattern, subscription);
+		if (pubsubTopicTrie_isEmpty(trie)) {
+			char *key = hashMapEntry_getKey(entry);
+			hashMap_remove(subscriptions->tries, key);
+			free(key);
+			pubsubTopicTrie_destroy(trie);
+		}
+	}
+
+	return status;
+}
+
+void pubsubWildcardSubscriptions_match(pubsub_wildcard_subscriptions_pt subscriptions, const char *scope, const char *topic, pubsub_topic_trie_match_fn fn, void *handle) {
+	pubsub_topic_trie_pt trie = hashMap_get(subscriptions->tries, scope);
+	if (trie != NULL) {
+		pubsubTopicTrie_match(trie, topic, fn, handle);
+	}
+}
+
+bool pubsubWildcardSubscriptions_matchesKey(const char *scope, const char *pattern, const char *scopeTopicKey) {
+	size_t scopeLen = strlen(scope);
+	return strncmp(scopeTopicKey, scope, scopeLen) == 0 && scopeTopicKey[scopeLen] == ':' && pubsubTopic_matches(pattern, scopeTopicKey + scopeLen + 1);
+}
@@ -0,0 +1,112 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+extern "C" {
+#include "hash_map.h"
+#include "pubsub_msg_type_index.h"
+}
+
+#define NR_MSG_TYPES 40
+
+static pubsub_msg_serializer_t* createMsgSerializer(unsigned int msgId, const char *msgName) {
+    pubsub_msg_serializer_t *msgSer = (pubsub_msg_serializer_t*)calloc(1, sizeof(*msgSer));
+    msgSer->msgId = msgId;
+    msgSer->msgName = msgName;
+    return msgSer;
+}
+
+TEST_GROUP(pubsub_msg_type_index) {
+    pubsub_msg_type_index_pt index;
+    hash_map_pt msgTypes;
+
+    void setup(void) {
+        index = NULL;
+        LONGS_EQUAL(CELIX_SUCCESS, pubsubMsgTypeIndex_create(&index));
+        msgTypes = hashMap_create(NULL, NULL, NULL, NULL);
+    }
+
+    void teardown() {
+        hashMap_destroy(msgTypes, false, true);
+        pubsubMsgTypeIndex_destroy(index);
+    }
+
+    void add(unsigned int msgId, const char *msgName) {
+        hashMap_put(msgTypes, (void*)(uintptr_t)msgId, createMsgSerializer(msgId, msgName));
+    }
+};
+
+TEST(pubsub_msg_type_index, denseIndices) {
+    static char names[NR_MSG_TYPES][16];
+    pubsub_msg_serializer_t **serializers = NULL;
+    unsigned int size = 0;
+
+    //consecutive ids, and ids only differing in their high bits
+    for (int i = 0; i < NR_MSG_TYPES; i++) {
+        snprintf(names[i], sizeof(names[i]), "msg%d", i);
+        add(i % 2 == 0 ? 100 + i : (unsigned int)i << 24, names[i]);
+    }
+
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubMsgTypeIndex_bind(index, msgTypes, &serializers, &size));
+    LONGS_EQUAL(NR_MSG_TYPES, size);
+
+    hash_map_iterator_pt iter = hashMapIterator_create(msgTypes);
+    while (hashMapIterator_hasNext(iter)) {
+        pubsub_msg_serializer_t *msgSer = (pubsub_msg_serializer_t*)hashMapIterator_nextValue(iter);
+        int localIndex = pubsubMsgTypeIndex_get(index, msgSer->msgId);
+        CHECK(localIndex >= 0 && localIndex < NR_MSG_TYPES);
+        POINTERS_EQUAL(msgSer, pubsubMsgTypeIndex_getSerializer(serializers, size, localIndex));
+    }
+    hashMapIterator_destroy(iter);
+
+    LONGS_EQUAL(-1, pubsubMsgTypeIndex_get(index, 99));
+    LONGS_EQUAL(-1, pubsubMsgTypeIndex_get(index, 0));
+    free(serializers);
+}
+
+TEST(pubsub_msg_type_index, reservedAndCollidingIds) {
+    pubsub_msg_serializer_t **serializers = NULL;
+    unsigned int size = 0;
+
+    add(0, "zero");
+    add(1, "one");
+    add(42, "answer");
+
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubMsgTypeIndex_bind(index, msgTypes, &serializers, &size));
+    LONGS_EQUAL(1, size);
+    LONGS_EQUAL(-1, pubsubMsgTypeIndex_get(index, 0));
+    LONGS_EQUAL(-1, pubsubMsgTypeIndex_get(index, 1));
+    LONGS_EQUAL(0, pubsubMsgTypeIndex_get(index, 42));
+    free(serializers);
+
+    //another msg name with the same id is left out, the first one keeps its index
+    hash_map_pt other = hashMap_create(NULL, NULL, NULL, NULL);
+    pubsub_msg_serializer_t *alias = createMsgSerializer(42, "alias");
+    hashMap_put(other, (void*)(uintptr_t)42, alias);
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubMsgTypeIndex_bind(index, other, &serializers, &size));
+    POINTERS_EQUAL(NULL, serializers);
+    LONGS_EQUAL(0, size);
+    LONGS_EQUAL(0, pubsubMsgTypeIndex_get(index, 42));
+    hashMap_destroy(other, false, true);
+}
@@ -0,0 +1,217 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include "pubsub_topic_trie.h"
+#include "pubsub_wildcard_subscriptions.h"
+}
+
+#define NR_PATTERNS 12
+#define MAX_VALUES  16
+
+static const char* patterns[NR_PATTERNS] = {
+    "a", "a.b", "a.*", "a.**", "*.b", "*", "**", "a.*.c", "*.*", "b.**", "a.b.c", "a.*.**"
+};
+
+static const char* topics[] = {
+    "a", "b", "a.b", "a.c", "b.b", "a.b.c", "a.c.c", "a.b.d", "x.y.z", "ab", "a.*", "a.**", "*", "**"
+};
+
+//counts per value how often it is reported by a match
+static void countMatch(void *handle, void *value) {
+    int *counts = (int*)handle;
+    counts[(intptr_t)value]++;
+}
+
+static void match(pubsub_topic_trie_pt trie, const char *topic, int *counts) {
+    memset(counts, 0, MAX_VALUES * sizeof(int));
+    pubsubTopicTrie_match(trie, topic, countMatch, counts);
+}
+
+
+TEST_GROUP(pubsub_topic_trie) {
+    pubsub_topic_trie_pt trie;
+
+    void setup(void) {
+        trie = NULL;
+        LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_create(&trie));
+    }
+
+    void teardown() {
+        pubsubTopicTrie_destroy(trie);
+    }
+};
+
+TEST(pubsub_topic_trie, matchLikePubsubTopicMatches) {
+    int counts[MAX_VALUES];
+
+    for (int i = 0; i < NR_PATTERNS; i++) {
+        LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_add(trie, patterns[i], (void*)(intptr_t)i));
+    }
+
+    //every matching pattern is reported exactly once, also when a topic segment equals a wildcard
+    for (size_t t = 0; t < sizeof(topics) / sizeof(topics[0]); t++) {
+        match(trie, topics[t], counts);
+        for (int i = 0; i < NR_PATTERNS; i++) {
+            int expected = pubsubTopic_matches(patterns[i], topics[t]) ? 1 : 0;
+            if (counts[i] != expected) {
+                printf("pattern %s, topic %s: reported %d times\n", patterns[i], topics[t], counts[i]);
+            }
+            LONGS_EQUAL(expected, counts[i]);
+        }
+    }
+}
+
+TEST(pubsub_topic_trie, restMatchesParent) {
+    int counts[MAX_VALUES];
+
+    CHECK(pubsubTopic_matches("a.**", "a"));
+    CHECK(pubsubTopic_matches("a.**", "a.b.c"));
+    CHECK(!pubsubTopic_matches("a.**", "ab"));
+    CHECK(!pubsubTopic_matches("a.*", "a"));
+
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_add(trie, "a.**", (void*)1));
+    match(trie, "a", counts);
+    LONGS_EQUAL(1, counts[1]);
+    match(trie, "a.b.c", counts);
+    LONGS_EQUAL(1, counts[1]);
+    match(trie, "ab", counts);
+    LONGS_EQUAL(0, counts[1]);
+    match(trie, "b", counts);
+    LONGS_EQUAL(0, counts[1]);
+}
+
+TEST(pubsub_topic_trie, wildcardSegmentNotReportedTwice) {
+    int counts[MAX_VALUES];
+
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_add(trie, "a.*", (void*)1));
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_add(trie, "a.**", (void*)2));
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_add(trie, "*.*", (void*)3));
+
+    match(trie, "a.*", counts);
+    LONGS_EQUAL(1, counts[1]);
+    LONGS_EQUAL(1, counts[2]);
+    LONGS_EQUAL(1, counts[3]);
+
+    match(trie, "a.**", counts);
+    LONGS_EQUAL(1, counts[1]);
+    LONGS_EQUAL(1, counts[2]);
+    LONGS_EQUAL(1, counts[3]);
+
+    match(trie, "*.*", counts);
+    LONGS_EQUAL(0, counts[1]);
+    LONGS_EQUAL(0, counts[2]);
+    LONGS_EQUAL(1, counts[3]);
+}
+
+TEST(pubsub_topic_trie, addRemovePrunes) {
+    int counts[MAX_VALUES];
+
+    CHECK(pubsubTopicTrie_isEmpty(trie));
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_add(trie, "a.b.c", (void*)1));
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_add(trie, "a.b", (void*)2));
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_add(trie, "a.b", (void*)3));
+    CHECK(!pubsubTopicTrie_isEmpty(trie));
+
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_remove(trie, "a.b.c", (void*)1));
+    LONGS_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsubTopicTrie_remove(trie, "a.b.c", (void*)1));
+    LONGS_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsubTopicTrie_remove(trie, "a.x", (void*)2));
+    match(trie, "a.b.c", counts);
+    LONGS_EQUAL(0, counts[1]);
+    match(trie, "a.b", counts);
+    LONGS_EQUAL(1, counts[2]);
+    LONGS_EQUAL(1, counts[3]);
+
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_remove(trie, "a.b", (void*)2));
+    CHECK(!pubsubTopicTrie_isEmpty(trie));
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubTopicTrie_remove(trie, "a.b", (void*)3));
+
+    //the nodes of the removed patterns are removed as well
+    CHECK(pubsubTopicTrie_isEmpty(trie));
+}
+
+TEST(pubsub_topic_trie, validPattern) {
+    CHECK(pubsubTopic_isValidPattern("a"));
+    CHECK(pubsubTopic_isValidPattern("a.*.c"));
+    CHECK(pubsubTopic_isValidPattern("**"));
+    CHECK(pubsubTopic_isValidPattern("a.**"));
+    CHECK(pubsubTopic_isValidPattern("a**.b"));
+    CHECK(!pubsubTopic_isValidPattern("**.a"));
+    CHECK(!pubsubTopic_isValidPattern("a.**.b"));
+
+    CHECK(pubsubTopic_isWildcard("a.*"));
+    CHECK(pubsubTopic_isWildcard("**"));
+    CHECK(!pubsubTopic_isWildcard("a.b"));
+    CHECK(!pubsubTopic_isWildcard("a*.b"));
+
+    LONGS_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsubTopicTrie_add(trie, "a.**.b", (void*)1));
+    CHECK(pubsubTopicTrie_isEmpty(trie));
+}
+
+
+TEST_GROUP(pubsub_wildcard_subscriptions) {
+    pubsub_wildcard_subscriptions_pt subscriptions;
+
+    void setup(void) {
+        subscriptions = NULL;
+        LONGS_EQUAL(CELIX_SUCCESS, pubsubWildcardSubscriptions_create(&subscriptions));
+    }
+
+    void teardown() {
+        pubsubWildcardSubscriptions_destroy(subscriptions);
+    }
+};
+
+TEST(pubsub_wildcard_subscriptions, matchPerScope) {
+    int counts[MAX_VALUES];
+
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubWildcardSubscriptions_add(subscriptions, "s1", "a.*", (void*)1));
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubWildcardSubscriptions_add(subscriptions, "s2", "a.*", (void*)2));
+    LONGS_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsubWildcardSubscriptions_add(subscriptions, "s3", "**.a", (void*)3));
+
+    memset(counts, 0, sizeof(counts));
+    pubsubWildcardSubscriptions_match(subscriptions, "s1", "a.b", countMatch, counts);
+    LONGS_EQUAL(1, counts[1]);
+    LONGS_EQUAL(0, counts[2]);
+
+    LONGS_EQUAL(CELIX_SUCCESS, pubsubWildcardSubscriptions_remove(subscriptions, "s1", "a.*", (void*)1));
+    LONGS_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsubWildcardSubscriptions_remove(subscriptions, "s1", "a.*", (void*)1));
+    LONGS_EQUAL(CELIX_ILLEGAL_ARGUMENT, pubsubWildcardSubscriptions_remove(subscriptions, "s3", "**.a", (void*)3));
+
+    memset(counts, 0, sizeof(counts));
+    pubsubWildcardSubscriptions_match(subscriptions, "s1", "a.b", countMatch, counts);
+    pubsubWildcardSubscriptions_match(subscriptions, "s2", "a.b", countMatch, counts);
+    LONGS_EQUAL(0, counts[1]);
+    LONGS_EQUAL(1, counts[2]);
+}
+
+TEST(pubsub_wildcard_subscriptions, matchesKey) {
+    CHECK(pubsubWildcardSubscriptions_matchesKey("s1", "a.*", "s1:a.b"));
+    CHECK(pubsubWildcardSubscriptions_matchesKey("s1", "a.**", "s1:a"));
+    CHECK(!pubsubWildcardSubscriptions_matchesKey("s1", "a.*", "s2:a.b"));
+    CHECK(!pubsubWildcardSubscriptions_matchesKey("s1", "a.*", "s10:a.b"));
+    CHECK(!pubsubWildcardSubscriptions_matchesKey("s1", "a.*", "s1:b.b"));
+}
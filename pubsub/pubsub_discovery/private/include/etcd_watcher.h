@@ -27,6 +27,10 @@
 #include "pubsub_endpoint.h"
 
 typedef struct etcd_watcher *etcd_watcher_pt;
+typedef struct etcd_watcher_loop *etcd_watcher_loop_pt;
+
+celix_status_t etcdWatcher_createLoop(etcd_watcher_loop_pt *watchLoop);
+celix_status_t etcdWatcher_destroyLoop(etcd_watcher_loop_pt watchLoop);
 
 celix_status_t etcdWatcher_create(pubsub_discovery_pt discovery,  bundle_context_pt context, const char *scope, const char* topic, etcd_watcher_pt *watcher);
 celix_status_t etcdWatcher_destroy(etcd_watcher_pt watcher);
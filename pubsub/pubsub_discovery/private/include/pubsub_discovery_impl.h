@@ -47,6 +47,7 @@ struct pubsub_discovery {
 	hash_map_pt watchers; //key = topicname, value = struct watcher_info
 
 	etcd_writer_pt writer;
+	etcd_watcher_loop_pt watchLoop; //runs the etcd watches of all watchers
 };
 
 
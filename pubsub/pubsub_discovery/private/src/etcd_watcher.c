@@ -30,6 +30,7 @@
 
 #include "pubsub_discovery.h"
 #include "pubsub_discovery_impl.h"
+#include "pubsub_topic_trie.h"
 
 
 
@@ -50,16 +51,30 @@
 #define CFG_ETCD_TTL                    "DISCOVERY_ETCD_TTL"
 #define DEFAULT_ETCD_TTL                30
 
+#define WATCH_LOOP_TIMEOUT_MS           1000
+
+
+/* all watchers of a discovery share one etcd watch loop, run by a single thread */
+struct etcd_watcher_loop {
+	etcd_watch_loop_t *loop;
+
+	celix_thread_mutex_t lock; //protects pending and the arming, stopped and watchId fields of the watchers
+	celix_thread_cond_t armed;
+	array_list_pt pending; //watchers of which the already existing publishers are not read yet
+
+	celix_thread_t thread;
+	volatile bool running;
+};
 
 struct etcd_watcher {
 	pubsub_discovery_pt pubsub_discovery;
 
-	celix_thread_mutex_t watcherLock;
-	celix_thread_t watcherThread;
-
 	char *scope;
 	char *topic;
-	volatile bool running;
+
+	bool arming; //the loop thread reads the already existing publishers
+	bool stopped;
+	long watchId; //0 while not added to the etcd watch loop
 };
 
 struct etcd_writer {
@@ -77,7 +92,12 @@ static celix_status_t etcdWatcher_getTopicRootPath(bundle_context_pt context, co
 	const char* rootPath = NULL;
 
 	if (((bundleContext_getProperty(context, CFG_ETCD_ROOT_PATH, &rootPath)) != CELIX_SUCCESS) || (!rootPath)) {
-		snprintf(rootNode, rootNodeLen, "%s/%s/%s", DEFAULT_ETCD_ROOTPATH, scope, topic);
+		rootPath = DEFAULT_ETCD_ROOTPATH;
+	}
+
+	if (pubsubTopic_isWildcard(topic)) {
+		// the publishers of the matching topics can be anywhere in the scope
+		snprintf(rootNode, rootNodeLen, "%s/%s", rootPath, scope);
 	} else {
 		snprintf(rootNode, rootNodeLen, "%s/%s/%s", rootPath, scope, topic);
 	}
@@ -99,18 +119,29 @@ static celix_status_t etcdWatcher_getRootPath(bundle_context_pt context, char* r
 }
 
 
+// a watcher of a wildcard topic watches the whole scope, so only returns the endpoints of matching topics
+static celix_status_t etcdWatcher_getMatchingEndpointFromKey(etcd_watcher_pt watcher, const char* etcdKey, const char* etcdValue, pubsub_endpoint_pt* pubEP) {
+	celix_status_t status = etcdWatcher_getPublisherEndpointFromKey(watcher->pubsub_discovery, etcdKey, etcdValue, pubEP);
+	if (status == CELIX_SUCCESS && pubsubTopic_isWildcard(watcher->topic) && !pubsubTopic_matches(watcher->topic, (*pubEP)->topic)) {
+		pubsubEndpoint_destroy(*pubEP);
+		*pubEP = NULL;
+		status = CELIX_ILLEGAL_STATE;
+	}
+	return status;
+}
+
 static void add_node(const char *key, const char *value, void* arg) {
-	pubsub_discovery_pt ps_discovery = (pubsub_discovery_pt) arg;
+	etcd_watcher_pt watcher = (etcd_watcher_pt) arg;
 	pubsub_endpoint_pt pubEP = NULL;
-	celix_status_t status = etcdWatcher_getPublisherEndpointFromKey(ps_discovery, key, value, &pubEP);
+	celix_status_t status = etcdWatcher_getMatchingEndpointFromKey(watcher, key, value, &pubEP);
 	if(!status && pubEP) {
-		pubsub_discovery_addNode(ps_discovery, pubEP);
+		pubsub_discovery_addNode(watcher->pubsub_discovery, pubEP);
 	}
 }
 
-static celix_status_t etcdWatcher_addAlreadyExistingPublishers(pubsub_discovery_pt ps_discovery, const char *rootPath, long long * highestModified) {
+static celix_status_t etcdWatcher_addAlreadyExistingPublishers(etcd_watcher_pt watcher, const char *rootPath, long long * highestModified) {
 	celix_status_t status = CELIX_SUCCESS;
-	if(etcd_get_directory(rootPath, add_node, ps_discovery, highestModified)) {
+	if(etcd_get_directory(rootPath, add_node, watcher, highestModified)) {
 		status = CELIX_ILLEGAL_ARGUMENT;
 	}
 	return status;
@@ -150,86 +181,133 @@ celix_status_t etcdWatcher_getPublisherEndpointFromKey(pubsub_discovery_pt pubsu
 }
 
 /*
- * performs (blocking) etcd_watch calls to check for
- * changing discovery endpoint information within etcd.
+ * called by the etcd watch loop for every change of
+ * discovery endpoint information within the root path of the watcher.
  */
-static void* etcdWatcher_run(void* data) {
-	etcd_watcher_pt watcher = (etcd_watcher_pt) data;
-	time_t timeBeforeWatch = time(NULL);
-	char rootPath[MAX_ROOTNODE_LENGTH];
-	long long highestModified = 0;
-
+static void etcdWatcher_onChange(const char *action, const char *prevValue, const char *value, const char *rkey, long long modifiedIndex, void *arg) {
+	etcd_watcher_pt watcher = (etcd_watcher_pt) arg;
 	pubsub_discovery_pt ps_discovery = watcher->pubsub_discovery;
-	bundle_context_pt context = ps_discovery->context;
-
-	memset(rootPath, 0, MAX_ROOTNODE_LENGTH);
-
-	//TODO: add topic to etcd key
-	etcdWatcher_getTopicRootPath(context, watcher->scope, watcher->topic, rootPath, MAX_ROOTNODE_LENGTH);
-	etcdWatcher_addAlreadyExistingPublishers(ps_discovery, rootPath, &highestModified);
-
-	while ((celixThreadMutex_lock(&watcher->watcherLock) == CELIX_SUCCESS) && watcher->running) {
-
-		char *rkey = NULL;
-		char *value = NULL;
-		char *preValue = NULL;
-		char *action = NULL;
-		long long modIndex;
-
-		celixThreadMutex_unlock(&watcher->watcherLock);
-
-		if (etcd_watch(rootPath, highestModified + 1, &action, &preValue, &value, &rkey, &modIndex) == 0 && action != NULL) {
-			pubsub_endpoint_pt pubEP = NULL;
-			if ((strcmp(action, "set") == 0) || (strcmp(action, "create") == 0)) {
-				if (etcdWatcher_getPublisherEndpointFromKey(ps_discovery, rkey, value, &pubEP) == CELIX_SUCCESS) {
-					pubsub_discovery_addNode(ps_discovery, pubEP);
-				}
-			} else if (strcmp(action, "delete") == 0) {
-				if (etcdWatcher_getPublisherEndpointFromKey(ps_discovery, rkey, preValue, &pubEP) == CELIX_SUCCESS) {
-					pubsub_discovery_removeNode(ps_discovery, pubEP);
-				}
-			} else if (strcmp(action, "expire") == 0) {
-				if (etcdWatcher_getPublisherEndpointFromKey(ps_discovery, rkey, preValue, &pubEP) == CELIX_SUCCESS) {
-					pubsub_discovery_removeNode(ps_discovery, pubEP);
-				}
-			} else if (strcmp(action, "update") == 0) {
-				if (etcdWatcher_getPublisherEndpointFromKey(ps_discovery, rkey, value, &pubEP) == CELIX_SUCCESS) {
-					pubsub_discovery_addNode(ps_discovery, pubEP);
-				}
-			} else {
-				fw_log(logger, OSGI_FRAMEWORK_LOG_INFO, "Unexpected action: %s", action);
-			}
-			highestModified = modIndex;
-		} else if (time(NULL) - timeBeforeWatch <= (DEFAULT_ETCD_TTL / 4)) {
-			sleep(DEFAULT_ETCD_TTL / 4);
-		}
+	pubsub_endpoint_pt pubEP = NULL;
 
-		FREE_MEM(action);
-		FREE_MEM(value);
-		FREE_MEM(preValue);
-		FREE_MEM(rkey);
+	if (action == NULL) {
+		// changes were missed, the watch continues from the current index, so read the publishers again
+		char rootPath[MAX_ROOTNODE_LENGTH];
+		long long highestModified = 0;
+		etcdWatcher_getTopicRootPath(ps_discovery->context, watcher->scope, watcher->topic, rootPath, MAX_ROOTNODE_LENGTH);
+		etcdWatcher_addAlreadyExistingPublishers(watcher, rootPath, &highestModified);
+	} else if ((strcmp(action, "set") == 0) || (strcmp(action, "create") == 0)) {
+		if (etcdWatcher_getMatchingEndpointFromKey(watcher, rkey, value, &pubEP) == CELIX_SUCCESS) {
+			pubsub_discovery_addNode(ps_discovery, pubEP);
+		}
+	} else if (strcmp(action, "delete") == 0) {
+		if (etcdWatcher_getMatchingEndpointFromKey(watcher, rkey, prevValue, &pubEP) == CELIX_SUCCESS) {
+			pubsub_discovery_removeNode(ps_discovery, pubEP);
+		}
+	} else if (strcmp(action, "expire") == 0) {
+		if (etcdWatcher_getMatchingEndpointFromKey(watcher, rkey, prevValue, &pubEP) == CELIX_SUCCESS) {
+			pubsub_discovery_removeNode(ps_discovery, pubEP);
+		}
+	} else if (strcmp(action, "update") == 0) {
+		if (etcdWatcher_getMatchingEndpointFromKey(watcher, rkey, value, &pubEP) == CELIX_SUCCESS) {
+			pubsub_discovery_addNode(ps_discovery, pubEP);
+		}
+	} else {
+		fw_log(logger, OSGI_FRAMEWORK_LOG_INFO, "Unexpected action: %s", action);
+	}
+}
 
-		/* prevent busy waiting, in case etcd_watch returns false */
+/*
+ * reads the already existing publishers of the new watchers and adds their watch to the etcd watch loop,
+ * starting just after the read index so no change is missed. Called from the loop thread.
+ */
+static void etcdWatcher_armPending(etcd_watcher_loop_pt watchLoop) {
+	celixThreadMutex_lock(&watchLoop->lock);
+	while (arrayList_size(watchLoop->pending) > 0) {
+		etcd_watcher_pt watcher = arrayList_remove(watchLoop->pending, 0);
+		char rootPath[MAX_ROOTNODE_LENGTH];
+		long long highestModified = 0;
+
+		watcher->arming = true;
+		celixThreadMutex_unlock(&watchLoop->lock);
+
+		// no lock held while informing the listeners of the already existing publishers
+		memset(rootPath, 0, MAX_ROOTNODE_LENGTH);
+		etcdWatcher_getTopicRootPath(watcher->pubsub_discovery->context, watcher->scope, watcher->topic, rootPath, MAX_ROOTNODE_LENGTH);
+		etcdWatcher_addAlreadyExistingPublishers(watcher, rootPath, &highestModified);
+
+		celixThreadMutex_lock(&watchLoop->lock);
+		watcher->arming = false;
+		if (!watcher->stopped) {
+			etcd_watch_loop_add(watchLoop->loop, rootPath, highestModified + 1, etcdWatcher_onChange, watcher, &watcher->watchId);
+		}
+		celixThreadCondition_broadcast(&watchLoop->armed);
+	}
+	celixThreadMutex_unlock(&watchLoop->lock);
+}
 
+static void* etcdWatcher_runLoop(void* data) {
+	etcd_watcher_loop_pt watchLoop = (etcd_watcher_loop_pt) data;
 
-		if (time(NULL) - timeBeforeWatch > (DEFAULT_ETCD_TTL / 4)) {
-			timeBeforeWatch = time(NULL);
+	while (watchLoop->running) {
+		etcdWatcher_armPending(watchLoop);
+		if (etcd_watch_loop_run(watchLoop->loop, WATCH_LOOP_TIMEOUT_MS) != 0) {
+			/* prevent busy waiting */
+			sleep(1);
 		}
+	}
+
+	return NULL;
+}
 
+celix_status_t etcdWatcher_createLoop(etcd_watcher_loop_pt *out) {
+	etcd_watcher_loop_pt watchLoop = calloc(1, sizeof(*watchLoop));
+
+	if (watchLoop == NULL) {
+		return CELIX_ENOMEM;
+	}
+	if (etcd_watch_loop_create(&watchLoop->loop) != 0) {
+		free(watchLoop);
+		return CELIX_BUNDLE_EXCEPTION;
 	}
 
-	if (watcher->running == false) {
-		celixThreadMutex_unlock(&watcher->watcherLock);
+	celixThreadMutex_create(&watchLoop->lock, NULL);
+	celixThreadCondition_init(&watchLoop->armed, NULL);
+	arrayList_create(&watchLoop->pending);
+
+	watchLoop->running = true;
+	celix_status_t status = celixThread_create(&watchLoop->thread, NULL, etcdWatcher_runLoop, watchLoop);
+	if (status != CELIX_SUCCESS) {
+		arrayList_destroy(watchLoop->pending);
+		celixThreadCondition_destroy(&watchLoop->armed);
+		celixThreadMutex_destroy(&watchLoop->lock);
+		etcd_watch_loop_destroy(watchLoop->loop);
+		free(watchLoop);
+		return status;
 	}
 
-	return NULL;
+	*out = watchLoop;
+	return status;
+}
+
+// all watchers must be stopped before
+celix_status_t etcdWatcher_destroyLoop(etcd_watcher_loop_pt watchLoop) {
+	watchLoop->running = false;
+	celixThread_join(watchLoop->thread, NULL);
+
+	etcd_watch_loop_destroy(watchLoop->loop);
+	arrayList_destroy(watchLoop->pending);
+	celixThreadCondition_destroy(&watchLoop->armed);
+	celixThreadMutex_destroy(&watchLoop->lock);
+	free(watchLoop);
+
+	return CELIX_SUCCESS;
 }
 
 celix_status_t etcdWatcher_create(pubsub_discovery_pt pubsub_discovery, bundle_context_pt context, const char *scope, const char *topic, etcd_watcher_pt *watcher) {
 	celix_status_t status = CELIX_SUCCESS;
 
 
-	if (pubsub_discovery == NULL) {
+	if (pubsub_discovery == NULL || pubsub_discovery->watchLoop == NULL) {
 		return CELIX_BUNDLE_EXCEPTION;
 	}
 
@@ -243,18 +321,11 @@ celix_status_t etcdWatcher_create(pubsub_discovery_pt pubsub_discovery, bundle_c
 	(*watcher)->scope = strdup(scope);
 	(*watcher)->topic = strdup(topic);
 
-
-	celixThreadMutex_create(&(*watcher)->watcherLock, NULL);
-
-	celixThreadMutex_lock(&(*watcher)->watcherLock);
-
-	status = celixThread_create(&(*watcher)->watcherThread, NULL, etcdWatcher_run, *watcher);
-	if (status == CELIX_SUCCESS) {
-		(*watcher)->running = true;
-	}
-
-	celixThreadMutex_unlock(&(*watcher)->watcherLock);
-
+	// the loop thread reads the already existing publishers and starts the watch
+	etcd_watcher_loop_pt watchLoop = pubsub_discovery->watchLoop;
+	celixThreadMutex_lock(&watchLoop->lock);
+	arrayList_add(watchLoop->pending, *watcher);
+	celixThreadMutex_unlock(&watchLoop->lock);
 
 	return status;
 }
@@ -263,10 +334,6 @@ celix_status_t etcdWatcher_destroy(etcd_watcher_pt watcher) {
 
 	celix_status_t status = CELIX_SUCCESS;
 
-	char rootPath[MAX_ROOTNODE_LENGTH];
-	etcdWatcher_getTopicRootPath(watcher->pubsub_discovery->context, watcher->scope, watcher->topic, rootPath, MAX_ROOTNODE_LENGTH);
-	celixThreadMutex_destroy(&(watcher->watcherLock));
-
 	free(watcher->scope);
 	free(watcher->topic);
 	free(watcher);
@@ -274,14 +341,22 @@ celix_status_t etcdWatcher_destroy(etcd_watcher_pt watcher) {
 	return status;
 }
 
+// after stop no callback of the watcher is in progress anymore, so it can be destroyed
 celix_status_t etcdWatcher_stop(etcd_watcher_pt watcher){
 	celix_status_t status = CELIX_SUCCESS;
+	etcd_watcher_loop_pt watchLoop = watcher->pubsub_discovery->watchLoop;
 
-	celixThreadMutex_lock(&(watcher->watcherLock));
-	watcher->running = false;
-	celixThreadMutex_unlock(&(watcher->watcherLock));
-
-	celixThread_join(watcher->watcherThread, NULL);
+	celixThreadMutex_lock(&watchLoop->lock);
+	watcher->stopped = true;
+	arrayList_removeElement(watchLoop->pending, watcher);
+	while (watcher->arming) {
+		celixThreadCondition_wait(&watchLoop->armed, &watchLoop->lock);
+	}
+	if (watcher->watchId != 0) {
+		etcd_watch_loop_remove(watchLoop->loop, watcher->watchId);
+		watcher->watchId = 0;
+	}
+	celixThreadMutex_unlock(&watchLoop->lock);
 
 	return status;
 
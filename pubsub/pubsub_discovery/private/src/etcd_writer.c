@@ -21,9 +21,14 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
 
 #include "celix_log.h"
 #include "constants.h"
+#include "hash_map.h"
+#include "utils.h"
 
 #include "etcd.h"
 #include "etcd_writer.h"
@@ -46,25 +51,66 @@
 #define CFG_ETCD_TTL   "DISCOVERY_ETCD_TTL"
 #define DEFAULT_ETCD_TTL 30
 
+// only refresh the TTL of the announced endpoints instead of rewriting them, needs etcd 2.3 or newer
+#define CFG_ETCD_TTL_REFRESH		"PUBSUB_DISCOVERY_ETCD_TTL_REFRESH"
+
+// announce/remove calls are written once no new call arrived for this many ms, but at most after CFG_ETCD_MAX_WRITE_DELAY ms
+#define CFG_ETCD_DEBOUNCE			"PUBSUB_DISCOVERY_ETCD_DEBOUNCE_MS"
+#define DEFAULT_ETCD_DEBOUNCE		100
+#define CFG_ETCD_MAX_WRITE_DELAY	"PUBSUB_DISCOVERY_ETCD_MAX_WRITE_DELAY_MS"
+#define DEFAULT_ETCD_MAX_WRITE_DELAY	1000
+
 struct etcd_writer {
 	pubsub_discovery_pt pubsub_discovery;
-	celix_thread_mutex_t localPubsLock;
+	celix_thread_mutex_t localPubsLock; // also guards the fields below
 	array_list_pt localPubs;
-	volatile bool running;
+	bool running;
 	celix_thread_t writerThread;
+	celix_thread_cond_t writerCond;
+
+	hash_map_pt pendingWrites; //<key(string),endpoint url(string) or NULL to delete the key>
+	struct timespec firstPendingWrite;
+	struct timespec lastPendingWrite;
+
+	const char *rootPath;
+	int ttl;
+	bool ttlRefresh;
+	unsigned int debounce; // ms
+	unsigned int maxWriteDelay; // ms
 };
 
 
 static const char* etcdWriter_getRootPath(bundle_context_pt context);
+static int etcdWriter_getIntProperty(bundle_context_pt context, const char *name, int defaultValue);
+static char* etcdWriter_createKey(etcd_writer_pt writer, pubsub_endpoint_pt pubEP);
+static void etcdWriter_addPendingWrite(etcd_writer_pt writer, char *key, const char *value);
+static void etcdWriter_writePending(etcd_writer_pt writer, hash_map_pt pendingWrites);
+static void etcdWriter_refresh(etcd_writer_pt writer, array_list_pt keys, array_list_pt values);
 static void* etcdWriter_run(void* data);
 
+static void timespec_addMs(struct timespec *ts, unsigned int ms);
+static bool timespec_before(const struct timespec *a, const struct timespec *b);
+
 
 etcd_writer_pt etcdWriter_create(pubsub_discovery_pt disc) {
 	etcd_writer_pt writer = calloc(1, sizeof(*writer));
 	if(writer) {
+		bundle_context_pt context = disc->context;
+		const char *refresh = NULL;
+
 		celixThreadMutex_create(&writer->localPubsLock, NULL);
+		celixThreadCondition_init(&writer->writerCond, NULL);
 		arrayList_create(&writer->localPubs);
+		writer->pendingWrites = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 		writer->pubsub_discovery = disc;
+
+		writer->rootPath = etcdWriter_getRootPath(context);
+		writer->ttl = etcdWriter_getIntProperty(context, CFG_ETCD_TTL, DEFAULT_ETCD_TTL);
+		writer->debounce = etcdWriter_getIntProperty(context, CFG_ETCD_DEBOUNCE, DEFAULT_ETCD_DEBOUNCE);
+		writer->maxWriteDelay = etcdWriter_getIntProperty(context, CFG_ETCD_MAX_WRITE_DELAY, DEFAULT_ETCD_MAX_WRITE_DELAY);
+		bundleContext_getProperty(context, CFG_ETCD_TTL_REFRESH, &refresh);
+		writer->ttlRefresh = (refresh != NULL && strcmp(refresh, "true") == 0);
+
 		writer->running = true;
 		celixThread_create(&writer->writerThread, NULL, etcdWriter_run, writer);
 	}
@@ -72,78 +118,62 @@ etcd_writer_pt etcdWriter_create(pubsub_discovery_pt disc) {
 }
 
 void etcdWriter_destroy(etcd_writer_pt writer) {
-	char dir[MAX_ROOTNODE_LENGTH];
-	const char *rootPath = etcdWriter_getRootPath(writer->pubsub_discovery->context);
-
+	celixThreadMutex_lock(&writer->localPubsLock);
 	writer->running = false;
+	celixThreadCondition_signal(&writer->writerCond);
+	celixThreadMutex_unlock(&writer->localPubsLock);
+
 	celixThread_join(writer->writerThread, NULL);
 
 	celixThreadMutex_lock(&writer->localPubsLock);
+	/* Nothing pending is written anymore, remove those keys as well as the ones of the local publishers */
+	hash_map_iterator_pt iter = hashMapIterator_create(writer->pendingWrites);
+	while(hashMapIterator_hasNext(iter)) {
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+		etcd_del((char*)hashMapEntry_getKey(entry));
+	}
+	hashMapIterator_destroy(iter);
+	hashMap_destroy(writer->pendingWrites, true, true);
+
 	for(int i = 0; i < arrayList_size(writer->localPubs); i++) {
 		pubsub_endpoint_pt pubEP = (pubsub_endpoint_pt)arrayList_get(writer->localPubs,i);
-		memset(dir,0,MAX_ROOTNODE_LENGTH);
-		snprintf(dir,MAX_ROOTNODE_LENGTH,"%s/%s/%s/%s",rootPath,pubEP->scope,pubEP->topic,pubEP->frameworkUUID);
-		etcd_del(dir);
+		char *key = etcdWriter_createKey(writer, pubEP);
+		etcd_del(key);
+		free(key);
 		pubsubEndpoint_destroy(pubEP);
 	}
 	arrayList_destroy(writer->localPubs);
 
 	celixThreadMutex_unlock(&writer->localPubsLock);
+	celixThreadCondition_destroy(&writer->writerCond);
 	celixThreadMutex_destroy(&(writer->localPubsLock));
 
 	free(writer);
 }
 
+/* The endpoint is written to etcd asynchronously by the writer thread, bursts of calls are combined */
 celix_status_t etcdWriter_addPublisherEndpoint(etcd_writer_pt writer, pubsub_endpoint_pt pubEP, bool storeEP){
-	celix_status_t status = CELIX_BUNDLE_EXCEPTION;
+	celix_status_t status = CELIX_SUCCESS;
 
+	celixThreadMutex_lock(&writer->localPubsLock);
 	if(storeEP){
 		const char *fwUUID = NULL;
 		bundleContext_getProperty(writer->pubsub_discovery->context, OSGI_FRAMEWORK_FRAMEWORK_UUID, &fwUUID);
 		if(fwUUID && strcmp(pubEP->frameworkUUID, fwUUID) == 0) {
-			celixThreadMutex_lock(&writer->localPubsLock);
 			pubsub_endpoint_pt p = NULL;
 			pubsubEndpoint_clone(pubEP, &p);
 			arrayList_add(writer->localPubs,p);
-			celixThreadMutex_unlock(&writer->localPubsLock);
 		}
 	}
 
-	char *key;
-
-	const char* ttlStr = NULL;
-	int ttl = 0;
-
-	// determine ttl
-	if ((bundleContext_getProperty(writer->pubsub_discovery->context, CFG_ETCD_TTL, &ttlStr) != CELIX_SUCCESS) || !ttlStr) {
-		ttl = DEFAULT_ETCD_TTL;
-	} else {
-		char* endptr = NULL;
-		errno = 0;
-		ttl = strtol(ttlStr, &endptr, 10);
-		if (*endptr || errno != 0) {
-			ttl = DEFAULT_ETCD_TTL;
-		}
-	}
-
-	const char *rootPath = etcdWriter_getRootPath(writer->pubsub_discovery->context);
-
-	asprintf(&key,"%s/%s/%s/%s/%ld",rootPath,pubEP->scope,pubEP->topic,pubEP->frameworkUUID,pubEP->serviceID);
+	etcdWriter_addPendingWrite(writer, etcdWriter_createKey(writer, pubEP), pubEP->endpoint);
+	celixThreadMutex_unlock(&writer->localPubsLock);
 
-	if(!etcd_set(key,pubEP->endpoint,ttl,false)){
-		status = CELIX_ILLEGAL_ARGUMENT;
-	}
-	FREE_MEM(key);
 	return status;
 }
 
 celix_status_t etcdWriter_deletePublisherEndpoint(etcd_writer_pt writer, pubsub_endpoint_pt pubEP) {
 	celix_status_t status = CELIX_SUCCESS;
-	char *key = NULL;
-
-	const char *rootPath = etcdWriter_getRootPath(writer->pubsub_discovery->context);
-
-	asprintf(&key, "%s/%s/%s/%s/%ld", rootPath, pubEP->scope, pubEP->topic, pubEP->frameworkUUID, pubEP->serviceID);
 
 	celixThreadMutex_lock(&writer->localPubsLock);
 	for (unsigned int i = 0; i < arrayList_size(writer->localPubs); i++) {
@@ -154,30 +184,134 @@ celix_status_t etcdWriter_deletePublisherEndpoint(etcd_writer_pt writer, pubsub_
 			break;
 		}
 	}
+
+	etcdWriter_addPendingWrite(writer, etcdWriter_createKey(writer, pubEP), NULL);
 	celixThreadMutex_unlock(&writer->localPubsLock);
 
-	if (etcd_del(key)) {
-		printf("Failed to remove key %s from ETCD\n",key);
-		status = CELIX_ILLEGAL_ARGUMENT;
-	}
-	FREE_MEM(key);
 	return status;
 }
 
+/* Replaces an earlier pending write of the same key. Takes over key. Must be called with localPubsLock taken. */
+static void etcdWriter_addPendingWrite(etcd_writer_pt writer, char *key, const char *value) {
+	hash_map_entry_pt entry = hashMap_getEntry(writer->pendingWrites, key);
+	if(entry != NULL) {
+		char *oldKey = (char*)hashMapEntry_getKey(entry);
+		char *oldValue = hashMap_remove(writer->pendingWrites, key);
+		free(oldKey);
+		free(oldValue);
+	}
+
+	clock_gettime(CLOCK_REALTIME, &writer->lastPendingWrite);
+	if(hashMap_size(writer->pendingWrites) == 0) {
+		writer->firstPendingWrite = writer->lastPendingWrite;
+	}
+	hashMap_put(writer->pendingWrites, key, value != NULL ? strdup(value) : NULL);
+
+	celixThreadCondition_signal(&writer->writerCond);
+}
+
+static void etcdWriter_writePending(etcd_writer_pt writer, hash_map_pt pendingWrites) {
+	hash_map_iterator_pt iter = hashMapIterator_create(pendingWrites);
+	while(hashMapIterator_hasNext(iter)) {
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+		char *key = (char*)hashMapEntry_getKey(entry);
+		char *value = (char*)hashMapEntry_getValue(entry);
+
+		if(value != NULL) {
+			if(etcd_set(key, value, writer->ttl, false)) {
+				printf("PSD: Failed to write key %s to ETCD\n", key);
+			}
+		}
+		else if(etcd_del(key)) {
+			printf("Failed to remove key %s from ETCD\n", key);
+		}
+	}
+	hashMapIterator_destroy(iter);
+	hashMap_destroy(pendingWrites, true, true);
+}
+
+/* Keeps the keys of the local publishers alive, the value is only rewritten when a refresh is not possible */
+static void etcdWriter_refresh(etcd_writer_pt writer, array_list_pt keys, array_list_pt values) {
+	for(int i = 0; i < arrayList_size(keys); i++) {
+		char *key = arrayList_get(keys, i);
+		char *value = arrayList_get(values, i);
+
+		if(!writer->ttlRefresh || etcd_refresh(key, writer->ttl)) {
+			/* Also recreates keys that expired, e.g. while etcd was not reachable */
+			if(etcd_set(key, value, writer->ttl, false)) {
+				printf("PSD: Failed to write key %s to ETCD\n", key);
+			}
+		}
+		free(key);
+		free(value);
+	}
+}
+
 static void* etcdWriter_run(void* data) {
 	etcd_writer_pt writer = (etcd_writer_pt)data;
+	struct timespec nextRefresh;
+
+	clock_gettime(CLOCK_REALTIME, &nextRefresh);
+	timespec_addMs(&nextRefresh, writer->ttl * 1000 / 2);
+
+	celixThreadMutex_lock(&writer->localPubsLock);
 	while(writer->running) {
-		celixThreadMutex_lock(&writer->localPubsLock);
-		for(int i=0; i < arrayList_size(writer->localPubs); i++) {
-			etcdWriter_addPublisherEndpoint(writer,(pubsub_endpoint_pt)arrayList_get(writer->localPubs,i),false);
+		struct timespec now;
+		struct timespec deadline = nextRefresh;
+		clock_gettime(CLOCK_REALTIME, &now);
+
+		if(hashMap_size(writer->pendingWrites) > 0) {
+			struct timespec debounced = writer->lastPendingWrite;
+			struct timespec latest = writer->firstPendingWrite;
+			timespec_addMs(&debounced, writer->debounce);
+			timespec_addMs(&latest, writer->maxWriteDelay);
+
+			if(!timespec_before(&now, &debounced) || !timespec_before(&now, &latest)) {
+				hash_map_pt pendingWrites = writer->pendingWrites;
+				writer->pendingWrites = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+				celixThreadMutex_unlock(&writer->localPubsLock);
+				etcdWriter_writePending(writer, pendingWrites);
+				celixThreadMutex_lock(&writer->localPubsLock);
+				continue;
+			}
+
+			deadline = timespec_before(&debounced, &latest) ? debounced : latest;
+		}
+		else if(!timespec_before(&now, &nextRefresh)) {
+			array_list_pt keys = NULL;
+			array_list_pt values = NULL;
+			arrayList_create(&keys);
+			arrayList_create(&values);
+			for(int i = 0; i < arrayList_size(writer->localPubs); i++) {
+				pubsub_endpoint_pt pubEP = (pubsub_endpoint_pt)arrayList_get(writer->localPubs, i);
+				arrayList_add(keys, etcdWriter_createKey(writer, pubEP));
+				arrayList_add(values, strdup(pubEP->endpoint));
+			}
+			celixThreadMutex_unlock(&writer->localPubsLock);
+
+			etcdWriter_refresh(writer, keys, values);
+			arrayList_destroy(keys);
+			arrayList_destroy(values);
+
+			clock_gettime(CLOCK_REALTIME, &nextRefresh);
+			timespec_addMs(&nextRefresh, writer->ttl * 1000 / 2);
+			celixThreadMutex_lock(&writer->localPubsLock);
+			continue;
 		}
-		celixThreadMutex_unlock(&writer->localPubsLock);
-		sleep(DEFAULT_ETCD_TTL / 2);
+
+		pthread_cond_timedwait(&writer->writerCond, &writer->localPubsLock, &deadline);
 	}
+	celixThreadMutex_unlock(&writer->localPubsLock);
 
 	return NULL;
 }
 
+static char* etcdWriter_createKey(etcd_writer_pt writer, pubsub_endpoint_pt pubEP) {
+	char *key = NULL;
+	asprintf(&key, "%s/%s/%s/%s/%ld", writer->rootPath, pubEP->scope, pubEP->topic, pubEP->frameworkUUID, pubEP->serviceID);
+	return key;
+}
+
 static const char* etcdWriter_getRootPath(bundle_context_pt context) {
 	const char* rootPath = NULL;
 	bundleContext_getProperty(context, CFG_ETCD_ROOT_PATH, &rootPath);
@@ -187,3 +321,30 @@ static const char* etcdWriter_getRootPath(bundle_context_pt context) {
 	return rootPath;
 }
 
+static int etcdWriter_getIntProperty(bundle_context_pt context, const char *name, int defaultValue) {
+	const char* str = NULL;
+	int value = defaultValue;
+
+	if ((bundleContext_getProperty(context, name, &str) == CELIX_SUCCESS) && str) {
+		char* endptr = NULL;
+		errno = 0;
+		value = strtol(str, &endptr, 10);
+		if (*endptr || errno != 0 || value < 0) {
+			value = defaultValue;
+		}
+	}
+	return value;
+}
+
+static void timespec_addMs(struct timespec *ts, unsigned int ms) {
+	ts->tv_sec += ms / 1000;
+	ts->tv_nsec += (ms % 1000) * 1000000L;
+	if(ts->tv_nsec >= 1000000000L) {
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000L;
+	}
+}
+
+static bool timespec_before(const struct timespec *a, const struct timespec *b) {
+	return (a->tv_sec < b->tv_sec) || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
@@ -36,6 +36,7 @@
 #include "service_registration.h"
 
 #include "publisher_endpoint_announce.h"
+#include "etcd.h"
 #include "etcd_common.h"
 #include "etcd_watcher.h"
 #include "etcd_writer.h"
@@ -107,6 +108,9 @@ celix_status_t pubsub_discovery_destroy(pubsub_discovery_pt ps_discovery) {
 celix_status_t pubsub_discovery_start(pubsub_discovery_pt ps_discovery) {
     celix_status_t status = CELIX_SUCCESS;
     status = etcdCommon_init(ps_discovery->context);
+    if (status == CELIX_SUCCESS) {
+        status = etcdWatcher_createLoop(&ps_discovery->watchLoop);
+    }
     ps_discovery->writer = etcdWriter_create(ps_discovery);
 
     return status;
@@ -167,6 +171,14 @@ celix_status_t pubsub_discovery_stop(pubsub_discovery_pt ps_discovery) {
     hashMapIterator_destroy(iter);
     hashMap_destroy(ps_discovery->watchers, true, true);
     celixThreadMutex_unlock(&ps_discovery->watchersMutex);
+
+    if (ps_discovery->watchLoop != NULL) {
+        etcdWatcher_destroyLoop(ps_discovery->watchLoop);
+        ps_discovery->watchLoop = NULL;
+    }
+    // the writer and watch loop threads are joined, nothing of etcdlib is used anymore
+    etcd_fini();
+
     return status;
 }
 
@@ -0,0 +1,37 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * pubsub_serializer_impl.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef PUBSUB_SERIALIZER_BINARY_H_
+#define PUBSUB_SERIALIZER_BINARY_H_
+
+#include "pubsub_dyn_serializer.h"
+
+#define PUBSUB_SERIALIZER_TYPE	"binary"
+
+/* Encodes and decodes the msgs, the rest of the serializer is in pubsub_dyn_serializer.c of pubsub_common */
+extern const pubsub_dyn_codec_t pubsubSerializer_codec;
+
+#endif /* PUBSUB_SERIALIZER_BINARY_H_ */
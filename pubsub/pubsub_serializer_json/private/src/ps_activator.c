@@ -32,7 +32,7 @@
 #include "pubsub_serializer_impl.h"
 
 struct activator {
-	pubsub_serializer_t* serializer;
+	pubsub_dyn_serializer_pt serializer;
 	pubsub_serializer_service_t* serializerService;
 	service_registration_pt registration;
 };
@@ -47,7 +47,7 @@ celix_status_t bundleActivator_create(bundle_context_pt context, void **userData
 	}
 	else{
 		*userData = activator;
-		status = pubsubSerializer_create(context, &(activator->serializer));
+		status = pubsubDynSerializer_create(context, &pubsubSerializer_codec, &(activator->serializer));
 	}
 
 	return status;
@@ -64,8 +64,8 @@ celix_status_t bundleActivator_start(void * userData, bundle_context_pt context)
 	else{
 		pubsubSerializerSvc->handle = activator->serializer;
 
-		pubsubSerializerSvc->createSerializerMap = (void*)pubsubSerializer_createSerializerMap;
-		pubsubSerializerSvc->destroySerializerMap = (void*)pubsubSerializer_destroySerializerMap;
+		pubsubSerializerSvc->createSerializerMap = (void*)pubsubDynSerializer_createSerializerMap;
+		pubsubSerializerSvc->destroySerializerMap = (void*)pubsubDynSerializer_destroySerializerMap;
 		activator->serializerService = pubsubSerializerSvc;
 
 		/* Set serializer type */
@@ -96,7 +96,7 @@ celix_status_t bundleActivator_destroy(void * userData, bundle_context_pt contex
 	celix_status_t status = CELIX_SUCCESS;
 	struct activator *activator = userData;
 
-	pubsubSerializer_destroy(activator->serializer);
+	pubsubDynSerializer_destroy(activator->serializer);
 	activator->serializer = NULL;
 
 	free(activator);
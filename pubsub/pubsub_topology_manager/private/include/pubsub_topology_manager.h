@@ -53,6 +53,9 @@ struct pubsub_topology_manager {
 	celix_thread_mutex_t subscriptionsLock;
 	hash_map_pt subscriptions; //<topic(string),list<pubsub_ep>>
 
+	hash_map_pt publicationAdmins; //<pubsub_ep,pstm_admin_assignment>, protected by publicationsLock
+	hash_map_pt subscriptionAdmins; //<pubsub_ep,pstm_admin_assignment>, protected by subscriptionsLock
+
 	log_helper_pt loghelper;
 };
 
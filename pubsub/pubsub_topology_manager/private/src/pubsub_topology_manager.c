@@ -49,6 +49,26 @@
 #include "pubsub_endpoint.h"
 #include "pubsub_admin.h"
 #include "pubsub_utils.h"
+#include "pubsub_topic_trie.h"
+
+/* The PSA that handles an endpoint, with the score it matched the endpoint with */
+struct pstm_admin_assignment {
+	pubsub_admin_service_pt psa;
+	double score;
+};
+
+typedef struct pstm_admin_assignment *pstm_admin_assignment_pt;
+
+static pubsub_admin_service_pt pubsub_topologyManager_findBestAdmin(pubsub_topology_manager_pt manager, pubsub_endpoint_pt ep, double *best_score);
+static pubsub_admin_service_pt pubsub_topologyManager_findTopicAdmin(pubsub_topology_manager_pt manager, hash_map_pt endpoints, hash_map_pt admins, pubsub_endpoint_pt ep, double *best_score);
+static celix_status_t pubsub_topologyManager_moveSubscription(pubsub_topology_manager_pt manager, array_list_pt sub_ep_list, pubsub_endpoint_pt sub, pubsub_admin_service_pt psa, double score);
+static celix_status_t pubsub_topologyManager_followPublication(pubsub_topology_manager_pt manager, pubsub_endpoint_pt pub, pubsub_admin_service_pt psa);
+static celix_status_t pubsub_topologyManager_assignOrphans(pubsub_topology_manager_pt manager, const char *fwUUID);
+static void pubsub_topologyManager_assignAdmin(hash_map_pt admins, pubsub_endpoint_pt ep, pubsub_admin_service_pt psa, double score);
+static pubsub_admin_service_pt pubsub_topologyManager_unassignAdmin(hash_map_pt admins, pubsub_endpoint_pt ep);
+static bool pubsub_topologyManager_isAssignedToAny(hash_map_pt admins, array_list_pt endpoints, pubsub_admin_service_pt psa);
+static void pubsub_topologyManager_informDiscoveries(pubsub_topology_manager_pt manager, pubsub_endpoint_pt pubEP, bool announce);
+static void pubsub_topologyManager_destroyEndpointLists(hash_map_pt endpoints);
 
 
 celix_status_t pubsub_topologyManager_create(bundle_context_pt context, log_helper_pt logHelper, pubsub_topology_manager_pt *manager) {
@@ -76,6 +96,8 @@ celix_status_t pubsub_topologyManager_create(bundle_context_pt context, log_help
 	(*manager)->discoveryList = hashMap_create(serviceReference_hashCode, NULL, serviceReference_equals2, NULL);
 	(*manager)->publications = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 	(*manager)->subscriptions = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+	(*manager)->publicationAdmins = hashMap_create(NULL, NULL, NULL, NULL);
+	(*manager)->subscriptionAdmins = hashMap_create(NULL, NULL, NULL, NULL);
 
 	(*manager)->loghelper = logHelper;
 
@@ -96,32 +118,14 @@ celix_status_t pubsub_topologyManager_destroy(pubsub_topology_manager_pt manager
 	celixThreadMutex_destroy(&manager->psaListLock);
 
 	celixThreadMutex_lock(&manager->publicationsLock);
-	hash_map_iterator_pt pubit = hashMapIterator_create(manager->publications);
-	while(hashMapIterator_hasNext(pubit)){
-		array_list_pt l = (array_list_pt)hashMapIterator_nextValue(pubit);
-		int i;
-		for(i=0;i<arrayList_size(l);i++){
-			pubsubEndpoint_destroy((pubsub_endpoint_pt)arrayList_get(l,i));
-		}
-		arrayList_destroy(l);
-	}
-	hashMapIterator_destroy(pubit);
-	hashMap_destroy(manager->publications, true, false);
+	hashMap_destroy(manager->publicationAdmins, false, true);
+	pubsub_topologyManager_destroyEndpointLists(manager->publications);
 	celixThreadMutex_unlock(&manager->publicationsLock);
 	celixThreadMutex_destroy(&manager->publicationsLock);
 
 	celixThreadMutex_lock(&manager->subscriptionsLock);
-	hash_map_iterator_pt subit = hashMapIterator_create(manager->subscriptions);
-	while(hashMapIterator_hasNext(subit)){
-		array_list_pt l = (array_list_pt)hashMapIterator_nextValue(subit);
-		int i;
-		for(i=0;i<arrayList_size(l);i++){
-			pubsubEndpoint_destroy((pubsub_endpoint_pt)arrayList_get(l,i));
-		}
-		arrayList_destroy(l);
-	}
-	hashMapIterator_destroy(subit);
-	hashMap_destroy(manager->subscriptions, true, false);
+	hashMap_destroy(manager->subscriptionAdmins, false, true);
+	pubsub_topologyManager_destroyEndpointLists(manager->subscriptions);
 	celixThreadMutex_unlock(&manager->subscriptionsLock);
 	celixThreadMutex_destroy(&manager->subscriptionsLock);
 
@@ -142,14 +146,20 @@ celix_status_t pubsub_topologyManager_psaAdded(void * handle, service_reference_
 	arrayList_add(manager->psaList, psa);
 	celixThreadMutex_unlock(&manager->psaListLock);
 
-	// Add already detected subscriptions to new PSA
+	// Move already detected subscriptions to the new PSA when it matches them better than their current PSA
 	celixThreadMutex_lock(&manager->subscriptionsLock);
 	hash_map_iterator_pt subscriptionsIterator = hashMapIterator_create(manager->subscriptions);
 
 	while (hashMapIterator_hasNext(subscriptionsIterator)) {
 		array_list_pt sub_ep_list = hashMapIterator_nextValue(subscriptionsIterator);
 		for(i=0;i<arrayList_size(sub_ep_list);i++){
-			status += psa->addSubscription(psa->admin, (pubsub_endpoint_pt)arrayList_get(sub_ep_list,i));
+			pubsub_endpoint_pt sub = (pubsub_endpoint_pt)arrayList_get(sub_ep_list,i);
+			pstm_admin_assignment_pt current = hashMap_get(manager->subscriptionAdmins, sub);
+			double score = 0;
+			psa->matchEndpoint(psa->admin,sub,&score);
+			if(score>0 && (current==NULL || score>current->score)){
+				status += pubsub_topologyManager_moveSubscription(manager,sub_ep_list,sub,psa,score);
+			}
 		}
 	}
 
@@ -157,14 +167,34 @@ celix_status_t pubsub_topologyManager_psaAdded(void * handle, service_reference_
 
 	celixThreadMutex_unlock(&manager->subscriptionsLock);
 
-	// Add already detected publications to new PSA
-	status = celixThreadMutex_lock(&manager->publicationsLock);
+	/* Add already detected publications no PSA could handle yet to the new PSA.
+	 * Handled publications stay where they are: a local publication is bound to the endpoint of its PSA. */
+	celixThreadMutex_lock(&manager->publicationsLock);
 	hash_map_iterator_pt publicationsIterator = hashMapIterator_create(manager->publications);
 
+	const char* fwUUID = NULL;
+	bundleContext_getProperty(manager->context,OSGI_FRAMEWORK_FRAMEWORK_UUID,&fwUUID);
+
 	while (hashMapIterator_hasNext(publicationsIterator)) {
 		array_list_pt pub_ep_list = hashMapIterator_nextValue(publicationsIterator);
 		for(i=0;i<arrayList_size(pub_ep_list);i++){
-			status += psa->addPublication(psa->admin, (pubsub_endpoint_pt)arrayList_get(pub_ep_list,i));
+			pubsub_endpoint_pt pub = (pubsub_endpoint_pt)arrayList_get(pub_ep_list,i);
+			double score = 0;
+			if(hashMap_containsKey(manager->publicationAdmins, pub)){
+				continue;
+			}
+			psa->matchEndpoint(psa->admin,pub,&score);
+			if(score>0){
+				if(psa->addPublication(psa->admin,pub)==CELIX_SUCCESS){
+					pubsub_topologyManager_assignAdmin(manager->publicationAdmins,pub,psa,score);
+					if(fwUUID!=NULL && strcmp(pub->frameworkUUID,fwUUID)==0){
+						pubsub_topologyManager_informDiscoveries(manager,pub,true);
+					}
+				}
+				else{
+					status = CELIX_ILLEGAL_STATE;
+				}
+			}
 		}
 	}
 
@@ -189,66 +219,98 @@ celix_status_t pubsub_topologyManager_psaRemoved(void * handle, service_referenc
 
 	pubsub_admin_service_pt psa = (pubsub_admin_service_pt) service;
 
-	/* Deactivate all publications */
+	/* Take the PSA out of the matching first, so its endpoints cannot be assigned to it again */
+	celixThreadMutex_lock(&manager->psaListLock);
+	arrayList_removeElement(manager->psaList, psa);
+	celixThreadMutex_unlock(&manager->psaListLock);
+
+	const char* fwUUID = NULL;
+	bundleContext_getProperty(manager->context,OSGI_FRAMEWORK_FRAMEWORK_UUID,&fwUUID);
+
+	/* Deactivate the publications handled by this PSA. closedTopics holds the scope/topic keys of the topics already closed */
+	hash_map_pt closedTopics = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
 	celixThreadMutex_lock(&manager->publicationsLock);
 
-	hash_map_iterator_pt pubit = hashMapIterator_create(manager->publications);
+	hash_map_iterator_pt pubit = hashMapIterator_create(manager->publicationAdmins);
 	while(hashMapIterator_hasNext(pubit)){
-		hash_map_entry_pt pub_entry = hashMapIterator_nextEntry(pubit);
-		char* scope_topic_key = (char*)hashMapEntry_getKey(pub_entry);
-		// Extract scope/topic name from key
-		char scope[MAX_SCOPE_LEN];
-		char topic[MAX_TOPIC_LEN];
-		sscanf(scope_topic_key, "%[^:]:%s", scope, topic );
-		array_list_pt pubEP_list = (array_list_pt)hashMapEntry_getValue(pub_entry);
-
-		status = psa->closeAllPublications(psa->admin,scope,topic);
-
-		if(status==CELIX_SUCCESS){
-			celixThreadMutex_lock(&manager->discoveryListLock);
-			hash_map_iterator_pt iter = hashMapIterator_create(manager->discoveryList);
-			while(hashMapIterator_hasNext(iter)){
-				service_reference_pt disc_sr = (service_reference_pt)hashMapIterator_nextKey(iter);
-				publisher_endpoint_announce_pt disc = NULL;
-				bundleContext_getService(manager->context, disc_sr, (void**) &disc);
-				const char* fwUUID = NULL;
-				bundleContext_getProperty(manager->context,OSGI_FRAMEWORK_FRAMEWORK_UUID,&fwUUID);
-				int i;
-				for(i=0;i<arrayList_size(pubEP_list);i++){
-					pubsub_endpoint_pt pubEP = (pubsub_endpoint_pt)arrayList_get(pubEP_list,i);
-					if(strcmp(pubEP->frameworkUUID,fwUUID)==0){
-						disc->removePublisher(disc->handle,pubEP);
-					}
-				}
-				bundleContext_ungetService(manager->context, disc_sr, NULL);
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(pubit);
+		pubsub_endpoint_pt pubEP = (pubsub_endpoint_pt)hashMapEntry_getKey(entry);
+		pstm_admin_assignment_pt assignment = (pstm_admin_assignment_pt)hashMapEntry_getValue(entry);
+		if(assignment->psa!=psa){
+			continue;
+		}
+
+		char *scope_topic_key = createScopeTopicKey(pubEP->scope, pubEP->topic);
+		if(!hashMap_containsKey(closedTopics, scope_topic_key)){
+			hashMap_put(closedTopics, scope_topic_key, NULL);
+			status += psa->closeAllPublications(psa->admin,pubEP->scope,pubEP->topic);
+		}
+		else{
+			free(scope_topic_key);
+		}
+
+		if(fwUUID!=NULL && strcmp(pubEP->frameworkUUID,fwUUID)==0){
+			pubsub_topologyManager_informDiscoveries(manager,pubEP,false);
+			/* Reset the endpoint field, so that the next PSA binds the local publication from scratch */
+			if(pubEP->endpoint!=NULL){
+				free(pubEP->endpoint);
+				pubEP->endpoint = NULL;
 			}
-			hashMapIterator_destroy(iter);
-			celixThreadMutex_unlock(&manager->discoveryListLock);
 		}
+
+		hashMapIterator_remove(pubit);
+		free(assignment);
 	}
 	hashMapIterator_destroy(pubit);
 
 	celixThreadMutex_unlock(&manager->publicationsLock);
 
-	/* Deactivate all subscriptions */
+	hashMap_destroy(closedTopics, true, false);
+
+	/* Deactivate the subscriptions handled by this PSA */
+	closedTopics = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
 	celixThreadMutex_lock(&manager->subscriptionsLock);
-	hash_map_iterator_pt subit = hashMapIterator_create(manager->subscriptions);
+	hash_map_iterator_pt subit = hashMapIterator_create(manager->subscriptionAdmins);
 	while(hashMapIterator_hasNext(subit)){
-		// TODO do some error checking
-		char* scope_topic = (char*)hashMapIterator_nextKey(subit);
-		char scope[MAX_TOPIC_LEN];
-		char topic[MAX_TOPIC_LEN];
-		memset(scope, 0 , MAX_TOPIC_LEN*sizeof(char));
-		memset(topic, 0 , MAX_TOPIC_LEN*sizeof(char));
-		sscanf(scope_topic, "%[^:]:%s", scope, topic );
-		status += psa->closeAllSubscriptions(psa->admin,scope, topic);
+		hash_map_entry_pt entry = hashMapIterator_nextEntry(subit);
+		pubsub_endpoint_pt subEP = (pubsub_endpoint_pt)hashMapEntry_getKey(entry);
+		pstm_admin_assignment_pt assignment = (pstm_admin_assignment_pt)hashMapEntry_getValue(entry);
+		if(assignment->psa!=psa){
+			continue;
+		}
+
+		char *scope_topic_key = createScopeTopicKey(subEP->scope, subEP->topic);
+		if(!hashMap_containsKey(closedTopics, scope_topic_key)){
+			hashMap_put(closedTopics, scope_topic_key, NULL);
+			status += psa->closeAllSubscriptions(psa->admin,subEP->scope,subEP->topic);
+		}
+		else{
+			free(scope_topic_key);
+		}
+
+		if(subEP->endpoint!=NULL){
+			free(subEP->endpoint);
+			subEP->endpoint = NULL;
+		}
+
+		hashMapIterator_remove(subit);
+		free(assignment);
 	}
 	hashMapIterator_destroy(subit);
 	celixThreadMutex_unlock(&manager->subscriptionsLock);
 
+	hashMap_destroy(closedTopics, true, false);
+
+	/* Fail the endpoints of this PSA over to the remaining PSAs */
+	celixThreadMutex_lock(&manager->subscriptionsLock);
 	celixThreadMutex_lock(&manager->psaListLock);
-	arrayList_removeElement(manager->psaList, psa);
+	celixThreadMutex_lock(&manager->publicationsLock);
+	status += pubsub_topologyManager_assignOrphans(manager,fwUUID);
+	celixThreadMutex_unlock(&manager->publicationsLock);
 	celixThreadMutex_unlock(&manager->psaListLock);
+	celixThreadMutex_unlock(&manager->subscriptionsLock);
 
 	logHelper_log(manager->loghelper, OSGI_LOGSERVICE_INFO, "PSTM: Removed PSA");
 
@@ -273,26 +335,23 @@ celix_status_t pubsub_topologyManager_subscriberAdded(void * handle, service_ref
 		free(sub_key);
 		arrayList_add(sub_list_by_topic,sub);
 
-		celixThreadMutex_unlock(&manager->subscriptionsLock);
-
-		int j;
-		double score = 0;
 		double best_score = 0;
-		pubsub_admin_service_pt best_psa = NULL;
 		celixThreadMutex_lock(&manager->psaListLock);
-		for(j=0;j<arrayList_size(manager->psaList);j++){
-			pubsub_admin_service_pt psa = (pubsub_admin_service_pt)arrayList_get(manager->psaList,j);
-			psa->matchEndpoint(psa->admin,sub,&score);
-			if(score>best_score){ /* We have a new winner! */
-				best_score = score;
-				best_psa = psa;
-			}
+
+		/* Join the PSA of the known publications of the topic, so both sides meet */
+		celixThreadMutex_lock(&manager->publicationsLock);
+		pubsub_admin_service_pt best_psa = pubsub_topologyManager_findTopicAdmin(manager,manager->publications,manager->publicationAdmins,sub,&best_score);
+		celixThreadMutex_unlock(&manager->publicationsLock);
+		if(best_psa == NULL){
+			best_psa = pubsub_topologyManager_findBestAdmin(manager,sub,&best_score);
 		}
 
-		if(best_psa != NULL && best_score>0){
-			best_psa->addSubscription(best_psa->admin,sub);
+		if(best_psa != NULL && best_psa->addSubscription(best_psa->admin,sub) == CELIX_SUCCESS){
+			pubsub_topologyManager_assignAdmin(manager->subscriptionAdmins,sub,best_psa,best_score);
 		}
 
+		celixThreadMutex_unlock(&manager->subscriptionsLock);
+
 		// Inform discoveries for interest in the topic
 		celixThreadMutex_lock(&manager->discoveryListLock);
 		hash_map_iterator_pt iter = hashMapIterator_create(manager->discoveryList);
@@ -330,7 +389,7 @@ celix_status_t pubsub_topologyManager_subscriberRemoved(void * handle, service_r
 	pubsub_endpoint_pt subcmp = NULL;
 	if(pubsubEndpoint_createFromServiceReference(reference,&subcmp,false) == CELIX_SUCCESS){
 
-		int j,k;
+		int j;
 
 		// Inform discoveries that we not interested in the topic any more
 		celixThreadMutex_lock(&manager->discoveryListLock);
@@ -355,25 +414,22 @@ celix_status_t pubsub_topologyManager_subscriberRemoved(void * handle, service_r
 			for(j=0;j<arrayList_size(sub_list_by_topic);j++){
 				pubsub_endpoint_pt sub = arrayList_get(sub_list_by_topic,j);
 				if(pubsubEndpoint_equals(sub,subcmp)){
-					for(k=0;k<arrayList_size(manager->psaList);k++){
-						/* No problem with invoking removal on all psa's, only the one that manage this topic will do something */
-						pubsub_admin_service_pt psa = (pubsub_admin_service_pt)arrayList_get(manager->psaList,k);
+					/* Only the PSA that handles the subscription has to remove it */
+					pubsub_admin_service_pt psa = pubsub_topologyManager_unassignAdmin(manager->subscriptionAdmins,sub);
+					if(psa!=NULL){
 						psa->removeSubscription(psa->admin,sub);
 					}
 
-				}
-				arrayList_remove(sub_list_by_topic,j);
+					arrayList_remove(sub_list_by_topic,j);
 
-				/* If it was the last subscriber for this topic, tell PSA to close the ZMQ socket */
-				if(arrayList_size(sub_list_by_topic)==0){
-					for(k=0;k<arrayList_size(manager->psaList);k++){
-						pubsub_admin_service_pt psa = (pubsub_admin_service_pt)arrayList_get(manager->psaList,k);
+					/* If it was the last subscriber for this topic, tell PSA to close the ZMQ socket */
+					if(arrayList_size(sub_list_by_topic)==0 && psa!=NULL){
 						psa->closeAllSubscriptions(psa->admin,sub->scope, sub->topic);
 					}
-				}
-
-				pubsubEndpoint_destroy(sub);
 
+					pubsubEndpoint_destroy(sub);
+					break;
+				}
 			}
 		}
 
@@ -471,6 +527,8 @@ celix_status_t pubsub_topologyManager_pubsubDiscoveryRemoved(void * handle, serv
 }
 
 
+
+
 celix_status_t pubsub_topologyManager_publisherTrackerAdded(void *handle, array_list_pt listeners) {
 
 	celix_status_t status = CELIX_SUCCESS;
@@ -485,6 +543,21 @@ celix_status_t pubsub_topologyManager_publisherTrackerAdded(void *handle, array_
 		pubsub_endpoint_pt pub = NULL;
 		if(pubsubEndpoint_createFromListenerHookInfo(info, &pub, true) == CELIX_SUCCESS){
 
+			if(pubsubTopic_isWildcard(pub->topic)){
+				printf("PSTM: Wildcards are only allowed in subscriber topics, ignoring publisher for topic %s\n",pub->topic);
+				pubsubEndpoint_destroy(pub);
+				continue;
+			}
+
+			/* Join the PSA of the local subscriptions of the topic, so local delivery and the subscriptions see this publication */
+			double best_score = 0;
+			celixThreadMutex_lock(&manager->subscriptionsLock);
+			celixThreadMutex_lock(&manager->psaListLock);
+			pubsub_admin_service_pt best_psa = pubsub_topologyManager_findTopicAdmin(manager,manager->subscriptions,manager->subscriptionAdmins,pub,&best_score);
+			celixThreadMutex_unlock(&manager->psaListLock);
+			celixThreadMutex_unlock(&manager->subscriptionsLock);
+
+			celixThreadMutex_lock(&manager->psaListLock);
 			celixThreadMutex_lock(&manager->publicationsLock);
 			char *pub_key = createScopeTopicKey(pub->scope, pub->topic);
 			array_list_pt pub_list_by_topic = hashMap_get(manager->publications, pub_key);
@@ -495,40 +568,19 @@ celix_status_t pubsub_topologyManager_publisherTrackerAdded(void *handle, array_
 			free(pub_key);
 			arrayList_add(pub_list_by_topic,pub);
 
-			celixThreadMutex_unlock(&manager->publicationsLock);
-
-			int j;
-			double score = 0;
-			double best_score = 0;
-			pubsub_admin_service_pt best_psa = NULL;
-			celixThreadMutex_lock(&manager->psaListLock);
-
-			for(j=0;j<arrayList_size(manager->psaList);j++){
-				pubsub_admin_service_pt psa = (pubsub_admin_service_pt)arrayList_get(manager->psaList,j);
-				psa->matchEndpoint(psa->admin,pub,&score);
-				if(score>best_score){ /* We have a new winner! */
-					best_score = score;
-					best_psa = psa;
-				}
+			if(best_psa == NULL || !arrayList_contains(manager->psaList, best_psa)){
+				best_psa = pubsub_topologyManager_findBestAdmin(manager,pub,&best_score);
 			}
 
-			if(best_psa != NULL && best_score>0){
+			if(best_psa != NULL){
 				status = best_psa->addPublication(best_psa->admin,pub);
 				if(status==CELIX_SUCCESS){
-					celixThreadMutex_lock(&manager->discoveryListLock);
-					hash_map_iterator_pt iter = hashMapIterator_create(manager->discoveryList);
-					while(hashMapIterator_hasNext(iter)){
-						service_reference_pt disc_sr = (service_reference_pt)hashMapIterator_nextKey(iter);
-						publisher_endpoint_announce_pt disc = NULL;
-						bundleContext_getService(manager->context, disc_sr, (void**) &disc);
-						disc->announcePublisher(disc->handle,pub);
-						bundleContext_ungetService(manager->context, disc_sr, NULL);
-					}
-					hashMapIterator_destroy(iter);
-					celixThreadMutex_unlock(&manager->discoveryListLock);
+					pubsub_topologyManager_assignAdmin(manager->publicationAdmins,pub,best_psa,best_score);
+					pubsub_topologyManager_informDiscoveries(manager,pub,true);
 				}
 			}
 
+			celixThreadMutex_unlock(&manager->publicationsLock);
 			celixThreadMutex_unlock(&manager->psaListLock);
 
 		}
@@ -554,7 +606,7 @@ celix_status_t pubsub_topologyManager_publisherTrackerRemoved(void *handle, arra
 		if(pubsubEndpoint_createFromListenerHookInfo(info,&pubcmp,true) == CELIX_SUCCESS){
 
 
-			int j,k;
+			int j;
 			celixThreadMutex_lock(&manager->psaListLock);
 			celixThreadMutex_lock(&manager->publicationsLock);
 
@@ -564,35 +616,24 @@ celix_status_t pubsub_topologyManager_publisherTrackerRemoved(void *handle, arra
 				for(j=0;j<arrayList_size(pub_list_by_topic);j++){
 					pubsub_endpoint_pt pub = arrayList_get(pub_list_by_topic,j);
 					if(pubsubEndpoint_equals(pub,pubcmp)){
-						for(k=0;k<arrayList_size(manager->psaList);k++){
-							pubsub_admin_service_pt psa = (pubsub_admin_service_pt)arrayList_get(manager->psaList,k);
+						/* Only the PSA that handles the publication has to remove it */
+						pubsub_admin_service_pt psa = pubsub_topologyManager_unassignAdmin(manager->publicationAdmins,pub);
+						if(psa!=NULL){
 							status = psa->removePublication(psa->admin,pub);
-							if(status==CELIX_SUCCESS){ /* We found the one that manages this endpoint */
-								celixThreadMutex_lock(&manager->discoveryListLock);
-								hash_map_iterator_pt iter = hashMapIterator_create(manager->discoveryList);
-								while(hashMapIterator_hasNext(iter)){
-									service_reference_pt disc_sr = (service_reference_pt)hashMapIterator_nextKey(iter);
-									publisher_endpoint_announce_pt disc = NULL;
-									bundleContext_getService(manager->context, disc_sr, (void**) &disc);
-									disc->removePublisher(disc->handle,pub);
-									bundleContext_ungetService(manager->context, disc_sr, NULL);
-								}
-								hashMapIterator_destroy(iter);
-								celixThreadMutex_unlock(&manager->discoveryListLock);
+							if(status==CELIX_SUCCESS){
+								pubsub_topologyManager_informDiscoveries(manager,pub,false);
 							}
 							else if(status ==  CELIX_ILLEGAL_ARGUMENT){ /* Not a real error, just saying this psa does not handle this endpoint */
 								status = CELIX_SUCCESS;
 							}
 						}
-						//}
+
 						arrayList_remove(pub_list_by_topic,j);
+						j--;
 
 						/* If it was the last publisher for this topic, tell PSA to close the ZMQ socket and then inform the discovery */
-						if(arrayList_size(pub_list_by_topic)==0){
-							for(k=0;k<arrayList_size(manager->psaList);k++){
-								pubsub_admin_service_pt psa = (pubsub_admin_service_pt)arrayList_get(manager->psaList,k);
-								psa->closeAllPublications(psa->admin,pub->scope, pub->topic);
-							}
+						if(arrayList_size(pub_list_by_topic)==0 && psa!=NULL){
+							psa->closeAllPublications(psa->admin,pub->scope, pub->topic);
 						}
 
 						pubsubEndpoint_destroy(pub);
@@ -637,23 +678,16 @@ celix_status_t pubsub_topologyManager_announcePublisher(void *handle, pubsub_end
 	pubsubEndpoint_clone(pubEP, &p);
 	arrayList_add(pub_list_by_topic,p);
 
-	int j;
-	double score = 0;
 	double best_score = 0;
-	pubsub_admin_service_pt best_psa = NULL;
+	pubsub_admin_service_pt best_psa = pubsub_topologyManager_findBestAdmin(manager,p,&best_score);
 
-	for(j=0;j<arrayList_size(manager->psaList);j++){
-		pubsub_admin_service_pt psa = (pubsub_admin_service_pt)arrayList_get(manager->psaList,j);
-		psa->matchEndpoint(psa->admin,p,&score);
-		if(score>best_score){ /* We have a new winner! */
-			best_score = score;
-			best_psa = psa;
+	bool assigned = false;
+	if(best_psa != NULL){
+		if(best_psa->addPublication(best_psa->admin,p) == CELIX_SUCCESS){
+			pubsub_topologyManager_assignAdmin(manager->publicationAdmins,p,best_psa,best_score);
+			assigned = true;
 		}
 	}
-
-	if(best_psa != NULL && best_score>0){
-		best_psa->addPublication(best_psa->admin,p);
-	}
 	else{
 		status = CELIX_ILLEGAL_STATE;
 	}
@@ -661,6 +695,20 @@ celix_status_t pubsub_topologyManager_announcePublisher(void *handle, pubsub_end
 	celixThreadMutex_unlock(&manager->publicationsLock);
 	celixThreadMutex_unlock(&manager->psaListLock);
 
+	/* The subscriptions of the topic may sit on a PSA that cannot connect to this publication */
+	if(assigned){
+		celixThreadMutex_lock(&manager->subscriptionsLock);
+		celixThreadMutex_lock(&manager->psaListLock);
+		celixThreadMutex_lock(&manager->publicationsLock);
+		pstm_admin_assignment_pt assignment = hashMap_get(manager->publicationAdmins, p);
+		if(assignment!=NULL){
+			status = pubsub_topologyManager_followPublication(manager,p,assignment->psa);
+		}
+		celixThreadMutex_unlock(&manager->publicationsLock);
+		celixThreadMutex_unlock(&manager->psaListLock);
+		celixThreadMutex_unlock(&manager->subscriptionsLock);
+	}
+
 	return status;
 }
 
@@ -691,21 +739,17 @@ celix_status_t pubsub_topologyManager_removePublisher(void *handle, pubsub_endpo
 
 		if(found && p !=NULL){
 
-			for(i=0;i<arrayList_size(manager->psaList);i++){
-				pubsub_admin_service_pt psa = (pubsub_admin_service_pt)arrayList_get(manager->psaList,i);
-				/* No problem with invoking removal on all psa's, only the one that manage this topic will do something */
+			/* Only the PSA that handles the publication has to remove it */
+			pubsub_admin_service_pt psa = pubsub_topologyManager_unassignAdmin(manager->publicationAdmins,p);
+			if(psa!=NULL){
 				psa->removePublication(psa->admin,p);
 			}
 
 			arrayList_removeElement(pub_list_by_topic,p);
 
 			/* If it was the last publisher for this topic, tell PSA to close the ZMQ socket */
-			if(arrayList_size(pub_list_by_topic)==0){
-
-				for(i=0;i<arrayList_size(manager->psaList);i++){
-					pubsub_admin_service_pt psa = (pubsub_admin_service_pt)arrayList_get(manager->psaList,i);
-					psa->closeAllPublications(psa->admin,p->scope, p->topic);
-				}
+			if(arrayList_size(pub_list_by_topic)==0 && psa!=NULL){
+				psa->closeAllPublications(psa->admin,p->scope, p->topic);
 			}
 
 			pubsubEndpoint_destroy(p);
@@ -721,3 +765,226 @@ celix_status_t pubsub_topologyManager_removePublisher(void *handle, pubsub_endpo
 	return status;
 }
 
+/* Scores the endpoint against every PSA. The caller holds the psaListLock */
+static pubsub_admin_service_pt pubsub_topologyManager_findBestAdmin(pubsub_topology_manager_pt manager, pubsub_endpoint_pt ep, double *best_score) {
+	int j;
+	pubsub_admin_service_pt best_psa = NULL;
+
+	*best_score = 0;
+	for(j=0;j<arrayList_size(manager->psaList);j++){
+		pubsub_admin_service_pt psa = (pubsub_admin_service_pt)arrayList_get(manager->psaList,j);
+		double score = 0;
+		psa->matchEndpoint(psa->admin,ep,&score);
+		if(score>*best_score){ /* We have a new winner! */
+			*best_score = score;
+			best_psa = psa;
+		}
+	}
+
+	return best_psa;
+}
+
+/* Returns the best PSA that already handles an endpoint of the topic of ep in endpoints and can handle ep as well.
+ * The caller holds the psaListLock and the lock of endpoints */
+static pubsub_admin_service_pt pubsub_topologyManager_findTopicAdmin(pubsub_topology_manager_pt manager, hash_map_pt endpoints, hash_map_pt admins, pubsub_endpoint_pt ep, double *best_score) {
+	int i;
+	pubsub_admin_service_pt best_psa = NULL;
+
+	*best_score = 0;
+	char *key = createScopeTopicKey(ep->scope, ep->topic);
+	array_list_pt ep_list = hashMap_get(endpoints, key);
+	free(key);
+
+	for(i=0;ep_list!=NULL && i<arrayList_size(ep_list);i++){
+		pstm_admin_assignment_pt assignment = hashMap_get(admins, arrayList_get(ep_list,i));
+		if(assignment==NULL || assignment->psa==best_psa || !arrayList_contains(manager->psaList, assignment->psa)){
+			continue;
+		}
+		double score = 0;
+		assignment->psa->matchEndpoint(assignment->psa->admin,ep,&score);
+		if(score>*best_score){
+			*best_score = score;
+			best_psa = assignment->psa;
+		}
+	}
+
+	return best_psa;
+}
+
+/* Moves a subscription from its current PSA, if any, to psa. The caller holds the subscriptionsLock */
+static celix_status_t pubsub_topologyManager_moveSubscription(pubsub_topology_manager_pt manager, array_list_pt sub_ep_list, pubsub_endpoint_pt sub, pubsub_admin_service_pt psa, double score) {
+	if(psa->addSubscription(psa->admin,sub)!=CELIX_SUCCESS){
+		return CELIX_ILLEGAL_STATE;
+	}
+
+	pstm_admin_assignment_pt current = hashMap_get(manager->subscriptionAdmins, sub);
+	pubsub_admin_service_pt oldPsa = (current!=NULL) ? current->psa : NULL;
+	if(oldPsa!=NULL){
+		oldPsa->removeSubscription(oldPsa->admin,sub);
+	}
+	pubsub_topologyManager_assignAdmin(manager->subscriptionAdmins,sub,psa,score);
+
+	/* removeSubscription keeps the topic subscription of the old PSA open, close it once no subscription of the topic is left there */
+	if(oldPsa!=NULL && !pubsub_topologyManager_isAssignedToAny(manager->subscriptionAdmins,sub_ep_list,oldPsa)){
+		oldPsa->closeAllSubscriptions(oldPsa->admin,sub->scope,sub->topic);
+	}
+
+	return CELIX_SUCCESS;
+}
+
+/* Moves the subscriptions of the topic of pub to psa, which handles pub, when no other publication of the topic is left
+ * on their current PSA. E.g. a subscription follows a shared memory publication on the same host.
+ * The caller holds the subscriptionsLock, the psaListLock and the publicationsLock */
+static celix_status_t pubsub_topologyManager_followPublication(pubsub_topology_manager_pt manager, pubsub_endpoint_pt pub, pubsub_admin_service_pt psa) {
+	celix_status_t status = CELIX_SUCCESS;
+	int i;
+
+	char *key = createScopeTopicKey(pub->scope, pub->topic);
+	array_list_pt sub_ep_list = hashMap_get(manager->subscriptions, key);
+	array_list_pt pub_ep_list = hashMap_get(manager->publications, key);
+	free(key);
+
+	for(i=0;sub_ep_list!=NULL && i<arrayList_size(sub_ep_list);i++){
+		pubsub_endpoint_pt sub = (pubsub_endpoint_pt)arrayList_get(sub_ep_list,i);
+		pstm_admin_assignment_pt current = hashMap_get(manager->subscriptionAdmins, sub);
+		if(current!=NULL && (current->psa==psa || pubsub_topologyManager_isAssignedToAny(manager->publicationAdmins,pub_ep_list,current->psa))){
+			continue;
+		}
+		double score = 0;
+		psa->matchEndpoint(psa->admin,sub,&score);
+		if(score>0){
+			status += pubsub_topologyManager_moveSubscription(manager,sub_ep_list,sub,psa,score);
+		}
+	}
+
+	return status;
+}
+
+/* Assigns the publications and subscriptions without a PSA to the best remaining PSA, publications first so the
+ * subscriptions can join them. The caller holds the subscriptionsLock, the psaListLock and the publicationsLock */
+static celix_status_t pubsub_topologyManager_assignOrphans(pubsub_topology_manager_pt manager, const char *fwUUID) {
+	celix_status_t status = CELIX_SUCCESS;
+	int i;
+
+	hash_map_iterator_pt iter = hashMapIterator_create(manager->publications);
+	while(hashMapIterator_hasNext(iter)){
+		array_list_pt pub_ep_list = hashMapIterator_nextValue(iter);
+		for(i=0;i<arrayList_size(pub_ep_list);i++){
+			pubsub_endpoint_pt pub = (pubsub_endpoint_pt)arrayList_get(pub_ep_list,i);
+			if(hashMap_containsKey(manager->publicationAdmins, pub)){
+				continue;
+			}
+			double best_score = 0;
+			pubsub_admin_service_pt best_psa = pubsub_topologyManager_findTopicAdmin(manager,manager->subscriptions,manager->subscriptionAdmins,pub,&best_score);
+			if(best_psa == NULL){
+				best_psa = pubsub_topologyManager_findBestAdmin(manager,pub,&best_score);
+			}
+			if(best_psa == NULL){
+				continue;
+			}
+			if(best_psa->addPublication(best_psa->admin,pub)==CELIX_SUCCESS){
+				pubsub_topologyManager_assignAdmin(manager->publicationAdmins,pub,best_psa,best_score);
+				if(fwUUID!=NULL && strcmp(pub->frameworkUUID,fwUUID)==0){
+					pubsub_topologyManager_informDiscoveries(manager,pub,true);
+				}
+			}
+			else{
+				status = CELIX_ILLEGAL_STATE;
+			}
+		}
+	}
+	hashMapIterator_destroy(iter);
+
+	iter = hashMapIterator_create(manager->subscriptions);
+	while(hashMapIterator_hasNext(iter)){
+		array_list_pt sub_ep_list = hashMapIterator_nextValue(iter);
+		for(i=0;i<arrayList_size(sub_ep_list);i++){
+			pubsub_endpoint_pt sub = (pubsub_endpoint_pt)arrayList_get(sub_ep_list,i);
+			if(hashMap_containsKey(manager->subscriptionAdmins, sub)){
+				continue;
+			}
+			double best_score = 0;
+			pubsub_admin_service_pt best_psa = pubsub_topologyManager_findTopicAdmin(manager,manager->publications,manager->publicationAdmins,sub,&best_score);
+			if(best_psa == NULL){
+				best_psa = pubsub_topologyManager_findBestAdmin(manager,sub,&best_score);
+			}
+			if(best_psa == NULL){
+				continue;
+			}
+			if(best_psa->addSubscription(best_psa->admin,sub)==CELIX_SUCCESS){
+				pubsub_topologyManager_assignAdmin(manager->subscriptionAdmins,sub,best_psa,best_score);
+			}
+			else{
+				status = CELIX_ILLEGAL_STATE;
+			}
+		}
+	}
+	hashMapIterator_destroy(iter);
+
+	return status;
+}
+
+static void pubsub_topologyManager_assignAdmin(hash_map_pt admins, pubsub_endpoint_pt ep, pubsub_admin_service_pt psa, double score) {
+	pstm_admin_assignment_pt assignment = hashMap_get(admins, ep);
+	if(assignment==NULL){
+		assignment = calloc(1, sizeof(*assignment));
+		hashMap_put(admins, ep, assignment);
+	}
+	assignment->psa = psa;
+	assignment->score = score;
+}
+
+static pubsub_admin_service_pt pubsub_topologyManager_unassignAdmin(hash_map_pt admins, pubsub_endpoint_pt ep) {
+	pubsub_admin_service_pt psa = NULL;
+	pstm_admin_assignment_pt assignment = hashMap_remove(admins, ep);
+	if(assignment!=NULL){
+		psa = assignment->psa;
+		free(assignment);
+	}
+	return psa;
+}
+
+/* Returns true when one of the endpoints is assigned to psa */
+static bool pubsub_topologyManager_isAssignedToAny(hash_map_pt admins, array_list_pt endpoints, pubsub_admin_service_pt psa) {
+	int i;
+	for(i=0;i<arrayList_size(endpoints);i++){
+		pstm_admin_assignment_pt assignment = hashMap_get(admins, arrayList_get(endpoints,i));
+		if(assignment!=NULL && assignment->psa==psa){
+			return true;
+		}
+	}
+	return false;
+}
+
+static void pubsub_topologyManager_informDiscoveries(pubsub_topology_manager_pt manager, pubsub_endpoint_pt pubEP, bool announce) {
+	celixThreadMutex_lock(&manager->discoveryListLock);
+	hash_map_iterator_pt iter = hashMapIterator_create(manager->discoveryList);
+	while(hashMapIterator_hasNext(iter)){
+		service_reference_pt disc_sr = (service_reference_pt)hashMapIterator_nextKey(iter);
+		publisher_endpoint_announce_pt disc = NULL;
+		bundleContext_getService(manager->context, disc_sr, (void**) &disc);
+		if(announce){
+			disc->announcePublisher(disc->handle,pubEP);
+		}
+		else{
+			disc->removePublisher(disc->handle,pubEP);
+		}
+		bundleContext_ungetService(manager->context, disc_sr, NULL);
+	}
+	hashMapIterator_destroy(iter);
+	celixThreadMutex_unlock(&manager->discoveryListLock);
+}
+
+static void pubsub_topologyManager_destroyEndpointLists(hash_map_pt endpoints) {
+	hash_map_iterator_pt it = hashMapIterator_create(endpoints);
+	while(hashMapIterator_hasNext(it)){
+		array_list_pt l = (array_list_pt)hashMapIterator_nextValue(it);
+		int i;
+		for(i=0;i<arrayList_size(l);i++){
+			pubsubEndpoint_destroy((pubsub_endpoint_pt)arrayList_get(l,i));
+		}
+		arrayList_destroy(l);
+	}
+	hashMapIterator_destroy(it);
+	hashMap_destroy(endpoints, true, false);
+}
@@ -385,6 +385,7 @@ celix_status_t etcdWatcher_destroy(etcd_watcher_pt watcher) {
 	{
 		logHelper_log(*watcher->loghelper, OSGI_LOGSERVICE_WARNING, "Cannot remove local discovery registration.");
 	}
+	etcd_fini();
 
 	watcher->loghelper = NULL;
 
@@ -32,7 +32,12 @@ void exportRegistration_destroy(export_registration_pt registration);
 celix_status_t exportRegistration_start(export_registration_pt registration);
 celix_status_t exportRegistration_stop(export_registration_pt registration);
 
+/* Calls may run concurrently. The caller acquires the registration before calling it and releases it afterwards,
+ * closing the registration or removing its service waits until the acquired calls are released. */
+celix_status_t exportRegistration_acquire(export_registration_pt export);
+void exportRegistration_release(export_registration_pt export);
 celix_status_t exportRegistration_call(export_registration_pt export, char *data, int datalength, char **response, int *responseLength);
+celix_status_t exportRegistration_callBinary(export_registration_pt export, const char *data, size_t dataLength, char **response, size_t *responseLength);
 
 
 #endif //CELIX_EXPORT_REGISTRATION_DFI_H
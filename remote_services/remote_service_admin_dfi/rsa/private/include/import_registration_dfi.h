@@ -22,10 +22,12 @@
 
 #include "import_registration.h"
 #include "dfi_utils.h"
+#include "dyn_function.h"
 
 #include <celix_errno.h>
+#include <stdbool.h>
 
-typedef void (*send_func_type)(void *handle, endpoint_description_pt endpointDescription, char *request, char **reply, int* replyStatus);
+typedef void (*send_func_type)(void *handle, endpoint_description_pt endpointDescription, bool binary, char *request, size_t requestLength, char **reply, size_t *replyLength, int* replyStatus);
 
 celix_status_t importRegistration_create(bundle_context_pt context, endpoint_description_pt description, const char *classObject, const char* serviceVersion,
                                          import_registration_pt *import);
@@ -35,9 +37,16 @@ void importRegistration_destroy(import_registration_pt import);
 celix_status_t importRegistration_setSendFn(import_registration_pt reg,
                                             send_func_type,
                                             void *handle);
+/* Calls are sent with the binary protocol instead of JSON when set, see binary_rpc.h */
+celix_status_t importRegistration_setBinary(import_registration_pt import, bool binary);
 celix_status_t importRegistration_start(import_registration_pt import);
 celix_status_t importRegistration_stop(import_registration_pt import);
 
+/* Asynchronous calls of a proxy. A prepared call counts as in flight until it is finished. */
+celix_status_t importRegistration_prepareCall(void *service, const char *method, void *args[], import_registration_pt *import,
+                                              endpoint_description_pt *endpoint, dyn_function_type **func, bool *binary, char **request, size_t *requestLength);
+celix_status_t importRegistration_finishCall(import_registration_pt import, dyn_function_type *func, const char *reply, size_t replyLength, void *args[]);
+
 celix_status_t importRegistration_getService(import_registration_pt import, bundle_pt bundle, service_registration_pt registration, void **service);
 celix_status_t importRegistration_ungetService(import_registration_pt import, bundle_pt bundle, service_registration_pt registration, void **service);
 
@@ -30,6 +30,7 @@
 
 #include "bundle_context.h"
 #include "endpoint_description.h"
+#include "remote_service_admin_dfi_async.h"
 
 //typedef struct remote_service_admin *remote_service_admin_pt;
 
@@ -45,6 +46,10 @@ celix_status_t remoteServiceAdmin_getImportedEndpoints(remote_service_admin_pt a
 celix_status_t remoteServiceAdmin_importService(remote_service_admin_pt admin, endpoint_description_pt endpoint, import_registration_pt *registration);
 celix_status_t remoteServiceAdmin_removeImportedService(remote_service_admin_pt admin, import_registration_pt registration);
 
+celix_status_t remoteServiceAdmin_callAsync(void *handle, void *proxy, const char *method, void *args[], rsa_dfi_call_done_fn done, void *doneHandle, rsa_dfi_call_pt *call);
+int remoteServiceAdmin_waitAsync(void *handle, rsa_dfi_call_pt call, unsigned int timeoutInMs, int *callStatus);
+void remoteServiceAdmin_releaseAsync(void *handle, rsa_dfi_call_pt call);
+
 
 celix_status_t exportReference_getExportedEndpoint(export_reference_pt reference, endpoint_description_pt *endpoint);
 celix_status_t exportReference_getExportedService(export_reference_pt reference, service_reference_pt *service);
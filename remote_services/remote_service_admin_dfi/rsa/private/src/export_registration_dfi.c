@@ -25,6 +25,7 @@
 #include <service_tracker_customizer.h>
 #include <service_tracker.h>
 #include <json_rpc.h>
+#include <binary_rpc.h>
 #include "constants.h"
 #include "export_registration_dfi.h"
 #include "dfi_utils.h"
@@ -42,10 +43,10 @@ struct export_registration {
     service_tracker_pt tracker;
 
     celix_thread_mutex_t mutex;
+    celix_thread_cond_t callsDone;
     void *service; //protected by mutex
-
-    //TODO add tracker and lock
-    bool closed;
+    unsigned int calls; //acquired calls, protected by mutex
+    bool closed; //protected by mutex
 };
 
 static void exportRegistration_addServ(export_registration_pt reg, service_reference_pt ref, void *service);
@@ -76,6 +77,7 @@ celix_status_t exportRegistration_create(log_helper_pt helper, service_reference
         reg->closed = false;
 
         celixThreadMutex_create(&reg->mutex, NULL);
+        celixThreadCondition_init(&reg->callsDone, NULL);
     }
 
     const char *exports = NULL;
@@ -95,7 +97,8 @@ celix_status_t exportRegistration_create(log_helper_pt helper, service_reference
     }
 
     if (status == CELIX_SUCCESS) {
-        int rc = dynInterface_parse(descriptor, &reg->intf);
+        //exports only call through the interface, so exports of the same descriptor share one parsed interface
+        int rc = dynInterface_parseShared(descriptor, &reg->intf);
         fclose(descriptor);
         if (rc != 0) {
             status = CELIX_BUNDLE_EXCEPTION;
@@ -138,16 +141,63 @@ celix_status_t exportRegistration_create(log_helper_pt helper, service_reference
     return status;
 }
 
+celix_status_t exportRegistration_acquire(export_registration_pt export) {
+    celix_status_t status = CELIX_SUCCESS;
+
+    celixThreadMutex_lock(&export->mutex);
+    if (export->closed) {
+        status = CELIX_ILLEGAL_STATE;
+    } else {
+        export->calls += 1;
+    }
+    celixThreadMutex_unlock(&export->mutex);
+
+    return status;
+}
+
+void exportRegistration_release(export_registration_pt export) {
+    celixThreadMutex_lock(&export->mutex);
+    export->calls -= 1;
+    if (export->calls == 0) {
+        celixThreadCondition_broadcast(&export->callsDone);
+    }
+    celixThreadMutex_unlock(&export->mutex);
+}
+
 celix_status_t exportRegistration_call(export_registration_pt export, char *data, int datalength, char **responseOut, int *responseLength) {
     int status = CELIX_SUCCESS;
 
     //printf("calling for '%s'\n");
 
     *responseLength = -1;
+
+    //the acquired call keeps the service, so it is called without holding the lock
     celixThreadMutex_lock(&export->mutex);
-    status = jsonRpc_call(export->intf, export->service, data, responseOut);
+    void *service = export->service;
     celixThreadMutex_unlock(&export->mutex);
 
+    if (service != NULL) {
+        status = jsonRpc_call(export->intf, service, data, responseOut);
+    } else {
+        status = CELIX_ILLEGAL_STATE;
+    }
+
+    return status;
+}
+
+celix_status_t exportRegistration_callBinary(export_registration_pt export, const char *data, size_t dataLength, char **responseOut, size_t *responseLength) {
+    int status = CELIX_SUCCESS;
+
+    celixThreadMutex_lock(&export->mutex);
+    void *service = export->service;
+    celixThreadMutex_unlock(&export->mutex);
+
+    if (service != NULL) {
+        status = binaryRpc_call(export->intf, service, data, dataLength, (void **) responseOut, responseLength);
+    } else {
+        status = CELIX_ILLEGAL_STATE;
+    }
+
     return status;
 }
 
@@ -156,7 +206,7 @@ void exportRegistration_destroy(export_registration_pt reg) {
         if (reg->intf != NULL) {
             dyn_interface_type *intf = reg->intf;
             reg->intf = NULL;
-            dynInterface_destroy(intf);
+            dynInterface_release(intf);
         }
 
         if (reg->exportReference.endpoint != NULL) {
@@ -167,6 +217,7 @@ void exportRegistration_destroy(export_registration_pt reg) {
         if (reg->tracker != NULL) {
             serviceTracker_destroy(reg->tracker);
         }
+        celixThreadCondition_destroy(&reg->callsDone);
         celixThreadMutex_destroy(&reg->mutex);
 
         free(reg);
@@ -183,6 +234,14 @@ celix_status_t exportRegistration_start(export_registration_pt reg) {
 
 celix_status_t exportRegistration_stop(export_registration_pt reg) {
     celix_status_t status = CELIX_SUCCESS;
+
+    celixThreadMutex_lock(&reg->mutex);
+    reg->closed = true;
+    while (reg->calls > 0) {
+        celixThreadCondition_wait(&reg->callsDone, &reg->mutex);
+    }
+    celixThreadMutex_unlock(&reg->mutex);
+
     if (status == CELIX_SUCCESS) {
         status = bundleContext_ungetServiceReference(reg->context, reg->exportReference.reference);
         serviceTracker_close(reg->tracker);
@@ -199,6 +258,9 @@ static void exportRegistration_addServ(export_registration_pt reg, service_refer
 static void exportRegistration_removeServ(export_registration_pt reg, service_reference_pt ref, void *service) {
     celixThreadMutex_lock(&reg->mutex);
     if (reg->service == service) {
+        while (reg->calls > 0) {
+            celixThreadCondition_wait(&reg->callsDone, &reg->mutex);
+        }
         reg->service = NULL;
     }
     celixThreadMutex_unlock(&reg->mutex);
@@ -18,8 +18,10 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <jansson.h>
 #include <json_rpc.h>
+#include <binary_rpc.h>
 #include <assert.h>
 #include "version.h"
 #include "json_serializer.h"
@@ -33,9 +35,12 @@ struct import_registration {
     const char *classObject; //NOTE owned by endpoint
     version_pt version;
 
-    celix_thread_mutex_t mutex; //protects send & sendhandle
+    celix_thread_mutex_t mutex; //protects send, sendhandle & calls
+    celix_thread_cond_t callsDone;
     send_func_type send;
     void *sendHandle;
+    unsigned int calls; //calls in flight
+    bool binary;
 
     service_factory_pt factory;
     service_registration_pt factoryReg;
@@ -55,6 +60,7 @@ static celix_status_t importRegistration_createProxy(import_registration_pt impo
 static void importRegistration_proxyFunc(void *userData, void *args[], void *returnVal);
 static void importRegistration_destroyProxy(struct service_proxy *proxy);
 static void importRegistration_clearProxies(import_registration_pt import);
+static void importRegistration_endCall(import_registration_pt import);
 
 celix_status_t importRegistration_create(bundle_context_pt context, endpoint_description_pt endpoint, const char *classObject, const char* serviceVersion,
                                          import_registration_pt *out) {
@@ -72,6 +78,7 @@ celix_status_t importRegistration_create(bundle_context_pt context, endpoint_des
         reg->proxies = hashMap_create(NULL, NULL, NULL, NULL);
 
         celixThreadMutex_create(&reg->mutex, NULL);
+        celixThreadCondition_init(&reg->callsDone, NULL);
         celixThreadMutex_create(&reg->proxiesMutex, NULL);
         status = version_createVersionFromString((char*)serviceVersion,&(reg->version));
 
@@ -94,10 +101,22 @@ celix_status_t importRegistration_create(bundle_context_pt context, endpoint_des
 }
 
 
+celix_status_t importRegistration_setBinary(import_registration_pt import, bool binary) {
+    celixThreadMutex_lock(&import->mutex);
+    import->binary = binary;
+    celixThreadMutex_unlock(&import->mutex);
+
+    return CELIX_SUCCESS;
+}
+
 celix_status_t importRegistration_setSendFn(import_registration_pt reg,
                                             send_func_type send,
                                             void *handle) {
     celixThreadMutex_lock(&reg->mutex);
+    //wait for the calls using the previous send function
+    while (reg->calls > 0) {
+        celixThreadCondition_wait(&reg->callsDone, &reg->mutex);
+    }
     reg->send = send;
     reg->sendHandle = handle;
     celixThreadMutex_unlock(&reg->mutex);
@@ -128,6 +147,7 @@ void importRegistration_destroy(import_registration_pt import) {
             import->proxies = NULL;
         }
 
+        pthread_cond_destroy(&import->callsDone);
         pthread_mutex_destroy(&import->mutex);
         pthread_mutex_destroy(&import->proxiesMutex);
 
@@ -162,6 +182,15 @@ celix_status_t importRegistration_stop(import_registration_pt import) {
         import->factoryReg = NULL;
     }
 
+    //proxies can still be called by users that did not unget them yet
+    celixThreadMutex_lock(&import->mutex);
+    while (import->calls > 0) {
+        celixThreadCondition_wait(&import->callsDone, &import->mutex);
+    }
+    import->send = NULL;
+    import->sendHandle = NULL;
+    celixThreadMutex_unlock(&import->mutex);
+
     importRegistration_clearProxies(import);
 
     return status;
@@ -212,6 +241,7 @@ static celix_status_t importRegistration_createProxy(import_registration_pt impo
     }
 
     if (status == CELIX_SUCCESS) {
+        //not shared (dynInterface_parseShared), the proxy binds closures to the methods of its interface
         int rc = dynInterface_parse(descriptor, &intf);
         fclose(descriptor);
         if (rc != 0 || intf==NULL) {
@@ -294,37 +324,63 @@ static void importRegistration_proxyFunc(void *userData, void *args[], void *ret
     struct method_entry *entry = userData;
     import_registration_pt import = *((void **)args[0]);
 
-    if (import == NULL || import->send == NULL) {
+    if (import == NULL) {
         status = CELIX_ILLEGAL_ARGUMENT;
     }
 
 
     char *invokeRequest = NULL;
+    size_t requestLength = 0;
+    bool binary = false;
     if (status == CELIX_SUCCESS) {
-        status = jsonRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, &invokeRequest);
+        celixThreadMutex_lock(&import->mutex);
+        binary = import->binary;
+        celixThreadMutex_unlock(&import->mutex);
+
+        if (binary) {
+            status = binaryRpc_prepareInvokeRequest(entry->dynFunc, entry->index, entry->id, args, (void **) &invokeRequest, &requestLength);
+        } else {
+            status = jsonRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, &invokeRequest);
+            requestLength = invokeRequest != NULL ? strlen(invokeRequest) : 0;
+        }
         //printf("Need to send following json '%s'\n", invokeRequest);
     }
 
 
     if (status == CELIX_SUCCESS) {
         char *reply = NULL;
+        size_t replyLength = 0;
         int rc = 0;
         //printf("sending request\n");
+        //the lock only guards the send function, calls are sent concurrently
         celixThreadMutex_lock(&import->mutex);
-        if (import->send != NULL) {
-            import->send(import->sendHandle, import->endpoint, invokeRequest, &reply, &rc);
+        send_func_type send = import->send;
+        void *sendHandle = import->sendHandle;
+        if (send != NULL) {
+            import->calls += 1;
         }
         celixThreadMutex_unlock(&import->mutex);
+
+        if (send != NULL) {
+            send(sendHandle, import->endpoint, binary, invokeRequest, requestLength, &reply, &replyLength, &rc);
+            importRegistration_endCall(import);
+        } else {
+            rc = CELIX_ILLEGAL_STATE;
+        }
         //printf("request sended. got reply '%s' with status %i\n", reply, rc);
 
         if (rc == 0) {
             //fjprintf("Handling reply '%s'\n", reply);
-            status = jsonRpc_handleReply(entry->dynFunc, reply, args);
+            if (binary) {
+                status = binaryRpc_handleReply(entry->dynFunc, reply, replyLength, args);
+            } else {
+                status = jsonRpc_handleReply(entry->dynFunc, reply, args);
+            }
         }
 
         *(int *) returnVal = rc;
 
-        free(invokeRequest); //Allocated by json_dumps in jsonRpc_prepareInvokeRequest
+        free(invokeRequest); //Allocated by json_dumps in jsonRpc_prepareInvokeRequest or by binaryRpc_prepareInvokeRequest
         free(reply); //Allocated by json_dumps in remoteServiceAdmin_send through curl call
     }
 
@@ -333,6 +389,102 @@ static void importRegistration_proxyFunc(void *userData, void *args[], void *ret
     }
 }
 
+static void importRegistration_endCall(import_registration_pt import) {
+    celixThreadMutex_lock(&import->mutex);
+    import->calls -= 1;
+    if (import->calls == 0) {
+        celixThreadCondition_broadcast(&import->callsDone);
+    }
+    celixThreadMutex_unlock(&import->mutex);
+}
+
+celix_status_t importRegistration_prepareCall(void *service, const char *method, void *args[], import_registration_pt *out,
+                                              endpoint_description_pt *endpoint, dyn_function_type **func, bool *binary, char **request, size_t *requestLength) {
+    celix_status_t status = CELIX_SUCCESS;
+    import_registration_pt import = service != NULL ? ((void **)service)[0] : NULL; //see importRegistration_createProxy
+
+    if (import == NULL || method == NULL) {
+        status = CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    struct method_entry *entry = NULL;
+    if (status == CELIX_SUCCESS) {
+        pthread_mutex_lock(&import->proxiesMutex);
+        hash_map_iterator_pt iter = hashMapIterator_create(import->proxies);
+        while (hashMapIterator_hasNext(iter) && entry == NULL) {
+            struct service_proxy *proxy = hashMapIterator_nextValue(iter);
+            if (proxy->service == service) {
+                struct methods_head *list = NULL;
+                struct method_entry *current = NULL;
+                dynInterface_methods(proxy->intf, &list);
+                TAILQ_FOREACH(current, list, entries) {
+                    if (strcmp(current->name, method) == 0) {
+                        entry = current;
+                        break;
+                    }
+                }
+            }
+        }
+        hashMapIterator_destroy(iter);
+        pthread_mutex_unlock(&import->proxiesMutex);
+
+        if (entry == NULL) {
+            status = CELIX_ILLEGAL_ARGUMENT;
+        }
+    }
+
+    if (status == CELIX_SUCCESS) {
+        celixThreadMutex_lock(&import->mutex);
+        if (import->send != NULL) {
+            import->calls += 1;
+            *binary = import->binary;
+        } else {
+            status = CELIX_ILLEGAL_STATE;
+        }
+        celixThreadMutex_unlock(&import->mutex);
+    }
+
+    if (status == CELIX_SUCCESS) {
+        int rc = 0;
+        if (*binary) {
+            rc = binaryRpc_prepareInvokeRequest(entry->dynFunc, entry->index, entry->id, args, (void **) request, requestLength);
+        } else {
+            rc = jsonRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, request);
+            *requestLength = rc == 0 ? strlen(*request) : 0;
+        }
+        if (rc != 0) {
+            status = CELIX_ILLEGAL_ARGUMENT;
+            importRegistration_endCall(import);
+        }
+    }
+
+    if (status == CELIX_SUCCESS) {
+        *out = import;
+        *endpoint = import->endpoint;
+        *func = entry->dynFunc;
+    }
+
+    return status;
+}
+
+celix_status_t importRegistration_finishCall(import_registration_pt import, dyn_function_type *func, const char *reply, size_t replyLength, void *args[]) {
+    celix_status_t status = CELIX_SUCCESS;
+
+    if (reply != NULL) {
+        celixThreadMutex_lock(&import->mutex);
+        bool binary = import->binary;
+        celixThreadMutex_unlock(&import->mutex);
+
+        int rc = binary ? binaryRpc_handleReply(func, reply, replyLength, args) : jsonRpc_handleReply(func, reply, args);
+        if (rc != 0) {
+            status = CELIX_SERVICE_EXCEPTION;
+        }
+    }
+    importRegistration_endCall(import);
+
+    return status;
+}
+
 celix_status_t importRegistration_ungetService(import_registration_pt import, bundle_pt bundle, service_registration_pt registration, void **out) {
     celix_status_t  status = CELIX_SUCCESS;
 
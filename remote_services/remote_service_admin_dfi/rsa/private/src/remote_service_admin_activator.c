@@ -38,6 +38,8 @@ struct activator {
 	remote_service_admin_pt admin;
 	remote_service_admin_service_pt adminService;
 	service_registration_pt registration;
+	rsa_dfi_async_service_pt asyncService;
+	service_registration_pt asyncRegistration;
 };
 
 celix_status_t bundleActivator_create(bundle_context_pt context, void **userData) {
@@ -94,6 +96,21 @@ celix_status_t bundleActivator_start(void * userData, bundle_context_pt context)
 		}
 	}
 
+	if (status == CELIX_SUCCESS) {
+		rsa_dfi_async_service_pt asyncService = calloc(1, sizeof(*asyncService));
+		if (!asyncService) {
+			status = CELIX_ENOMEM;
+		} else {
+			asyncService->handle = activator->admin;
+			asyncService->call = remoteServiceAdmin_callAsync;
+			asyncService->wait = remoteServiceAdmin_waitAsync;
+			asyncService->release = remoteServiceAdmin_releaseAsync;
+
+			status = bundleContext_registerService(context, RSA_DFI_ASYNC_SERVICE, asyncService, NULL, &activator->asyncRegistration);
+			activator->asyncService = asyncService;
+		}
+	}
+
 	return status;
 }
 
@@ -101,6 +118,11 @@ celix_status_t bundleActivator_stop(void * userData, bundle_context_pt context)
     celix_status_t status = CELIX_SUCCESS;
     struct activator *activator = userData;
 
+    if (activator->asyncRegistration != NULL) {
+        serviceRegistration_unregister(activator->asyncRegistration);
+        activator->asyncRegistration = NULL;
+    }
+
     serviceRegistration_unregister(activator->registration);
     activator->registration = NULL;
 
@@ -108,6 +130,8 @@ celix_status_t bundleActivator_stop(void * userData, bundle_context_pt context)
     remoteServiceAdmin_destroy(&activator->admin);
 
     free(activator->adminService);
+    free(activator->asyncService);
+    activator->asyncService = NULL;
 
     return status;
 }
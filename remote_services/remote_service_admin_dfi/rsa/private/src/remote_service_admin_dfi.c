@@ -25,6 +25,10 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
 
 #include <arpa/inet.h>
 #include <netdb.h>
@@ -39,12 +43,15 @@
 #include "celix_threads.h"
 #include "hash_map.h"
 #include "array_list.h"
+#include "utils.h"
 
 #include "import_registration_dfi.h"
 #include "export_registration_dfi.h"
 #include "remote_service_admin_dfi.h"
 #include "dyn_interface.h"
 #include "json_rpc.h"
+#include "binary_serializer.h"
+#include "binary_rpc.h"
 
 #include "remote_constants.h"
 #include "constants.h"
@@ -69,6 +76,7 @@ struct remote_service_admin {
 
     celix_thread_mutex_t exportedServicesLock;
     hash_map_pt exportedServices;
+    hash_map_pt exportsById; //key = service id, value = export registration, protected by exportedServicesLock
 
     celix_thread_mutex_t importedServicesLock;
     array_list_pt importedServices;
@@ -77,11 +85,22 @@ struct remote_service_admin {
     char *ip;
 
     struct mg_context *ctx;
-};
 
-struct post {
-    const char *readptr;
-    int size;
+    celix_thread_mutex_t curlLock;
+    hash_map_pt idleCurlHandles; // key = server (scheme://host:port), value = array_list of idle CURL handles keeping their connection open
+    unsigned int maxIdleConnections; // per server
+    CURLSH *curlShare; // DNS cache shared by all handles
+    celix_thread_mutex_t curlShareLock;
+    struct curl_slist *curlHeaders;
+    struct curl_slist *curlBinaryHeaders;
+    bool binaryProtocol; //import with the binary protocol when the endpoint offers it
+
+    celix_thread_mutex_t asyncLock;
+    bool asyncRunning; //protected by asyncLock
+    array_list_pt asyncPending; //calls not yet handed to the event loop, protected by asyncLock
+    celix_thread_t asyncThread;
+    CURLM *curlMulti; //only used by the event loop thread
+    int asyncWakeup[2]; //pipe waking up the event loop thread
 };
 
 struct get {
@@ -89,32 +108,95 @@ struct get {
     int size;
 };
 
+struct rsa_dfi_call {
+    remote_service_admin_pt admin;
+    import_registration_pt import;
+    dyn_function_type *func;
+    void **args;
+    char *request;
+    size_t requestLength;
+    bool binary;
+    struct get reply;
+    char url[256];
+    char server[256];
+    CURL *curl;
+    rsa_dfi_call_done_fn doneFn;
+    void *doneHandle;
+
+    celix_thread_mutex_t lock;
+    celix_thread_cond_t finished;
+    unsigned int refCount; //protected by lock
+    bool done; //protected by lock
+    int status; //protected by lock
+};
+
 #define OSGI_RSA_REMOTE_PROXY_FACTORY 	"remote_proxy_factory"
 #define OSGI_RSA_REMOTE_PROXY_TIMEOUT   "remote_proxy_timeout"
 
+// the content length lets the client keep the connection open for the next call
 static const char *data_response_headers =
         "HTTP/1.1 200 OK\r\n"
                 "Cache: no-cache\r\n"
                 "Content-Type: application/json\r\n"
+                "Content-Length: %zu\r\n"
+                "\r\n";
+
+static const char *binary_response_headers =
+        "HTTP/1.1 200 OK\r\n"
+                "Cache: no-cache\r\n"
+                "Content-Type: application/x-celix-dfi-binary\r\n"
+                "Content-Length: %zu\r\n"
                 "\r\n";
 
 static const char *no_content_response_headers =
-        "HTTP/1.1 204 OK\r\n";
+        "HTTP/1.1 204 OK\r\n"
+                "Content-Length: 0\r\n"
+                "\r\n";
 
 // TODO do we need to specify a non-Amdatu specific configuration type?!
 static const char * const CONFIGURATION_TYPE = "org.amdatu.remote.admin.http";
 static const char * const ENDPOINT_URL = "org.amdatu.remote.admin.http.url";
+// the protocols the exported endpoint understands, older exports only understand json
+static const char * const ENDPOINT_PROTOCOLS = "org.apache.celix.rsa.dfi.protocols";
+static const char * const SUPPORTED_PROTOCOLS = "json,binary";
+static const char * const BINARY_CONTENT_TYPE = "application/x-celix-dfi-binary";
 
 static const char *DEFAULT_PORT = "8888";
 static const char *DEFAULT_IP = "127.0.0.1";
 
 static const unsigned int DEFAULT_TIMEOUT = 0;
 
+/*
+ * A kept alive connection occupies a server thread until the client closes it or the server times it out after
+ * request_timeout_ms (30 s), there is no shorter idle timeout. With RSA_KEEP_ALIVE=yes, RSA_NUM_THREADS must
+ * therefore exceed (RSA_MAX_IDLE_CONNECTIONS + RSA_MAX_ASYNC_CONNECTIONS) times the number of client frameworks,
+ * plus the number of concurrent calls, otherwise clients starve and stopping the server waits for the idle connections.
+ */
+static const char *DEFAULT_NUM_THREADS = "5";
+static const char *DEFAULT_KEEP_ALIVE = "no";
+
+static const char *DEFAULT_PROTOCOL = "binary";
+
+static const unsigned int DEFAULT_MAX_IDLE_CONNECTIONS = 2;
+
+static const unsigned int DEFAULT_MAX_ASYNC_CONNECTIONS = 2;
+
 static int remoteServiceAdmin_callback(struct mg_connection *conn);
 static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_service_admin_pt admin, service_reference_pt reference, properties_pt props, char *interface, endpoint_description_pt *description);
-static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_pt endpointDescription, char *request, char **reply, int* replyStatus);
+static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_pt endpointDescription, bool binary, char *request, size_t requestLength, char **reply, size_t *replyLength, int* replyStatus);
+static int remoteServiceAdmin_getTimeout(remote_service_admin_pt rsa, endpoint_description_pt endpointDescription);
+static void remoteServiceAdmin_getServer(const char *url, char *server, size_t size);
+static void remoteServiceAdmin_setupPost(remote_service_admin_pt rsa, CURL *curl, const char *url, bool binary, const char *request, size_t requestLength, int timeout, struct get *get);
+static void remoteServiceAdmin_unrefCall(rsa_dfi_call_pt call);
+static void remoteServiceAdmin_completeCall(remote_service_admin_pt rsa, rsa_dfi_call_pt call, CURLcode res);
+static void* remoteServiceAdmin_asyncLoop(void *data);
 static celix_status_t remoteServiceAdmin_getIpAdress(char* interface, char** ip);
-static size_t remoteServiceAdmin_readCallback(void *ptr, size_t size, size_t nmemb, void *userp);
+static unsigned long remoteServiceAdmin_getExportServiceId(export_registration_pt registration);
+static CURL* remoteServiceAdmin_takeCurlHandle(remote_service_admin_pt admin, const char *server);
+static void remoteServiceAdmin_releaseCurlHandle(remote_service_admin_pt admin, const char *server, CURL *curl, bool reusable);
+static void remoteServiceAdmin_destroyCurlHandles(remote_service_admin_pt admin);
+static void remoteServiceAdmin_lockCurlShare(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr);
+static void remoteServiceAdmin_unlockCurlShare(CURL *handle, curl_lock_data data, void *userptr);
 static size_t remoteServiceAdmin_write(void *contents, size_t size, size_t nmemb, void *userp);
 static void remoteServiceAdmin_log(remote_service_admin_pt admin, int level, const char *file, int line, const char *msg, ...);
 
@@ -132,11 +214,54 @@ celix_status_t remoteServiceAdmin_create(bundle_context_pt context, remote_servi
         char *detectedIp = NULL;
         (*admin)->context = context;
         (*admin)->exportedServices = hashMap_create(NULL, NULL, NULL, NULL);
+        (*admin)->exportsById = hashMap_create(NULL, NULL, NULL, NULL);
          arrayList_create(&(*admin)->importedServices);
 
         celixThreadMutex_create(&(*admin)->exportedServicesLock, NULL);
         celixThreadMutex_create(&(*admin)->importedServicesLock, NULL);
 
+        celixThreadMutex_create(&(*admin)->curlLock, NULL);
+        celixThreadMutex_create(&(*admin)->curlShareLock, NULL);
+        (*admin)->idleCurlHandles = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+        (*admin)->curlShare = curl_share_init();
+        if ((*admin)->curlShare != NULL) {
+            curl_share_setopt((*admin)->curlShare, CURLSHOPT_LOCKFUNC, remoteServiceAdmin_lockCurlShare);
+            curl_share_setopt((*admin)->curlShare, CURLSHOPT_UNLOCKFUNC, remoteServiceAdmin_unlockCurlShare);
+            curl_share_setopt((*admin)->curlShare, CURLSHOPT_USERDATA, *admin);
+            curl_share_setopt((*admin)->curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        }
+        // no "Expect: 100-continue" round trip before larger requests
+        (*admin)->curlHeaders = curl_slist_append(NULL, "Expect:");
+        char binaryContentType[128];
+        snprintf(binaryContentType, sizeof(binaryContentType), "Content-Type: %s", BINARY_CONTENT_TYPE);
+        (*admin)->curlBinaryHeaders = curl_slist_append(NULL, "Expect:");
+        (*admin)->curlBinaryHeaders = curl_slist_append((*admin)->curlBinaryHeaders, binaryContentType);
+
+        const char *protocol = NULL;
+        bundleContext_getProperty(context, "RSA_DFI_PROTOCOL", &protocol);
+        if (protocol == NULL) {
+            protocol = DEFAULT_PROTOCOL;
+        }
+        (*admin)->binaryProtocol = strcmp(protocol, "binary") == 0;
+
+        celixThreadMutex_create(&(*admin)->asyncLock, NULL);
+        arrayList_create(&(*admin)->asyncPending);
+        (*admin)->curlMulti = curl_multi_init();
+        if ((*admin)->curlMulti != NULL) {
+            // asynchronous calls beyond this number wait in the event loop for a connection to the server
+            const char *maxAsync = NULL;
+            bundleContext_getProperty(context, "RSA_MAX_ASYNC_CONNECTIONS", &maxAsync);
+            long maxAsyncConnections = maxAsync != NULL ? strtol(maxAsync, NULL, 10) : DEFAULT_MAX_ASYNC_CONNECTIONS;
+            curl_multi_setopt((*admin)->curlMulti, CURLMOPT_MAX_HOST_CONNECTIONS, maxAsyncConnections);
+        }
+        if (pipe((*admin)->asyncWakeup) == 0) {
+            fcntl((*admin)->asyncWakeup[0], F_SETFL, O_NONBLOCK);
+            fcntl((*admin)->asyncWakeup[1], F_SETFL, O_NONBLOCK);
+        } else {
+            (*admin)->asyncWakeup[0] = -1;
+            (*admin)->asyncWakeup[1] = -1;
+        }
+
         if (logHelper_create(context, &(*admin)->loghelper) == CELIX_SUCCESS) {
             logHelper_start((*admin)->loghelper);
             dynCommon_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
@@ -145,6 +270,8 @@ celix_status_t remoteServiceAdmin_create(bundle_context_pt context, remote_servi
             dynInterface_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
             jsonSerializer_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
             jsonRpc_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
+            binarySerializer_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
+            binaryRpc_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
         }
 
         bundleContext_getProperty(context, "RSA_PORT", &port);
@@ -152,6 +279,10 @@ celix_status_t remoteServiceAdmin_create(bundle_context_pt context, remote_servi
             port = (char *)DEFAULT_PORT;
         }
 
+        const char *maxIdle = NULL;
+        bundleContext_getProperty(context, "RSA_MAX_IDLE_CONNECTIONS", &maxIdle);
+        (*admin)->maxIdleConnections = maxIdle != NULL ? (unsigned int) strtoul(maxIdle, NULL, 10) : DEFAULT_MAX_IDLE_CONNECTIONS;
+
         bundleContext_getProperty(context, "RSA_IP", &ip);
         if (ip == NULL) {
             const char *interface = NULL;
@@ -186,11 +317,23 @@ celix_status_t remoteServiceAdmin_create(bundle_context_pt context, remote_servi
         memset(&callbacks, 0, sizeof(callbacks));
         callbacks.begin_request = remoteServiceAdmin_callback;
 
+        // every kept alive connection occupies a server thread while it is open, see DEFAULT_KEEP_ALIVE
+        const char *numThreads = NULL;
+        const char *keepAlive = NULL;
+        bundleContext_getProperty(context, "RSA_NUM_THREADS", &numThreads);
+        bundleContext_getProperty(context, "RSA_KEEP_ALIVE", &keepAlive);
+        if (numThreads == NULL) {
+            numThreads = DEFAULT_NUM_THREADS;
+        }
+        if (keepAlive == NULL) {
+            keepAlive = DEFAULT_KEEP_ALIVE;
+        }
+
         char newPort[10];
 
         do {
 
-            const char *options[] = { "listening_ports", port, "num_threads", "5", NULL};
+            const char *options[] = { "listening_ports", port, "num_threads", numThreads, "enable_keep_alive", keepAlive, NULL};
 
             (*admin)->ctx = mg_start(&callbacks, (*admin), options);
 
@@ -216,6 +359,12 @@ celix_status_t remoteServiceAdmin_create(bundle_context_pt context, remote_servi
             }
         } while(((*admin)->ctx == NULL) && (port_counter < MAX_NUMBER_OF_RESTARTS));
 
+        if ((*admin)->curlMulti != NULL && (*admin)->asyncWakeup[0] >= 0) {
+            (*admin)->asyncRunning = true;
+            celixThread_create(&(*admin)->asyncThread, NULL, remoteServiceAdmin_asyncLoop, *admin);
+        } else {
+            logHelper_log((*admin)->loghelper, OSGI_LOGSERVICE_ERROR, "RSA: Cannot start event loop, asynchronous calls are not available");
+        }
     }
 
     return status;
@@ -226,6 +375,24 @@ celix_status_t remoteServiceAdmin_destroy(remote_service_admin_pt *admin)
 {
     celix_status_t status = CELIX_SUCCESS;
 
+    hashMap_destroy((*admin)->idleCurlHandles, false, false);
+    if ((*admin)->curlShare != NULL) {
+        curl_share_cleanup((*admin)->curlShare);
+    }
+    curl_slist_free_all((*admin)->curlHeaders);
+    curl_slist_free_all((*admin)->curlBinaryHeaders);
+    if ((*admin)->curlMulti != NULL) {
+        curl_multi_cleanup((*admin)->curlMulti);
+    }
+    if ((*admin)->asyncWakeup[0] >= 0) {
+        close((*admin)->asyncWakeup[0]);
+        close((*admin)->asyncWakeup[1]);
+    }
+    arrayList_destroy((*admin)->asyncPending);
+    celixThreadMutex_destroy(&(*admin)->asyncLock);
+    celixThreadMutex_destroy(&(*admin)->curlLock);
+    celixThreadMutex_destroy(&(*admin)->curlShareLock);
+
     free((*admin)->ip);
     free((*admin)->port);
     free(*admin);
@@ -241,6 +408,19 @@ celix_status_t remoteServiceAdmin_destroy(remote_service_admin_pt *admin)
 celix_status_t remoteServiceAdmin_stop(remote_service_admin_pt admin) {
     celix_status_t status = CELIX_SUCCESS;
 
+    //fails the asynchronous calls that are not done yet, before their imports are stopped
+    celixThreadMutex_lock(&admin->asyncLock);
+    bool asyncRunning = admin->asyncRunning;
+    admin->asyncRunning = false;
+    celixThreadMutex_unlock(&admin->asyncLock);
+    if (asyncRunning) {
+        char wakeup = 1;
+        if (write(admin->asyncWakeup[1], &wakeup, 1) < 0) {
+            //pipe already full, the event loop is woken up anyway
+        }
+        celixThread_join(admin->asyncThread, NULL);
+    }
+
     celixThreadMutex_lock(&admin->exportedServicesLock);
 
     hash_map_iterator_pt iter = hashMapIterator_create(admin->exportedServices);
@@ -257,6 +437,8 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_pt admin) {
         arrayList_destroy(exports);
     }
     hashMapIterator_destroy(iter);
+    hashMap_clear(admin->exportedServices, false, false);
+    hashMap_clear(admin->exportsById, false, false);
     celixThreadMutex_unlock(&admin->exportedServicesLock);
 
     celixThreadMutex_lock(&admin->importedServicesLock);
@@ -278,8 +460,11 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_pt admin) {
     }
 
     hashMap_destroy(admin->exportedServices, false, false);
+    hashMap_destroy(admin->exportsById, false, false);
     arrayList_destroy(admin->importedServices);
 
+    remoteServiceAdmin_destroyCurlHandles(admin);
+
     logHelper_stop(admin->loghelper);
     logHelper_destroy(&admin->loghelper);
 
@@ -317,28 +502,13 @@ static int remoteServiceAdmin_callback(struct mg_connection *conn) {
 
             celixThreadMutex_lock(&rsa->exportedServicesLock);
 
-            //find endpoint
-            export_registration_pt export = NULL;
-            hash_map_iterator_pt iter = hashMapIterator_create(rsa->exportedServices);
-            while (hashMapIterator_hasNext(iter)) {
-                hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
-                array_list_pt exports = hashMapEntry_getValue(entry);
-                int expIt = 0;
-                for (expIt = 0; expIt < arrayList_size(exports); expIt++) {
-                    export_registration_pt check = arrayList_get(exports, expIt);
-                    export_reference_pt  ref = NULL;
-                    exportRegistration_getExportReference(check, &ref);
-                    endpoint_description_pt  checkEndpoint = NULL;
-                    exportReference_getExportedEndpoint(ref, &checkEndpoint);
-                    if (serviceId == checkEndpoint->serviceId) {
-                        export = check;
-                        free(ref);
-                        break;
-                    }
-                    free(ref);
-                }
+            export_registration_pt export = hashMap_get(rsa->exportsById, (void *) (uintptr_t) serviceId);
+
+            //the acquired export stays valid until released, so calls run without holding the exported services lock
+            if (export != NULL && exportRegistration_acquire(export) != CELIX_SUCCESS) {
+                export = NULL;
             }
-            hashMapIterator_destroy(iter);
+            celixThreadMutex_unlock(&rsa->exportedServicesLock);
 
             if (export != NULL) {
 
@@ -347,16 +517,26 @@ static int remoteServiceAdmin_callback(struct mg_connection *conn) {
                 mg_read(conn, data, datalength);
                 data[datalength] = '\0';
 
+                const char *contentType = mg_get_header(conn, "Content-Type");
+                bool binary = contentType != NULL && strcmp(contentType, BINARY_CONTENT_TYPE) == 0;
+
                 char *response = NULL;
-                int responceLength = 0;
-                int rc = exportRegistration_call(export, data, -1, &response, &responceLength);
+                size_t responseLength = 0;
+                int rc = CELIX_SUCCESS;
+                if (binary) {
+                    rc = exportRegistration_callBinary(export, data, datalength, &response, &responseLength);
+                } else {
+                    int responceLength = 0;
+                    rc = exportRegistration_call(export, data, -1, &response, &responceLength);
+                    responseLength = response != NULL ? strlen(response) : 0;
+                }
                 if (rc != CELIX_SUCCESS) {
                     RSA_LOG_ERROR(rsa, "Error trying to invoke remove service, got error %i\n", rc);
                 }
 
                 if (rc == CELIX_SUCCESS && response != NULL) {
-                    mg_write(conn, data_response_headers, strlen(data_response_headers));
-                    mg_write(conn, response, strlen(response));
+                    mg_printf(conn, binary ? binary_response_headers : data_response_headers, responseLength);
+                    mg_write(conn, response, responseLength);
                     free(response);
                 } else {
                     mg_write(conn, no_content_response_headers, strlen(no_content_response_headers));
@@ -364,13 +544,12 @@ static int remoteServiceAdmin_callback(struct mg_connection *conn) {
                 result = 1;
 
                 free(data);
+                exportRegistration_release(export);
             } else {
                 result = 0;
                 RSA_LOG_WARNING(rsa, "NO export registration found for service id %lu", serviceId);
             }
 
-            celixThreadMutex_unlock(&rsa->exportedServicesLock);
-
         }
     }
 
@@ -441,6 +620,13 @@ celix_status_t remoteServiceAdmin_exportService(remote_service_admin_pt admin, c
     if (status == CELIX_SUCCESS) {
         celixThreadMutex_lock(&admin->exportedServicesLock);
         hashMap_put(admin->exportedServices, reference, *registrations);
+        for (i = 0; i < arrayList_size(*registrations); i++) {
+            export_registration_pt registration = arrayList_get(*registrations, i);
+            unsigned long id = remoteServiceAdmin_getExportServiceId(registration);
+            if (!hashMap_containsKey(admin->exportsById, (void *) (uintptr_t) id)) {
+                hashMap_put(admin->exportsById, (void *) (uintptr_t) id, registration);
+            }
+        }
         celixThreadMutex_unlock(&admin->exportedServicesLock);
     }
     else{
@@ -469,6 +655,13 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_pt
     		arrayList_destroy(exports);
     	}
 
+        endpoint_description_pt endpoint = NULL;
+        exportReference_getExportedEndpoint(ref, &endpoint);
+        void *id = (void *) (uintptr_t) endpoint->serviceId;
+        if (hashMap_get(admin->exportsById, id) == registration) {
+            hashMap_remove(admin->exportsById, id);
+        }
+
         exportRegistration_close(registration);
         exportRegistration_destroy(registration);
 
@@ -483,6 +676,18 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_pt
     return status;
 }
 
+static unsigned long remoteServiceAdmin_getExportServiceId(export_registration_pt registration) {
+    unsigned long id = 0;
+    export_reference_pt ref = NULL;
+    if (exportRegistration_getExportReference(registration, &ref) == CELIX_SUCCESS) {
+        endpoint_description_pt endpoint = NULL;
+        exportReference_getExportedEndpoint(ref, &endpoint);
+        id = endpoint->serviceId;
+        free(ref);
+    }
+    return id;
+}
+
 static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_service_admin_pt admin, service_reference_pt reference, properties_pt props, char *interface, endpoint_description_pt *endpoint) {
 
     celix_status_t status = CELIX_SUCCESS;
@@ -529,6 +734,7 @@ static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_servic
     properties_set(endpointProperties, (char*) OSGI_RSA_SERVICE_IMPORTED, "true");
     properties_set(endpointProperties, (char*) OSGI_RSA_SERVICE_IMPORTED_CONFIGS, (char*) CONFIGURATION_TYPE);
     properties_set(endpointProperties, (char*) ENDPOINT_URL, url);
+    properties_set(endpointProperties, (char*) ENDPOINT_PROTOCOLS, (char*) SUPPORTED_PROTOCOLS);
 
     if (props != NULL) {
         hash_map_iterator_pt propIter = hashMapIterator_create(props);
@@ -627,6 +833,9 @@ celix_status_t remoteServiceAdmin_importService(remote_service_admin_pt admin, e
         status = importRegistration_create(admin->context, endpointDescription, objectClass, serviceVersion, &import);
     }
     if (status == CELIX_SUCCESS && import != NULL) {
+        const char *protocols = properties_get(endpointDescription->properties, (char*) ENDPOINT_PROTOCOLS);
+        bool binary = admin->binaryProtocol && protocols != NULL && strstr(protocols, "binary") != NULL;
+        importRegistration_setBinary(import, binary);
         importRegistration_setSendFn(import, (send_func_type) remoteServiceAdmin_send, admin);
     }
 
@@ -669,11 +878,8 @@ celix_status_t remoteServiceAdmin_removeImportedService(remote_service_admin_pt
 }
 
 
-static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_pt endpointDescription, char *request, char **reply, int* replyStatus) {
+static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_pt endpointDescription, bool binary, char *request, size_t requestLength, char **reply, size_t *replyLength, int* replyStatus) {
     remote_service_admin_pt  rsa = handle;
-    struct post post;
-    post.readptr = request;
-    post.size = strlen(request);
 
     struct get get;
     get.size = 0;
@@ -683,6 +889,34 @@ static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description
     char url[256];
     snprintf(url, 256, "%s", serviceUrl);
 
+    // connections are pooled per server, e.g. http://host:port
+    char server[256];
+    remoteServiceAdmin_getServer(url, server, 256);
+
+    celix_status_t status = CELIX_SUCCESS;
+    CURL *curl;
+    CURLcode res;
+
+    curl = remoteServiceAdmin_takeCurlHandle(rsa, server);
+    if(!curl) {
+        status = CELIX_ILLEGAL_STATE;
+        free(get.writeptr);
+    } else {
+        remoteServiceAdmin_setupPost(rsa, curl, url, binary, request, requestLength, remoteServiceAdmin_getTimeout(rsa, endpointDescription), &get);
+        logHelper_log(rsa->loghelper, OSGI_LOGSERVICE_DEBUG, "RSA: Performing curl post\n");
+        res = curl_easy_perform(curl);
+
+        *reply = get.writeptr;
+        *replyLength = get.size;
+        *replyStatus = res;
+
+        remoteServiceAdmin_releaseCurlHandle(rsa, server, curl, res == CURLE_OK);
+    }
+
+    return status;
+}
+
+static int remoteServiceAdmin_getTimeout(remote_service_admin_pt rsa, endpoint_description_pt endpointDescription) {
     // assume the default timeout
     int timeout = DEFAULT_TIMEOUT;
 
@@ -699,46 +933,326 @@ static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description
         timeout = atoi(timeoutStr);
     }
 
+    return timeout;
+}
+
+static void remoteServiceAdmin_getServer(const char *url, char *server, size_t size) {
+    snprintf(server, size, "%s", url);
+    char *path = strstr(server, "://");
+    path = strchr(path != NULL ? path + 3 : server, '/');
+    if (path != NULL) {
+        *path = '\0';
+    }
+}
+
+static void remoteServiceAdmin_setupPost(remote_service_admin_pt rsa, CURL *curl, const char *url, bool binary, const char *request, size_t requestLength, int timeout, struct get *get) {
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout);
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (curl_off_t)requestLength);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, binary ? rsa->curlBinaryHeaders : rsa->curlHeaders);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, remoteServiceAdmin_write);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)get);
+}
+
+celix_status_t remoteServiceAdmin_callAsync(void *handle, void *proxy, const char *method, void *args[], rsa_dfi_call_done_fn done, void *doneHandle, rsa_dfi_call_pt *out) {
+    remote_service_admin_pt rsa = handle;
     celix_status_t status = CELIX_SUCCESS;
-    CURL *curl;
-    CURLcode res;
 
-    curl = curl_easy_init();
-    if(!curl) {
-        status = CELIX_ILLEGAL_STATE;
-    } else {
-        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout);
-        curl_easy_setopt(curl, CURLOPT_URL, url);
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        curl_easy_setopt(curl, CURLOPT_READFUNCTION, remoteServiceAdmin_readCallback);
-        curl_easy_setopt(curl, CURLOPT_READDATA, &post);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, remoteServiceAdmin_write);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&get);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (curl_off_t)post.size);
-        logHelper_log(rsa->loghelper, OSGI_LOGSERVICE_DEBUG, "RSA: Performing curl post\n");
-        res = curl_easy_perform(curl);
+    rsa_dfi_call_pt call = calloc(1, sizeof(*call));
+    if (call == NULL) {
+        return CELIX_ENOMEM;
+    }
 
-        *reply = get.writeptr;
-        *replyStatus = res;
+    endpoint_description_pt endpoint = NULL;
+    status = importRegistration_prepareCall(proxy, method, args, &call->import, &endpoint, &call->func, &call->binary, &call->request, &call->requestLength);
 
-        curl_easy_cleanup(curl);
+    if (status == CELIX_SUCCESS) {
+        int nrOfArgs = dynFunction_nrOfArguments(call->func);
+        call->args = calloc(nrOfArgs, sizeof(void *));
+        call->reply.size = 0;
+        call->reply.writeptr = malloc(1);
+        if (call->args != NULL && call->reply.writeptr != NULL) {
+            memcpy(call->args, args, nrOfArgs * sizeof(void *));
+        } else {
+            status = CELIX_ENOMEM;
+        }
+    }
+
+    if (status == CELIX_SUCCESS) {
+        char *serviceUrl = (char*)properties_get(endpoint->properties, (char*) ENDPOINT_URL);
+        snprintf(call->url, 256, "%s", serviceUrl);
+        remoteServiceAdmin_getServer(call->url, call->server, 256);
+
+        call->curl = remoteServiceAdmin_takeCurlHandle(rsa, call->server);
+        if (call->curl != NULL) {
+            remoteServiceAdmin_setupPost(rsa, call->curl, call->url, call->binary, call->request, call->requestLength, remoteServiceAdmin_getTimeout(rsa, endpoint), &call->reply);
+            curl_easy_setopt(call->curl, CURLOPT_PRIVATE, call);
+        } else {
+            status = CELIX_ILLEGAL_STATE;
+        }
+    }
+
+    if (status == CELIX_SUCCESS) {
+        call->admin = rsa;
+        call->doneFn = done;
+        call->doneHandle = doneHandle;
+        call->refCount = 2; //caller & event loop
+        celixThreadMutex_create(&call->lock, NULL);
+        celixThreadCondition_init(&call->finished, NULL);
+
+        celixThreadMutex_lock(&rsa->asyncLock);
+        if (rsa->asyncRunning) {
+            arrayList_add(rsa->asyncPending, call);
+        } else {
+            status = CELIX_ILLEGAL_STATE;
+        }
+        celixThreadMutex_unlock(&rsa->asyncLock);
+
+        if (status == CELIX_SUCCESS) {
+            char wakeup = 1;
+            if (write(rsa->asyncWakeup[1], &wakeup, 1) < 0) {
+                //pipe already full, the event loop is woken up anyway
+            }
+            *out = call;
+        } else {
+            celixThreadCondition_destroy(&call->finished);
+            celixThreadMutex_destroy(&call->lock);
+        }
+    }
+
+    if (status != CELIX_SUCCESS) {
+        if (call->curl != NULL) {
+            remoteServiceAdmin_releaseCurlHandle(rsa, call->server, call->curl, false);
+        }
+        if (call->import != NULL) {
+            importRegistration_finishCall(call->import, call->func, NULL, 0, NULL);
+        }
+        free(call->request);
+        free(call->reply.writeptr);
+        free(call->args);
+        free(call);
     }
 
     return status;
 }
 
-static size_t remoteServiceAdmin_readCallback(void *ptr, size_t size, size_t nmemb, void *userp) {
-    struct post *post = userp;
+int remoteServiceAdmin_waitAsync(void *handle, rsa_dfi_call_pt call, unsigned int timeoutInMs, int *callStatus) {
+    int rc = 0;
+
+    celixThreadMutex_lock(&call->lock);
+    if (timeoutInMs == 0) {
+        while (!call->done) {
+            celixThreadCondition_wait(&call->finished, &call->lock);
+        }
+    } else {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeoutInMs / 1000;
+        deadline.tv_nsec += (timeoutInMs % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (!call->done && rc == 0) {
+            rc = pthread_cond_timedwait(&call->finished, &call->lock, &deadline);
+        }
+        if (call->done) {
+            rc = 0;
+        }
+    }
+    if (rc == 0) {
+        *callStatus = call->status;
+    }
+    celixThreadMutex_unlock(&call->lock);
+
+    return rc;
+}
+
+void remoteServiceAdmin_releaseAsync(void *handle, rsa_dfi_call_pt call) {
+    remoteServiceAdmin_unrefCall(call);
+}
+
+static void remoteServiceAdmin_unrefCall(rsa_dfi_call_pt call) {
+    celixThreadMutex_lock(&call->lock);
+    call->refCount -= 1;
+    bool destroy = call->refCount == 0;
+    celixThreadMutex_unlock(&call->lock);
+
+    if (destroy) {
+        celixThreadCondition_destroy(&call->finished);
+        celixThreadMutex_destroy(&call->lock);
+        free(call->args);
+        free(call);
+    }
+}
+
+static void remoteServiceAdmin_completeCall(remote_service_admin_pt rsa, rsa_dfi_call_pt call, CURLcode res) {
+    int status = res;
+    if (res == CURLE_OK) {
+        status = importRegistration_finishCall(call->import, call->func, call->reply.writeptr, call->reply.size, call->args);
+    } else {
+        importRegistration_finishCall(call->import, call->func, NULL, 0, NULL);
+    }
+    remoteServiceAdmin_releaseCurlHandle(rsa, call->server, call->curl, res == CURLE_OK);
+    call->curl = NULL;
+    free(call->request);
+    call->request = NULL;
+    free(call->reply.writeptr);
+    call->reply.writeptr = NULL;
+
+    celixThreadMutex_lock(&call->lock);
+    call->status = status;
+    call->done = true;
+    celixThreadCondition_broadcast(&call->finished);
+    celixThreadMutex_unlock(&call->lock);
+
+    if (call->doneFn != NULL) {
+        call->doneFn(call->doneHandle, call, status);
+    }
+
+    remoteServiceAdmin_unrefCall(call);
+}
+
+static void* remoteServiceAdmin_asyncLoop(void *data) {
+    remote_service_admin_pt rsa = data;
+    array_list_pt active = NULL; // calls added to the multi handle
+    array_list_pt added = NULL;
+    arrayList_create(&active);
+    arrayList_create(&added);
+
+    bool running = true;
+    while (running) {
+        celixThreadMutex_lock(&rsa->asyncLock);
+        running = rsa->asyncRunning;
+        arrayList_addAll(added, rsa->asyncPending);
+        arrayList_clear(rsa->asyncPending);
+        celixThreadMutex_unlock(&rsa->asyncLock);
+
+        int i;
+        for (i = 0; i < arrayList_size(added); i++) {
+            rsa_dfi_call_pt call = arrayList_get(added, i);
+            curl_multi_add_handle(rsa->curlMulti, call->curl);
+            arrayList_add(active, call);
+        }
+        arrayList_clear(added);
+
+        int stillRunning = 0;
+        curl_multi_perform(rsa->curlMulti, &stillRunning);
+
+        CURLMsg *msg = NULL;
+        int msgsLeft = 0;
+        while ((msg = curl_multi_info_read(rsa->curlMulti, &msgsLeft)) != NULL) {
+            if (msg->msg == CURLMSG_DONE) {
+                CURL *curl = msg->easy_handle;
+                CURLcode res = msg->data.result;
+                rsa_dfi_call_pt call = NULL;
+                curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char **)&call);
+                curl_multi_remove_handle(rsa->curlMulti, curl);
+                arrayList_removeElement(active, call);
+                remoteServiceAdmin_completeCall(rsa, call, res);
+            }
+        }
+
+        if (running) {
+            struct curl_waitfd wakeup;
+            wakeup.fd = rsa->asyncWakeup[0];
+            wakeup.events = CURL_WAIT_POLLIN;
+            wakeup.revents = 0;
+            curl_multi_wait(rsa->curlMulti, &wakeup, 1, 1000, NULL);
+            if (wakeup.revents != 0) {
+                char buf[64];
+                while (read(rsa->asyncWakeup[0], buf, sizeof(buf)) > 0) {
+                    //drain
+                }
+            }
+        }
+    }
+
+    //stopped, fail the calls that are not done yet
+    int i;
+    for (i = 0; i < arrayList_size(active); i++) {
+        rsa_dfi_call_pt call = arrayList_get(active, i);
+        curl_multi_remove_handle(rsa->curlMulti, call->curl);
+        remoteServiceAdmin_completeCall(rsa, call, CURLE_ABORTED_BY_CALLBACK);
+    }
+    arrayList_destroy(active);
+    arrayList_destroy(added);
+
+    return NULL;
+}
+
+static CURL* remoteServiceAdmin_takeCurlHandle(remote_service_admin_pt admin, const char *server) {
+    CURL *curl = NULL;
+
+    celixThreadMutex_lock(&admin->curlLock);
+    array_list_pt idle = hashMap_get(admin->idleCurlHandles, server);
+    if (idle != NULL && arrayList_size(idle) > 0) {
+        curl = arrayList_remove(idle, arrayList_size(idle) - 1);
+    }
+    celixThreadMutex_unlock(&admin->curlLock);
+
+    if (curl == NULL) {
+        curl = curl_easy_init();
+        if (curl != NULL && admin->curlShare != NULL) {
+            curl_easy_setopt(curl, CURLOPT_SHARE, admin->curlShare);
+        }
+    }
+
+    return curl;
+}
+
+static void remoteServiceAdmin_releaseCurlHandle(remote_service_admin_pt admin, const char *server, CURL *curl, bool reusable) {
+    bool pooled = false;
+
+    if (reusable) {
+        celixThreadMutex_lock(&admin->curlLock);
+        array_list_pt idle = hashMap_get(admin->idleCurlHandles, server);
+        if (idle == NULL) {
+            arrayList_create(&idle);
+            hashMap_put(admin->idleCurlHandles, strdup(server), idle);
+        }
+        if (arrayList_size(idle) < admin->maxIdleConnections) {
+            arrayList_add(idle, curl);
+            pooled = true;
+        }
+        celixThreadMutex_unlock(&admin->curlLock);
+    }
+
+    if (!pooled) {
+        curl_easy_cleanup(curl);
+    }
+}
 
-    if (post->size) {
-        *(char *) ptr = post->readptr[0];
-        post->readptr++;
-        post->size--;
-        return 1;
+static void remoteServiceAdmin_destroyCurlHandles(remote_service_admin_pt admin) {
+    celixThreadMutex_lock(&admin->curlLock);
+    hash_map_iterator_pt iter = hashMapIterator_create(admin->idleCurlHandles);
+    while (hashMapIterator_hasNext(iter)) {
+        hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
+        array_list_pt idle = hashMapEntry_getValue(entry);
+        int i;
+        for (i = 0; i < arrayList_size(idle); i++) {
+            curl_easy_cleanup(arrayList_get(idle, i));
+        }
+        arrayList_destroy(idle);
+        free(hashMapEntry_getKey(entry));
     }
+    hashMapIterator_destroy(iter);
+    hashMap_clear(admin->idleCurlHandles, false, false);
+    celixThreadMutex_unlock(&admin->curlLock);
+}
+
+static void remoteServiceAdmin_lockCurlShare(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr) {
+    remote_service_admin_pt admin = userptr;
+    celixThreadMutex_lock(&admin->curlShareLock);
+}
 
-    return 0;
+static void remoteServiceAdmin_unlockCurlShare(CURL *handle, curl_lock_data data, void *userptr) {
+    remote_service_admin_pt admin = userptr;
+    celixThreadMutex_unlock(&admin->curlShareLock);
 }
 
 static size_t remoteServiceAdmin_write(void *contents, size_t size, size_t nmemb, void *userp) {
@@ -0,0 +1,72 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+/*
+ * remote_service_admin_dfi_async.h
+ *
+ *  \date       Oct 19, 2026
+ *  \author    	<a href="mailto:dev@celix.apache.org">Apache Celix Project Team</a>
+ *  \copyright	Apache License, Version 2.0
+ */
+
+#ifndef REMOTE_SERVICE_ADMIN_DFI_ASYNC_H_
+#define REMOTE_SERVICE_ADMIN_DFI_ASYNC_H_
+
+#define RSA_DFI_ASYNC_SERVICE "remote_service_admin_dfi_async"
+
+typedef struct rsa_dfi_call rsa_dfi_call_t;
+typedef rsa_dfi_call_t* rsa_dfi_call_pt;
+
+/**
+ * Called from the event loop thread of the remote service admin when a call is done.
+ * status is 0 when the reply has been written to the output arguments.
+ */
+typedef void (*rsa_dfi_call_done_fn)(void *handle, rsa_dfi_call_pt call, int status);
+
+/**
+ * Calls methods of services imported by the DFI remote service admin without blocking the caller.
+ * All calls are sent and received by one event loop thread.
+ */
+struct rsa_dfi_async_service {
+	void *handle;
+
+	/**
+	 * Starts a call of method 'method' (the name of the method in the descriptor) of the imported service 'proxy'.
+	 * args are the arguments as for the proxy function: args[i] points to argument i, args[0] to the service handle.
+	 * The input arguments are serialized before call returns. The output arguments must stay valid,
+	 * and the proxy must not be ungotten, until the call is done.
+	 * done (may be NULL) is called when the call is done. Every call must be released.
+	 */
+	int (*call)(void *handle, void *proxy, const char *method, void *args[], rsa_dfi_call_done_fn done, void *doneHandle, rsa_dfi_call_pt *call);
+
+	/**
+	 * Waits at most timeoutInMs (0 is forever) until the call is done.
+	 * Returns ETIMEDOUT when the call is not done yet, otherwise 0 with the status of the call in callStatus.
+	 */
+	int (*wait)(void *handle, rsa_dfi_call_pt call, unsigned int timeoutInMs, int *callStatus);
+
+	/**
+	 * Releases the call. A call that is not done yet completes without a caller.
+	 */
+	void (*release)(void *handle, rsa_dfi_call_pt call);
+};
+
+typedef struct rsa_dfi_async_service rsa_dfi_async_service_t;
+typedef rsa_dfi_async_service_t* rsa_dfi_async_service_pt;
+
+#endif /* REMOTE_SERVICE_ADMIN_DFI_ASYNC_H_ */
@@ -20,6 +20,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 #include <service_tracker_customizer.h>
 #include <service_tracker.h>
 
@@ -28,9 +29,11 @@
 #include "service_registration.h"
 #include "service_reference.h"
 #include "celix_errno.h"
+#include "celix_threads.h"
 
 #include "tst_service.h"
 #include "calculator_service.h"
+#include "remote_service_admin_dfi_async.h"
 
 
 struct activator {
@@ -41,11 +44,20 @@ struct activator {
 	service_tracker_customizer_pt cust;
 	service_tracker_pt tracker;
 	calculator_service_pt calc;
+
+	service_tracker_customizer_pt asyncCust;
+	service_tracker_pt asyncTracker;
+	rsa_dfi_async_service_pt async;
 };
 
 static celix_status_t addCalc(void * handle, service_reference_pt reference, void * service);
 static celix_status_t removeCalc(void * handle, service_reference_pt reference, void * service);
+static celix_status_t addAsync(void * handle, service_reference_pt reference, void * service);
+static celix_status_t removeAsync(void * handle, service_reference_pt reference, void * service);
 static int test(void *handle);
+static int roundTrips(void *handle, int nrOfCalls, double *usPerCall);
+static int concurrentCalls(void *handle, int nrOfThreads, int callsPerThread, double *callsPerSecond);
+static int asyncCalls(void *handle, int nrOfCalls, double *callsPerSecond);
 
 celix_status_t bundleActivator_create(bundle_context_pt context, void **out) {
 	celix_status_t status = CELIX_SUCCESS;
@@ -54,9 +66,14 @@ celix_status_t bundleActivator_create(bundle_context_pt context, void **out) {
 		act->context = context;
 		act->serv.handle = act;
 		act->serv.test = test;
+		act->serv.roundTrips = roundTrips;
+		act->serv.concurrentCalls = concurrentCalls;
+		act->serv.asyncCalls = asyncCalls;
 
 		status = serviceTrackerCustomizer_create(act, NULL, addCalc, NULL, removeCalc, &act->cust);
 		status = CELIX_DO_IF(status, serviceTracker_create(context, CALCULATOR2_SERVICE, act->cust, &act->tracker));
+		status = CELIX_DO_IF(status, serviceTrackerCustomizer_create(act, NULL, addAsync, NULL, removeAsync, &act->asyncCust));
+		status = CELIX_DO_IF(status, serviceTracker_create(context, RSA_DFI_ASYNC_SERVICE, act->asyncCust, &act->asyncTracker));
 
 	} else {
 		status = CELIX_ENOMEM;
@@ -73,6 +90,10 @@ celix_status_t bundleActivator_create(bundle_context_pt context, void **out) {
 			serviceTracker_destroy(act->tracker);
 			act->tracker = NULL;
 		}
+		if (act->asyncTracker != NULL) {
+			serviceTracker_destroy(act->asyncTracker);
+			act->asyncTracker = NULL;
+		}
 		free(act);
 	}
 
@@ -96,6 +117,20 @@ static celix_status_t removeCalc(void * handle, service_reference_pt reference,
 
 }
 
+static celix_status_t addAsync(void * handle, service_reference_pt reference, void * service) {
+	struct activator * act = handle;
+	act->async = service;
+	return CELIX_SUCCESS;
+}
+
+static celix_status_t removeAsync(void * handle, service_reference_pt reference, void * service) {
+	struct activator * act = handle;
+	if (act->async == service) {
+		act->async = NULL;
+	}
+	return CELIX_SUCCESS;
+}
+
 celix_status_t bundleActivator_start(void * userData, bundle_context_pt context) {
     celix_status_t status = CELIX_SUCCESS;
 	struct activator * act = userData;
@@ -104,6 +139,7 @@ celix_status_t bundleActivator_start(void * userData, bundle_context_pt context)
 	status = bundleContext_registerService(context, (char *)TST_SERVICE_NAME, &act->serv, NULL, &act->reg);
 
 	status = CELIX_DO_IF(status, serviceTracker_open(act->tracker));
+	status = CELIX_DO_IF(status, serviceTracker_open(act->asyncTracker));
 
 
 	return status;
@@ -116,6 +152,7 @@ celix_status_t bundleActivator_stop(void * userData, bundle_context_pt context)
 
 	status = serviceRegistration_unregister(act->reg);
 	status = CELIX_DO_IF(status, serviceTracker_close(act->tracker));
+	status = CELIX_DO_IF(status, serviceTracker_close(act->asyncTracker));
 
 	return status;
 }
@@ -127,6 +164,10 @@ celix_status_t bundleActivator_destroy(void * userData, bundle_context_pt contex
 			serviceTracker_destroy(act->tracker);
 			act->tracker = NULL;
 		}
+		if (act->asyncTracker != NULL) {
+			serviceTracker_destroy(act->asyncTracker);
+			act->asyncTracker = NULL;
+		}
 		free(act);
 	}
 	return CELIX_SUCCESS;
@@ -151,3 +192,133 @@ static int test(void *handle) {
 	}
 	return status;
 }
+
+/* Adds 1 to first .. first + nrOfCalls - 1, returns non zero when a call fails or returns a wrong result */
+static int addCalls(struct activator *act, int first, int nrOfCalls) {
+	double result = 0.0;
+	int rc = 0;
+	int i;
+
+	for (i = first; i < first + nrOfCalls && rc == 0; i++) {
+		rc = act->calc->add(act->calc->calculator, i, 1.0, &result);
+		if (rc == 0 && result != i + 1.0) {
+			printf("add(%d, 1) returned %f\n", i, result);
+			rc = 1;
+		}
+	}
+	return rc;
+}
+
+static int roundTrips(void *handle, int nrOfCalls, double *usPerCall) {
+	struct activator *act = handle;
+	struct timespec start;
+	struct timespec end;
+
+	if (act->calc == NULL || nrOfCalls <= 0) {
+		printf("calc not ready\n");
+		return 1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	int rc = addCalls(act, 0, nrOfCalls);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	*usPerCall = ((end.tv_sec - start.tv_sec) * 1000000.0 + (end.tv_nsec - start.tv_nsec) / 1000.0) / nrOfCalls;
+	return rc;
+}
+
+struct call_thread_data {
+	struct activator *act;
+	int first;
+	int nrOfCalls;
+	int rc;
+};
+
+static void* callThread(void *data) {
+	struct call_thread_data *td = data;
+	td->rc = addCalls(td->act, td->first, td->nrOfCalls);
+	return NULL;
+}
+
+static int concurrentCalls(void *handle, int nrOfThreads, int callsPerThread, double *callsPerSecond) {
+	struct activator *act = handle;
+	celix_thread_t threads[nrOfThreads];
+	struct call_thread_data data[nrOfThreads];
+	struct timespec start;
+	struct timespec end;
+	int rc = 0;
+	int i;
+
+	if (act->calc == NULL || nrOfThreads <= 0 || callsPerThread <= 0) {
+		printf("calc not ready\n");
+		return 1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < nrOfThreads; i++) {
+		//every thread adds its own numbers, so a reply delivered to the wrong caller is detected
+		data[i].act = act;
+		data[i].first = i * callsPerThread;
+		data[i].nrOfCalls = callsPerThread;
+		data[i].rc = 1;
+		celixThread_create(&threads[i], NULL, callThread, &data[i]);
+	}
+	for (i = 0; i < nrOfThreads; i++) {
+		celixThread_join(threads[i], NULL);
+		if (data[i].rc != 0) {
+			rc = 1;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+	*callsPerSecond = (nrOfThreads * callsPerThread) / seconds;
+	return rc;
+}
+
+static int asyncCalls(void *handle, int nrOfCalls, double *callsPerSecond) {
+	struct activator *act = handle;
+	calculator_service_pt calc = act->calc;
+	rsa_dfi_async_service_pt async = act->async;
+	struct timespec start;
+	struct timespec end;
+	int rc = 0;
+	int i;
+
+	if (calc == NULL || async == NULL || nrOfCalls <= 0) {
+		printf("calc or async service not ready\n");
+		return 1;
+	}
+
+	rsa_dfi_call_pt calls[nrOfCalls];
+	double a[nrOfCalls];
+	double b = 1.0;
+	double results[nrOfCalls];
+	double *out[nrOfCalls];
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < nrOfCalls; i++) {
+		a[i] = i;
+		results[i] = -1.0;
+		out[i] = &results[i];
+		void *args[] = { &calc->calculator, &a[i], &b, &out[i] };
+		calls[i] = NULL;
+		if (async->call(async->handle, calc, "add", args, NULL, NULL, &calls[i]) != 0) {
+			rc = 1;
+		}
+	}
+	for (i = 0; i < nrOfCalls; i++) {
+		int callStatus = 1;
+		if (calls[i] != NULL) {
+			if (async->wait(async->handle, calls[i], 0, &callStatus) != 0 || callStatus != 0 || results[i] != i + 1.0) {
+				rc = 1;
+			}
+			async->release(async->handle, calls[i]);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+	*callsPerSecond = nrOfCalls / seconds;
+	return rc;
+}
@@ -25,6 +25,9 @@
 struct tst_service {
     void *handle;
     int (*test)(void *handle);
+    int (*roundTrips)(void *handle, int nrOfCalls, double *usPerCall); // average round trip latency of calculator calls
+    int (*concurrentCalls)(void *handle, int nrOfThreads, int callsPerThread, double *callsPerSecond); // calculator calls from nrOfThreads threads at once, fails on a wrong result
+    int (*asyncCalls)(void *handle, int nrOfCalls, double *callsPerSecond); // nrOfCalls asynchronous calculator calls at once, from one thread
 };
 
 typedef struct tst_service *tst_service_pt;
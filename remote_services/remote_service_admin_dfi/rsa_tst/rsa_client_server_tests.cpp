@@ -87,34 +87,102 @@ extern "C" {
         clientFramework = NULL;
     }
 
-    static void test1(void) {
-        celix_status_t rc;
-        service_reference_pt ref = NULL;
+    //waits at most 4 seconds for the imported tst service
+    static tst_service_pt getTstService(service_reference_pt *ref) {
+        celix_status_t rc = CELIX_SUCCESS;
         tst_service_pt tst = NULL;
         int retries = 4;
 
-        while (ref == NULL && retries > 0) {
+        *ref = NULL;
+        while (retries > 0) {
+            rc = bundleContext_getServiceReference(clientContext, (char *) TST_SERVICE_NAME, ref);
+            if (*ref != NULL) {
+                break;
+            }
             printf("Waiting for service .. %d\n", retries);
-            rc = bundleContext_getServiceReference(clientContext, (char *) TST_SERVICE_NAME, &ref);
             usleep(1000000);
             --retries;
         }
 
         CHECK_EQUAL(CELIX_SUCCESS, rc);
-        CHECK(ref != NULL);
+        CHECK(*ref != NULL);
 
-        rc = bundleContext_getService(clientContext, ref, (void **)&tst);
+        rc = bundleContext_getService(clientContext, *ref, (void **)&tst);
         CHECK_EQUAL(CELIX_SUCCESS, rc);
         CHECK(tst != NULL);
 
-        rc = tst->test(tst->handle);
-        CHECK_EQUAL(CELIX_SUCCESS, rc);
+        return tst;
+    }
 
+    static void ungetTstService(service_reference_pt ref) {
         bool result;
         bundleContext_ungetService(clientContext, ref, &result);
         bundleContext_ungetServiceReference(clientContext, ref);
     }
 
+    static void test1(void) {
+        celix_status_t rc;
+        service_reference_pt ref = NULL;
+        tst_service_pt tst = getTstService(&ref);
+
+        rc = tst->test(tst->handle);
+        CHECK_EQUAL(CELIX_SUCCESS, rc);
+
+        ungetTstService(ref);
+    }
+
+    static void testRoundTripLatency(void) {
+        celix_status_t rc;
+        service_reference_pt ref = NULL;
+        tst_service_pt tst = getTstService(&ref);
+
+        //first call sets up the connection
+        double usPerCall = 0.0;
+        rc = tst->roundTrips(tst->handle, 1, &usPerCall);
+        CHECK_EQUAL(0, rc);
+
+        rc = tst->roundTrips(tst->handle, 1000, &usPerCall);
+        CHECK_EQUAL(0, rc);
+        printf("RSA round trip latency: %.1f us per call\n", usPerCall);
+
+        ungetTstService(ref);
+    }
+
+    static void testConcurrentCalls(void) {
+        celix_status_t rc;
+        service_reference_pt ref = NULL;
+        tst_service_pt tst = getTstService(&ref);
+
+        double usPerCall = 0.0;
+        rc = tst->roundTrips(tst->handle, 1, &usPerCall);
+        CHECK_EQUAL(0, rc);
+
+        double singleThread = 0.0;
+        rc = tst->concurrentCalls(tst->handle, 1, 2000, &singleThread);
+        CHECK_EQUAL(0, rc);
+
+        double fourThreads = 0.0;
+        rc = tst->concurrentCalls(tst->handle, 4, 500, &fourThreads);
+        CHECK_EQUAL(0, rc);
+        //only logged, the throughput depends on the load of the machine
+        printf("RSA throughput: %.0f calls/s with 1 thread, %.0f calls/s with 4 threads\n", singleThread, fourThreads);
+
+        ungetTstService(ref);
+    }
+
+    static void testAsyncCalls(void) {
+        celix_status_t rc;
+        service_reference_pt ref = NULL;
+        tst_service_pt tst = getTstService(&ref);
+
+        double callsPerSecond = 0.0;
+        rc = tst->asyncCalls(tst->handle, 200, &callsPerSecond);
+        CHECK_EQUAL(0, rc);
+        printf("RSA throughput: %.0f calls/s with 200 asynchronous calls from 1 thread\n", callsPerSecond);
+
+        ungetTstService(ref);
+    }
+
 }
 
 
@@ -131,3 +199,15 @@ TEST_GROUP(RsaDfiClientServerTests) {
 TEST(RsaDfiClientServerTests, Test1) {
     test1();
 }
+
+TEST(RsaDfiClientServerTests, RoundTripLatency) {
+    testRoundTripLatency();
+}
+
+TEST(RsaDfiClientServerTests, ConcurrentCalls) {
+    testConcurrentCalls();
+}
+
+TEST(RsaDfiClientServerTests, AsyncCalls) {
+    testAsyncCalls();
+}
@@ -30,6 +30,8 @@ extern "C" {
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
+#include <curl/curl.h>
 
 #include "celix_launcher.h"
 #include "framework.h"
@@ -180,6 +182,76 @@ extern "C" {
          */
     }
 
+    static size_t writeReply(void *contents, size_t size, size_t nmemb, void *userp) {
+        return size * nmemb; //only the status code is checked
+    }
+
+    static void testManyExportedServices(void) {
+        const int nrOfServices = 200;
+        const int nrOfCalls = 2000;
+        service_registration_pt regs[nrOfServices];
+        array_list_pt exports[nrOfServices];
+        char urls[nrOfServices][256];
+        int rc = 0;
+        int i;
+
+        for (i = 0; i < nrOfServices; i++) {
+            properties_pt props = properties_create();
+            properties_set(props, (char *)OSGI_RSA_SERVICE_EXPORTED_INTERFACES, (char *)CALCULATOR2_SERVICE);
+            rc = bundleContext_registerService(context, (char *)CALCULATOR2_SERVICE, calc, props, &regs[i]);
+            CHECK_EQUAL(CELIX_SUCCESS, rc);
+
+            properties_pt regProps = NULL;
+            serviceRegistration_getProperties(regs[i], &regProps);
+            const char *id = properties_get(regProps, (char *)OSGI_FRAMEWORK_SERVICE_ID);
+
+            exports[i] = NULL;
+            rc = rsa->exportService(rsa->admin, (char *)id, NULL, &exports[i]);
+            CHECK_EQUAL(CELIX_SUCCESS, rc);
+            CHECK_EQUAL(1, arrayList_size(exports[i]));
+
+            export_reference_pt ref = NULL;
+            endpoint_description_pt endpoint = NULL;
+            rsa->exportRegistration_getExportReference((export_registration_pt)arrayList_get(exports[i], 0), &ref);
+            rsa->exportReference_getExportedEndpoint(ref, &endpoint);
+            snprintf(urls[i], 256, "%s", properties_get(endpoint->properties, (char *)"org.amdatu.remote.admin.http.url"));
+            free(ref);
+        }
+
+        //calls spread over all exported services, on one kept alive connection
+        CURL *curl = curl_easy_init();
+        CHECK(curl != NULL);
+        const char *request = "{\"m\":\"add(DD)D\",\"a\":[1.0,2.0]}";
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)strlen(request));
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeReply);
+
+        struct timespec start;
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < nrOfCalls; i++) {
+            curl_easy_setopt(curl, CURLOPT_URL, urls[(i * 7) % nrOfServices]);
+            CHECK_EQUAL(CURLE_OK, curl_easy_perform(curl));
+            long code = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+            CHECK_EQUAL(200, code);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        curl_easy_cleanup(curl);
+
+        double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+        printf("RSA: %.0f calls/s to %i exported services\n", nrOfCalls / seconds, nrOfServices);
+
+        for (i = 0; i < nrOfServices; i++) {
+            rc = rsa->exportRegistration_close(rsa->admin, (export_registration_pt)arrayList_get(exports[i], 0));
+            CHECK_EQUAL(CELIX_SUCCESS, rc);
+            rc = serviceRegistration_unregister(regs[i]);
+            CHECK_EQUAL(CELIX_SUCCESS, rc);
+        }
+    }
+
     static void testBundles(void) {
         array_list_pt bundles = NULL;
 
@@ -229,6 +301,10 @@ TEST(RsaDfiTests, ImportService) {
     testImportService();
 }
 
+TEST(RsaDfiTests, ManyExportedServices) {
+    testManyExportedServices();
+}
+
 TEST(RsaDfiTests, TestBundles) {
     testBundles();
 }